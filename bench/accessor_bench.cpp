@@ -0,0 +1,152 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <cgltf/cgltf.h>
+
+#include <io/accessor_decoder.h>
+#include <io/types/vertex.h>
+
+#include "bench.h"
+
+const uint32_t ELEMENT_COUNT = 1 << 20;
+
+typedef struct {
+	const char *name;
+	cgltf_component_type componentType;
+	cgltf_type type;
+	bool normalized;
+	uint32_t stride; // 0 for tightly packed
+	uint32_t sparseCount;
+} Layout;
+
+const Layout LAYOUTS[] = {
+	{ "f32 vec3 packed", cgltf_component_type_r_32f, cgltf_type_vec3, false, 0, 0 },
+	{ "f32 vec3 interleaved", cgltf_component_type_r_32f, cgltf_type_vec3, false, 32, 0 },
+	{ "f32 vec2 interleaved", cgltf_component_type_r_32f, cgltf_type_vec2, false, 32, 0 },
+	{ "u16n vec2 packed", cgltf_component_type_r_16u, cgltf_type_vec2, true, 0, 0 },
+	{ "u8n vec2 strided", cgltf_component_type_r_8u, cgltf_type_vec2, true, 4, 0 },
+	{ "s16n vec3 strided", cgltf_component_type_r_16, cgltf_type_vec3, true, 8, 0 },
+	{ "s8n vec3 strided", cgltf_component_type_r_8, cgltf_type_vec3, true, 4, 0 },
+	{ "u16 vec3 strided", cgltf_component_type_r_16u, cgltf_type_vec3, false, 8, 0 },
+	{ "f32 vec3 sparse 1%", cgltf_component_type_r_32f, cgltf_type_vec3, false, 0, ELEMENT_COUNT / 100 },
+};
+
+typedef struct {
+	std::vector<uint8_t> data;
+
+	cgltf_buffer buffer;
+	cgltf_buffer_view view;
+	cgltf_buffer_view sparseIndicesView;
+	cgltf_buffer_view sparseValuesView;
+	cgltf_accessor accessor;
+} Source;
+
+static void _sourceCreate(const Layout &layout, Source &source) {
+	const size_t elementSize = cgltf_calc_size(layout.type, layout.componentType);
+	const size_t stride = layout.stride != 0 ? layout.stride : elementSize;
+	const size_t denseSize = stride * (ELEMENT_COUNT - 1) + elementSize;
+	const size_t indicesSize = layout.sparseCount * sizeof(uint32_t);
+	const size_t valuesSize = layout.sparseCount * elementSize;
+
+	source.data.resize(denseSize + indicesSize + valuesSize);
+	for (size_t i = 0; i < source.data.size(); i++)
+		source.data[i] = (uint8_t)(rand() & 0xff);
+
+	// keep random float bit patterns finite so results can be compared
+	if (layout.componentType == cgltf_component_type_r_32f) {
+		for (size_t i = 0; i + sizeof(float) <= source.data.size(); i += sizeof(float)) {
+			float value = (rand() / (float)RAND_MAX) * 2.0f - 1.0f;
+			memcpy(&source.data[i], &value, sizeof(float));
+		}
+	}
+
+	memset(&source.buffer, 0, sizeof(source.buffer));
+	source.buffer.size = source.data.size();
+	source.buffer.data = source.data.data();
+
+	memset(&source.view, 0, sizeof(source.view));
+	source.view.buffer = &source.buffer;
+	source.view.size = denseSize;
+	source.view.stride = layout.stride;
+
+	memset(&source.accessor, 0, sizeof(source.accessor));
+	source.accessor.component_type = layout.componentType;
+	source.accessor.normalized = layout.normalized;
+	source.accessor.type = layout.type;
+	source.accessor.count = ELEMENT_COUNT;
+	source.accessor.stride = stride;
+	source.accessor.buffer_view = &source.view;
+
+	if (layout.sparseCount == 0)
+		return;
+
+	uint32_t *indices = reinterpret_cast<uint32_t *>(&source.data[denseSize]);
+	for (uint32_t i = 0; i < layout.sparseCount; i++) {
+		uint32_t index = i * (ELEMENT_COUNT / layout.sparseCount);
+		memcpy(&indices[i], &index, sizeof(index));
+	}
+
+	memset(&source.sparseIndicesView, 0, sizeof(source.sparseIndicesView));
+	source.sparseIndicesView.buffer = &source.buffer;
+	source.sparseIndicesView.offset = denseSize;
+	source.sparseIndicesView.size = indicesSize;
+
+	memset(&source.sparseValuesView, 0, sizeof(source.sparseValuesView));
+	source.sparseValuesView.buffer = &source.buffer;
+	source.sparseValuesView.offset = denseSize + indicesSize;
+	source.sparseValuesView.size = valuesSize;
+
+	source.accessor.is_sparse = true;
+	source.accessor.sparse.count = layout.sparseCount;
+	source.accessor.sparse.indices_buffer_view = &source.sparseIndicesView;
+	source.accessor.sparse.indices_component_type = cgltf_component_type_r_32u;
+	source.accessor.sparse.values_buffer_view = &source.sparseValuesView;
+}
+
+int main() {
+	std::vector<Vertex> reference(ELEMENT_COUNT);
+	std::vector<Vertex> decoded(ELEMENT_COUNT);
+
+	printf("%-22s %12s %12s %8s %10s\n", "layout", "scalar ns/el", "simd ns/el", "speedup", "max error");
+
+	bool mismatch = false;
+	for (const Layout &layout : LAYOUTS) {
+		Source source;
+		_sourceCreate(layout, source);
+
+		const uint32_t components = cgltf_num_components(layout.type);
+		float *referenceOut = reference[0].position;
+		float *decodedOut = decoded[0].position;
+
+		double referenceTime = benchMedian([&] {
+			AccessorDecoder::floatsDecodeReference(source.accessor, referenceOut, components, sizeof(Vertex));
+			benchKeep(reference[0]);
+		});
+
+		double decodedTime = benchMedian([&] {
+			AccessorDecoder::floatsDecode(source.accessor, decodedOut, components, sizeof(Vertex));
+			benchKeep(decoded[0]);
+		});
+
+		float maxError = 0.0f;
+		for (uint32_t i = 0; i < ELEMENT_COUNT; i++) {
+			for (uint32_t c = 0; c < components; c++) {
+				float error = std::fabs(reference[i].position[c] - decoded[i].position[c]);
+				maxError = std::max(maxError, error);
+			}
+		}
+
+		// the reference divides, the kernels multiply by the reciprocal
+		if (maxError > 1e-6f)
+			mismatch = true;
+
+		printf("%-22s %12.3f %12.3f %7.2fx %10.2e\n", layout.name, referenceTime * 1e6 / ELEMENT_COUNT,
+				decodedTime * 1e6 / ELEMENT_COUNT, referenceTime / decodedTime, maxError);
+	}
+
+	return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
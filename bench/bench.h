@@ -0,0 +1,34 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <core/timer.h>
+
+// Keeps the compiler from discarding a result that is otherwise unused.
+template <typename T>
+inline void benchKeep(const T &value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Runs function warmup times untimed, then repetitions times and returns the
+// median duration of a single run in milliseconds.
+template <typename F>
+double benchMedian(F function, uint32_t warmup = 2, uint32_t repetitions = 7) {
+	for (uint32_t i = 0; i < warmup; i++)
+		function();
+
+	std::vector<double> times(repetitions);
+	for (uint32_t i = 0; i < repetitions; i++) {
+		Timer timer;
+		function();
+		times[i] = timer.elapsed();
+	}
+
+	std::sort(times.begin(), times.end());
+	return times[repetitions / 2];
+}
+
+#endif // !BENCH_H
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <core/thread_pool.h>
+
+#include <math/frustum.h>
+#include <math/projection.h>
+#include <math/transform_batch.h>
+#include <math/types/mat4.h>
+#include <math/types/vec3.h>
+
+#include "bench.h"
+
+using namespace math;
+
+// Owns the arrays behind the streams, instances scattered through a cube around the camera.
+typedef struct {
+	std::vector<float> boxes[6];
+	std::vector<float> spheres[4];
+} Instances;
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static Instances _instancesCreate(uint32_t count, float extent) {
+	Instances instances;
+	for (std::vector<float> &component : instances.boxes)
+		component.resize(count);
+	for (std::vector<float> &component : instances.spheres)
+		component.resize(count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		float size[3] = { 0.5f + std::fabs(_random()) * 4.0f, 0.5f + std::fabs(_random()) * 4.0f,
+			0.5f + std::fabs(_random()) * 4.0f };
+
+		for (int c = 0; c < 3; c++) {
+			instances.boxes[c][i] = _random() * extent;
+			instances.boxes[3 + c][i] = size[c];
+			instances.spheres[c][i] = instances.boxes[c][i] + size[c] * 0.5f;
+		}
+
+		instances.spheres[3][i] = 0.5f * std::sqrt(size[0] * size[0] + size[1] * size[1] + size[2] * size[2]);
+	}
+
+	return instances;
+}
+
+static void _resultPrint(const char *name, uint32_t count, uint32_t visibleCount, double time, bool matches) {
+	printf("%-28s %10.3f ms %12.0f %10u %s\n", name, time, count / time, visibleCount, matches ? "" : "MISMATCH");
+}
+
+// Culls count instances, 1M by default, against a reverse z perspective camera and reports objects per ms
+// for one element at a time, the batch kernels on one thread and on all threads.
+int main(int argc, char *argv[]) {
+	const uint32_t count = argc > 1 ? atoi(argv[1]) : 1000000;
+	const uint32_t threadCount = argc > 2 ? atoi(argv[2]) : 0;
+
+	srand(1);
+	Instances instances = _instancesCreate(count, 500.0f);
+	std::vector<float> *boxes = instances.boxes;
+	std::vector<float> *spheres = instances.spheres;
+
+	const AABBStream aabbs = { boxes[0].data(), boxes[1].data(), boxes[2].data(), boxes[3].data(), boxes[4].data(),
+		boxes[5].data() };
+	const SphereStream sphereStream = { spheres[0].data(), spheres[1].data(), spheres[2].data(),
+		spheres[3].data() };
+
+	const mat4 viewProjection = perspective(16.0f / 9.0f, 1.0f, 0.1f, 400.0f) *
+			lookAt(vec3(0.0f, 2.0f, 0.0f), vec3(1.0f, 1.5f, -3.0f), vec3(0.0f, 1.0f, 0.0f));
+	const Frustum frustum = frustumExtract(viewProjection);
+
+	ThreadPool pool(threadCount);
+	std::vector<uint32_t> visible(count), referenceVisible(count);
+
+	printf("%u instances, %u threads\n", count, pool.threadCount());
+	printf("%-28s %13s %12s %10s\n", "test", "time", "objects/ms", "visible");
+
+	uint32_t referenceCount = 0;
+	double time = benchMedian([&] {
+		referenceCount = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			if (frustumSphereTest(frustum, vec3(spheres[0][i], spheres[1][i], spheres[2][i]), spheres[3][i]))
+				referenceVisible[referenceCount++] = i;
+		}
+	});
+	_resultPrint("spheres, one at a time", count, referenceCount, time, true);
+
+	auto matches = [&](uint32_t visibleCount) {
+		return visibleCount == referenceCount &&
+				std::equal(visible.begin(), visible.begin() + visibleCount, referenceVisible.begin());
+	};
+
+	uint32_t visibleCount = 0;
+	time = benchMedian([&] { visibleCount = spheresCull(frustum, sphereStream, count, visible.data()); });
+	_resultPrint("spheres, batches of 8", count, visibleCount, time, matches(visibleCount));
+
+	time = benchMedian([&] { visibleCount = spheresCull(frustum, sphereStream, count, visible.data(), &pool); });
+	_resultPrint("spheres, batches, threaded", count, visibleCount, time, matches(visibleCount));
+
+	time = benchMedian([&] {
+		referenceCount = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			vec3 halfExtents = vec3(boxes[3][i], boxes[4][i], boxes[5][i]) * 0.5f;
+			vec3 center = vec3(boxes[0][i], boxes[1][i], boxes[2][i]) + halfExtents;
+
+			if (frustumBoxTest(frustum, center, halfExtents))
+				referenceVisible[referenceCount++] = i;
+		}
+	});
+	_resultPrint("aabbs, one at a time", count, referenceCount, time, true);
+
+	time = benchMedian([&] { visibleCount = aabbsCull(frustum, aabbs, count, visible.data()); });
+	_resultPrint("aabbs, batches of 8", count, visibleCount, time, matches(visibleCount));
+
+	time = benchMedian([&] { visibleCount = aabbsCull(frustum, aabbs, count, visible.data(), &pool); });
+	_resultPrint("aabbs, batches, threaded", count, visibleCount, time, matches(visibleCount));
+
+	time = benchMedian([&] { visibleCount = boundsCull(frustum, sphereStream, aabbs, count, visible.data()); });
+	_resultPrint("spheres then aabbs", count, visibleCount, time, true);
+
+	time = benchMedian(
+			[&] { visibleCount = boundsCull(frustum, sphereStream, aabbs, count, visible.data(), &pool); });
+	_resultPrint("spheres then aabbs, threaded", count, visibleCount, time, true);
+
+	return EXIT_SUCCESS;
+}
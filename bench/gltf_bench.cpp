@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <core/memory_stats.h>
+
+#include <io/gltf_loader.h>
+
+// Every operator new of the process, the loader's own containers and the thread pool included.
+// cgltf allocates through malloc and the scene through the arena, the latter is in LoadStats.
+static std::atomic<uint64_t> heapAllocations(0);
+
+void *operator new(size_t size) {
+	heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	void *pointer = malloc(size == 0 ? 1 : size);
+	if (pointer == nullptr)
+		throw std::bad_alloc();
+
+	return pointer;
+}
+
+// GCC cannot tell that the replaced operator new allocates through malloc.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wunknown-warning-option"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void operator delete(void *pointer) noexcept {
+	free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+	free(pointer);
+}
+
+#pragma GCC diagnostic pop
+
+typedef struct {
+	std::string path;
+	bool loaded;
+	uint32_t runs;
+	LoadStats stats; // of the median run by total time
+	uint64_t heapAllocations;
+	uint64_t rssPeak;
+} AssetResult;
+
+static bool _assetPath(const std::string &path) {
+	size_t dot = path.find_last_of('.');
+	if (dot == std::string::npos)
+		return false;
+
+	std::string extension = path.substr(dot);
+	return extension == ".gltf" || extension == ".glb";
+}
+
+// Recursive, sorted so the JSON of two runs can be diffed.
+static void _assetsFind(const std::string &path, std::vector<std::string> &assets) {
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0) {
+		fprintf(stderr, "Failed to open %s\n", path.c_str());
+		return;
+	}
+
+	if (!S_ISDIR(info.st_mode)) {
+		assets.push_back(path);
+		return;
+	}
+
+	DIR *directory = opendir(path.c_str());
+	if (directory == nullptr)
+		return;
+
+	std::vector<std::string> entries;
+	while (struct dirent *entry = readdir(directory)) {
+		if (entry->d_name[0] != '.')
+			entries.push_back(path + "/" + entry->d_name);
+	}
+
+	closedir(directory);
+	std::sort(entries.begin(), entries.end());
+
+	for (const std::string &entry : entries) {
+		if (stat(entry.c_str(), &info) != 0)
+			continue;
+
+		if (S_ISDIR(info.st_mode))
+			_assetsFind(entry, assets);
+		else if (_assetPath(entry))
+			assets.push_back(entry);
+	}
+}
+
+static AssetResult _assetRun(const std::string &path, const LoadOptions &options, uint32_t runs) {
+	AssetResult result = {};
+	result.path = path;
+	result.runs = runs;
+
+	std::vector<LoadStats> stats(runs);
+	std::vector<uint64_t> allocations(runs);
+
+	for (uint32_t i = 0; i < runs; i++) {
+		uint64_t allocationsBefore = heapAllocations.load();
+		Scene scene = GLTFLoader::loadFile(path.c_str(), options, &stats[i]);
+		allocations[i] = heapAllocations.load() - allocationsBefore;
+
+		if (scene.arena == nullptr)
+			return result;
+
+		GLTFLoader::sceneFree(scene);
+	}
+
+	std::vector<uint32_t> order(runs);
+	for (uint32_t i = 0; i < runs; i++)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(),
+			[&](uint32_t a, uint32_t b) { return stats[a].totalTime < stats[b].totalTime; });
+
+	uint32_t median = order[runs / 2];
+	result.loaded = true;
+	result.stats = stats[median];
+	result.heapAllocations = allocations[median];
+	result.rssPeak = memoryRssPeak();
+	return result;
+}
+
+static double _perSecond(uint64_t count, double milliseconds) {
+	return milliseconds > 0.0 ? count / (milliseconds / 1e3) : 0.0;
+}
+
+static void _jsonString(FILE *file, const std::string &value) {
+	fputc('"', file);
+	for (char c : value) {
+		if (c == '"' || c == '\\')
+			fprintf(file, "\\%c", c);
+		else if ((unsigned char)c < 0x20)
+			fprintf(file, "\\u%04x", c);
+		else
+			fputc(c, file);
+	}
+	fputc('"', file);
+}
+
+static void _jsonWrite(FILE *file, const std::vector<AssetResult> &results, const LoadOptions &options) {
+	const char *BOOLEANS[] = { "false", "true" };
+	fprintf(file, "{\n  \"options\": {\n");
+	fprintf(file, "    \"mapFiles\": %s,\n    \"optimizeMeshes\": %s,\n    \"buildMeshlets\": %s,\n",
+			BOOLEANS[options.mapFiles], BOOLEANS[options.optimizeMeshes], BOOLEANS[options.buildMeshlets]);
+	fprintf(file, "    \"loadTextures\": %s,\n    \"weldVertices\": %s,\n    \"orientedBounds\": %s\n",
+			BOOLEANS[options.loadTextures], BOOLEANS[options.weldVertices], BOOLEANS[options.orientedBounds]);
+	fprintf(file, "  },\n  \"assets\": [");
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const AssetResult &result = results[i];
+		const LoadStats &stats = result.stats;
+
+		fprintf(file, "%s\n    {\n      \"path\": ", i == 0 ? "" : ",");
+		_jsonString(file, result.path);
+		fprintf(file, ",\n      \"loaded\": %s", result.loaded ? "true" : "false");
+
+		if (!result.loaded) {
+			fprintf(file, "\n    }");
+			continue;
+		}
+
+		fprintf(file, ",\n      \"runs\": %u,\n      \"threads\": %u,\n", result.runs, stats.threadCount);
+		fprintf(file, "      \"meshes\": %u,\n      \"primitives\": %u,\n      \"nodes\": %u,\n", stats.meshCount,
+				stats.primitiveCount, stats.nodeCount);
+		fprintf(file, "      \"vertices\": %lu,\n      \"triangles\": %lu,\n      \"textures\": %u,\n",
+				stats.vertexCount, stats.triangleCount, stats.textureCount);
+		if (options.validateBounds)
+			fprintf(file, "      \"boundsMismatches\": %u,\n", stats.boundsMismatchCount);
+
+		fprintf(file, "      \"timesMs\": {\n");
+		fprintf(file, "        \"total\": %.4f,\n        \"parse\": %.4f,\n        \"buffers\": %.4f,\n",
+				stats.totalTime, stats.parseTime, stats.bufferTime);
+		fprintf(file, "        \"meshopt\": %.4f,\n", stats.meshoptTime);
+		fprintf(file, "        \"hierarchy\": %.4f,\n        \"meshes\": %.4f,\n        \"textures\": %.4f,\n",
+				stats.hierarchyTime, stats.meshTime, stats.textureTime);
+		fprintf(file, "        \"cache\": %.4f,\n        \"indices\": %.4f,\n        \"attributes\": %.4f,\n",
+				stats.cacheTime, stats.indexTime, stats.attributeTime);
+		fprintf(file, "        \"weld\": %.4f,\n        \"normals\": %.4f,\n        \"tangents\": %.4f,\n",
+				stats.weldTime, stats.normalTime, stats.tangentTime);
+		fprintf(file, "        \"bounds\": %.4f,\n", stats.boundsTime);
+		fprintf(file, "        \"optimize\": %.4f,\n        \"meshlets\": %.4f,\n        \"lods\": %.4f,\n",
+				stats.optimizeTime, stats.meshletTime, stats.lodTime);
+		fprintf(file, "        \"mips\": %.4f\n      },\n", stats.mipTime);
+
+		fprintf(file, "      \"trianglesPerSecond\": %.1f,\n      \"verticesPerSecond\": %.1f,\n",
+				_perSecond(stats.triangleCount, stats.totalTime), _perSecond(stats.vertexCount, stats.totalTime));
+
+		fprintf(file, "      \"memory\": {\n");
+		fprintf(file, "        \"fileBytes\": %lu,\n        \"rssGrowth\": %lu,\n        \"rssPeak\": %lu,\n",
+				stats.fileBytes, stats.rssGrowth, result.rssPeak);
+		fprintf(file, "        \"arenaBytes\": %lu,\n        \"arenaReserved\": %lu,\n", stats.arenaBytes,
+				stats.arenaReserved);
+		fprintf(file, "        \"arenaAllocations\": %lu,\n        \"arenaBlocks\": %lu,\n", stats.arenaAllocations,
+				stats.arenaBlocks);
+		fprintf(file, "        \"heapAllocations\": %lu\n      }\n    }", result.heapAllocations);
+	}
+
+	fprintf(file, "\n  ]\n}\n");
+}
+
+static void _usagePrint(const char *name) {
+	printf("Usage: %s [options] <file or directory>...\n", name);
+	printf("Loads every .gltf/.glb without a window or a GPU and reports where the time and memory go.\n");
+	printf("  -t <count>   loader threads, 0 for the hardware concurrency (default)\n");
+	printf("  -r <count>   loads per asset, the median run by total time is reported (default 5)\n");
+	printf("  -j <path>    write JSON results to path, - for stdout instead of the table\n");
+	printf("  -m           mmap source files\n");
+	printf("  -o           optimize meshes\n");
+	printf("  -l           build meshlets\n");
+	printf("  -x           decode textures\n");
+	printf("  -w           weld vertices\n");
+	printf("  -b           fit oriented boxes and count stored AABBs off from the positions\n");
+}
+
+// Headless import benchmark for catching loader regressions, e.g. in CI. The mesh cache
+// stays disabled so every run goes through glTF parsing. Exits with failure if any asset
+// does not load.
+int main(int argc, char *argv[]) {
+	LoadOptions options;
+	options.threadCount = 0;
+
+	uint32_t runs = 5;
+	const char *jsonPath = nullptr;
+	std::vector<std::string> assets;
+
+	for (int i = 1; i < argc; i++) {
+		const char *argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(argument, "-t") == 0 && hasValue)
+			options.threadCount = atoi(argv[++i]);
+		else if (strcmp(argument, "-r") == 0 && hasValue)
+			runs = std::max(atoi(argv[++i]), 1);
+		else if (strcmp(argument, "-j") == 0 && hasValue)
+			jsonPath = argv[++i];
+		else if (strcmp(argument, "-m") == 0)
+			options.mapFiles = true;
+		else if (strcmp(argument, "-o") == 0)
+			options.optimizeMeshes = true;
+		else if (strcmp(argument, "-l") == 0)
+			options.buildMeshlets = true;
+		else if (strcmp(argument, "-x") == 0)
+			options.loadTextures = true;
+		else if (strcmp(argument, "-w") == 0)
+			options.weldVertices = true;
+		else if (strcmp(argument, "-b") == 0)
+			options.orientedBounds = options.validateBounds = true;
+		else if (argument[0] == '-') {
+			_usagePrint(argv[0]);
+			return EXIT_FAILURE;
+		} else
+			_assetsFind(argument, assets);
+	}
+
+	if (assets.empty()) {
+		_usagePrint(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	bool table = jsonPath == nullptr || strcmp(jsonPath, "-") != 0;
+	if (table) {
+		printf("%-40s %10s %10s %10s %10s %12s %12s %10s %10s\n", "asset", "total (ms)", "parse", "buffers",
+				"meshes", "Mtri/s", "Mvert/s", "rss (MB)", "allocs");
+	}
+
+	std::vector<AssetResult> results;
+	bool success = true;
+
+	for (const std::string &asset : assets) {
+		results.push_back(_assetRun(asset, options, runs));
+
+		const AssetResult &result = results.back();
+		const LoadStats &stats = result.stats;
+		success = success && result.loaded;
+
+		std::string name = asset.size() > 40 ? "..." + asset.substr(asset.size() - 37) : asset;
+
+		if (!table)
+			continue;
+
+		if (!result.loaded) {
+			printf("%-40s failed to load\n", name.c_str());
+			continue;
+		}
+
+		double triangleRate = _perSecond(stats.triangleCount, stats.totalTime) / 1e6;
+		double vertexRate = _perSecond(stats.vertexCount, stats.totalTime) / 1e6;
+
+		printf("%-40s %10.3f %10.3f %10.3f %10.3f %12.2f %12.2f %10.2f %10lu\n", name.c_str(), stats.totalTime,
+				stats.parseTime, stats.bufferTime, stats.meshTime, triangleRate, vertexRate,
+				stats.rssGrowth / (1024.0 * 1024.0), result.heapAllocations + stats.arenaAllocations);
+	}
+
+	if (jsonPath != nullptr) {
+		FILE *file = table ? fopen(jsonPath, "w") : stdout;
+		if (file == nullptr) {
+			fprintf(stderr, "Failed to write %s\n", jsonPath);
+			return EXIT_FAILURE;
+		}
+
+		_jsonWrite(file, results, options);
+
+		if (file != stdout)
+			fclose(file);
+	}
+
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <core/arena.h>
+#include <core/thread_pool.h>
+
+#include <io/transform_hierarchy.h>
+#include <io/types/hierarchy.h>
+
+#include "bench.h"
+
+// Random tree with fanout around branching, built breadth first the way the loader flattens it.
+static Hierarchy _hierarchyCreate(uint32_t count, uint32_t branching, Arena &arena) {
+	std::vector<uint32_t> parents(1, NO_PARENT);
+	std::vector<uint32_t> levelEnds(1, 1);
+
+	srand(1);
+	uint32_t levelBegin = 0;
+	while (parents.size() < count) {
+		uint32_t levelEnd = parents.size();
+
+		for (uint32_t parent = levelBegin; parent < levelEnd && parents.size() < count; parent++) {
+			uint32_t children = 1 + rand() % (2 * branching - 1);
+			for (uint32_t i = 0; i < children && parents.size() < count; i++)
+				parents.push_back(parent);
+		}
+
+		levelBegin = levelEnd;
+		levelEnds.push_back(parents.size());
+	}
+
+	Hierarchy hierarchy = TransformHierarchy::hierarchyAllocate(count, levelEnds.size(), arena);
+
+	hierarchy.levelOffsets[0] = 0;
+	for (uint32_t i = 0; i < levelEnds.size(); i++)
+		hierarchy.levelOffsets[i + 1] = levelEnds[i];
+
+	for (uint32_t i = 0; i < count; i++) {
+		float angle = 0.001f * i;
+
+		Transform &local = hierarchy.locals[i];
+		local.translation[0] = 1.0f;
+		local.translation[1] = 0.5f;
+		local.translation[2] = 0.0f;
+		local.rotation[0] = 0.0f;
+		local.rotation[1] = std::sin(angle);
+		local.rotation[2] = 0.0f;
+		local.rotation[3] = std::cos(angle);
+		local.scale[0] = local.scale[1] = local.scale[2] = 1.0f;
+
+		hierarchy.parents[i] = parents[i];
+		hierarchy.meshIndices[i] = NO_MESH;
+	}
+
+	TransformHierarchy::dirtyAll(hierarchy);
+	return hierarchy;
+}
+
+// Edits editCount random nodes, the subtrees below them are recomputed as well.
+static void _edit(Hierarchy &hierarchy, uint32_t editCount) {
+	for (uint32_t i = 0; i < editCount; i++) {
+		uint32_t node = rand() % hierarchy.count;
+
+		Transform local = hierarchy.locals[node];
+		local.translation[1] += 0.01f;
+		TransformHierarchy::localSet(hierarchy, node, local);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t count = argc > 1 ? atoi(argv[1]) : 200000;
+	uint32_t branching = argc > 2 ? atoi(argv[2]) : 4;
+
+	Arena arena;
+	Hierarchy hierarchy = _hierarchyCreate(count, branching, arena);
+	printf("%u nodes in %u levels\n", hierarchy.count, hierarchy.levelCount);
+
+	ThreadPool pool(0);
+
+	double serialTime = benchMedian([&] {
+		TransformHierarchy::dirtyAll(hierarchy);
+		TransformHierarchy::worldsUpdate(hierarchy);
+	});
+
+	double parallelTime = benchMedian([&] {
+		TransformHierarchy::dirtyAll(hierarchy);
+		TransformHierarchy::worldsUpdate(hierarchy, &pool);
+	});
+
+	const uint32_t EDIT_COUNTS[] = { 1, 100, 1000 };
+
+	printf("%-28s %10.3f ms %10.2f Mnodes/s\n", "full update, 1 thread", serialTime, count / serialTime / 1e3);
+	printf("full update, %2u threads %15.3f ms %10.2f Mnodes/s\n", pool.threadCount(), parallelTime,
+			count / parallelTime / 1e3);
+
+	for (uint32_t editCount : EDIT_COUNTS) {
+		double editTime = benchMedian([&] {
+			_edit(hierarchy, editCount);
+			TransformHierarchy::worldsUpdate(hierarchy, &pool);
+		});
+
+		printf("%5u edited nodes %20.3f ms\n", editCount, editTime);
+	}
+
+	benchKeep(hierarchy.worlds[count - 1]);
+	return EXIT_SUCCESS;
+}
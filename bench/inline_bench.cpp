@@ -0,0 +1,199 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <io/transform_hierarchy.h>
+#include <io/types/hierarchy.h>
+
+#include <math/projection.h>
+#include <math/types/mat4.h>
+#include <math/types/vec3.h>
+#include <math/types/vec4.h>
+
+#include "bench.h"
+
+using namespace math;
+
+// The math library before it moved into headers: every constructor, operator and function was a call into
+// another translation unit. These wrappers keep exactly those calls around the same arithmetic.
+__attribute__((noinline)) static vec3 _vec3Sub(const vec3 &a, const vec3 &b) {
+	return a - b;
+}
+
+__attribute__((noinline)) static vec3 _vec3Cross(const vec3 &a, const vec3 &b) {
+	return cross(a, b);
+}
+
+__attribute__((noinline)) static float _vec3Dot(const vec3 &a, const vec3 &b) {
+	return dot(a, b);
+}
+
+__attribute__((noinline)) static vec3 _vec3Normalize(const vec3 &v) {
+	return normalize(v);
+}
+
+__attribute__((noinline)) static vec4 _vec4Make(float x, float y, float z, float w) {
+	return vec4(x, y, z, w);
+}
+
+__attribute__((noinline)) static mat4 _mat4Make(const vec4 &x, const vec4 &y, const vec4 &z, const vec4 &w) {
+	return mat4(x, y, z, w);
+}
+
+__attribute__((noinline)) static mat4 _mat4Product(const mat4 &a, const mat4 &b) {
+	return a * b;
+}
+
+// TransformHierarchy::transformMatrix as it compiled against the out-of-line constructors.
+static mat4 _referenceTransformMatrix(const Transform &transform) {
+	const float *q = transform.rotation;
+	const float *s = transform.scale;
+	const float *t = transform.translation;
+
+	float xx = q[0] * q[0], yy = q[1] * q[1], zz = q[2] * q[2];
+	float xy = q[0] * q[1], xz = q[0] * q[2], yz = q[1] * q[2];
+	float wx = q[3] * q[0], wy = q[3] * q[1], wz = q[3] * q[2];
+
+	return _mat4Make(
+			_vec4Make((1.0f - 2.0f * (yy + zz)) * s[0], 2.0f * (xy + wz) * s[0], 2.0f * (xz - wy) * s[0], 0.0f),
+			_vec4Make(2.0f * (xy - wz) * s[1], (1.0f - 2.0f * (xx + zz)) * s[1], 2.0f * (yz + wx) * s[1], 0.0f),
+			_vec4Make(2.0f * (xz + wy) * s[2], 2.0f * (yz - wx) * s[2], (1.0f - 2.0f * (xx + yy)) * s[2], 0.0f),
+			_vec4Make(t[0], t[1], t[2], 1.0f));
+}
+
+// The old perspective: the OpenGL matrix, then both constant matrices multiplied in at runtime.
+static mat4 _referencePerspective(float aspect, float fovY, float zNear, float zFar) {
+	float tanHalfFovY = std::tan(fovY / 2.0f);
+
+	mat4 projection = _mat4Make(_vec4Make(1.0f / (aspect * tanHalfFovY), 0.0f, 0.0f, 0.0f),
+			_vec4Make(0.0f, 1.0f / tanHalfFovY, 0.0f, 0.0f),
+			_vec4Make(0.0f, 0.0f, -(zFar + zNear) / (zFar - zNear), -1.0f),
+			_vec4Make(0.0f, 0.0f, -(2.0f * zFar * zNear) / (zFar - zNear), 0.0f));
+	return _mat4Product(_mat4Product(REVERSE_Z_MATRIX, OPENGL_TO_VULKAN_MATRIX), projection);
+}
+
+// The view matrix lookAt computes, written out instead of inverting the camera's world matrix.
+static mat4 _referenceLookAt(const vec3 &eye, const vec3 &target, const vec3 &up) {
+	vec3 f = _vec3Normalize(_vec3Sub(target, eye));
+	vec3 s = _vec3Normalize(_vec3Cross(f, up));
+	vec3 u = _vec3Cross(s, f);
+
+	return _mat4Make(_vec4Make(s.x, u.x, -f.x, 0.0f), _vec4Make(s.y, u.y, -f.y, 0.0f),
+			_vec4Make(s.z, u.z, -f.z, 0.0f), _vec4Make(-_vec3Dot(s, eye), -_vec3Dot(u, eye), _vec3Dot(f, eye), 1.0f));
+}
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static float _largestDifference(const float *a, const float *b, size_t count) {
+	float largest = 0.0f;
+	for (size_t i = 0; i < count; i++)
+		largest = std::fmax(largest, std::fabs(a[i] - b[i]) / std::fmax(1.0f, std::fabs(a[i])));
+
+	return largest;
+}
+
+static void _resultPrint(const char *name, double referenceTime, double time, uint32_t count, float difference) {
+	printf("%-28s %12.3f %12.3f %8.2fx %12.2e\n", name, referenceTime * 1e6 / count, time * 1e6 / count,
+			referenceTime / time, difference);
+}
+
+// The hot paths of the loader and renderer that use the math types, with the old out-of-line calls and
+// with the header only library, in ns per element. max diff is relative to the larger of 1 and the value.
+int main(int argc, char *argv[]) {
+	const uint32_t count = argc > 1 ? atoi(argv[1]) : 4096;
+
+	srand(1);
+	std::vector<Transform> locals(count);
+	std::vector<mat4> parents(count), worlds(count), referenceWorlds(count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		Transform &local = locals[i];
+		float angle = _random() * 3.0f;
+		float axis[3] = { _random(), _random(), _random() };
+		float norm = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]) + 1e-6f;
+
+		for (int c = 0; c < 3; c++) {
+			local.translation[c] = _random() * 10.0f;
+			local.rotation[c] = axis[c] / norm * std::sin(angle / 2.0f);
+			local.scale[c] = 1.0f + _random() * 0.5f;
+		}
+		local.rotation[3] = std::cos(angle / 2.0f);
+
+		parents[i] = TransformHierarchy::transformMatrix(local);
+	}
+
+	printf("%u elements per run\n", count);
+	printf("%-28s %12s %12s %9s %12s\n", "path", "before (ns)", "now (ns)", "speedup", "max diff");
+
+	// loader: a node's local matrix from its TRS and the product with the parent's world matrix
+	double referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			referenceWorlds[i] = _mat4Product(parents[(i * 7) % count], _referenceTransformMatrix(locals[i]));
+
+		benchKeep(referenceWorlds[0]);
+	});
+	double time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			worlds[i] = parents[(i * 7) % count] * TransformHierarchy::transformMatrix(locals[i]);
+
+		benchKeep(worlds[0]);
+	});
+	_resultPrint("node world transform", referenceTime, time, count,
+			_largestDifference(&referenceWorlds[0].x.x, &worlds[0].x.x, count * 16));
+
+	// loader: face normals of a triangle fan, the vec3 arithmetic of normal and tangent generation
+	std::vector<vec3> positions(count + 2);
+	for (vec3 &position : positions)
+		position = vec3(_random(), _random(), _random());
+
+	std::vector<vec3> normals(count), referenceNormals(count);
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++) {
+			vec3 e1 = _vec3Sub(positions[i + 1], positions[i]);
+			vec3 e2 = _vec3Sub(positions[i + 2], positions[i]);
+			referenceNormals[i] = _vec3Normalize(_vec3Cross(e1, e2));
+		}
+
+		benchKeep(referenceNormals[0]);
+	});
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++) {
+			vec3 e1 = positions[i + 1] - positions[i];
+			vec3 e2 = positions[i + 2] - positions[i];
+			normals[i] = normalize(cross(e1, e2));
+		}
+
+		benchKeep(normals[0]);
+	});
+	_resultPrint("face normal", referenceTime, time, count,
+			_largestDifference(&referenceNormals[0].x, &normals[0].x, count * 3));
+
+	// renderer: a camera's view projection, set up once per view and frame
+	std::vector<mat4> cameras(count), referenceCameras(count);
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++) {
+			const vec3 &eye = positions[i];
+			referenceCameras[i] = _mat4Product(_referencePerspective(1.7f, 1.0f + 0.1f * eye.x, 0.1f, 1000.0f),
+					_referenceLookAt(eye * 10.0f, vec3(0.0f), vec3(0.0f, 1.0f, 0.0f)));
+		}
+
+		benchKeep(referenceCameras[0]);
+	});
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++) {
+			const vec3 &eye = positions[i];
+			cameras[i] = perspective(1.7f, 1.0f + 0.1f * eye.x, 0.1f, 1000.0f) *
+					lookAt(eye * 10.0f, vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+		}
+
+		benchKeep(cameras[0]);
+	});
+	_resultPrint("camera view projection", referenceTime, time, count,
+			_largestDifference(&referenceCameras[0].x.x, &cameras[0].x.x, count * 16));
+
+	return EXIT_SUCCESS;
+}
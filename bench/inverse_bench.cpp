@@ -0,0 +1,298 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <math/projection.h>
+#include <math/transform_batch.h>
+#include <math/types/mat4.h>
+#include <math/types/quat.h>
+#include <math/types/trs.h>
+#include <math/types/vec3.h>
+#include <math/types/vec4.h>
+
+#include "bench.h"
+
+using namespace math;
+
+// Column major like mat4, in double precision.
+typedef struct {
+	double m[4][4];
+} Mat4d;
+
+static Mat4d _mat4dFrom(const mat4 &matrix) {
+	Mat4d out;
+	const float *elements = &matrix.x.x;
+	for (int i = 0; i < 16; i++)
+		out.m[i / 4][i % 4] = elements[i];
+
+	return out;
+}
+
+// Gauss-Jordan with partial pivoting, on the transpose which has the same inverse up to transposition.
+static Mat4d _referenceInverse(const Mat4d &matrix) {
+	double a[4][8];
+	for (int r = 0; r < 4; r++) {
+		for (int c = 0; c < 4; c++) {
+			a[r][c] = matrix.m[r][c];
+			a[r][4 + c] = r == c ? 1.0 : 0.0;
+		}
+	}
+
+	for (int c = 0; c < 4; c++) {
+		int pivot = c;
+		for (int r = c + 1; r < 4; r++) {
+			if (std::fabs(a[r][c]) > std::fabs(a[pivot][c]))
+				pivot = r;
+		}
+
+		for (int k = 0; k < 8; k++)
+			std::swap(a[c][k], a[pivot][k]);
+
+		double denom = 1.0 / a[c][c];
+		for (int k = 0; k < 8; k++)
+			a[c][k] *= denom;
+
+		for (int r = 0; r < 4; r++) {
+			if (r == c)
+				continue;
+
+			double factor = a[r][c];
+			for (int k = 0; k < 8; k++)
+				a[r][k] -= factor * a[c][k];
+		}
+	}
+
+	Mat4d out;
+	for (int r = 0; r < 4; r++) {
+		for (int c = 0; c < 4; c++)
+			out.m[r][c] = a[r][4 + c];
+	}
+
+	return out;
+}
+
+static Mat4d _referenceTrsMatrix(const trs &transform) {
+	double q[4] = { transform.rotation.x, transform.rotation.y, transform.rotation.z, transform.rotation.w };
+	double s[3] = { transform.scale.x, transform.scale.y, transform.scale.z };
+
+	double xx = q[0] * q[0], yy = q[1] * q[1], zz = q[2] * q[2];
+	double xy = q[0] * q[1], xz = q[0] * q[2], yz = q[1] * q[2];
+	double wx = q[3] * q[0], wy = q[3] * q[1], wz = q[3] * q[2];
+
+	double rotation[3][3] = {
+		{ 1.0 - 2.0 * (yy + zz), 2.0 * (xy + wz), 2.0 * (xz - wy) },
+		{ 2.0 * (xy - wz), 1.0 - 2.0 * (xx + zz), 2.0 * (yz + wx) },
+		{ 2.0 * (xz + wy), 2.0 * (yz - wx), 1.0 - 2.0 * (xx + yy) },
+	};
+
+	Mat4d out = {};
+	for (int c = 0; c < 3; c++) {
+		for (int r = 0; r < 3; r++)
+			out.m[c][r] = rotation[c][r] * s[c];
+	}
+
+	out.m[3][0] = transform.translation.x;
+	out.m[3][1] = transform.translation.y;
+	out.m[3][2] = transform.translation.z;
+	out.m[3][3] = 1.0;
+	return out;
+}
+
+// Largest difference relative to the largest element of the reference.
+static double _matrixError(const mat4 &matrix, const Mat4d &reference) {
+	const float *elements = &matrix.x.x;
+
+	double largest = 0.0, scale = 0.0;
+	for (int i = 0; i < 16; i++) {
+		largest = std::max(largest, std::fabs(elements[i] - reference.m[i / 4][i % 4]));
+		scale = std::max(scale, std::fabs(reference.m[i / 4][i % 4]));
+	}
+
+	return largest / scale;
+}
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static quat _randomRotation() {
+	return normalize(quat(_random(), _random(), _random(), _random()));
+}
+
+// referenceTime is 0 for errors checked against a different operation than the one timed.
+static void _resultPrint(const char *name, double time, double referenceTime, uint32_t count, double error) {
+	if (referenceTime > 0.0)
+		printf("%-30s %10.2f %14.2f %12.2e\n", name, time * 1e6 / count, referenceTime * 1e6 / count, error);
+	else
+		printf("%-30s %10.2f %14s %12.2e\n", name, time * 1e6 / count, "-", error);
+}
+
+// The quaternion, TRS and inverse functions against double precision references: ns per element of both and
+// the largest error relative to the largest element of the reference result.
+int main(int argc, char *argv[]) {
+	const uint32_t count = argc > 1 ? atoi(argv[1]) : 4096;
+
+	srand(1);
+	std::vector<trs> transforms(count);
+	std::vector<mat4> affines(count), projectives(count), out(count);
+	std::vector<Mat4d> references(count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		transforms[i] = trs(vec3(_random(), _random(), _random()) * 10.0f, _randomRotation(),
+				vec3(1.0f + _random() * 0.5f, 1.0f + _random() * 0.5f, 1.0f + _random() * 0.5f));
+		affines[i] = trsMatrix(transforms[i]);
+
+		vec3 eye = vec3(_random(), _random(), _random()) * 20.0f;
+		projectives[i] = perspective(1.7f, 1.0f, 0.1f, 100.0f) * lookAt(eye, vec3(0.0f), vec3(0.0f, 1.0f, 0.0f)) *
+				affines[i];
+	}
+
+	printf("%u elements per run\n", count);
+	printf("%-30s %10s %14s %12s\n", "function", "ns", "double ns", "max error");
+
+	auto inverseRun = [&](const char *name, const std::vector<mat4> &matrices, mat4 (*function)(const mat4 &)) {
+		double referenceTime = benchMedian([&] {
+			for (uint32_t i = 0; i < count; i++)
+				references[i] = _referenceInverse(_mat4dFrom(matrices[i]));
+
+			benchKeep(references[0]);
+		});
+		double time = benchMedian([&] {
+			for (uint32_t i = 0; i < count; i++)
+				out[i] = function(matrices[i]);
+
+			benchKeep(out[0]);
+		});
+
+		double error = 0.0;
+		for (uint32_t i = 0; i < count; i++)
+			error = std::max(error, _matrixError(out[i], references[i]));
+
+		_resultPrint(name, time, referenceTime, count, error);
+	};
+
+	inverseRun("inverse, projective", projectives, inverse);
+	inverseRun("inverse, affine", affines, inverse);
+	inverseRun("affineInverse", affines, affineInverse);
+
+	// the reference is the transpose of the inverse, only its upper 3x3 is compared
+	double referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			references[i] = _referenceInverse(_mat4dFrom(affines[i]));
+
+		benchKeep(references[0]);
+	});
+	double time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			out[i] = normalMatrix(affines[i]);
+
+		benchKeep(out[0]);
+	});
+
+	double error = 0.0;
+	for (uint32_t i = 0; i < count; i++) {
+		Mat4d transposed = {};
+		for (int c = 0; c < 3; c++) {
+			for (int r = 0; r < 3; r++)
+				transposed.m[c][r] = references[i].m[r][c];
+		}
+		transposed.m[3][3] = 1.0;
+
+		error = std::max(error, _matrixError(out[i], transposed));
+	}
+	_resultPrint("normalMatrix", time, referenceTime, count, error);
+
+	// TRS to matrix, one at a time and in batches
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			references[i] = _referenceTrsMatrix(transforms[i]);
+
+		benchKeep(references[0]);
+	});
+
+	auto trsError = [&] {
+		double largest = 0.0;
+		for (uint32_t i = 0; i < count; i++)
+			largest = std::max(largest, _matrixError(out[i], references[i]));
+
+		return largest;
+	};
+
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			out[i] = trsMatrix(transforms[i]);
+
+		benchKeep(out[0]);
+	});
+	_resultPrint("trsMatrix", time, referenceTime, count, trsError());
+
+	time = benchMedian([&] {
+		trsMatrices(transforms.data(), out.data(), count);
+		benchKeep(out[0]);
+	});
+	_resultPrint("trsMatrices", time, referenceTime, count, trsError());
+
+	std::vector<quat> rotations(count);
+	for (uint32_t i = 0; i < count; i++)
+		rotations[i] = transforms[i].rotation;
+
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			out[i] = quatMatrix(rotations[i]);
+
+		benchKeep(out[0]);
+	});
+	printf("%-30s %10.2f\n", "quatMatrix", time * 1e6 / count);
+
+	time = benchMedian([&] {
+		quatMatrices(rotations.data(), out.data(), count);
+		benchKeep(out[0]);
+	});
+	printf("%-30s %10.2f\n", "quatMatrices", time * 1e6 / count);
+
+	// the product of rotations against the product of their matrices
+	std::vector<quat> products(count);
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			products[i] = rotations[i] * rotations[(i * 7 + 1) % count];
+
+		benchKeep(products[0]);
+	});
+
+	error = 0.0;
+	for (uint32_t i = 0; i < count; i++) {
+		const Mat4d a = _referenceTrsMatrix(trs(vec3(0.0f), rotations[i], vec3(1.0f)));
+		const Mat4d b = _referenceTrsMatrix(trs(vec3(0.0f), rotations[(i * 7 + 1) % count], vec3(1.0f)));
+
+		Mat4d product = {};
+		for (int c = 0; c < 4; c++) {
+			for (int r = 0; r < 4; r++) {
+				for (int k = 0; k < 4; k++)
+					product.m[c][r] += a.m[k][r] * b.m[c][k];
+			}
+		}
+
+		error = std::max(error, _matrixError(quatMatrix(products[i]), product));
+	}
+	_resultPrint("quat product", time, 0.0, count, error);
+
+	// decomposing and composing again, against the double product of the decomposed transform
+	std::vector<trs> decomposed(count);
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			decomposed[i] = trsDecompose(affines[i]);
+
+		benchKeep(decomposed[0]);
+	});
+
+	error = 0.0;
+	for (uint32_t i = 0; i < count; i++)
+		error = std::max(error, _matrixError(affines[i], _referenceTrsMatrix(decomposed[i])));
+
+	_resultPrint("trsDecompose", time, 0.0, count, error);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <math/types/mat4.h>
+#include <math/types/vec4.h>
+
+#include "bench.h"
+
+using namespace math;
+
+// The scalar implementation before the SIMD backends, dot was an out-of-line call then.
+__attribute__((noinline)) static float _referenceDot(const vec4 &a, const vec4 &b) {
+	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+}
+
+static mat4 _referenceMul(const mat4 &a, const mat4 &b) {
+	vec4 rows[4] = { b.x, b.y, b.z, b.w };
+
+	vec4 columns[4] = {
+		{ a.x.x, a.y.x, a.z.x, a.w.x },
+		{ a.x.y, a.y.y, a.z.y, a.w.y },
+		{ a.x.z, a.y.z, a.z.z, a.w.z },
+		{ a.x.w, a.y.w, a.z.w, a.w.w },
+	};
+
+	float data[4][4];
+	for (int i = 0; i < 4; i++) {
+		data[i][0] = _referenceDot(rows[i], columns[0]);
+		data[i][1] = _referenceDot(rows[i], columns[1]);
+		data[i][2] = _referenceDot(rows[i], columns[2]);
+		data[i][3] = _referenceDot(rows[i], columns[3]);
+	}
+
+	mat4 out;
+	memcpy(&out, data, sizeof(mat4));
+	return out;
+}
+
+// What transforming a vector took without mat4 * vec4: the transposed rows dotted with it.
+static vec4 _referenceTransform(const mat4 &m, const vec4 &v) {
+	vec4 rows[4] = {
+		{ m.x.x, m.y.x, m.z.x, m.w.x },
+		{ m.x.y, m.y.y, m.z.y, m.w.y },
+		{ m.x.z, m.y.z, m.z.z, m.w.z },
+		{ m.x.w, m.y.w, m.z.w, m.w.w },
+	};
+
+	return vec4(_referenceDot(rows[0], v), _referenceDot(rows[1], v), _referenceDot(rows[2], v),
+			_referenceDot(rows[3], v));
+}
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static vec4 _randomVector() {
+	return vec4(_random(), _random(), _random(), _random());
+}
+
+static float _largestDifference(const float *a, const float *b, size_t count) {
+	float largest = 0.0f;
+	for (size_t i = 0; i < count; i++)
+		largest = std::fmax(largest, std::fabs(a[i] - b[i]));
+
+	return largest;
+}
+
+static void _resultPrint(const char *name, double referenceTime, double time, uint32_t count, float difference) {
+	printf("%-20s %12.3f %12.3f %8.2fx %12.2e\n", name, referenceTime * 1e6 / count, time * 1e6 / count,
+			referenceTime / time, difference);
+}
+
+// Compares the math backend this was built with against the scalar code it replaced, in ns per operation.
+// Configure with -DRENDERER_AVX2=ON or -DRENDERER_MATH_SCALAR=ON to measure the other backends.
+int main(int argc, char *argv[]) {
+	const uint32_t count = argc > 1 ? atoi(argv[1]) : 4096;
+
+#if defined(MATH_AVX2)
+	const char *backend = "AVX2";
+#elif defined(MATH_SSE)
+	const char *backend = "SSE";
+#else
+	const char *backend = "scalar";
+#endif
+
+	srand(1);
+	std::vector<mat4> a(count), b(count), products(count), referenceProducts(count);
+	std::vector<vec4> vectors(count), transformed(count), referenceTransformed(count);
+
+	for (uint32_t i = 0; i < count; i++) {
+		a[i] = mat4(_randomVector(), _randomVector(), _randomVector(), _randomVector());
+		b[i] = mat4(_randomVector(), _randomVector(), _randomVector(), _randomVector());
+		vectors[i] = _randomVector();
+	}
+
+	printf("%u operations per run, %s backend\n", count, backend);
+	printf("%-20s %12s %12s %9s %12s\n", "operation", "before (ns)", "now (ns)", "speedup", "max diff");
+
+	double referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			referenceProducts[i] = _referenceMul(a[i], b[i]);
+
+		benchKeep(referenceProducts[0]);
+	});
+	double time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			products[i] = a[i] * b[i];
+
+		benchKeep(products[0]);
+	});
+	_resultPrint("mat4 * mat4", referenceTime, time, count,
+			_largestDifference(&products[0].x.x, &referenceProducts[0].x.x, count * 16));
+
+	// a chain of products, the latency of one multiply rather than the throughput
+	referenceTime = benchMedian([&] {
+		mat4 chain = mat4(1.0f);
+		for (uint32_t i = 0; i < count; i++)
+			chain = _referenceMul(chain, b[i]);
+
+		benchKeep(chain);
+	});
+	time = benchMedian([&] {
+		mat4 chain = mat4(1.0f);
+		for (uint32_t i = 0; i < count; i++)
+			chain *= b[i];
+
+		benchKeep(chain);
+	});
+	_resultPrint("mat4 *= (chained)", referenceTime, time, count, 0.0f);
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			referenceTransformed[i] = _referenceTransform(a[i], vectors[i]);
+
+		benchKeep(referenceTransformed[0]);
+	});
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformed[i] = a[i] * vectors[i];
+
+		benchKeep(transformed[0]);
+	});
+	_resultPrint("mat4 * vec4", referenceTime, time, count,
+			_largestDifference(&transformed[0].x, &referenceTransformed[0].x, count * 4));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++) {
+			const mat4 &m = a[i];
+			referenceProducts[i] = mat4(vec4(m.x.x, m.y.x, m.z.x, m.w.x), vec4(m.x.y, m.y.y, m.z.y, m.w.y),
+					vec4(m.x.z, m.y.z, m.z.z, m.w.z), vec4(m.x.w, m.y.w, m.z.w, m.w.w));
+		}
+
+		benchKeep(referenceProducts[0]);
+	});
+	time = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			products[i] = transpose(a[i]);
+
+		benchKeep(products[0]);
+	});
+	_resultPrint("transpose", referenceTime, time, count,
+			_largestDifference(&products[0].x.x, &referenceProducts[0].x.x, count * 16));
+
+	return EXIT_SUCCESS;
+}
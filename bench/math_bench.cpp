@@ -0,0 +1,633 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <math/projection.h>
+#include <math/types/mat4.h>
+#include <math/types/precision.h>
+#include <math/types/quat.h>
+#include <math/types/trs.h>
+#include <math/types/vec3.h>
+#include <math/types/vec4.h>
+
+#include "bench.h"
+
+using namespace math;
+
+// Runs per timing, ns per operation is the median of the repetitions over the inputs.
+const uint32_t BENCH_WARMUP = 3;
+const uint32_t BENCH_REPETITIONS = 31;
+
+// Column major like mat4.
+typedef struct {
+	long double m[16];
+} LongMat4;
+
+typedef struct {
+	long double v[4];
+} LongVec4;
+
+// Random inputs for both parts, count of each. The matrices are well conditioned: affine from a TRS with
+// scales in [0.5, 1.5], projective a camera's view projection times one of them.
+typedef struct {
+	std::vector<float> positives;
+	std::vector<float> factors;
+	std::vector<vec3> vec3s[2];
+	std::vector<vec4> vec4s[2];
+	std::vector<quat> rotations[2];
+	std::vector<trs> transforms;
+	std::vector<mat4> affines[2];
+	std::vector<mat4> projectives;
+} Inputs;
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static Inputs _inputsCreate(uint32_t count) {
+	Inputs inputs;
+	inputs.positives.resize(count);
+	inputs.factors.resize(count);
+	inputs.transforms.resize(count);
+	inputs.projectives.resize(count);
+
+	for (int k = 0; k < 2; k++) {
+		inputs.vec3s[k].resize(count);
+		inputs.vec4s[k].resize(count);
+		inputs.rotations[k].resize(count);
+		inputs.affines[k].resize(count);
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		inputs.positives[i] = std::ldexp(1.0f + std::fabs(_random()), rand() % 40 - 20);
+		inputs.factors[i] = std::fabs(_random());
+
+		for (int k = 0; k < 2; k++) {
+			inputs.vec3s[k][i] = vec3(_random(), _random(), _random()) * 10.0f;
+			inputs.vec4s[k][i] = vec4(_random(), _random(), _random(), _random()) * 10.0f;
+			inputs.rotations[k][i] = normalize(quat(_random(), _random(), _random(), _random()));
+
+			trs transform = trs(vec3(_random(), _random(), _random()) * 10.0f, inputs.rotations[k][i],
+					vec3(1.0f + _random() * 0.5f, 1.0f + _random() * 0.5f, 1.0f + _random() * 0.5f));
+			inputs.affines[k][i] = trsMatrix(transform);
+
+			if (k == 0)
+				inputs.transforms[i] = transform;
+		}
+
+		vec3 eye = vec3(_random(), _random(), _random()) * 20.0f + vec3(0.0f, 0.0f, 25.0f);
+		inputs.projectives[i] = perspective(1.7f, 1.0f, 0.1f, 100.0f) *
+				lookAt(eye, vec3(0.0f), vec3(0.0f, 1.0f, 0.0f)) * inputs.affines[0][i];
+	}
+
+	return inputs;
+}
+
+template <typename Operation>
+static void _benchmarkRun(const char *name, uint32_t count, Operation operation) {
+	double time = benchMedian(
+			[&] {
+				for (uint32_t i = 0; i < count; i++)
+					operation(i);
+
+				benchKeep(count);
+			},
+			BENCH_WARMUP, BENCH_REPETITIONS);
+
+	printf("%-32s %10.3f\n", name, time * 1e6 / count);
+}
+
+// ns per operation of every primitive, each over count inputs written to count outputs.
+static void _benchmarksRun(const Inputs &inputs, uint32_t count) {
+	std::vector<float> floats(count);
+	std::vector<vec3> vec3s(count);
+	std::vector<vec4> vec4s(count);
+	std::vector<mat4> mat4s(count);
+	std::vector<quat> quats(count);
+	std::vector<trs> transforms(count);
+
+	const std::vector<vec3> &a3 = inputs.vec3s[0], &b3 = inputs.vec3s[1];
+	const std::vector<vec4> &a4 = inputs.vec4s[0], &b4 = inputs.vec4s[1];
+	const std::vector<mat4> &affines = inputs.affines[0], &others = inputs.affines[1];
+	const std::vector<quat> &rotations = inputs.rotations[0], &targets = inputs.rotations[1];
+
+	printf("%-32s %10s\n", "primitive", "ns/op");
+
+	_benchmarkRun("vec3 +", count, [&](uint32_t i) { vec3s[i] = a3[i] + b3[i]; });
+	_benchmarkRun("vec3 * float", count, [&](uint32_t i) { vec3s[i] = a3[i] * inputs.factors[i]; });
+	_benchmarkRun("vec3 dot", count, [&](uint32_t i) { floats[i] = dot(a3[i], b3[i]); });
+	_benchmarkRun("vec3 cross", count, [&](uint32_t i) { vec3s[i] = cross(a3[i], b3[i]); });
+	_benchmarkRun("vec3 length", count, [&](uint32_t i) { floats[i] = length(a3[i]); });
+	_benchmarkRun("vec3 length, fast", count, [&](uint32_t i) { floats[i] = length(a3[i], PRECISION_FAST); });
+	_benchmarkRun("vec3 normalize", count, [&](uint32_t i) { vec3s[i] = normalize(a3[i]); });
+	_benchmarkRun(
+			"vec3 normalize, fast", count, [&](uint32_t i) { vec3s[i] = normalize(a3[i], PRECISION_FAST); });
+
+	_benchmarkRun("vec4 +", count, [&](uint32_t i) { vec4s[i] = a4[i] + b4[i]; });
+	_benchmarkRun("vec4 * vec4", count, [&](uint32_t i) { vec4s[i] = a4[i] * b4[i]; });
+	_benchmarkRun("vec4 dot", count, [&](uint32_t i) { floats[i] = dot(a4[i], b4[i]); });
+	_benchmarkRun("vec4 normalize", count, [&](uint32_t i) { vec4s[i] = normalize(a4[i]); });
+	_benchmarkRun(
+			"vec4 normalize, fast", count, [&](uint32_t i) { vec4s[i] = normalize(a4[i], PRECISION_FAST); });
+
+	_benchmarkRun("rsqrt", count, [&](uint32_t i) { floats[i] = rsqrt(inputs.positives[i]); });
+	_benchmarkRun(
+			"rsqrt, fast", count, [&](uint32_t i) { floats[i] = rsqrt(inputs.positives[i], PRECISION_FAST); });
+
+	_benchmarkRun("mat4 * mat4", count, [&](uint32_t i) { mat4s[i] = affines[i] * others[i]; });
+	_benchmarkRun("mat4 * vec4", count, [&](uint32_t i) { vec4s[i] = affines[i] * a4[i]; });
+	_benchmarkRun("transpose", count, [&](uint32_t i) { mat4s[i] = transpose(affines[i]); });
+	_benchmarkRun("inverse", count, [&](uint32_t i) { mat4s[i] = inverse(inputs.projectives[i]); });
+	_benchmarkRun("affineInverse", count, [&](uint32_t i) { mat4s[i] = affineInverse(affines[i]); });
+	_benchmarkRun("normalMatrix", count, [&](uint32_t i) { mat4s[i] = normalMatrix(affines[i]); });
+
+	_benchmarkRun("perspective", count,
+			[&](uint32_t i) { mat4s[i] = perspective(1.7f, 0.5f + inputs.factors[i], 0.1f, 100.0f); });
+	_benchmarkRun("lookAt", count,
+			[&](uint32_t i) { mat4s[i] = lookAt(a3[i], b3[i] + vec3(0.0f, 0.0f, 25.0f), vec3(0.0f, 1.0f, 0.0f)); });
+
+	_benchmarkRun("quat *", count, [&](uint32_t i) { quats[i] = rotations[i] * targets[i]; });
+	_benchmarkRun("quat rotate", count, [&](uint32_t i) { vec3s[i] = rotate(rotations[i], a3[i]); });
+	_benchmarkRun("quat nlerp", count,
+			[&](uint32_t i) { quats[i] = nlerp(rotations[i], targets[i], inputs.factors[i]); });
+	_benchmarkRun("quat slerp", count,
+			[&](uint32_t i) { quats[i] = slerp(rotations[i], targets[i], inputs.factors[i]); });
+	_benchmarkRun("quatMatrix", count, [&](uint32_t i) { mat4s[i] = quatMatrix(rotations[i]); });
+	_benchmarkRun("trsMatrix", count, [&](uint32_t i) { mat4s[i] = trsMatrix(inputs.transforms[i]); });
+	_benchmarkRun("trsDecompose", count, [&](uint32_t i) { transforms[i] = trsDecompose(affines[i]); });
+}
+
+static LongMat4 _longMat4(const mat4 &matrix) {
+	LongMat4 out;
+	const float *elements = &matrix.x.x;
+	for (int k = 0; k < 16; k++)
+		out.m[k] = elements[k];
+
+	return out;
+}
+
+// a * b, and the same product of the absolute values: the magnitude the rounding errors scale with.
+static LongMat4 _longMul(const LongMat4 &a, const LongMat4 &b, bool absolute) {
+	LongMat4 out;
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 4; r++) {
+			long double sum = 0.0L;
+			for (int k = 0; k < 4; k++)
+				sum += absolute ? std::fabs(a.m[k * 4 + r] * b.m[c * 4 + k]) : a.m[k * 4 + r] * b.m[c * 4 + k];
+
+			out.m[c * 4 + r] = sum;
+		}
+	}
+
+	return out;
+}
+
+// Gauss-Jordan with partial pivoting, on the transpose like the inverse it checks.
+static LongMat4 _longInverse(const LongMat4 &matrix) {
+	long double a[4][8];
+	for (int r = 0; r < 4; r++) {
+		for (int c = 0; c < 4; c++) {
+			a[r][c] = matrix.m[r * 4 + c];
+			a[r][4 + c] = r == c ? 1.0L : 0.0L;
+		}
+	}
+
+	for (int c = 0; c < 4; c++) {
+		int pivot = c;
+		for (int r = c + 1; r < 4; r++) {
+			if (std::fabs(a[r][c]) > std::fabs(a[pivot][c]))
+				pivot = r;
+		}
+
+		for (int k = 0; k < 8; k++)
+			std::swap(a[c][k], a[pivot][k]);
+
+		long double denom = 1.0L / a[c][c];
+		for (int k = 0; k < 8; k++)
+			a[c][k] *= denom;
+
+		for (int r = 0; r < 4; r++) {
+			if (r == c)
+				continue;
+
+			long double factor = a[r][c];
+			for (int k = 0; k < 8; k++)
+				a[r][k] -= factor * a[c][k];
+		}
+	}
+
+	LongMat4 out;
+	for (int r = 0; r < 4; r++) {
+		for (int c = 0; c < 4; c++)
+			out.m[r * 4 + c] = a[r][4 + c];
+	}
+
+	return out;
+}
+
+static LongMat4 _longTrsMatrix(const trs &transform) {
+	long double x = transform.rotation.x, y = transform.rotation.y, z = transform.rotation.z;
+	long double w = transform.rotation.w;
+	long double s[3] = { transform.scale.x, transform.scale.y, transform.scale.z };
+
+	long double rotation[9] = {
+		1.0L - 2.0L * (y * y + z * z), 2.0L * (x * y + w * z), 2.0L * (x * z - w * y),
+		2.0L * (x * y - w * z), 1.0L - 2.0L * (x * x + z * z), 2.0L * (y * z + w * x),
+		2.0L * (x * z + w * y), 2.0L * (y * z - w * x), 1.0L - 2.0L * (x * x + y * y),
+	};
+
+	LongMat4 out = {};
+	for (int c = 0; c < 3; c++) {
+		for (int r = 0; r < 3; r++)
+			out.m[c * 4 + r] = rotation[c * 3 + r] * s[c];
+	}
+
+	out.m[12] = transform.translation.x;
+	out.m[13] = transform.translation.y;
+	out.m[14] = transform.translation.z;
+	out.m[15] = 1.0L;
+	return out;
+}
+
+static void _longNormalize(long double *v, int count) {
+	long double sum = 0.0L;
+	for (int k = 0; k < count; k++)
+		sum += v[k] * v[k];
+
+	long double denom = 1.0L / std::sqrt(sum);
+	for (int k = 0; k < count; k++)
+		v[k] *= denom;
+}
+
+static void _longCross(const long double *a, const long double *b, long double *out) {
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static LongMat4 _longLookAt(const vec3 &eye, const vec3 &target, const vec3 &up) {
+	long double e[3] = { eye.x, eye.y, eye.z };
+	long double f[3] = { (long double)target.x - eye.x, (long double)target.y - eye.y, (long double)target.z - eye.z };
+	long double u[3] = { up.x, up.y, up.z };
+	_longNormalize(f, 3);
+
+	long double s[3], cameraUp[3];
+	_longCross(f, u, s);
+	_longNormalize(s, 3);
+	_longCross(s, f, cameraUp);
+
+	LongMat4 out = {};
+	for (int k = 0; k < 3; k++) {
+		out.m[k * 4 + 0] = s[k];
+		out.m[k * 4 + 1] = cameraUp[k];
+		out.m[k * 4 + 2] = -f[k];
+	}
+
+	out.m[12] = -(s[0] * e[0] + s[1] * e[1] + s[2] * e[2]);
+	out.m[13] = -(cameraUp[0] * e[0] + cameraUp[1] * e[1] + cameraUp[2] * e[2]);
+	out.m[14] = f[0] * e[0] + f[1] * e[1] + f[2] * e[2];
+	out.m[15] = 1.0L;
+	return out;
+}
+
+static void _longQuatMul(const quat &a, const quat &b, long double *out) {
+	long double ax = a.x, ay = a.y, az = a.z, aw = a.w;
+	long double bx = b.x, by = b.y, bz = b.z, bw = b.w;
+
+	out[0] = aw * bx + ax * bw + ay * bz - az * by;
+	out[1] = aw * by - ax * bz + ay * bw + az * bx;
+	out[2] = aw * bz + ax * by - ay * bx + az * bw;
+	out[3] = aw * bw - ax * bx - ay * by - az * bz;
+}
+
+// The largest difference in units in the last place of a float of the given magnitude.
+static double _ulps(const float *values, const long double *reference, int count, long double magnitude) {
+	long double largest = 0.0L;
+	for (int k = 0; k < count; k++)
+		largest = std::max(largest, std::fabs((long double)values[k] - reference[k]));
+
+	if (magnitude == 0.0L)
+		return largest == 0.0L ? 0.0 : HUGE_VAL;
+
+	int exponent;
+	std::frexp((double)magnitude, &exponent);
+	return (double)(largest / std::ldexp(1.0L, exponent - 24));
+}
+
+static double _matrixUlps(const mat4 &matrix, const LongMat4 &reference, const LongMat4 &magnitudes) {
+	double largest = 0.0;
+	for (int k = 0; k < 16; k++)
+		largest = std::max(largest, _ulps(&matrix.x.x + k, &reference.m[k], 1, magnitudes.m[k]));
+
+	return largest;
+}
+
+// The largest element of the reference as the magnitude of the whole matrix.
+static double _matrixNormUlps(const mat4 &matrix, const LongMat4 &reference) {
+	long double magnitude = 0.0L;
+	for (long double element : reference.m)
+		magnitude = std::max(magnitude, std::fabs(element));
+
+	return _ulps(&matrix.x.x, reference.m, 16, magnitude);
+}
+
+// Runs check(i) for every input, reports the largest error it returns and whether that is within bound.
+template <typename Check>
+static bool _accuracyRun(const char *name, uint32_t count, double bound, Check check) {
+	double largest = 0.0;
+	for (uint32_t i = 0; i < count; i++)
+		largest = std::max(largest, check(i));
+
+	bool passes = largest <= bound;
+	printf("%-32s %10.3f %10.1f %s\n", name, largest, bound, passes ? "ok" : "EXCEEDED");
+	return passes;
+}
+
+// Every primitive against a long double reference on count random inputs. Errors are in ulps of the magnitude
+// the rounding scales with: the sum of the absolute terms for sums of products, the largest element of the
+// result for matrices, 1 for unit vectors and rotations. The bounds leave a margin over the scalar, SSE and AVX2
+// backends, a change exceeding one is a precision regression.
+static bool _accuracyRunAll(const Inputs &inputs, uint32_t count) {
+	const std::vector<vec3> &a3 = inputs.vec3s[0], &b3 = inputs.vec3s[1];
+	const std::vector<vec4> &a4 = inputs.vec4s[0], &b4 = inputs.vec4s[1];
+	const std::vector<mat4> &affines = inputs.affines[0], &others = inputs.affines[1];
+	const std::vector<quat> &rotations = inputs.rotations[0], &targets = inputs.rotations[1];
+
+	printf("%-32s %10s %10s\n", "primitive", "max ulp", "bound");
+
+	bool passes = _accuracyRun("vec3 +", count, 0.5, [&](uint32_t i) {
+		vec3 sum = a3[i] + b3[i];
+		const float *a = &a3[i].x, *b = &b3[i].x;
+
+		double largest = 0.0;
+		for (int k = 0; k < 3; k++) {
+			long double reference = (long double)a[k] + b[k];
+			largest = std::max(largest, _ulps(&sum.x + k, &reference, 1, std::fabs(a[k]) + std::fabs(b[k])));
+		}
+
+		return largest;
+	});
+
+	passes &= _accuracyRun("vec3 dot", count, 3.0, [&](uint32_t i) {
+		float value = dot(a3[i], b3[i]);
+		const float *a = &a3[i].x, *b = &b3[i].x;
+
+		long double reference = 0.0L, magnitude = 0.0L;
+		for (int k = 0; k < 3; k++) {
+			reference += (long double)a[k] * b[k];
+			magnitude += std::fabs((long double)a[k] * b[k]);
+		}
+
+		return _ulps(&value, &reference, 1, magnitude);
+	});
+
+	passes &= _accuracyRun("vec3 cross", count, 2.0, [&](uint32_t i) {
+		vec3 value = cross(a3[i], b3[i]);
+		long double a[3] = { a3[i].x, a3[i].y, a3[i].z }, b[3] = { b3[i].x, b3[i].y, b3[i].z };
+
+		long double reference[3];
+		_longCross(a, b, reference);
+
+		double largest = 0.0;
+		for (int k = 0; k < 3; k++) {
+			int j = (k + 1) % 3, l = (k + 2) % 3;
+			long double magnitude = std::fabs(a[j] * b[l]) + std::fabs(a[l] * b[j]);
+			largest = std::max(largest, _ulps(&value.x + k, &reference[k], 1, magnitude));
+		}
+
+		return largest;
+	});
+
+	passes &= _accuracyRun("vec3 length", count, 1.5, [&](uint32_t i) {
+		float value = length(a3[i]);
+		long double reference = std::sqrt((long double)a3[i].x * a3[i].x + (long double)a3[i].y * a3[i].y +
+				(long double)a3[i].z * a3[i].z);
+
+		return _ulps(&value, &reference, 1, reference);
+	});
+
+	auto normalize3Check = [&](Precision precision) {
+		return [&, precision](uint32_t i) {
+			vec3 value = normalize(a3[i], precision);
+			long double reference[3] = { a3[i].x, a3[i].y, a3[i].z };
+			_longNormalize(reference, 3);
+
+			return _ulps(&value.x, reference, 3, 1.0L);
+		};
+	};
+	passes &= _accuracyRun("vec3 normalize", count, 2.0, normalize3Check(PRECISION_EXACT));
+	passes &= _accuracyRun("vec3 normalize, fast", count, 4.0, normalize3Check(PRECISION_FAST));
+
+	passes &= _accuracyRun("vec4 dot", count, 3.0, [&](uint32_t i) {
+		float value = dot(a4[i], b4[i]);
+		const float *a = &a4[i].x, *b = &b4[i].x;
+
+		long double reference = 0.0L, magnitude = 0.0L;
+		for (int k = 0; k < 4; k++) {
+			reference += (long double)a[k] * b[k];
+			magnitude += std::fabs((long double)a[k] * b[k]);
+		}
+
+		return _ulps(&value, &reference, 1, magnitude);
+	});
+
+	auto normalize4Check = [&](Precision precision) {
+		return [&, precision](uint32_t i) {
+			vec4 value = normalize(a4[i], precision);
+			long double reference[4] = { a4[i].x, a4[i].y, a4[i].z, a4[i].w };
+			_longNormalize(reference, 4);
+
+			return _ulps(&value.x, reference, 4, 1.0L);
+		};
+	};
+	passes &= _accuracyRun("vec4 normalize", count, 2.0, normalize4Check(PRECISION_EXACT));
+	passes &= _accuracyRun("vec4 normalize, fast", count, 4.0, normalize4Check(PRECISION_FAST));
+
+	auto rsqrtCheck = [&](Precision precision) {
+		return [&, precision](uint32_t i) {
+			float value = rsqrt(inputs.positives[i], precision);
+			long double reference = 1.0L / std::sqrt((long double)inputs.positives[i]);
+			return _ulps(&value, &reference, 1, reference);
+		};
+	};
+	passes &= _accuracyRun("rsqrt", count, 1.5, rsqrtCheck(PRECISION_EXACT));
+	passes &= _accuracyRun("rsqrt, fast", count, RSQRT_FAST_ULP, rsqrtCheck(PRECISION_FAST));
+
+	passes &= _accuracyRun("mat4 * mat4", count, 3.0, [&](uint32_t i) {
+		LongMat4 a = _longMat4(affines[i]), b = _longMat4(others[i]);
+		return _matrixUlps(affines[i] * others[i], _longMul(a, b, false), _longMul(a, b, true));
+	});
+
+	passes &= _accuracyRun("mat4 * vec4", count, 3.0, [&](uint32_t i) {
+		vec4 value = affines[i] * a4[i];
+		LongMat4 a = _longMat4(affines[i]);
+		LongMat4 v = {};
+		for (int k = 0; k < 4; k++)
+			v.m[k] = (&a4[i].x)[k];
+
+		LongMat4 reference = _longMul(a, v, false), magnitudes = _longMul(a, v, true);
+
+		double largest = 0.0;
+		for (int k = 0; k < 4; k++)
+			largest = std::max(largest, _ulps(&value.x + k, &reference.m[k], 1, magnitudes.m[k]));
+
+		return largest;
+	});
+
+	passes &= _accuracyRun("transpose", count, 0.0, [&](uint32_t i) {
+		LongMat4 reference, original = _longMat4(affines[i]);
+		for (int c = 0; c < 4; c++) {
+			for (int r = 0; r < 4; r++)
+				reference.m[c * 4 + r] = original.m[r * 4 + c];
+		}
+
+		return _matrixNormUlps(transpose(affines[i]), reference);
+	});
+
+	passes &= _accuracyRun("inverse, affine", count, 16.0, [&](uint32_t i) {
+		return _matrixNormUlps(inverse(affines[i]), _longInverse(_longMat4(affines[i])));
+	});
+
+	passes &= _accuracyRun("inverse, projective", count, 16.0, [&](uint32_t i) {
+		return _matrixNormUlps(inverse(inputs.projectives[i]), _longInverse(_longMat4(inputs.projectives[i])));
+	});
+
+	passes &= _accuracyRun("affineInverse", count, 16.0, [&](uint32_t i) {
+		return _matrixNormUlps(affineInverse(affines[i]), _longInverse(_longMat4(affines[i])));
+	});
+
+	passes &= _accuracyRun("normalMatrix", count, 16.0, [&](uint32_t i) {
+		LongMat4 inverted = _longInverse(_longMat4(affines[i]));
+
+		LongMat4 reference = {};
+		for (int c = 0; c < 3; c++) {
+			for (int r = 0; r < 3; r++)
+				reference.m[c * 4 + r] = inverted.m[r * 4 + c];
+		}
+		reference.m[15] = 1.0L;
+
+		return _matrixNormUlps(normalMatrix(affines[i]), reference);
+	});
+
+	passes &= _accuracyRun("perspective", count, 4.0, [&](uint32_t i) {
+		float fovY = 0.5f + inputs.factors[i], aspect = 1.7f, zNear = 0.1f, zFar = 100.0f;
+		long double focal = 1.0L / std::tan((long double)fovY / 2.0L);
+
+		LongMat4 reference = {};
+		reference.m[0] = focal / aspect;
+		reference.m[5] = -focal;
+		reference.m[10] = (long double)zNear / ((long double)zFar - zNear);
+		reference.m[11] = -1.0L;
+		reference.m[14] = (long double)zFar * zNear / ((long double)zFar - zNear);
+
+		return _matrixNormUlps(perspective(aspect, fovY, zNear, zFar), reference);
+	});
+
+	passes &= _accuracyRun("lookAt", count, 16.0, [&](uint32_t i) {
+		vec3 target = b3[i] + vec3(0.0f, 0.0f, 25.0f), up = vec3(0.0f, 1.0f, 0.0f);
+		return _matrixNormUlps(lookAt(a3[i], target, up), _longLookAt(a3[i], target, up));
+	});
+
+	passes &= _accuracyRun("quat *", count, 2.0, [&](uint32_t i) {
+		quat value = rotations[i] * targets[i];
+		long double reference[4];
+		_longQuatMul(rotations[i], targets[i], reference);
+
+		return _ulps(&value.x, reference, 4, 1.0L);
+	});
+
+	passes &= _accuracyRun("quat rotate", count, 12.0, [&](uint32_t i) {
+		vec3 value = rotate(rotations[i], a3[i]);
+
+		// q * (v, 0) * conjugate(q)
+		long double product[4], reference[4];
+		_longQuatMul(rotations[i], quat(a3[i], 0.0f), product);
+		quat q = conjugate(rotations[i]);
+		long double qx = q.x, qy = q.y, qz = q.z, qw = q.w;
+		reference[0] = product[3] * qx + product[0] * qw + product[1] * qz - product[2] * qy;
+		reference[1] = product[3] * qy - product[0] * qz + product[1] * qw + product[2] * qx;
+		reference[2] = product[3] * qz + product[0] * qy - product[1] * qx + product[2] * qw;
+
+		long double magnitude =
+				std::sqrt(reference[0] * reference[0] + reference[1] * reference[1] + reference[2] * reference[2]);
+		return _ulps(&value.x, reference, 3, magnitude);
+	});
+
+	passes &= _accuracyRun("quat slerp", count, 8.0, [&](uint32_t i) {
+		const quat &a = rotations[i], &b = targets[i];
+		long double cosAngle = (long double)a.x * b.x + (long double)a.y * b.y + (long double)a.z * b.z +
+				(long double)a.w * b.w;
+
+		// nlerp takes over close to the same rotation, its error there is not slerp's
+		long double sign = cosAngle < 0.0L ? -1.0L : 1.0L;
+		if (cosAngle * sign > 0.999L)
+			return 0.0;
+
+		long double angle = std::acos(cosAngle * sign), t = inputs.factors[i];
+		long double remainder = std::sin((1.0L - t) * angle) / std::sin(angle);
+		long double weight = std::sin(t * angle) / std::sin(angle) * sign;
+
+		const float *qa = &a.x, *qb = &b.x;
+		long double reference[4];
+		for (int k = 0; k < 4; k++)
+			reference[k] = qa[k] * remainder + qb[k] * weight;
+
+		quat value = slerp(a, b, inputs.factors[i]);
+		return _ulps(&value.x, reference, 4, 1.0L);
+	});
+
+	passes &= _accuracyRun("quatMatrix", count, 4.0, [&](uint32_t i) {
+		return _matrixNormUlps(quatMatrix(rotations[i]), _longTrsMatrix(trs(vec3(0.0f), rotations[i], vec3(1.0f))));
+	});
+
+	passes &= _accuracyRun("trsMatrix", count, 4.0, [&](uint32_t i) {
+		return _matrixNormUlps(trsMatrix(inputs.transforms[i]), _longTrsMatrix(inputs.transforms[i]));
+	});
+
+	// composing the decomposed transform again in long double gives back the matrix
+	passes &= _accuracyRun("trsDecompose", count, 16.0, [&](uint32_t i) {
+		LongMat4 original = _longMat4(affines[i]);
+		LongMat4 recomposed = _longTrsMatrix(trsDecompose(affines[i]));
+
+		mat4 value;
+		float *elements = &value.x.x;
+		for (int k = 0; k < 16; k++)
+			elements[k] = (float)recomposed.m[k];
+
+		return _matrixNormUlps(value, original);
+	});
+
+	return passes;
+}
+
+// Microbenchmarks and accuracy checks of the math library: math_bench [bench|accuracy] [count].
+// Without a mode both run, the accuracy part fails the run when an error bound is exceeded.
+int main(int argc, char *argv[]) {
+	const char *mode = argc > 1 ? argv[1] : "";
+	const uint32_t count = argc > 2 ? atoi(argv[2]) : 4096;
+	const bool benchmarks = strcmp(mode, "accuracy") != 0, accuracy = strcmp(mode, "bench") != 0;
+
+	srand(1);
+	const Inputs inputs = _inputsCreate(count);
+
+	if (benchmarks) {
+		printf("%u inputs per run, median of %u runs after %u warmup runs\n", count, BENCH_REPETITIONS,
+				BENCH_WARMUP);
+		_benchmarksRun(inputs, count);
+	}
+
+	if (benchmarks && accuracy)
+		printf("\n");
+
+	bool passes = true;
+	if (accuracy) {
+		printf("%u random inputs against long double\n", count);
+		passes = _accuracyRunAll(inputs, count);
+	}
+
+	return passes ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <cgltf/cgltf.h>
+
+#include <io/meshopt_decoder.h>
+
+#include "bench.h"
+
+// Straightforward ATTRIBUTES encoder, version 0: per block and byte, the smallest of the
+// four group widths. The bytes can differ from meshoptimizer's, decoding works the same.
+static uint8_t _zigzag(uint8_t delta) {
+	return (uint8_t)((delta << 1) ^ (uint8_t)((int8_t)delta >> 7));
+}
+
+static void _groupEncode(const uint8_t *values, std::vector<uint8_t> &out, uint8_t *bits) {
+	std::vector<uint8_t> best(values, values + 16);
+	*bits = 3;
+
+	bool zero = std::all_of(values, values + 16, [](uint8_t v) { return v == 0; });
+	if (zero) {
+		best.clear();
+		*bits = 0;
+	}
+
+	for (uint32_t width : { 2u, 4u }) {
+		const uint8_t sentinel = (1 << width) - 1;
+
+		std::vector<uint8_t> packed(16 * width / 8, 0);
+		std::vector<uint8_t> exceptions;
+		for (uint32_t i = 0; i < 16; i++) {
+			uint8_t value = std::min(values[i], sentinel);
+			if (value == sentinel)
+				exceptions.push_back(values[i]);
+
+			uint32_t bit = i * width;
+			packed[bit / 8] |= value << (8 - width - bit % 8);
+		}
+
+		packed.insert(packed.end(), exceptions.begin(), exceptions.end());
+		if (!zero && packed.size() < best.size()) {
+			best = packed;
+			*bits = width == 2 ? 1 : 2;
+		}
+	}
+
+	out.insert(out.end(), best.begin(), best.end());
+}
+
+static std::vector<uint8_t> _vertexBufferEncode(const uint8_t *vertices, size_t count, size_t stride) {
+	std::vector<uint8_t> out(1, 0xa0);
+
+	const size_t blockSize = std::min<size_t>((8192 / stride) & ~15, 256);
+	std::vector<uint8_t> last(vertices, vertices + stride);
+
+	for (size_t offset = 0; offset < count; offset += blockSize) {
+		size_t blockCount = std::min(blockSize, count - offset);
+		size_t aligned = (blockCount + 15) & ~15;
+
+		for (size_t k = 0; k < stride; k++) {
+			std::vector<uint8_t> deltas(aligned, 0);
+			for (size_t i = 0; i < blockCount; i++) {
+				uint8_t value = vertices[(offset + i) * stride + k];
+				deltas[i] = _zigzag(value - last[k]);
+				last[k] = value;
+			}
+
+			size_t header = out.size();
+			out.resize(out.size() + (aligned / 16 + 3) / 4, 0);
+
+			for (size_t group = 0; group < aligned / 16; group++) {
+				uint8_t bits;
+				_groupEncode(&deltas[group * 16], out, &bits);
+				out[header + group / 4] |= bits << ((group % 4) * 2);
+			}
+		}
+	}
+
+	// the tail holds the first vertex, padded in front to at least 32 bytes
+	out.resize(out.size() + std::max<size_t>(stride, 32) - stride, 0);
+	out.insert(out.end(), vertices, vertices + stride);
+	return out;
+}
+
+static void _vbyteEncode(std::vector<uint8_t> &out, uint32_t value) {
+	do {
+		out.push_back((value & 127) | (value > 127 ? 128 : 0));
+		value >>= 7;
+	} while (value != 0);
+}
+
+// INDICES mode, deltas against the closer of the two baselines.
+static std::vector<uint8_t> _indexSequenceEncode(const uint32_t *indices, size_t count) {
+	std::vector<uint8_t> out(1, 0xd1);
+	uint32_t last[2] = {};
+
+	for (size_t i = 0; i < count; i++) {
+		int32_t d0 = (int32_t)(indices[i] - last[0]);
+		int32_t d1 = (int32_t)(indices[i] - last[1]);
+		uint32_t baseline = std::abs((int64_t)d0) <= std::abs((int64_t)d1) ? 0 : 1;
+
+		int32_t delta = baseline == 0 ? d0 : d1;
+		uint32_t v = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+		_vbyteEncode(out, (v << 1) | baseline);
+		last[baseline] = indices[i];
+	}
+
+	out.resize(out.size() + 4, 0);
+	return out;
+}
+
+// Quantized vertex of a wavy grid, shaped like gltfpack output: u16 position, snorm8 octahedral normal
+// and tangent, u16 texture coordinates.
+typedef struct {
+	uint16_t position[4];
+	int8_t normal[4];
+	int8_t tangent[4];
+	uint16_t texCoord[2];
+} PackedVertex;
+
+static std::vector<PackedVertex> _gridCreate(uint32_t size, std::vector<uint32_t> &indices) {
+	std::vector<PackedVertex> vertices;
+	for (uint32_t y = 0; y <= size; y++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			float fx = x / (float)size;
+			float fy = y / (float)size;
+			float height = std::sin(fx * 40.0f) * std::cos(fy * 30.0f);
+
+			PackedVertex vertex = {};
+			vertex.position[0] = (uint16_t)(fx * 65535.0f);
+			vertex.position[1] = (uint16_t)(fy * 65535.0f);
+			vertex.position[2] = (uint16_t)((height * 0.5f + 0.5f) * 65535.0f);
+
+			vertex.normal[0] = (int8_t)(std::cos(fx * 40.0f) * 40.0f);
+			vertex.normal[1] = (int8_t)(std::sin(fy * 30.0f) * 40.0f);
+			vertex.normal[2] = 127;
+			vertex.tangent[0] = 127 - std::abs(vertex.normal[1]);
+			vertex.tangent[2] = 127;
+			vertex.tangent[3] = 127;
+
+			vertex.texCoord[0] = (uint16_t)(fx * 65535.0f);
+			vertex.texCoord[1] = (uint16_t)(fy * 65535.0f);
+			vertices.push_back(vertex);
+		}
+	}
+
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			uint32_t a = y * (size + 1) + x;
+			uint32_t c = a + size + 1;
+			uint32_t quad[6] = { a, a + 1, c, a + 1, c + 1, c };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+
+	return vertices;
+}
+
+static void _resultPrint(const char *name, size_t encoded, size_t decoded, double time) {
+	printf("%-28s %10.3f %10.3f %8.2fx %10.3f ms %8.2f GB/s\n", name, encoded / 1e6, decoded / 1e6,
+			(double)decoded / encoded, time, decoded / (time / 1e3) / 1e9);
+}
+
+// Decodes every EXT_meshopt_compression buffer view of a file, e.g. one written by gltfpack -c.
+static int _fileRun(const char *path) {
+	cgltf_options options = {};
+	cgltf_data *data = nullptr;
+	if (cgltf_parse_file(&options, path, &data) != cgltf_result_success ||
+			cgltf_load_buffers(&options, data, path) != cgltf_result_success) {
+		fprintf(stderr, "Failed to load %s\n", path);
+		cgltf_free(data);
+		return EXIT_FAILURE;
+	}
+
+	const char *MODES[] = { "invalid", "attributes", "triangles", "indices" };
+	const char *FILTERS[] = { "", " octahedral", " quaternion", " exponential" };
+
+	size_t totalEncoded = 0, totalDecoded = 0;
+	double totalTime = 0.0;
+
+	for (uint64_t i = 0; i < data->buffer_views_count; i++) {
+		const cgltf_buffer_view &view = data->buffer_views[i];
+		if (!view.has_meshopt_compression)
+			continue;
+
+		const cgltf_meshopt_compression &compression = view.meshopt_compression;
+		std::vector<uint8_t> out(compression.count * compression.stride);
+
+		if (!MeshoptDecoder::bufferViewDecode(compression, out.data())) {
+			fprintf(stderr, "Buffer view %lu does not decode\n", i);
+			continue;
+		}
+
+		double time = benchMedian([&] { MeshoptDecoder::bufferViewDecode(compression, out.data()); });
+
+		char name[64];
+		snprintf(name, sizeof(name), "view %lu %s%s", i, MODES[compression.mode], FILTERS[compression.filter]);
+		_resultPrint(name, compression.size, out.size(), time);
+
+		totalEncoded += compression.size;
+		totalDecoded += out.size();
+		totalTime += time;
+	}
+
+	if (totalTime > 0.0)
+		_resultPrint("all views", totalEncoded, totalDecoded, totalTime);
+
+	cgltf_free(data);
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+	printf("%-28s %10s %10s %9s %13s %13s\n", "stream", "MB in", "MB out", "ratio", "time", "decode");
+
+	if (argc > 1 && (strstr(argv[1], ".gltf") != nullptr || strstr(argv[1], ".glb") != nullptr))
+		return _fileRun(argv[1]);
+
+	uint32_t size = argc > 1 ? atoi(argv[1]) : 1024;
+
+	std::vector<uint32_t> indices;
+	std::vector<PackedVertex> vertices = _gridCreate(size, indices);
+
+	const uint8_t *vertexData = reinterpret_cast<const uint8_t *>(vertices.data());
+	const size_t vertexBytes = vertices.size() * sizeof(PackedVertex);
+
+	std::vector<uint8_t> encoded = _vertexBufferEncode(vertexData, vertices.size(), sizeof(PackedVertex));
+	std::vector<uint8_t> decoded(vertexBytes);
+
+	if (!MeshoptDecoder::vertexBufferDecode(decoded.data(), vertices.size(), sizeof(PackedVertex), encoded.data(),
+				encoded.size()) ||
+			memcmp(decoded.data(), vertexData, vertexBytes) != 0) {
+		fprintf(stderr, "Vertex round trip failed\n");
+		return EXIT_FAILURE;
+	}
+
+	double time = benchMedian([&] {
+		MeshoptDecoder::vertexBufferDecode(decoded.data(), vertices.size(), sizeof(PackedVertex), encoded.data(),
+				encoded.size());
+	});
+	char name[64];
+	snprintf(name, sizeof(name), "attributes, %zu byte vertex", sizeof(PackedVertex));
+	_resultPrint(name, encoded.size(), vertexBytes, time);
+
+	// the filters run on data already in cache, like right after decoding
+	std::vector<uint8_t> normals(vertices.size() * 4);
+	for (size_t i = 0; i < vertices.size(); i++)
+		memcpy(&normals[i * 4], vertices[i].normal, 4);
+
+	std::vector<uint8_t> filtered(normals.size());
+	time = benchMedian([&] {
+		memcpy(filtered.data(), normals.data(), normals.size());
+		MeshoptDecoder::octahedralFilter(filtered.data(), vertices.size(), 4);
+	});
+	_resultPrint("octahedral filter, snorm8", normals.size(), normals.size(), time);
+
+	std::vector<uint32_t> floats(vertices.size() * 3);
+	for (size_t i = 0; i < floats.size(); i++)
+		floats[i] = ((uint32_t)(-8 - (int32_t)(i % 4)) << 24) | (i & 0xffff);
+
+	std::vector<uint32_t> exponents(floats.size());
+	time = benchMedian([&] {
+		memcpy(exponents.data(), floats.data(), floats.size() * sizeof(uint32_t));
+		MeshoptDecoder::exponentialFilter(exponents.data(), vertices.size(), 12);
+	});
+	_resultPrint("exponential filter, vec3", floats.size() * 4, floats.size() * 4, time);
+
+	std::vector<uint8_t> sequence = _indexSequenceEncode(indices.data(), indices.size());
+	std::vector<uint32_t> indexOut(indices.size());
+
+	if (!MeshoptDecoder::indexSequenceDecode(reinterpret_cast<uint8_t *>(indexOut.data()), indices.size(), 4,
+				sequence.data(), sequence.size()) ||
+			indexOut != indices) {
+		fprintf(stderr, "Index sequence round trip failed\n");
+		return EXIT_FAILURE;
+	}
+
+	time = benchMedian([&] {
+		MeshoptDecoder::indexSequenceDecode(reinterpret_cast<uint8_t *>(indexOut.data()), indices.size(), 4,
+				sequence.data(), sequence.size());
+	});
+	_resultPrint("indices, u32", sequence.size(), indices.size() * 4, time);
+
+	return EXIT_SUCCESS;
+}
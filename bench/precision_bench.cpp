@@ -0,0 +1,129 @@
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <math/projection.h>
+#include <math/types/mat4.h>
+#include <math/types/precision.h>
+#include <math/types/vec3.h>
+
+#include "bench.h"
+
+using namespace math;
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static void _resultPrint(const char *name, double beforeTime, double exactTime, double fastTime, uint32_t count) {
+	printf("%-28s %12.3f %12.3f %12.3f %8.2fx\n", name, beforeTime * 1e6 / count, exactTime * 1e6 / count,
+			fastTime * 1e6 / count, beforeTime / fastTime);
+}
+
+// The precision tiers where they run: rsqrt alone, vec3 normalize, the loader's per vertex normal normalization
+// and a camera's view projection, in ns per element. before is the code they replace: normalize in double,
+// the loader dividing by the length.
+int main(int argc, char *argv[]) {
+	const uint32_t count = argc > 1 ? atoi(argv[1]) : 4096;
+
+	srand(1);
+	std::vector<float> values(count), results(count);
+	std::vector<vec3> vectors(count), normals(count);
+	for (uint32_t i = 0; i < count; i++) {
+		values[i] = std::fabs(_random()) * 100.0f + 1e-3f;
+		vectors[i] = vec3(_random(), _random(), _random()) + vec3(1e-3f);
+	}
+
+	printf("%u elements per run\n", count);
+	printf("%-28s %12s %12s %12s %9s\n", "path", "before (ns)", "exact (ns)", "fast (ns)", "speedup");
+
+	auto rsqrtRun = [&](Precision precision) {
+		return benchMedian([&] {
+			for (uint32_t i = 0; i < count; i++)
+				results[i] = rsqrt(values[i], precision);
+
+			benchKeep(results[0]);
+		});
+	};
+	double beforeTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			results[i] = 1.0 / std::sqrt(values[i]);
+
+		benchKeep(results[0]);
+	});
+	_resultPrint("rsqrt", beforeTime, rsqrtRun(PRECISION_EXACT), rsqrtRun(PRECISION_FAST), count);
+
+	auto normalizeRun = [&](Precision precision) {
+		return benchMedian([&] {
+			for (uint32_t i = 0; i < count; i++)
+				normals[i] = normalize(vectors[i], precision);
+
+			benchKeep(normals[0]);
+		});
+	};
+	beforeTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++) {
+			const vec3 &v = vectors[i];
+			float denom = 1.0 / std::sqrt((v.x * v.x) + (v.y * v.y) + (v.z * v.z));
+			normals[i] = v * denom;
+		}
+
+		benchKeep(normals[0]);
+	});
+	_resultPrint("normalize vec3", beforeTime, normalizeRun(PRECISION_EXACT), normalizeRun(PRECISION_FAST), count);
+
+	// loader: normalizing the normals of a vertex array in place, as the glTF loader and normal generation do
+	std::vector<vec3> vertexNormals(count);
+	auto loaderRun = [&](Precision precision) {
+		return benchMedian([&] {
+			vertexNormals = vectors;
+			for (vec3 &normal : vertexNormals) {
+				float lengthSquared = normal.x * normal.x + normal.y * normal.y + normal.z * normal.z;
+				if (lengthSquared < FLT_MIN)
+					continue;
+
+				float scale = rsqrt(lengthSquared, precision);
+				normal.x *= scale;
+				normal.y *= scale;
+				normal.z *= scale;
+			}
+
+			benchKeep(vertexNormals[0]);
+		});
+	};
+	beforeTime = benchMedian([&] {
+		vertexNormals = vectors;
+		for (vec3 &normal : vertexNormals) {
+			float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			if (length == 0.0f)
+				continue;
+
+			normal.x /= length;
+			normal.y /= length;
+			normal.z /= length;
+		}
+
+		benchKeep(vertexNormals[0]);
+	});
+	_resultPrint("loader normals", beforeTime, loaderRun(PRECISION_EXACT), loaderRun(PRECISION_FAST), count);
+
+	// renderer: a camera's view projection per view and frame
+	std::vector<mat4> cameras(count);
+	auto cameraRun = [&](Precision precision) {
+		return benchMedian([&] {
+			for (uint32_t i = 0; i < count; i++) {
+				cameras[i] = perspective(1.7f, 1.0f, 0.1f, 1000.0f) *
+						lookAt(vectors[i] * 10.0f, vec3(0.0f), vec3(0.0f, 1.0f, 0.0f), precision);
+			}
+
+			benchKeep(cameras[0]);
+		});
+	};
+	double exactTime = cameraRun(PRECISION_EXACT);
+	_resultPrint("camera view projection", exactTime, exactTime, cameraRun(PRECISION_FAST), count);
+
+	return EXIT_SUCCESS;
+}
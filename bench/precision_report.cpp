@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <math/types/precision.h>
+#include <math/types/vec3.h>
+#include <math/types/vec4.h>
+
+using namespace math;
+
+typedef struct {
+	double largest;
+	double sum;
+	uint64_t count;
+} UlpError;
+
+// Distance from reference in units in the last place of a float at the reference's magnitude.
+static double _ulpDistance(float value, long double reference) {
+	int exponent;
+	std::frexp((double)std::fabs(reference), &exponent);
+	return (double)(std::fabs((long double)value - reference) / std::ldexp(1.0L, exponent - 24));
+}
+
+static void _errorAdd(UlpError &error, double ulps) {
+	error.largest = std::max(error.largest, ulps);
+	error.sum += ulps;
+	error.count++;
+}
+
+static float _floatFromBits(uint32_t bits) {
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static bool _resultPrint(const char *name, const UlpError &error, double bound) {
+	bool passes = bound <= 0.0 || error.largest <= bound;
+
+	printf("%-28s %10.3f %10.4f %10llu", name, error.largest, error.sum / error.count,
+			(unsigned long long)error.count);
+	if (bound > 0.0)
+		printf("   bound %.1f %s", bound, passes ? "ok" : "EXCEEDED");
+
+	printf("\n");
+	return passes;
+}
+
+// Bounds the error of both precision tiers against long double references: rsqrt for every float in [1, 4),
+// the estimate's error repeats every two binades, and for random floats of any exponent, then normalize on
+// random vectors. Fails when rsqrt exceeds its documented bound.
+int main(int argc, char *argv[]) {
+	const uint32_t vectorCount = argc > 1 ? atoi(argv[1]) : 1000000;
+
+	printf("%-28s %10s %10s %10s\n", "function", "max ulp", "mean ulp", "samples");
+
+	UlpError exact = {}, fast = {};
+	const uint32_t first = 0x3f800000u, last = 0x40800000u; // 1.0f and 4.0f
+	for (uint32_t bits = first; bits < last; bits++) {
+		float x = _floatFromBits(bits);
+		long double reference = 1.0L / std::sqrt((long double)x);
+
+		_errorAdd(exact, _ulpDistance(rsqrt(x, PRECISION_EXACT), reference));
+		_errorAdd(fast, _ulpDistance(rsqrt(x, PRECISION_FAST), reference));
+	}
+
+	bool passes = _resultPrint("rsqrt exact, [1, 4)", exact, 1.5);
+	passes &= _resultPrint("rsqrt fast, [1, 4)", fast, RSQRT_FAST_ULP);
+
+	exact = {};
+	fast = {};
+	srand(1);
+	for (uint32_t i = 0; i < vectorCount; i++) {
+		// every normal exponent
+		uint32_t bits = (uint32_t)(1 + rand() % 254) << 23 | ((uint32_t)rand() & 0x7fffffu);
+		float x = _floatFromBits(bits);
+		long double reference = 1.0L / std::sqrt((long double)x);
+
+		_errorAdd(exact, _ulpDistance(rsqrt(x, PRECISION_EXACT), reference));
+		_errorAdd(fast, _ulpDistance(rsqrt(x, PRECISION_FAST), reference));
+	}
+
+	passes &= _resultPrint("rsqrt exact, normal floats", exact, 1.5);
+	passes &= _resultPrint("rsqrt fast, normal floats", fast, RSQRT_FAST_ULP);
+
+	// the largest component of the unit vector, the small ones inherit the rounding of the squared length
+	auto largestFind = [](const float *components, int count) {
+		int largest = 0;
+		for (int c = 1; c < count; c++) {
+			if (std::fabs(components[c]) > std::fabs(components[largest]))
+				largest = c;
+		}
+
+		return largest;
+	};
+
+	UlpError exact3 = {}, fast3 = {}, exact4 = {}, fast4 = {};
+	for (uint32_t i = 0; i < vectorCount; i++) {
+		vec4 v = vec4(_random(), _random(), _random(), _random()) * std::ldexp(1.0f, rand() % 40 - 20);
+		const float *components = &v.x;
+
+		long double squared = 0.0L;
+		for (int c = 0; c < 3; c++)
+			squared += (long double)components[c] * components[c];
+
+		if (squared == 0.0L)
+			continue;
+
+		int largest = largestFind(components, 3);
+		long double reference = components[largest] / std::sqrt(squared);
+
+		vec3 exactNormal = normalize(vec3(v.x, v.y, v.z), PRECISION_EXACT);
+		vec3 fastNormal = normalize(vec3(v.x, v.y, v.z), PRECISION_FAST);
+		_errorAdd(exact3, _ulpDistance((&exactNormal.x)[largest], reference));
+		_errorAdd(fast3, _ulpDistance((&fastNormal.x)[largest], reference));
+
+		squared += (long double)v.w * v.w;
+		largest = largestFind(components, 4);
+		reference = components[largest] / std::sqrt(squared);
+
+		vec4 exactNormal4 = normalize(v, PRECISION_EXACT), fastNormal4 = normalize(v, PRECISION_FAST);
+		_errorAdd(exact4, _ulpDistance((&exactNormal4.x)[largest], reference));
+		_errorAdd(fast4, _ulpDistance((&fastNormal4.x)[largest], reference));
+	}
+
+	_resultPrint("normalize vec3 exact", exact3, 0.0);
+	_resultPrint("normalize vec3 fast", fast3, 0.0);
+	_resultPrint("normalize vec4 exact", exact4, 0.0);
+	_resultPrint("normalize vec4 fast", fast4, 0.0);
+
+	return passes ? EXIT_SUCCESS : EXIT_FAILURE;
+}
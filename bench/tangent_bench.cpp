@@ -0,0 +1,123 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <core/thread_pool.h>
+
+#include <io/tangent_space.h>
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include "bench.h"
+
+// Wavy grid with a mirrored UV seam down the middle, so both handedness values occur.
+static void _gridCreate(uint32_t size, std::vector<uint32_t> &indices, std::vector<Vertex> &vertices) {
+	vertices.resize((size + 1) * (size + 1));
+	for (uint32_t y = 0; y <= size; y++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			float fx = x / (float)size;
+			float fy = y / (float)size;
+
+			Vertex &vertex = vertices[y * (size + 1) + x];
+			vertex.position[0] = fx;
+			vertex.position[1] = fy;
+			vertex.position[2] = 0.05f * std::sin(fx * 40.0f) * std::cos(fy * 30.0f);
+
+			vertex.normal[0] = 0.0f;
+			vertex.normal[1] = 0.0f;
+			vertex.normal[2] = 1.0f;
+
+			vertex.texCoord[0] = fx < 0.5f ? fx : 1.0f - fx;
+			vertex.texCoord[1] = fy;
+		}
+	}
+
+	indices.clear();
+	indices.reserve(size * size * 6);
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			uint32_t a = y * (size + 1) + x;
+			uint32_t b = a + 1;
+			uint32_t c = a + size + 1;
+			uint32_t d = c + 1;
+
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(c);
+			indices.push_back(b);
+			indices.push_back(d);
+			indices.push_back(c);
+		}
+	}
+}
+
+// The loader's previous scalar implementation: unweighted, unprojected average, no handedness.
+static void _tangentsGenerateReference(const IndexArray &indices, VertexArray &vertices) {
+	std::vector<float> tangents(vertices.count * 3, 0.0f);
+	std::vector<float> averages(vertices.count, 0.0f);
+
+	for (size_t i = 0; i < indices.count; i += 3) {
+		const Vertex &v0 = vertices.data[indices.data[i + 0]];
+		const Vertex &v1 = vertices.data[indices.data[i + 1]];
+		const Vertex &v2 = vertices.data[indices.data[i + 2]];
+
+		float e1[3], e2[3];
+		for (int k = 0; k < 3; k++) {
+			e1[k] = v1.position[k] - v0.position[k];
+			e2[k] = v2.position[k] - v0.position[k];
+		}
+
+		float du1 = v1.texCoord[0] - v0.texCoord[0];
+		float dv1 = v1.texCoord[1] - v0.texCoord[1];
+		float du2 = v2.texCoord[0] - v0.texCoord[0];
+		float dv2 = v2.texCoord[1] - v0.texCoord[1];
+
+		float r = 1.0 / (du1 * dv2 - dv1 * du2);
+		for (int c = 0; c < 3; c++) {
+			for (int k = 0; k < 3; k++)
+				tangents[indices.data[i + c] * 3 + k] += (e1[k] * dv2 - e2[k] * dv1) * r;
+
+			averages[indices.data[i + c]] += 1.0f;
+		}
+	}
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		for (int k = 0; k < 3; k++)
+			vertices.data[i].tangent[k] = tangents[i * 3 + k] / averages[i];
+	}
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t size = argc > 1 ? atoi(argv[1]) : 1024;
+
+	std::vector<uint32_t> indexData;
+	std::vector<Vertex> vertexData;
+	_gridCreate(size, indexData, vertexData);
+
+	IndexArray indices = { indexData.data(), (uint32_t)indexData.size() };
+	VertexArray vertices = { vertexData.data(), (uint32_t)vertexData.size() };
+
+	const double triangles = indices.count / 3;
+	printf("%u vertices, %.0f triangles\n", vertices.count, triangles);
+
+	double referenceTime = benchMedian([&] { _tangentsGenerateReference(indices, vertices); });
+	double serialTime = benchMedian([&] { TangentSpace::tangentsGenerate(indices, vertices); });
+
+	ThreadPool pool(0);
+	double parallelTime = benchMedian([&] { TangentSpace::tangentsGenerate(indices, vertices, &pool); });
+
+	uint32_t negative = 0;
+	for (uint32_t i = 0; i < vertices.count; i++)
+		negative += vertices.data[i].tangent[3] < 0.0f;
+
+	printf("%-24s %10.3f ms %10.2f Mtri/s\n", "previous scalar", referenceTime, triangles / referenceTime / 1e3);
+	printf("%-24s %10.3f ms %10.2f Mtri/s\n", "tangent space, 1 thread", serialTime, triangles / serialTime / 1e3);
+	printf("tangent space, %2u threads %9.3f ms %10.2f Mtri/s\n", pool.threadCount(), parallelTime,
+			triangles / parallelTime / 1e3);
+	printf("%u of %u vertices with negative handedness\n", negative, vertices.count);
+
+	return EXIT_SUCCESS;
+}
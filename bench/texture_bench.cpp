@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <core/arena.h>
+#include <core/thread_pool.h>
+
+#include <io/texture_decoder.h>
+#include <io/types/texture.h>
+
+#include "bench.h"
+
+// Gradient with a checker in blue, the checker only survives the sRGB round trip if filtering is linear.
+static std::vector<uint8_t> _imageCreate(uint32_t width, uint32_t height) {
+	std::vector<uint8_t> pixels((size_t)width * height * 4);
+
+	for (uint32_t y = 0; y < height; y++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint8_t *pixel = &pixels[((size_t)y * width + x) * 4];
+			pixel[0] = x * 255 / (width - 1);
+			pixel[1] = y * 255 / (height - 1);
+			pixel[2] = ((x / 8 + y / 8) % 2) ? 255 : 0;
+			pixel[3] = 255;
+		}
+	}
+
+	return pixels;
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t size = argc > 1 ? atoi(argv[1]) : 2048;
+	uint32_t imageCount = argc > 2 ? atoi(argv[2]) : 8;
+
+	std::vector<uint8_t> pixels = _imageCreate(size, size);
+	printf("%u images of %ux%u\n", imageCount, size, size);
+
+	ThreadPool pool(0);
+
+	const MipFilter FILTERS[] = { MIP_FILTER_BOX, MIP_FILTER_KAISER };
+	const char *FILTER_NAMES[] = { "box", "kaiser" };
+
+	for (uint32_t i = 0; i < 2; i++) {
+		for (bool srgb : { false, true }) {
+			Texture texture = {};
+
+			double serialTime = benchMedian([&] {
+				Arena arena;
+				texture = TextureDecoder::textureCreate(pixels.data(), size, size, srgb, FILTERS[i], arena);
+				benchKeep(texture.data[texture.size - 1]);
+			});
+
+			// one image per task, like the loader
+			double parallelTime = benchMedian([&] {
+				std::vector<Arena> arenas(imageCount);
+				pool.parallelFor(imageCount, [&](uint32_t imageIndex) {
+					Texture chain = TextureDecoder::textureCreate(
+							pixels.data(), size, size, srgb, FILTERS[i], arenas[imageIndex]);
+					benchKeep(chain.data[chain.size - 1]);
+				});
+			}, 1, 3);
+
+			double megapixels = (double)size * size / 1e6;
+			printf("%-6s %-6s %10.3f ms/image %8.1f Mpixel/s, %2u threads %8.1f Mpixel/s\n", FILTER_NAMES[i],
+					srgb ? "srgb" : "linear", serialTime, megapixels / (serialTime / 1e3), pool.threadCount(),
+					megapixels * imageCount / (parallelTime / 1e3));
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
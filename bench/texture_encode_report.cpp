@@ -0,0 +1,97 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <core/arena.h>
+#include <core/mapped_file.h>
+#include <core/thread_pool.h>
+
+#include <io/ktx2_file.h>
+#include <io/texture_decoder.h>
+#include <io/texture_encoder.h>
+#include <io/types/texture.h>
+
+// Encodes images to every block format and prints quality, encode rate and size against RGBA8.
+// With an output directory the chains are written there as <image>.<format>.ktx2 and read back.
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		printf("Usage: %s <image>... [-o <directory>]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const char *directory = nullptr;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "-o") == 0)
+			directory = argv[i + 1];
+	}
+
+	ThreadPool pool(0);
+
+	const TextureFormat FORMATS[] = { TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC4, TEXTURE_FORMAT_BC5, TEXTURE_FORMAT_BC7 };
+
+	printf("%-32s %-6s %10s %12s %10s %8s\n", "image", "format", "psnr (dB)", "Mpixel/s", "MB", "ratio");
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-o") == 0) {
+			i++;
+			continue;
+		}
+
+		MappedFile file;
+		if (!fileMap(argv[i], &file)) {
+			fprintf(stderr, "Failed to open %s\n", argv[i]);
+			continue;
+		}
+
+		uint32_t width, height;
+		uint8_t *pixels =
+				TextureDecoder::pixelsDecode(reinterpret_cast<const uint8_t *>(file.data), file.size, &width, &height);
+		fileUnmap(file);
+
+		if (pixels == nullptr) {
+			fprintf(stderr, "Failed to decode %s\n", argv[i]);
+			continue;
+		}
+
+		Arena arena;
+		Texture source = TextureDecoder::textureCreate(pixels, width, height, true, MIP_FILTER_BOX, arena);
+		TextureDecoder::pixelsFree(pixels);
+
+		std::string name(argv[i]);
+		name = name.substr(name.find_last_of('/') + 1);
+
+		for (TextureFormat format : FORMATS) {
+			EncodeStats stats;
+			Texture texture = TextureEncoder::textureEncode(source, format, arena, &pool, &stats);
+
+			printf("%-32s %-6s %10.2f %12.1f %10.3f %7.1fx\n", name.c_str(), TextureEncoder::formatName(format),
+					stats.psnr, stats.pixelCount / 1e6 / (stats.encodeTime / 1e3), stats.encodedBytes / 1e6,
+					(double)stats.sourceBytes / stats.encodedBytes);
+
+			if (directory == nullptr)
+				continue;
+
+			std::string path = std::string(directory) + "/" + name + "." + TextureEncoder::formatName(format) + ".ktx2";
+			if (!KTX2File::textureWrite(path.c_str(), texture)) {
+				fprintf(stderr, "Failed to write %s\n", path.c_str());
+				continue;
+			}
+
+			MappedFile written;
+			Texture read;
+			bool valid = fileMap(path.c_str(), &written) &&
+					KTX2File::textureRead(reinterpret_cast<const uint8_t *>(written.data), written.size, arena, &read);
+			valid = valid && read.size == texture.size && memcmp(read.data, texture.data, texture.size) == 0;
+
+			if (written.data != nullptr)
+				fileUnmap(written);
+
+			if (!valid)
+				fprintf(stderr, "%s does not read back\n", path.c_str());
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <io/mesh_bounds.h>
+#include <io/types/aabb.h>
+
+#include <math/transform_batch.h>
+#include <math/types/mat4.h>
+#include <math/types/vec4.h>
+
+#include "bench.h"
+
+using namespace math;
+
+// Owns the arrays behind a Vec3Stream or AABBStream.
+typedef struct {
+	std::vector<float> components[6];
+} Streams;
+
+static float _random() {
+	return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static Streams _streamsCreate(uint32_t count, bool random) {
+	Streams streams;
+	for (std::vector<float> &component : streams.components) {
+		component.resize(count);
+		for (float &value : component)
+			value = random ? _random() * 10.0f : 0.0f;
+	}
+
+	return streams;
+}
+
+static Vec3Stream _vec3Stream(Streams &streams) {
+	return { streams.components[0].data(), streams.components[1].data(), streams.components[2].data() };
+}
+
+static AABBStream _aabbStream(Streams &streams) {
+	return { streams.components[0].data(), streams.components[1].data(), streams.components[2].data(),
+		streams.components[3].data(), streams.components[4].data(), streams.components[5].data() };
+}
+
+// Affine, rotation and scale from random columns, translation up to 10.
+static mat4 _randomMatrix() {
+	return mat4(vec4(_random(), _random(), _random(), 0.0f), vec4(_random(), _random(), _random(), 0.0f),
+			vec4(_random(), _random(), _random(), 0.0f), vec4(_random() * 10.0f, _random() * 10.0f, _random() * 10.0f,
+														 1.0f));
+}
+
+static float _largestDifference(const Streams &streams, const float *reference, uint32_t componentCount,
+		uint32_t count) {
+	float largest = 0.0f;
+	for (uint32_t i = 0; i < count; i++) {
+		for (uint32_t c = 0; c < componentCount; c++) {
+			float value = reference[i * componentCount + c];
+			float difference = std::fabs(streams.components[c][i] - value) / std::fmax(1.0f, std::fabs(value));
+			largest = std::fmax(largest, difference);
+		}
+	}
+
+	return largest;
+}
+
+static void _resultPrint(const char *name, double referenceTime, double time, uint32_t count, float difference) {
+	printf("%-32s %10.3f %10.3f %8.2fx %12.2e\n", name, count / (referenceTime * 1e6), count / (time * 1e6),
+			referenceTime / time, difference);
+}
+
+// Batch SoA transforms against transforming AoS elements one at a time with mat4 * vec4 and
+// MeshBounds::aabbTransform, in elements per ns. The default count is odd so every kernel runs a tail.
+int main(int argc, char *argv[]) {
+	const uint32_t count = argc > 1 ? atoi(argv[1]) : 100003;
+	const uint32_t jointCount = 64;
+
+#if defined(MATH_AVX2)
+	const char *backend = "AVX2";
+#elif defined(MATH_SSE)
+	const char *backend = "SSE";
+#else
+	const char *backend = "scalar";
+#endif
+
+	srand(1);
+	Streams in = _streamsCreate(count, true);
+	Streams out = _streamsCreate(count, false);
+
+	// the boxes have positive sizes
+	for (uint32_t c = 3; c < 6; c++) {
+		for (float &value : in.components[c])
+			value = std::fabs(value);
+	}
+
+	std::vector<vec4> points(count), directions(count), transformed(count);
+	std::vector<AABB> aabbs(count), transformedAABBs(count);
+	for (uint32_t i = 0; i < count; i++) {
+		const std::vector<float> *c = in.components;
+		points[i] = vec4(c[0][i], c[1][i], c[2][i], 1.0f);
+		directions[i] = vec4(c[0][i], c[1][i], c[2][i], 0.0f);
+		aabbs[i] = { c[0][i], c[1][i], c[2][i], c[3][i], c[4][i], c[5][i] };
+	}
+
+	const mat4 matrix = _randomMatrix();
+
+	std::vector<mat4> matrices(count), joints(jointCount);
+	std::vector<uint32_t> jointIndices(count);
+	for (mat4 &m : matrices)
+		m = _randomMatrix();
+	for (mat4 &m : joints)
+		m = _randomMatrix();
+	for (uint32_t &index : jointIndices)
+		index = rand() % jointCount;
+
+	printf("%u elements per run, %s backend\n", count, backend);
+	printf("%-32s %10s %10s %9s %12s\n", "kernel", "one (/ns)", "batch (/ns)", "speedup", "max diff");
+
+	// results are compared as x, y, z per element, AABB fields in order
+	auto vectorsCompare = [&](const std::vector<vec4> &vectors) {
+		std::vector<float> flat(count * 3);
+		for (uint32_t i = 0; i < count; i++) {
+			flat[i * 3] = vectors[i].x;
+			flat[i * 3 + 1] = vectors[i].y;
+			flat[i * 3 + 2] = vectors[i].z;
+		}
+
+		return _largestDifference(out, flat.data(), 3, count);
+	};
+
+	double referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformed[i] = matrix * points[i];
+
+		benchKeep(transformed[0]);
+	});
+	double time = benchMedian([&] {
+		pointsTransform(matrix, _vec3Stream(in), _vec3Stream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("points, one matrix", referenceTime, time, count, vectorsCompare(transformed));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformed[i] = matrices[i] * points[i];
+
+		benchKeep(transformed[0]);
+	});
+	time = benchMedian([&] {
+		pointsTransform(matrices.data(), nullptr, _vec3Stream(in), _vec3Stream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("points, matrix per element", referenceTime, time, count, vectorsCompare(transformed));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformed[i] = joints[jointIndices[i]] * points[i];
+
+		benchKeep(transformed[0]);
+	});
+	time = benchMedian([&] {
+		pointsTransform(joints.data(), jointIndices.data(), _vec3Stream(in), _vec3Stream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("points, 64 indexed joints", referenceTime, time, count, vectorsCompare(transformed));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformed[i] = matrix * directions[i];
+
+		benchKeep(transformed[0]);
+	});
+	time = benchMedian([&] {
+		directionsTransform(matrix, _vec3Stream(in), _vec3Stream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("directions, one matrix", referenceTime, time, count, vectorsCompare(transformed));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformed[i] = matrices[i] * directions[i];
+
+		benchKeep(transformed[0]);
+	});
+	time = benchMedian([&] {
+		directionsTransform(matrices.data(), nullptr, _vec3Stream(in), _vec3Stream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("directions, matrix per element", referenceTime, time, count, vectorsCompare(transformed));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformedAABBs[i] = MeshBounds::aabbTransform(aabbs[i], matrix);
+
+		benchKeep(transformedAABBs[0]);
+	});
+	time = benchMedian([&] {
+		aabbsTransform(matrix, _aabbStream(in), _aabbStream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("aabbs, one matrix", referenceTime, time, count,
+			_largestDifference(out, &transformedAABBs[0].x, 6, count));
+
+	referenceTime = benchMedian([&] {
+		for (uint32_t i = 0; i < count; i++)
+			transformedAABBs[i] = MeshBounds::aabbTransform(aabbs[i], matrices[i]);
+
+		benchKeep(transformedAABBs[0]);
+	});
+	time = benchMedian([&] {
+		aabbsTransform(matrices.data(), nullptr, _aabbStream(in), _aabbStream(out), count);
+		benchKeep(out.components[0][0]);
+	});
+	_resultPrint("aabbs, matrix per element", referenceTime, time, count,
+			_largestDifference(out, &transformedAABBs[0].x, 6, count));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <io/gltf_loader.h>
+#include <io/types/mesh.h>
+#include <io/types/scene.h>
+#include <io/types/vertex.h>
+#include <io/vertex_quantizer.h>
+
+// Reports the vertex memory each asset saves with CompactVertex and the
+// largest round trip error, usage: vertex_compact_report file.gltf [file.glb ...]
+
+typedef struct {
+	uint64_t vertexCount;
+	float positionError; // relative to the largest AABB extent
+	float normalError;   // degrees
+	float tangentError;  // degrees
+	float texCoordError;
+	uint32_t handednessFlips;
+} Report;
+
+static float _angle(const float *a, const float *b) {
+	float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	float la = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+	float lb = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+	if (la == 0.0f || lb == 0.0f)
+		return 0.0f;
+
+	return std::acos(std::min(std::max(d / (la * lb), -1.0f), 1.0f)) * 180.0f / M_PI;
+}
+
+static void _primitiveReport(const Primitive &primitive, Report &report) {
+	std::vector<CompactVertex> compactData(primitive.vertices.count);
+	CompactVertexArray compact = { compactData.data(), primitive.vertices.count };
+	VertexQuantizer::verticesQuantize(primitive.vertices, primitive.aabb, compact);
+
+	float scale = VertexQuantizer::positionScale(primitive.aabb);
+
+	for (uint32_t i = 0; i < primitive.vertices.count; i++) {
+		const Vertex &original = primitive.vertices.data[i];
+		Vertex decoded = VertexQuantizer::vertexDequantize(compact.data[i], primitive.aabb);
+
+		for (int k = 0; k < 3; k++)
+			report.positionError =
+					std::max(report.positionError, std::fabs(decoded.position[k] - original.position[k]) / scale);
+
+		for (int k = 0; k < 2; k++)
+			report.texCoordError =
+					std::max(report.texCoordError, std::fabs(decoded.texCoord[k] - original.texCoord[k]));
+
+		report.normalError = std::max(report.normalError, _angle(decoded.normal, original.normal));
+		report.tangentError = std::max(report.tangentError, _angle(decoded.tangent, original.tangent));
+		report.handednessFlips += (decoded.tangent[3] < 0.0f) != (original.tangent[3] < 0.0f);
+	}
+
+	report.vertexCount += primitive.vertices.count;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s file.gltf [file.glb ...]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	printf("%-32s %10s %10s %10s %6s %10s %8s %8s %10s\n", "asset", "vertices", "float MB", "compact MB", "saved",
+			"pos error", "normal", "tangent", "uv error");
+
+	uint64_t totalVertices = 0;
+	for (int i = 1; i < argc; i++) {
+		Scene scene = GLTFLoader::loadFile(argv[i]);
+
+		Report report = {};
+		for (uint32_t m = 0; m < scene.meshCount; m++) {
+			for (uint32_t p = 0; p < scene.meshes[m].primitiveCount; p++)
+				_primitiveReport(scene.meshes[m].primitives[p], report);
+		}
+
+		double floatBytes = report.vertexCount * sizeof(Vertex);
+		double compactBytes = report.vertexCount * sizeof(CompactVertex);
+		double saved = floatBytes > 0.0 ? 100.0 * (1.0 - compactBytes / floatBytes) : 0.0;
+
+		printf("%-32s %10lu %10.3f %10.3f %5.1f%% %10.2e %7.3f° %7.3f° %10.2e\n", argv[i], report.vertexCount,
+				floatBytes / (1024.0 * 1024.0), compactBytes / (1024.0 * 1024.0), saved, report.positionError,
+				report.normalError, report.tangentError, report.texCoordError);
+
+		if (report.handednessFlips > 0)
+			printf("  %u vertices changed tangent handedness\n", report.handednessFlips);
+
+		totalVertices += report.vertexCount;
+		GLTFLoader::sceneFree(scene);
+	}
+
+	printf("%lu vertices, %lu bytes per vertex instead of %lu, %.3f MB saved in total\n", totalVertices,
+			sizeof(CompactVertex), sizeof(Vertex),
+			totalVertices * (sizeof(Vertex) - sizeof(CompactVertex)) / (1024.0 * 1024.0));
+
+	return EXIT_SUCCESS;
+}
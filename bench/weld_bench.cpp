@@ -0,0 +1,83 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <core/thread_pool.h>
+
+#include <io/mesh_welder.h>
+#include <io/tangent_space.h>
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include "bench.h"
+
+// Wavy grid as a non-indexed triangle list without normals, every inner vertex appears six times.
+static std::vector<Vertex> _soupCreate(uint32_t size) {
+	std::vector<Vertex> vertices;
+	vertices.reserve(size * size * 6);
+
+	const uint32_t CORNERS[6][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+	for (uint32_t y = 0; y < size; y++) {
+		for (uint32_t x = 0; x < size; x++) {
+			for (const uint32_t *corner : CORNERS) {
+				float fx = (x + corner[0]) / (float)size;
+				float fy = (y + corner[1]) / (float)size;
+
+				Vertex vertex = {};
+				vertex.position[0] = fx;
+				vertex.position[1] = fy;
+				vertex.position[2] = 0.05f * std::sin(fx * 40.0f) * std::cos(fy * 30.0f);
+				vertex.texCoord[0] = fx;
+				vertex.texCoord[1] = fy;
+				vertices.push_back(vertex);
+			}
+		}
+	}
+
+	return vertices;
+}
+
+// Weld and normal times per vertex for growing grids, they stay flat if both are linear.
+int main(int argc, char *argv[]) {
+	uint32_t maxSize = argc > 1 ? atoi(argv[1]) : 1024;
+
+	ThreadPool pool(0);
+
+	printf("%10s %10s %12s %10s %12s %12s %12s\n", "vertices", "welded", "weld (ms)", "ns/vertex", "normals (ms)",
+			"pool (ms)", "ns/vertex");
+
+	for (uint32_t size = 64; size <= maxSize; size *= 2) {
+		const std::vector<Vertex> soup = _soupCreate(size);
+
+		std::vector<uint32_t> indexData(soup.size());
+		std::vector<Vertex> vertexData;
+		IndexArray indices = {};
+		VertexArray vertices = {};
+
+		// every run starts over from the soup, the copy is part of the time
+		double weldTime = benchMedian([&] {
+			vertexData = soup;
+			indices = { indexData.data(), (uint32_t)indexData.size() };
+			vertices = { vertexData.data(), (uint32_t)vertexData.size() };
+
+			for (uint32_t i = 0; i < indices.count; i++)
+				indices.data[i] = i;
+
+			MeshWelder::verticesWeld(indices, vertices);
+		});
+
+		double serialTime = benchMedian([&] {
+			TangentSpace::normalsGenerate(indices, vertices, NORMAL_WEIGHTING_ANGLE);
+		});
+		double parallelTime = benchMedian([&] {
+			TangentSpace::normalsGenerate(indices, vertices, NORMAL_WEIGHTING_ANGLE, &pool);
+		});
+
+		printf("%10zu %10u %12.3f %10.2f %12.3f %12.3f %12.2f\n", soup.size(), vertices.count, weldTime,
+				weldTime * 1e6 / soup.size(), serialTime, parallelTime, serialTime * 1e6 / vertices.count);
+	}
+
+	return EXIT_SUCCESS;
+}
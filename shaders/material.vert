@@ -1,8 +1,16 @@
 #version 450
 
+#ifdef COMPACT_VERTEX
+// CompactVertex: unorm position with handedness in w, octahedral normal and tangent.
+// MODEL_MATRIX includes the dequantization to the primitive AABB.
+layout(location = 0) in vec4 inPositionHandedness;
+layout(location = 1) in vec2 inNormalOct;
+layout(location = 2) in vec2 inTangentOct;
+#else
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec3 inTangent;
+layout(location = 2) in vec4 inTangent;
+#endif
 layout(location = 3) in vec2 inTexCoord;
 
 layout(location = 0) out vec3 outPosition;
@@ -16,12 +24,27 @@ layout(push_constant) uniform MaterialConstants {
 	mat4 MODEL_MATRIX;
 };
 
+#ifdef COMPACT_VERTEX
+vec3 octDecode(vec2 e) {
+	vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-v.z, 0.0);
+	v.xy += mix(vec2(t), vec2(-t), greaterThanEqual(v.xy, vec2(0.0)));
+	return normalize(v);
+}
+#endif
+
 void main() {
-	vec3 tangent = normalize(vec3(MODEL_MATRIX * vec4(inTangent, 0.0)));
+#ifdef COMPACT_VERTEX
+	vec3 inPosition = inPositionHandedness.xyz;
+	vec3 inNormal = octDecode(inNormalOct);
+	vec4 inTangent = vec4(octDecode(inTangentOct), inPositionHandedness.w * 2.0 - 1.0);
+#endif
+
+	vec3 tangent = normalize(vec3(MODEL_MATRIX * vec4(inTangent.xyz, 0.0)));
 	vec3 normal = normalize(vec3(MODEL_MATRIX * vec4(inNormal, 0.0)));
 
 	tangent = normalize(tangent - dot(tangent, normal) * normal);
-	vec3 bitangent = cross(normal, tangent);
+	vec3 bitangent = cross(normal, tangent) * inTangent.w;
 
 	vec4 position4 = MODEL_MATRIX * vec4(inPosition, 1.0);
 	vec3 position = vec3(position4) / position4.w;
@@ -0,0 +1,97 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include "arena.h"
+
+void *Arena::_blockAllocate(size_t size, size_t alignment) {
+	size_t headerSize = (sizeof(Block) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	size_t required = headerSize + size + (alignment > ARENA_ALIGNMENT ? alignment : 0);
+
+	// oversized requests get their own block behind the current one, so the
+	// space left in the current block stays usable
+	bool dedicated = required > m_nextBlockSize;
+	size_t blockSize = dedicated ? required : m_nextBlockSize;
+
+	Block *block = static_cast<Block *>(malloc(blockSize));
+	if (block == nullptr) {
+		fprintf(stderr, "Arena: out of memory allocating %zu bytes!\n", blockSize);
+		abort();
+	}
+
+	block->size = blockSize;
+
+	m_bytesReserved += blockSize;
+	m_blockCount++;
+
+	uint8_t *begin = reinterpret_cast<uint8_t *>(block) + headerSize;
+	uintptr_t address = (reinterpret_cast<uintptr_t>(begin) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+	if (dedicated && m_blocks != nullptr) {
+		block->next = m_blocks->next;
+		m_blocks->next = block;
+		return reinterpret_cast<void *>(address);
+	}
+
+	block->next = m_blocks;
+	m_blocks = block;
+
+	m_cursor = reinterpret_cast<uint8_t *>(address + size);
+	m_end = reinterpret_cast<uint8_t *>(block) + blockSize;
+
+	if (!dedicated && m_nextBlockSize < ARENA_MAX_BLOCK)
+		m_nextBlockSize *= 2;
+
+	return reinterpret_cast<void *>(address);
+}
+
+void Arena::splice(Arena &other) {
+	if (other.m_blocks == nullptr)
+		return;
+
+	Block *last = other.m_blocks;
+	while (last->next != nullptr)
+		last = last->next;
+
+	// keep our current block first so bump allocation carries on in it
+	if (m_blocks != nullptr) {
+		last->next = m_blocks->next;
+		m_blocks->next = other.m_blocks;
+	} else {
+		m_blocks = other.m_blocks;
+		m_cursor = other.m_cursor;
+		m_end = other.m_end;
+	}
+
+	m_bytesUsed += other.m_bytesUsed;
+	m_bytesReserved += other.m_bytesReserved;
+	m_allocationCount += other.m_allocationCount;
+	m_blockCount += other.m_blockCount;
+
+	other.m_blocks = nullptr;
+	other.m_cursor = nullptr;
+	other.m_end = nullptr;
+	other.m_nextBlockSize = ARENA_MIN_BLOCK;
+	other.m_bytesUsed = 0;
+	other.m_bytesReserved = 0;
+	other.m_allocationCount = 0;
+	other.m_blockCount = 0;
+}
+
+void Arena::release() {
+	Block *block = m_blocks;
+	while (block != nullptr) {
+		Block *next = block->next;
+		free(block);
+		block = next;
+	}
+
+	m_blocks = nullptr;
+	m_cursor = nullptr;
+	m_end = nullptr;
+	m_nextBlockSize = ARENA_MIN_BLOCK;
+
+	m_bytesUsed = 0;
+	m_bytesReserved = 0;
+	m_allocationCount = 0;
+	m_blockCount = 0;
+}
@@ -0,0 +1,96 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+const size_t ARENA_ALIGNMENT = 16;
+const size_t ARENA_MIN_BLOCK = 4096;
+const size_t ARENA_MAX_BLOCK = 1 << 20;
+
+// Bump allocator owning everything allocated from it until release or
+// destruction, individual allocations are never freed. Blocks start small and
+// double up to ARENA_MAX_BLOCK, larger requests get a block of their own.
+// Not thread safe, give every thread its own arena and splice them together.
+class Arena {
+private:
+	typedef struct Block {
+		Block *next;
+		size_t size;
+	} Block;
+
+	Block *m_blocks = nullptr; // current block first
+	uint8_t *m_cursor = nullptr;
+	uint8_t *m_end = nullptr;
+	size_t m_nextBlockSize = ARENA_MIN_BLOCK;
+
+	uint64_t m_bytesUsed = 0;
+	uint64_t m_bytesReserved = 0;
+	uint64_t m_allocationCount = 0;
+	uint64_t m_blockCount = 0;
+
+	void *_blockAllocate(size_t size, size_t alignment);
+
+public:
+	Arena(Arena const &) = delete;
+	void operator=(Arena const &) = delete;
+
+	// alignment must be a power of two. Never returns nullptr, aborts when out of memory.
+	void *allocate(size_t size, size_t alignment = ARENA_ALIGNMENT) {
+		m_allocationCount++;
+		m_bytesUsed += size;
+
+		uintptr_t address = (reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		if (m_cursor != nullptr && address + size <= reinterpret_cast<uintptr_t>(m_end)) {
+			m_cursor = reinterpret_cast<uint8_t *>(address + size);
+			return reinterpret_cast<void *>(address);
+		}
+
+		return _blockAllocate(size, alignment);
+	}
+
+	// Uninitialized unless zero is set, T must be trivially constructible.
+	template <typename T>
+	T *arrayAllocate(size_t count, bool zero = false) {
+		size_t alignment = alignof(T) > ARENA_ALIGNMENT ? alignof(T) : ARENA_ALIGNMENT;
+		T *array = static_cast<T *>(allocate(count * sizeof(T), alignment));
+
+		if (zero)
+			memset(static_cast<void *>(array), 0, count * sizeof(T));
+
+		return array;
+	}
+
+	// Takes over the blocks and counters of other, which is left empty.
+	// Allocation continues in this arena's current block.
+	void splice(Arena &other);
+
+	// Frees every block at once.
+	void release();
+
+	// Requested bytes, malloc'd bytes including unused block space, allocate calls, malloc calls.
+	uint64_t bytesUsed() const {
+		return m_bytesUsed;
+	}
+
+	uint64_t bytesReserved() const {
+		return m_bytesReserved;
+	}
+
+	uint64_t allocationCount() const {
+		return m_allocationCount;
+	}
+
+	uint64_t blockCount() const {
+		return m_blockCount;
+	}
+
+	Arena() {}
+
+	~Arena() {
+		release();
+	}
+};
+
+#endif // !ARENA_H
@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "hash.h"
+#include "mapped_file.h"
+
+const uint64_t PRIME_1 = 11400714785074694791ULL;
+const uint64_t PRIME_2 = 14029467366897019727ULL;
+const uint64_t PRIME_3 = 1609587929392839161ULL;
+const uint64_t PRIME_4 = 9650029242287828579ULL;
+const uint64_t PRIME_5 = 2870177450012600261ULL;
+
+static inline uint64_t _rotl(uint64_t v, int r) {
+	return (v << r) | (v >> (64 - r));
+}
+
+static inline uint64_t _read64(const uint8_t *p) {
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t _read32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t _round(uint64_t acc, uint64_t input) {
+	acc += input * PRIME_2;
+	acc = _rotl(acc, 31);
+	return acc * PRIME_1;
+}
+
+static inline uint64_t _mergeRound(uint64_t acc, uint64_t v) {
+	acc ^= _round(0, v);
+	return acc * PRIME_1 + PRIME_4;
+}
+
+uint64_t hash64(const void *data, size_t size, uint64_t seed) {
+	const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+	const uint8_t *end = p + size;
+
+	uint64_t h;
+	if (size >= 32) {
+		uint64_t v1 = seed + PRIME_1 + PRIME_2;
+		uint64_t v2 = seed + PRIME_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME_1;
+
+		const uint8_t *limit = end - 32;
+		do {
+			v1 = _round(v1, _read64(p + 0));
+			v2 = _round(v2, _read64(p + 8));
+			v3 = _round(v3, _read64(p + 16));
+			v4 = _round(v4, _read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = _rotl(v1, 1) + _rotl(v2, 7) + _rotl(v3, 12) + _rotl(v4, 18);
+		h = _mergeRound(h, v1);
+		h = _mergeRound(h, v2);
+		h = _mergeRound(h, v3);
+		h = _mergeRound(h, v4);
+	} else {
+		h = seed + PRIME_5;
+	}
+
+	h += size;
+
+	while (p + 8 <= end) {
+		h ^= _round(0, _read64(p));
+		h = _rotl(h, 27) * PRIME_1 + PRIME_4;
+		p += 8;
+	}
+
+	if (p + 4 <= end) {
+		h ^= (uint64_t)_read32(p) * PRIME_1;
+		h = _rotl(h, 23) * PRIME_2 + PRIME_3;
+		p += 4;
+	}
+
+	while (p < end) {
+		h ^= (*p) * PRIME_5;
+		h = _rotl(h, 11) * PRIME_1;
+		p++;
+	}
+
+	h ^= h >> 33;
+	h *= PRIME_2;
+	h ^= h >> 29;
+	h *= PRIME_3;
+	h ^= h >> 32;
+	return h;
+}
+
+bool fileHash(const char *path, uint64_t *hash) {
+	MappedFile file;
+	if (!fileMap(path, &file))
+		return false;
+
+	*hash = hash64(file.data, file.size);
+	fileUnmap(file);
+	return true;
+}
@@ -0,0 +1,13 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit XXH64 hash, fast enough to key caches on multi-gigabyte files.
+uint64_t hash64(const void *data, size_t size, uint64_t seed = 0);
+
+// Hash of the whole file contents, returns false if the file cannot be read.
+bool fileHash(const char *path, uint64_t *hash);
+
+#endif // !HASH_H
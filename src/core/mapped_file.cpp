@@ -0,0 +1,49 @@
+#include <cstddef>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.h"
+
+bool fileMap(const char *path, MappedFile *file, bool writable) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		return false;
+	}
+
+	file->data = nullptr;
+	file->size = info.st_size;
+
+	if (file->size == 0) {
+		close(fd);
+		return true;
+	}
+
+	int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+	void *data = mmap(nullptr, file->size, protection, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	// Mapped data is mostly consumed front to back, let the kernel read ahead.
+	madvise(data, file->size, MADV_WILLNEED);
+
+	file->data = data;
+	return true;
+}
+
+void fileUnmap(MappedFile &file) {
+	if (file.data != nullptr)
+		munmap(file.data, file.size);
+
+	file.data = nullptr;
+	file.size = 0;
+}
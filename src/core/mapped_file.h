@@ -0,0 +1,18 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// Read-only view of a whole file. Pages are faulted in on first access and
+// stay clean, so the kernel can drop them under memory pressure.
+typedef struct {
+	void *data;
+	size_t size;
+} MappedFile;
+
+// Returns false if the file cannot be opened or mapped. Empty files map to data == nullptr.
+// A writable mapping is copy-on-write, writes never reach the file.
+bool fileMap(const char *path, MappedFile *file, bool writable = false);
+void fileUnmap(MappedFile &file);
+
+#endif // !MAPPED_FILE_H
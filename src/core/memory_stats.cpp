@@ -0,0 +1,48 @@
+#include <cstdint>
+#include <cstdio>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "memory_stats.h"
+
+uint64_t memoryRssCurrent() {
+	FILE *file = fopen("/proc/self/statm", "r");
+	if (file == nullptr)
+		return 0;
+
+	unsigned long size = 0;
+	unsigned long resident = 0;
+	int count = fscanf(file, "%lu %lu", &size, &resident);
+	fclose(file);
+
+	if (count != 2)
+		return 0;
+
+	return (uint64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+uint64_t memoryRssPeak() {
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	// ru_maxrss is in kilobytes on Linux
+	return (uint64_t)usage.ru_maxrss * 1024;
+}
+
+uint64_t memoryRssAnonymous() {
+	FILE *file = fopen("/proc/self/status", "r");
+	if (file == nullptr)
+		return 0;
+
+	char line[256];
+	unsigned long kilobytes = 0;
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		if (sscanf(line, "RssAnon: %lu kB", &kilobytes) == 1)
+			break;
+	}
+
+	fclose(file);
+	return (uint64_t)kilobytes * 1024;
+}
@@ -0,0 +1,14 @@
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <cstdint>
+
+// Resident set size of the process in bytes, 0 where unsupported.
+uint64_t memoryRssCurrent();
+uint64_t memoryRssPeak();
+
+// Anonymous (heap and stack) part of the resident set. Unlike memoryRssCurrent
+// it leaves out clean file-backed pages, which the kernel can drop at any time.
+uint64_t memoryRssAnonymous();
+
+#endif // !MEMORY_STATS_H
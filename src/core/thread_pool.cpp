@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "thread_pool.h"
+
+static thread_local bool isWorker = false;
+
+void ThreadPool::_jobRun(Job &job) {
+	while (true) {
+		uint32_t i = job.next.fetch_add(1);
+		if (i >= job.count)
+			break;
+
+		(*job.function)(i);
+		job.finished.fetch_add(1);
+	}
+}
+
+void ThreadPool::_workerLoop() {
+	isWorker = true;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		m_wake.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+
+		if (m_stop)
+			return;
+
+		Job *job = m_jobs.front();
+		job->users++;
+
+		lock.unlock();
+		_jobRun(*job);
+		lock.lock();
+
+		// job is exhausted, no point handing it to other workers
+		if (!m_jobs.empty() && m_jobs.front() == job)
+			m_jobs.pop_front();
+
+		job->users--;
+		if (job->users == 0)
+			m_done.notify_all();
+	}
+}
+
+uint32_t ThreadPool::threadCount() const {
+	return m_workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)> &function) {
+	if (count == 0)
+		return;
+
+	if (isWorker || m_workers.empty() || count == 1) {
+		for (uint32_t i = 0; i < count; i++)
+			function(i);
+
+		return;
+	}
+
+	Job job;
+	job.function = &function;
+	job.count = count;
+	job.next = 0;
+	job.finished = 0;
+	job.users = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(&job);
+	}
+
+	m_wake.notify_all();
+	_jobRun(job);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	std::deque<Job *>::iterator it = std::find(m_jobs.begin(), m_jobs.end(), &job);
+	if (it != m_jobs.end())
+		m_jobs.erase(it);
+
+	m_done.wait(lock, [&job] { return job.users == 0 && job.finished == job.count; });
+}
+
+ThreadPool::ThreadPool(uint32_t threadCount) {
+	if (threadCount == 0)
+		threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (uint32_t i = 1; i < threadCount; i++)
+		m_workers.push_back(std::thread(&ThreadPool::_workerLoop, this));
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_wake.notify_all();
+
+	for (std::thread &worker : m_workers)
+		worker.join();
+}
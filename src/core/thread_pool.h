@@ -0,0 +1,52 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+private:
+	typedef struct {
+		const std::function<void(uint32_t)> *function;
+		uint32_t count;
+
+		std::atomic<uint32_t> next;
+		std::atomic<uint32_t> finished;
+		uint32_t users;
+	} Job;
+
+	std::vector<std::thread> m_workers;
+	std::deque<Job *> m_jobs;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	bool m_stop = false;
+
+	static void _jobRun(Job &job);
+	void _workerLoop();
+
+public:
+	ThreadPool(ThreadPool const &) = delete;
+	void operator=(ThreadPool const &) = delete;
+
+	// Number of threads taking part in parallelFor, including the calling thread.
+	uint32_t threadCount() const;
+
+	// Calls function(i) for every i in [0, count) and returns once all calls finished.
+	// The calling thread takes part in the work. Calls made from inside a worker run serially.
+	void parallelFor(uint32_t count, const std::function<void(uint32_t)> &function);
+
+	// threadCount includes the calling thread, 0 picks the hardware concurrency.
+	ThreadPool(uint32_t threadCount);
+	~ThreadPool();
+};
+
+#endif // !THREAD_POOL_H
@@ -0,0 +1,26 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <chrono>
+
+class Timer {
+private:
+	std::chrono::steady_clock::time_point m_start;
+
+public:
+	// Milliseconds since construction or the last reset.
+	double elapsed() const {
+		std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - m_start;
+		return duration.count();
+	}
+
+	void reset() {
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	Timer() {
+		reset();
+	}
+};
+
+#endif // !TIMER_H
@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <cgltf/cgltf.h>
+
+#include "accessor_decoder.h"
+
+typedef void (*FloatKernel)(const uint8_t *src, size_t srcStride, const uint8_t *srcEnd, size_t count,
+		uint32_t components, float *dst, size_t dstStride);
+
+template <typename T, bool NORMALIZED>
+static inline float _toFloat(T v) {
+	return (float)v;
+}
+
+template <>
+inline float _toFloat<int8_t, true>(int8_t v) {
+	return std::max(v / 127.0f, -1.0f);
+}
+
+template <>
+inline float _toFloat<uint8_t, true>(uint8_t v) {
+	return v / 255.0f;
+}
+
+template <>
+inline float _toFloat<int16_t, true>(int16_t v) {
+	return std::max(v / 32767.0f, -1.0f);
+}
+
+template <>
+inline float _toFloat<uint16_t, true>(uint16_t v) {
+	return v / 65535.0f;
+}
+
+template <typename T, bool NORMALIZED>
+static void _floatsDecodeScalar(const uint8_t *src, size_t srcStride, const uint8_t *srcEnd, size_t count,
+		uint32_t components, float *dst, size_t dstStride) {
+	uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+
+	for (size_t i = 0; i < count; i++) {
+		T element[4];
+		memcpy(element, src + i * srcStride, components * sizeof(T));
+
+		float *values = reinterpret_cast<float *>(out + i * dstStride);
+		for (uint32_t c = 0; c < components; c++)
+			values[c] = _toFloat<T, NORMALIZED>(element[c]);
+	}
+}
+
+#ifdef __SSE2__
+
+static inline void _floatsStore(float *dst, __m128 v, uint32_t components) {
+	switch (components) {
+		case 4:
+			_mm_storeu_ps(dst, v);
+			break;
+		case 3:
+			_mm_storel_pi(reinterpret_cast<__m64 *>(dst), v);
+			_mm_store_ss(dst + 2, _mm_movehl_ps(v, v));
+			break;
+		case 2:
+			_mm_storel_pi(reinterpret_cast<__m64 *>(dst), v);
+			break;
+		default:
+			_mm_store_ss(dst, v);
+			break;
+	}
+}
+
+// Loads one element widened to four 32-bit lanes. Reads up to 8 bytes past the
+// element start, callers make sure that stays inside the buffer view.
+template <typename T>
+static inline __m128i _elementLoad(const uint8_t *src);
+
+template <>
+inline __m128i _elementLoad<uint8_t>(const uint8_t *src) {
+	int32_t bytes;
+	memcpy(&bytes, src, sizeof(bytes));
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero);
+	return _mm_unpacklo_epi16(v, zero);
+}
+
+template <>
+inline __m128i _elementLoad<int8_t>(const uint8_t *src) {
+	int32_t bytes;
+	memcpy(&bytes, src, sizeof(bytes));
+
+	__m128i v = _mm_cvtsi32_si128(bytes);
+	v = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+	return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+}
+
+template <>
+inline __m128i _elementLoad<uint16_t>(const uint8_t *src) {
+	__m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src));
+	return _mm_unpacklo_epi16(v, _mm_setzero_si128());
+}
+
+template <>
+inline __m128i _elementLoad<int16_t>(const uint8_t *src) {
+	__m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src));
+	return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+}
+
+template <typename T>
+static inline float _normalizeScale();
+
+template <>
+inline float _normalizeScale<uint8_t>() {
+	return 1.0f / 255.0f;
+}
+
+template <>
+inline float _normalizeScale<int8_t>() {
+	return 1.0f / 127.0f;
+}
+
+template <>
+inline float _normalizeScale<uint16_t>() {
+	return 1.0f / 65535.0f;
+}
+
+template <>
+inline float _normalizeScale<int16_t>() {
+	return 1.0f / 32767.0f;
+}
+
+template <typename T, bool NORMALIZED>
+static void _floatsDecodeSSE(const uint8_t *src, size_t srcStride, const uint8_t *srcEnd, size_t count,
+		uint32_t components, float *dst, size_t dstStride) {
+	uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+
+	const __m128 scale = _mm_set1_ps(_normalizeScale<T>());
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const bool isSigned = std::is_signed<T>::value;
+
+	// the last elements may sit too close to the end of the view for a full 8 byte load
+	size_t vectorCount = 0;
+	if ((size_t)(srcEnd - src) >= 8)
+		vectorCount = std::min(count, (size_t)(srcEnd - src - 8) / srcStride + 1);
+
+	for (size_t i = 0; i < vectorCount; i++) {
+		__m128 v = _mm_cvtepi32_ps(_elementLoad<T>(src + i * srcStride));
+
+		if (NORMALIZED) {
+			v = _mm_mul_ps(v, scale);
+			if (isSigned)
+				v = _mm_max_ps(v, minusOne);
+		}
+
+		_floatsStore(reinterpret_cast<float *>(out + i * dstStride), v, components);
+	}
+
+	_floatsDecodeScalar<T, NORMALIZED>(src + vectorCount * srcStride, srcStride, srcEnd, count - vectorCount,
+			components, reinterpret_cast<float *>(out + vectorCount * dstStride), dstStride);
+}
+
+static void _floatsCopySSE(const uint8_t *src, size_t srcStride, const uint8_t *srcEnd, size_t count,
+		uint32_t components, float *dst, size_t dstStride) {
+	uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+
+	size_t vectorCount = 0;
+	if ((size_t)(srcEnd - src) >= 16)
+		vectorCount = std::min(count, (size_t)(srcEnd - src - 16) / srcStride + 1);
+
+	for (size_t i = 0; i < vectorCount; i++) {
+		__m128 v = _mm_loadu_ps(reinterpret_cast<const float *>(src + i * srcStride));
+		_floatsStore(reinterpret_cast<float *>(out + i * dstStride), v, components);
+	}
+
+	_floatsDecodeScalar<float, false>(src + vectorCount * srcStride, srcStride, srcEnd, count - vectorCount,
+			components, reinterpret_cast<float *>(out + vectorCount * dstStride), dstStride);
+}
+
+#endif // __SSE2__
+
+static void _floatsCopy(const uint8_t *src, size_t srcStride, const uint8_t *srcEnd, size_t count,
+		uint32_t components, float *dst, size_t dstStride) {
+	size_t size = components * sizeof(float);
+
+	if (srcStride == size && dstStride == size) {
+		memcpy(dst, src, count * size);
+		return;
+	}
+
+#ifdef __SSE2__
+	_floatsCopySSE(src, srcStride, srcEnd, count, components, dst, dstStride);
+#else
+	_floatsDecodeScalar<float, false>(src, srcStride, srcEnd, count, components, dst, dstStride);
+#endif
+}
+
+#ifdef __SSE2__
+#define FLOAT_KERNEL(T, NORMALIZED) _floatsDecodeSSE<T, NORMALIZED>
+#else
+#define FLOAT_KERNEL(T, NORMALIZED) _floatsDecodeScalar<T, NORMALIZED>
+#endif
+
+static FloatKernel _floatKernelGet(cgltf_component_type type, bool normalized) {
+	switch (type) {
+		case cgltf_component_type_r_8:
+			return normalized ? FLOAT_KERNEL(int8_t, true) : FLOAT_KERNEL(int8_t, false);
+		case cgltf_component_type_r_8u:
+			return normalized ? FLOAT_KERNEL(uint8_t, true) : FLOAT_KERNEL(uint8_t, false);
+		case cgltf_component_type_r_16:
+			return normalized ? FLOAT_KERNEL(int16_t, true) : FLOAT_KERNEL(int16_t, false);
+		case cgltf_component_type_r_16u:
+			return normalized ? FLOAT_KERNEL(uint16_t, true) : FLOAT_KERNEL(uint16_t, false);
+		case cgltf_component_type_r_32u:
+			return _floatsDecodeScalar<uint32_t, false>;
+		case cgltf_component_type_r_32f:
+			return _floatsCopy;
+		default:
+			return nullptr;
+	}
+}
+
+#undef FLOAT_KERNEL
+
+static bool _viewRangeGet(const cgltf_buffer_view *view, size_t offset, size_t stride, size_t elementSize,
+		size_t count, const uint8_t **begin, const uint8_t **end) {
+	const uint8_t *data = cgltf_buffer_view_data(view);
+	if (data == nullptr)
+		return false;
+
+	if (count > 0 && offset + (count - 1) * stride + elementSize > view->size)
+		return false;
+
+	*begin = data + offset;
+	*end = data + view->size;
+	return true;
+}
+
+static uint32_t _sparseIndexGet(const uint8_t *indices, cgltf_component_type type, size_t i) {
+	switch (type) {
+		case cgltf_component_type_r_8u:
+			return indices[i];
+		case cgltf_component_type_r_16u: {
+			uint16_t index;
+			memcpy(&index, indices + i * sizeof(uint16_t), sizeof(uint16_t));
+			return index;
+		}
+		default: {
+			uint32_t index;
+			memcpy(&index, indices + i * sizeof(uint32_t), sizeof(uint32_t));
+			return index;
+		}
+	}
+}
+
+bool AccessorDecoder::floatsDecode(const cgltf_accessor &accessor, float *out, uint32_t outComponents, size_t outStride) {
+	const uint32_t components = std::min((uint32_t)cgltf_num_components(accessor.type), outComponents);
+	const size_t componentSize = cgltf_component_size(accessor.component_type);
+	const size_t elementSize = components * componentSize;
+
+	FloatKernel kernel = _floatKernelGet(accessor.component_type, accessor.normalized);
+	if (kernel == nullptr || components == 0 || components > 4)
+		return false;
+
+	uint8_t *dst = reinterpret_cast<uint8_t *>(out);
+
+	if (accessor.buffer_view != nullptr) {
+		const uint8_t *begin;
+		const uint8_t *end;
+		if (!_viewRangeGet(accessor.buffer_view, accessor.offset, accessor.stride, elementSize, accessor.count, &begin,
+					&end))
+			return false;
+
+		kernel(begin, accessor.stride, end, accessor.count, components, out, outStride);
+	} else {
+		// sparse accessors without a buffer view start out as zeros
+		for (size_t i = 0; i < accessor.count; i++)
+			memset(dst + i * outStride, 0, components * sizeof(float));
+	}
+
+	if (!accessor.is_sparse)
+		return true;
+
+	const cgltf_accessor_sparse &sparse = accessor.sparse;
+	const size_t valueStride = cgltf_num_components(accessor.type) * componentSize;
+	const size_t indexSize = cgltf_component_size(sparse.indices_component_type);
+
+	const uint8_t *indices;
+	const uint8_t *indicesEnd;
+	if (!_viewRangeGet(sparse.indices_buffer_view, sparse.indices_byte_offset, indexSize, indexSize, sparse.count,
+				&indices, &indicesEnd))
+		return false;
+
+	const uint8_t *values;
+	const uint8_t *valuesEnd;
+	if (!_viewRangeGet(sparse.values_buffer_view, sparse.values_byte_offset, valueStride, elementSize, sparse.count,
+				&values, &valuesEnd))
+		return false;
+
+	std::vector<float> decoded(sparse.count * components);
+	kernel(values, valueStride, valuesEnd, sparse.count, components, decoded.data(), components * sizeof(float));
+
+	for (size_t i = 0; i < sparse.count; i++) {
+		uint32_t index = _sparseIndexGet(indices, sparse.indices_component_type, i);
+		if (index >= accessor.count)
+			return false;
+
+		memcpy(dst + index * outStride, &decoded[i * components], components * sizeof(float));
+	}
+
+	return true;
+}
+
+bool AccessorDecoder::floatsDecodeReference(
+		const cgltf_accessor &accessor, float *out, uint32_t outComponents, size_t outStride) {
+	const uint32_t accessorComponents = cgltf_num_components(accessor.type);
+	const uint32_t components = std::min(accessorComponents, outComponents);
+
+	const bool clamp = accessor.normalized &&
+			(accessor.component_type == cgltf_component_type_r_8 || accessor.component_type == cgltf_component_type_r_16);
+
+	uint8_t *dst = reinterpret_cast<uint8_t *>(out);
+
+	// cgltf refuses sparse accessors, read the dense part and substitute afterwards
+	cgltf_accessor dense = accessor;
+	dense.is_sparse = false;
+
+	for (size_t i = 0; i < accessor.count; i++) {
+		float element[16];
+		if (!cgltf_accessor_read_float(&dense, i, element, accessorComponents))
+			return false;
+
+		for (uint32_t c = 0; c < components && clamp; c++)
+			element[c] = std::max(element[c], -1.0f);
+
+		memcpy(dst + i * outStride, element, components * sizeof(float));
+	}
+
+	if (!accessor.is_sparse)
+		return true;
+
+	const cgltf_accessor_sparse &sparse = accessor.sparse;
+
+	cgltf_accessor values = dense;
+	values.count = sparse.count;
+	values.offset = sparse.values_byte_offset;
+	values.stride = cgltf_calc_size(accessor.type, accessor.component_type);
+	values.buffer_view = sparse.values_buffer_view;
+
+	const uint8_t *indices = cgltf_buffer_view_data(sparse.indices_buffer_view);
+	if (indices == nullptr)
+		return false;
+
+	indices += sparse.indices_byte_offset;
+
+	for (size_t i = 0; i < sparse.count; i++) {
+		float element[16];
+		if (!cgltf_accessor_read_float(&values, i, element, accessorComponents))
+			return false;
+
+		for (uint32_t c = 0; c < components && clamp; c++)
+			element[c] = std::max(element[c], -1.0f);
+
+		uint32_t index = _sparseIndexGet(indices, sparse.indices_component_type, i);
+		if (index >= accessor.count)
+			return false;
+
+		memcpy(dst + index * outStride, element, components * sizeof(float));
+	}
+
+	return true;
+}
+
+bool AccessorDecoder::indicesDecode(const cgltf_accessor &accessor, uint32_t *out) {
+	const size_t componentSize = cgltf_component_size(accessor.component_type);
+
+	const uint8_t *src;
+	const uint8_t *end;
+	if (accessor.buffer_view == nullptr ||
+			!_viewRangeGet(accessor.buffer_view, accessor.offset, accessor.stride, componentSize, accessor.count, &src,
+					&end))
+		return false;
+
+	const size_t count = accessor.count;
+	const size_t stride = accessor.stride;
+
+	switch (accessor.component_type) {
+		case cgltf_component_type_r_8u:
+			for (size_t i = 0; i < count; i++)
+				out[i] = src[i * stride];
+
+			return true;
+		case cgltf_component_type_r_16u: {
+			size_t i = 0;
+#ifdef __SSE2__
+			if (stride == sizeof(uint16_t)) {
+				const __m128i zero = _mm_setzero_si128();
+				for (; i + 8 <= count; i += 8) {
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * sizeof(uint16_t)));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi16(v, zero));
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 4), _mm_unpackhi_epi16(v, zero));
+				}
+			}
+#endif
+			for (; i < count; i++) {
+				uint16_t index;
+				memcpy(&index, src + i * stride, sizeof(uint16_t));
+				out[i] = index;
+			}
+
+			return true;
+		}
+		case cgltf_component_type_r_32u:
+			if (stride == sizeof(uint32_t)) {
+				memcpy(out, src, count * sizeof(uint32_t));
+				return true;
+			}
+
+			for (size_t i = 0; i < count; i++)
+				memcpy(&out[i], src + i * stride, sizeof(uint32_t));
+
+			return true;
+		default:
+			return false;
+	}
+}
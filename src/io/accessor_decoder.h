@@ -0,0 +1,30 @@
+#ifndef ACCESSOR_DECODER_H
+#define ACCESSOR_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct cgltf_accessor;
+
+// Decodes glTF accessors of any layout: tightly packed or interleaved
+// (byte_stride), with accessor offsets, float or (normalized) integer
+// components and sparse substitution. Integer to float conversion runs
+// in SSE2 kernels where available, with a scalar fallback elsewhere.
+class AccessorDecoder {
+public:
+	// Writes min(outComponents, accessor components) floats per element, elements
+	// outStride bytes apart, so data can go straight into an interleaved vertex.
+	// Normalized integers follow the glTF rules, signed values clamp at -1.0.
+	// Returns false if the accessor data is missing or out of its buffer view bounds.
+	static bool floatsDecode(const cgltf_accessor &accessor, float *out, uint32_t outComponents, size_t outStride);
+
+	// Same output as floatsDecode built on per-element cgltf_accessor_read_float calls.
+	// Only meant as a reference for validation and benchmarks.
+	static bool floatsDecodeReference(
+			const cgltf_accessor &accessor, float *out, uint32_t outComponents, size_t outStride);
+
+	// Widens u8/u16/u32 indices into out, which must hold accessor.count elements.
+	static bool indicesDecode(const cgltf_accessor &accessor, uint32_t *out);
+};
+
+#endif // !ACCESSOR_DECODER_H
@@ -1,25 +1,103 @@
-#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <cgltf/cgltf.h>
 #include <stb/stb_image.h>
 
+#include <core/arena.h>
+#include <core/hash.h>
+#include <core/mapped_file.h>
+#include <core/memory_stats.h>
+#include <core/thread_pool.h>
+#include <core/timer.h>
+
+#include <io/types/hierarchy.h>
 #include <io/types/mesh.h>
+#include <io/types/scene.h>
 #include <io/types/vertex.h>
 
 #include <math/types/mat4.h>
-#include <math/types/vec3.h>
+#include <math/types/precision.h>
 
+#include "accessor_decoder.h"
 #include "gltf_loader.h"
+#include "ktx2_file.h"
+#include "mesh_bounds.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "mesh_welder.h"
+#include "meshlet_builder.h"
+#include "meshopt_decoder.h"
+#include "tangent_space.h"
+#include "texture_decoder.h"
+#include "transform_hierarchy.h"
+
+typedef struct {
+	std::mutex mutex;
+	std::vector<MappedFile> files;
+	uint64_t bytes;
+} FileMappings;
+
+// cgltf file callbacks backed by mmap. cgltf keeps the pointer we return as
+// file_data (and as the .glb binary chunk, or external .bin buffer data),
+// so accessors are decoded straight from the mapped pages.
+static cgltf_result _fileMapRead(const cgltf_memory_options *memoryOptions, const cgltf_file_options *fileOptions,
+		const char *path, cgltf_size *size, void **data) {
+	FileMappings *mappings = reinterpret_cast<FileMappings *>(fileOptions->user_data);
+
+	MappedFile file;
+	if (!fileMap(path, &file))
+		return cgltf_result_file_not_found;
+
+	cgltf_size requestedSize = (size != nullptr && *size != 0) ? *size : file.size;
+	if (requestedSize > file.size) {
+		fileUnmap(file);
+		return cgltf_result_data_too_short;
+	}
+
+	if (size != nullptr)
+		*size = requestedSize;
+
+	if (data != nullptr)
+		*data = file.data;
+
+	std::lock_guard<std::mutex> lock(mappings->mutex);
+	mappings->files.push_back(file);
+	mappings->bytes += file.size;
+
+	return cgltf_result_success;
+}
+
+static void _fileMapRelease(
+		const cgltf_memory_options *memoryOptions, const cgltf_file_options *fileOptions, void *data) {
+	FileMappings *mappings = reinterpret_cast<FileMappings *>(fileOptions->user_data);
+
+	std::lock_guard<std::mutex> lock(mappings->mutex);
+	for (size_t i = 0; i < mappings->files.size(); i++) {
+		if (mappings->files[i].data != data)
+			continue;
+
+		fileUnmap(mappings->files[i]);
+		mappings->files.erase(mappings->files.begin() + i);
+		return;
+	}
+}
 
 bool GLTFLoader::_checkAttributes(const cgltf_attribute *attributes, uint32_t attributeCount) {
 	const char *REQUIRED_ATTRIBUTES[] = {
 		"POSITION",
-		"NORMAL",
-		"TEXCOORD_0",
 	};
 
 	for (const char *requiredAttribute : REQUIRED_ATTRIBUTES) {
@@ -42,195 +120,1015 @@ bool GLTFLoader::_checkAttributes(const cgltf_attribute *attributes, uint32_t at
 }
 
 math::mat4 GLTFLoader::_extractTransform(const cgltf_node &node) {
-	if (node.has_matrix) {
-		math::mat4 matrix;
-		memcpy(&matrix, node.matrix, sizeof(float) * 16);
-		return matrix;
-	}
+	// either the matrix or translation * rotation * scale, column major like mat4
+	math::mat4 matrix;
+	cgltf_node_transform_local(&node, reinterpret_cast<float *>(&matrix));
+	return matrix;
+}
+
+Transform GLTFLoader::_nodeLoad(const cgltf_node &node) {
+	if (node.has_matrix)
+		return TransformHierarchy::transformDecompose(_extractTransform(node));
 
-	return math::mat4(1.0f);
+	// cgltf fills in the defaults for missing properties
+	Transform transform;
+	memcpy(transform.translation, node.translation, sizeof(transform.translation));
+	memcpy(transform.rotation, node.rotation, sizeof(transform.rotation));
+	memcpy(transform.scale, node.scale, sizeof(transform.scale));
+	return transform;
 }
 
-void GLTFLoader::_tangentsGenerate(const IndexArray &indices, VertexArray &vertices) {
-	assert(indices.count % 3 == 0);
+Hierarchy GLTFLoader::_hierarchyLoad(const cgltf_data &data, Arena &arena) {
+	// breadth first from the roots, so every level ends up contiguous
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> levelEnds;
+	order.reserve(data.nodes_count);
 
-	math::vec3 *tangents = (math::vec3 *)calloc(vertices.count, sizeof(math::vec3));
-	float *averages = (float *)calloc(vertices.count, sizeof(float));
+	for (uint64_t i = 0; i < data.nodes_count; i++) {
+		if (data.nodes[i].parent == nullptr)
+			order.push_back(i);
+	}
 
-	for (size_t i = 0; i < indices.count; i += 3) {
-		const Vertex &v0 = vertices.data[indices.data[i + 0]];
-		const Vertex &v1 = vertices.data[indices.data[i + 1]];
-		const Vertex &v2 = vertices.data[indices.data[i + 2]];
+	for (uint32_t begin = 0; begin < order.size();) {
+		uint32_t end = order.size();
+		levelEnds.push_back(end);
 
-		math::vec3 position0 = {
-			v1.position[0] - v0.position[0],
-			v1.position[1] - v0.position[1],
-			v1.position[2] - v0.position[2],
-		};
+		for (uint32_t i = begin; i < end; i++) {
+			const cgltf_node &node = data.nodes[order[i]];
+			for (uint64_t j = 0; j < node.children_count; j++)
+				order.push_back(cgltf_node_index(&data, node.children[j]));
+		}
 
-		math::vec3 position1 = {
-			v2.position[0] - v0.position[0],
-			v2.position[1] - v0.position[1],
-			v2.position[2] - v0.position[2],
-		};
+		begin = end;
+	}
 
-		float texCoord0X = v1.texCoord[0] - v0.texCoord[0];
-		float texCoord0Y = v1.texCoord[1] - v0.texCoord[1];
+	std::vector<uint32_t> flatIndices(data.nodes_count, NO_PARENT);
+	for (uint32_t i = 0; i < order.size(); i++)
+		flatIndices[order[i]] = i;
 
-		float texCoord1X = v2.texCoord[0] - v0.texCoord[0];
-		float texCoord1Y = v2.texCoord[1] - v0.texCoord[1];
+	Hierarchy hierarchy = TransformHierarchy::hierarchyAllocate(order.size(), levelEnds.size(), arena);
 
-		float r = 1.0 / (texCoord0X * texCoord1Y - texCoord0Y * texCoord1X);
-		math::vec3 tangent = ((position0 * texCoord1Y) - (position1 * texCoord0Y)) * r;
+	hierarchy.levelOffsets[0] = 0;
+	memcpy(hierarchy.levelOffsets + 1, levelEnds.data(), levelEnds.size() * sizeof(uint32_t));
 
-		tangents[indices.data[i + 0]] += tangent;
-		tangents[indices.data[i + 1]] += tangent;
-		tangents[indices.data[i + 2]] += tangent;
+	for (uint32_t i = 0; i < order.size(); i++) {
+		const cgltf_node &node = data.nodes[order[i]];
 
-		averages[indices.data[i + 0]] += 1.0;
-		averages[indices.data[i + 1]] += 1.0;
-		averages[indices.data[i + 2]] += 1.0;
+		hierarchy.parents[i] = node.parent != nullptr ? flatIndices[cgltf_node_index(&data, node.parent)] : NO_PARENT;
+		hierarchy.meshIndices[i] = node.mesh != nullptr ? cgltf_mesh_index(&data, node.mesh) : NO_MESH;
+		hierarchy.locals[i] = _nodeLoad(node);
 	}
 
+	TransformHierarchy::dirtyAll(hierarchy);
+	return hierarchy;
+}
+
+uint64_t GLTFLoader::_cacheKey(const char *path, const LoadOptions &options, bool *valid) {
+	uint64_t hash = 0;
+	*valid = fileHash(path, &hash);
+
+	// options changing the baked output get their own entry
+	uint32_t settings[5] = {};
+	settings[0] = (options.optimizeMeshes ? 1 : 0) | (options.buildMeshlets ? 2 : 0) | (options.loadTextures ? 4 : 0) |
+			(options.weldVertices ? 8 : 0) | (options.orientedBounds ? 16 : 0);
+	settings[1] = options.lodCount;
+	memcpy(&settings[2], &options.lodReduction, sizeof(float));
+	settings[3] = options.mipFilter;
+	settings[4] = options.normalWeighting;
+	hash = hash64(settings, sizeof(settings), hash);
+
+	// External .bin files are only covered through their uri in the source file,
+	// rebuild the cache after editing them in place.
+	return hash;
+}
+
+// Largest distance between the exporter's min/max and the computed AABB, relative to its largest extent.
+const float BOUNDS_TOLERANCE = 1e-4f;
+
+static void _normalsNormalize(VertexArray &vertices) {
 	for (uint32_t i = 0; i < vertices.count; i++) {
-		float denom = 1.0 / averages[i];
-		math::vec3 tangent = tangents[i] * denom;
-		memcpy(vertices.data[i].tangent, &tangent, sizeof(tangent));
+		float *normal = vertices.data[i].normal;
+		float lengthSquared = normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2];
+		if (lengthSquared < FLT_MIN)
+			continue;
+
+		float scale = math::rsqrt(lengthSquared);
+		normal[0] *= scale;
+		normal[1] *= scale;
+		normal[2] *= scale;
 	}
 }
 
-Mesh GLTFLoader::_meshLoad(const cgltf_mesh &mesh) {
-	Mesh _mesh = {};
-	_mesh.primitiveCount = mesh.primitives_count;
-	_mesh.primitives = (Primitive *)calloc(mesh.primitives_count, sizeof(Primitive));
+bool GLTFLoader::_primitiveLoad(const cgltf_primitive &primitive, const LoadOptions &options, Arena &arena,
+		Primitive &out, LoadStats &stats) {
+	if (primitive.type != cgltf_primitive_type_triangles)
+		return false;
 
-	for (uint64_t i = 0; i < mesh.primitives_count; i++) {
-		const cgltf_primitive &primitive = mesh.primitives[i];
+	if (!_checkAttributes(primitive.attributes, primitive.attributes_count))
+		return false;
 
-		if (!_checkAttributes(primitive.attributes, primitive.attributes_count)) {
-			fprintf(stderr, "Mesh: %s, primitive: %ld is missing required attributes!\n", mesh.name, i);
-			continue;
-		}
+	Timer timer;
 
-		IndexArray indices = {};
-		indices.data = new uint32_t[primitive.indices->count];
+	IndexArray indices = {};
+	if (primitive.indices != nullptr) {
+		indices.data = arena.arrayAllocate<uint32_t>(primitive.indices->count);
 		indices.count = primitive.indices->count;
 
-		uint64_t offset = primitive.indices->buffer_view->offset;
-		uint8_t *buffer = reinterpret_cast<uint8_t *>(primitive.indices->buffer_view->buffer->data);
+		if (!AccessorDecoder::indicesDecode(*primitive.indices, indices.data))
+			return false;
+	}
 
-		switch (primitive.indices->component_type) {
-			case cgltf_component_type_r_16u:
-				for (uint32_t idx = 0; idx < indices.count; idx++) {
-					uint16_t element;
-					memcpy(&element, &buffer[offset + (idx * sizeof(uint16_t))], sizeof(uint16_t));
-					indices.data[idx] = element;
-				}
+	stats.indexTime += timer.elapsed();
+	timer.reset();
+
+	VertexArray vertices = {};
+	vertices.data = nullptr;
+	vertices.count = 0;
+
+	// the exporter's min/max, only used to validate the AABB computed from the positions
+	AABB storedAABB = {};
+	bool hasBounds = false;
+
+	for (uint64_t attributeIndex = 0; attributeIndex < primitive.attributes_count; attributeIndex++) {
+		if (strcmp("POSITION", primitive.attributes[attributeIndex].name) != 0)
+			continue;
+
+		const cgltf_accessor *positionAccessor = primitive.attributes[attributeIndex].data;
+
+		// zeroed, attributes missing from the file stay 0
+		vertices.data = arena.arrayAllocate<Vertex>(positionAccessor->count, true);
+		vertices.count = positionAccessor->count;
+
+		// exporters disagree on whether normalized min/max are in integer or normalized units
+		hasBounds = positionAccessor->has_min && positionAccessor->has_max && !positionAccessor->normalized;
+		if (!hasBounds)
+			continue;
+
+		const float *min = positionAccessor->min;
+		const float *max = positionAccessor->max;
+
+		storedAABB.x = min[0];
+		storedAABB.y = min[1];
+		storedAABB.z = min[2];
+
+		storedAABB.w = max[0] - min[0];
+		storedAABB.h = max[1] - min[1];
+		storedAABB.d = max[2] - min[2];
+	}
+
+	bool hasNormals = false;
+	bool hasTangents = false;
+
+	// KHR_mesh_quantization attributes are widened to the float Vertex like any other and stay float in the scene
+	// and the mesh cache. Nothing packs them back for upload, VertexQuantizer::verticesQuantize is up to the caller.
+	for (uint64_t attributeIndex = 0; attributeIndex < primitive.attributes_count; attributeIndex++) {
+		const cgltf_attribute &attribute = primitive.attributes[attributeIndex];
+		const cgltf_accessor &accessor = *attribute.data;
+
+		// only the first texture coordinate set ends up in Vertex, further sets and other attributes are ignored
+		bool used = attribute.type == cgltf_attribute_type_position || attribute.type == cgltf_attribute_type_normal ||
+				attribute.type == cgltf_attribute_type_tangent ||
+				(attribute.type == cgltf_attribute_type_texcoord && attribute.index == 0);
+		if (!used)
+			continue;
+
+		// the vertices it does not cover would load as zeros
+		if (accessor.count != vertices.count)
+			return false;
+
+		bool decoded = true;
+		switch (attribute.type) {
+			case cgltf_attribute_type_position:
+				decoded = AccessorDecoder::floatsDecode(accessor, vertices.data[0].position, 3, sizeof(Vertex));
+				break;
+			case cgltf_attribute_type_normal:
+				decoded = AccessorDecoder::floatsDecode(accessor, vertices.data[0].normal, 3, sizeof(Vertex));
+				hasNormals = decoded;
+
+				// KHR_mesh_quantization snorm8/16 normals are only unit length up to their precision
+				if (decoded && accessor.component_type != cgltf_component_type_r_32f)
+					_normalsNormalize(vertices);
+				break;
+			case cgltf_attribute_type_tangent:
+				decoded = AccessorDecoder::floatsDecode(accessor, vertices.data[0].tangent, 4, sizeof(Vertex));
+				hasTangents = decoded && cgltf_num_components(accessor.type) == 4;
 				break;
-			case cgltf_component_type_r_32u:
-				memcpy(indices.data, &buffer[offset], indices.count * sizeof(uint32_t));
+			case cgltf_attribute_type_texcoord:
+				decoded = AccessorDecoder::floatsDecode(accessor, vertices.data[0].texCoord, 2, sizeof(Vertex));
 				break;
 			default:
 				break;
 		}
 
-		VertexArray vertices = {};
-		vertices.data = nullptr;
-		vertices.count = 0;
+		// missing normals and tangents are generated, texture coordinates stay zero, positions cannot be replaced
+		if (!decoded && attribute.type == cgltf_attribute_type_position)
+			return false;
 
-		AABB aabb = {};
+		if (!decoded)
+			fprintf(stderr, "Attribute: %s could not be decoded!\n", attribute.name);
+	}
 
-		for (uint64_t attributeIndex = 0; attributeIndex < primitive.attributes_count; attributeIndex++) {
-			if (strcmp("POSITION", primitive.attributes[attributeIndex].name) != 0)
-				continue;
+	stats.attributeTime += timer.elapsed();
+	timer.reset();
+
+	AABB aabb = MeshBounds::aabbCompute(vertices);
+	if (options.validateBounds && hasBounds && !MeshBounds::aabbMatches(storedAABB, aabb, BOUNDS_TOLERANCE))
+		stats.boundsMismatchCount++;
+
+	stats.boundsTime += timer.elapsed();
+	timer.reset();
 
-			const cgltf_accessor *positionAccessor = primitive.attributes[attributeIndex].data;
+	// non-indexed primitives get one index per vertex, welding then shares the duplicates
+	bool weld = options.weldVertices;
+	if (primitive.indices == nullptr) {
+		indices = MeshWelder::indicesGenerate(vertices.count, arena);
+		weld = true;
+	}
 
-			vertices.data = new Vertex[positionAccessor->count];
-			vertices.count = positionAccessor->count;
+	// the arrays stay in the arena until the scene is freed
+	if (indices.count % 3 != 0)
+		return false;
 
-			// INFO: required in specification, probably check if valid anyway.
-			// Always float (same as POSITION attribute).
-			const float *min = positionAccessor->min;
-			const float *max = positionAccessor->max;
+	for (uint32_t i = 0; i < indices.count; i++) {
+		if (indices.data[i] >= vertices.count)
+			return false;
+	}
 
-			aabb.x = min[0];
-			aabb.y = min[1];
-			aabb.z = min[2];
+	if (weld) {
+		stats.weldedVertexCount += MeshWelder::verticesWeld(indices, vertices);
 
-			aabb.w = max[0] - min[0];
-			aabb.h = max[1] - min[1];
-			aabb.d = max[2] - min[2];
-		}
+		stats.weldTime += timer.elapsed();
+		timer.reset();
+	}
 
-		for (uint64_t attributeIndex = 0; attributeIndex < primitive.attributes_count; attributeIndex++) {
-			const cgltf_attribute *attribute = &primitive.attributes[attributeIndex];
+	// after welding, so vertices split only by the missing normals are shared again
+	if (!hasNormals) {
+		TangentSpace::normalsGenerate(indices, vertices, options.normalWeighting);
 
-			if (attribute == nullptr)
-				continue;
+		stats.normalTime += timer.elapsed();
+		timer.reset();
+	}
 
-			const cgltf_accessor *accessor = attribute->data;
-			const cgltf_buffer_view *bufferView = accessor->buffer_view;
+	if (options.optimizeMeshes) {
+		stats.transformsBefore += MeshOptimizer::vertexCacheAnalyze(indices, vertices.count).transforms;
 
-			if (bufferView->buffer->data == nullptr)
-				continue;
+		MeshOptimizer::vertexCacheOptimize(indices, vertices.count);
+		MeshOptimizer::overdrawOptimize(indices, vertices, aabb);
+		MeshOptimizer::vertexFetchOptimize(indices, vertices);
+
+		stats.transformsAfter += MeshOptimizer::vertexCacheAnalyze(indices, vertices.count).transforms;
 
-			const uint64_t begin = bufferView->offset;
-			const uint64_t size = bufferView->size;
-
-			const uint8_t *buffer = reinterpret_cast<uint8_t *>(bufferView->buffer->data);
-
-			uint32_t vertexIdx = 0;
-			switch (primitive.attributes[attributeIndex].type) {
-				case cgltf_attribute_type_position:
-					for (uint64_t offset = begin; offset < begin + size; offset += sizeof(float) * 3) {
-						memcpy(vertices.data[vertexIdx].position, &buffer[offset], sizeof(float) * 3);
-						vertexIdx++;
-					}
-
-					break;
-				case cgltf_attribute_type_normal:
-					for (uint64_t offset = begin; offset < begin + size; offset += sizeof(float) * 3) {
-						memcpy(vertices.data[vertexIdx].normal, &buffer[offset], sizeof(float) * 3);
-						vertexIdx++;
-					}
-
-					break;
-				case cgltf_attribute_type_texcoord:
-					// TODO: Handle other component types from specification
-					for (uint64_t offset = begin; offset < begin + size; offset += sizeof(float) * 2) {
-						memcpy(vertices.data[vertexIdx].texCoord, &buffer[offset], sizeof(float) * 2);
-						vertexIdx++;
-					}
-
-					break;
-				default:
+		stats.optimizeTime += timer.elapsed();
+		timer.reset();
+	}
+
+	MeshletArray meshlets = {};
+	if (options.buildMeshlets) {
+		meshlets = MeshletBuilder::meshletsBuild(indices, vertices, arena);
+
+		stats.meshletTime += timer.elapsed();
+		timer.reset();
+	}
+
+	LodArray lods = {};
+	if (options.lodCount > 0) {
+		lods = MeshSimplifier::lodsBuild(indices, vertices, arena, options.lodCount, options.lodReduction);
+
+		for (uint32_t i = 0; i < lods.count && options.optimizeMeshes; i++)
+			MeshOptimizer::vertexCacheOptimize(lods.data[i].indices, vertices.count);
+
+		for (uint32_t i = 0; i < lods.count; i++)
+			stats.lodTriangleCount += lods.data[i].indices.count / 3;
+
+		stats.lodTime += timer.elapsed();
+		timer.reset();
+	}
+
+	// supplied tangents are authoritative, generated ones would not match the baked normal maps
+	if (!hasTangents)
+		TangentSpace::tangentsGenerate(indices, vertices);
+
+	stats.tangentTime += timer.elapsed();
+	timer.reset();
+
+	BoundingSphere sphere = MeshBounds::sphereCompute(vertices, aabb);
+	OrientedBox box =
+			options.orientedBounds ? MeshBounds::orientedBoxCompute(vertices, aabb) : MeshBounds::aabbBox(aabb);
+
+	stats.boundsTime += timer.elapsed();
+
+	out.aabb = aabb;
+	out.sphere = sphere;
+	out.box = box;
+	out.indices = indices;
+	out.vertices = vertices;
+	out.meshlets = meshlets;
+	out.lods = lods;
+
+	stats.vertexCount += vertices.count;
+	stats.meshletCount += meshlets.count;
+	stats.lodCount += lods.count;
+	stats.triangleCount += indices.count / 3;
+	return true;
+}
+
+void GLTFLoader::statsPrint(const LoadStats &stats) {
+	printf("Loaded %u meshes, %u primitives, %lu vertices, %lu triangles on %u threads\n", stats.meshCount,
+			stats.primitiveCount, stats.vertexCount, stats.triangleCount, stats.threadCount);
+	printf("  parse:      %10.3f ms\n", stats.parseTime);
+	printf("  buffers:    %10.3f ms\n", stats.bufferTime);
+	printf("  meshopt:    %10.3f ms, %.3f MB decoded\n", stats.meshoptTime, stats.meshoptBytes / (1024.0 * 1024.0));
+	printf("  hierarchy:  %10.3f ms, %u nodes in %u levels\n", stats.hierarchyTime, stats.nodeCount, stats.levelCount);
+	printf("  meshes:     %10.3f ms\n", stats.meshTime);
+	printf("    indices:    %10.3f ms (cpu)\n", stats.indexTime);
+	printf("    attributes: %10.3f ms (cpu)\n", stats.attributeTime);
+	printf("    weld:       %10.3f ms (cpu), %lu vertices removed\n", stats.weldTime, stats.weldedVertexCount);
+	printf("    normals:    %10.3f ms (cpu)\n", stats.normalTime);
+	printf("    tangents:   %10.3f ms (cpu)\n", stats.tangentTime);
+	printf("    bounds:     %10.3f ms (cpu), %u stored AABBs off\n", stats.boundsTime, stats.boundsMismatchCount);
+	printf("    optimize:   %10.3f ms (cpu)\n", stats.optimizeTime);
+	printf("    meshlets:   %10.3f ms (cpu), %lu meshlets\n", stats.meshletTime, stats.meshletCount);
+	printf("    lods:       %10.3f ms (cpu), %lu levels, %lu triangles\n", stats.lodTime, stats.lodCount,
+			stats.lodTriangleCount);
+	printf("  textures:   %10.3f ms, %u textures, %.3f MB with mips\n", stats.textureTime, stats.textureCount,
+			stats.textureBytes / (1024.0 * 1024.0));
+	printf("    mips:       %10.3f ms (cpu)\n", stats.mipTime);
+
+	for (uint32_t i = 0; i < IMAGE_FORMAT_COUNT; i++) {
+		const DecodeStats &decode = stats.decodeStats[i];
+		if (decode.imageCount == 0)
+			continue;
+
+		printf("    %-5s       %10.3f ms (cpu), %u images, %.1f MB/s, %.1f Mpixel/s\n",
+				TextureDecoder::formatName((ImageFormat)i), decode.decodeTime, decode.imageCount,
+				decode.encodedBytes / (1024.0 * 1024.0) / (decode.decodeTime / 1e3),
+				decode.pixelCount / 1e6 / (decode.decodeTime / 1e3));
+	}
+
+	printf("  cache:      %10.3f ms (%s)\n", stats.cacheTime, stats.cacheHit ? "hit" : "miss");
+	printf("  total:      %10.3f ms\n", stats.totalTime);
+	printf("  files:      %10.3f MB (%s)\n", stats.fileBytes / (1024.0 * 1024.0),
+			stats.mapped ? "mapped, no heap copy" : "read to heap");
+	printf("  heap rss:   %10.3f MB growth, process peak rss: %.3f MB\n", stats.rssGrowth / (1024.0 * 1024.0),
+			stats.rssPeak / (1024.0 * 1024.0));
+	printf("  arena:      %10.3f MB in %lu allocations, %lu blocks, %.3f MB reserved\n",
+			stats.arenaBytes / (1024.0 * 1024.0), stats.arenaAllocations, stats.arenaBlocks,
+			stats.arenaReserved / (1024.0 * 1024.0));
+
+	if (stats.transformsBefore > 0 && stats.triangleCount > 0) {
+		printf("  acmr:       %10.3f -> %.3f (cache size %u)\n", (double)stats.transformsBefore / stats.triangleCount,
+				(double)stats.transformsAfter / stats.triangleCount, VERTEX_CACHE_SIZE);
+		printf("  atvr:       %10.3f -> %.3f\n", (double)stats.transformsBefore / stats.vertexCount,
+				(double)stats.transformsAfter / stats.vertexCount);
+	}
+}
+
+struct LoadJob {
+	std::string path;
+	LoadOptions options;
+
+	Scene scene = {};
+	LoadStats stats = {};
+
+	std::thread thread;
+	std::atomic<bool> cancelled;
+	std::atomic<bool> skipped; // a primitive or texture was left out because of the cancel
+
+	// guards everything below
+	std::mutex mutex;
+	LoadProgress progress = {};
+	std::vector<uint32_t> primitivesLeft;
+	std::vector<uint32_t> finishedMeshes;
+
+	LoadJob(const char *path, const LoadOptions &options)
+		: path(path), options(options), cancelled(false), skipped(false) {}
+};
+
+static void _arenaStats(const Arena &arena, LoadStats &stats) {
+	stats.arenaBytes = arena.bytesUsed();
+	stats.arenaReserved = arena.bytesReserved();
+	stats.arenaAllocations = arena.allocationCount();
+	stats.arenaBlocks = arena.blockCount();
+}
+
+static void _statusSet(LoadJob &job, LoadStatus status) {
+	std::lock_guard<std::mutex> lock(job.mutex);
+	job.progress.status = status;
+}
+
+void GLTFLoader::_meshDistances(
+		const cgltf_data &data, const Hierarchy &hierarchy, const float *position, float *distances) {
+	for (uint64_t i = 0; i < data.meshes_count; i++)
+		distances[i] = FLT_MAX;
+
+	for (uint32_t i = 0; i < hierarchy.count; i++) {
+		if (hierarchy.meshIndices[i] == NO_MESH)
+			continue;
+
+		const cgltf_mesh &mesh = data.meshes[hierarchy.meshIndices[i]];
+		const float *world = reinterpret_cast<const float *>(&hierarchy.worlds[i]);
+
+		// bounds grow with the largest axis scale, rotation keeps the length
+		float scale = 0.0f;
+		for (int column = 0; column < 3; column++) {
+			const float *axis = &world[column * 4];
+			scale = std::max(scale, std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]));
+		}
+
+		float &distance = distances[hierarchy.meshIndices[i]];
+
+		for (uint64_t j = 0; j < mesh.primitives_count; j++) {
+			const cgltf_primitive &primitive = mesh.primitives[j];
+
+			for (uint64_t k = 0; k < primitive.attributes_count; k++) {
+				const cgltf_accessor *accessor = primitive.attributes[k].data;
+				if (primitive.attributes[k].type != cgltf_attribute_type_position || !accessor->has_min ||
+						!accessor->has_max)
 					continue;
+
+				float center[3], radius = 0.0f;
+				for (int c = 0; c < 3; c++) {
+					center[c] = (accessor->min[c] + accessor->max[c]) * 0.5f;
+					radius += (accessor->max[c] - center[c]) * (accessor->max[c] - center[c]);
+				}
+
+				float d = 0.0f;
+				for (int r = 0; r < 3; r++) {
+					float p = world[r] * center[0] + world[4 + r] * center[1] + world[8 + r] * center[2] +
+							world[12 + r];
+					d += (p - position[r]) * (p - position[r]);
+				}
+
+				// distance to the bounding sphere, zero when the camera is inside
+				distance = std::min(distance, std::max(std::sqrt(d) - std::sqrt(radius) * scale, 0.0f));
 			}
 		}
+	}
+}
+
+// Mesh bounds from their primitives, then the world bounds of every node.
+// Mesh bounds are computed as meshes finish, before they are handed out.
+static void _worldBoundsCompute(Scene &scene, ThreadPool *pool) {
+	scene.worldAABBs = scene.arena->arrayAllocate<AABB>(scene.hierarchy.count);
+	scene.worldSpheres = scene.arena->arrayAllocate<BoundingSphere>(scene.hierarchy.count);
+	MeshBounds::worldBoundsUpdate(scene.hierarchy, scene.meshes, scene.worldAABBs, scene.worldSpheres, pool);
+}
+
+// Encoded bytes of an image: a buffer view, a data URI (decoded into *owned, release with free)
+// or a file next to the glTF (mapped into *file).
+static const uint8_t *_imageBytes(
+		const cgltf_image &image, const char *path, MappedFile *file, void **owned, size_t *size) {
+	if (image.buffer_view != nullptr) {
+		*size = image.buffer_view->size;
+		return cgltf_buffer_view_data(image.buffer_view);
+	}
+
+	if (image.uri == nullptr)
+		return nullptr;
+
+	if (strncmp(image.uri, "data:", 5) == 0) {
+		const char *comma = strchr(image.uri, ',');
+		if (comma == nullptr || comma - image.uri < 7 || strncmp(comma - 7, ";base64", 7) != 0)
+			return nullptr;
+
+		// 4 base64 characters per 3 bytes, padding included
+		const char *base64 = comma + 1;
+		size_t length = strlen(base64);
+		size_t padding = (length > 0 && base64[length - 1] == '=') + (length > 1 && base64[length - 2] == '=');
+
+		cgltf_options options = {};
+		*size = length / 4 * 3 - padding;
+		if (cgltf_load_buffer_base64(&options, *size, base64, owned) != cgltf_result_success)
+			return nullptr;
+
+		return reinterpret_cast<const uint8_t *>(*owned);
+	}
+
+	if (strstr(image.uri, "://") != nullptr)
+		return nullptr;
+
+	std::string uri(image.uri);
+	uri.resize(cgltf_decode_uri(&uri[0]));
+
+	std::string imagePath(path);
+	size_t slash = imagePath.find_last_of("/\\");
+	imagePath.resize(slash == std::string::npos ? 0 : slash + 1);
+	imagePath += uri;
+
+	if (!fileMap(imagePath.c_str(), file))
+		return nullptr;
+
+	*size = file->size;
+	return reinterpret_cast<const uint8_t *>(file->data);
+}
+
+// Material slots holding color data, their images are filtered in linear space.
+static std::vector<bool> _imagesSrgb(const cgltf_data &data) {
+	std::vector<bool> srgb(data.images_count, false);
+
+	auto mark = [&](const cgltf_texture_view &view) {
+		if (view.texture != nullptr && view.texture->image != nullptr)
+			srgb[cgltf_image_index(&data, view.texture->image)] = true;
+	};
+
+	for (size_t i = 0; i < data.materials_count; i++) {
+		const cgltf_material &material = data.materials[i];
+
+		mark(material.pbr_metallic_roughness.base_color_texture);
+		mark(material.pbr_specular_glossiness.diffuse_texture);
+		mark(material.pbr_specular_glossiness.specular_glossiness_texture);
+		mark(material.emissive_texture);
+	}
 
-		_tangentsGenerate(indices, vertices);
+	return srgb;
+}
+
+// Decodes every EXT_meshopt_compression buffer view on the pool. cgltf_buffer_view_data
+// returns the decoded data from then on, so accessors need no special handling, and
+// cgltf_free releases it. Fails if any view does not decode.
+bool GLTFLoader::_bufferViewsDecode(cgltf_data &data, ThreadPool &pool, uint64_t *bytes) {
+	std::vector<cgltf_buffer_view *> views;
+	for (uint64_t i = 0; i < data.buffer_views_count; i++) {
+		if (data.buffer_views[i].has_meshopt_compression)
+			views.push_back(&data.buffer_views[i]);
+	}
+
+	*bytes = 0;
+	for (cgltf_buffer_view *view : views) {
+		const cgltf_meshopt_compression &compression = view->meshopt_compression;
+		if (compression.count * compression.stride != view->size)
+			return false;
+
+		// freed by cgltf_free through the default memory callbacks
+		view->data = malloc(view->size);
+		if (view->data == nullptr)
+			return false;
 
-		_mesh.primitives[i].aabb = aabb;
-		_mesh.primitives[i].indices = indices;
-		_mesh.primitives[i].vertices = vertices;
+		*bytes += view->size;
 	}
 
-	return _mesh;
+	std::atomic<bool> valid(true);
+	pool.parallelFor(views.size(), [&](uint32_t i) {
+		if (!MeshoptDecoder::bufferViewDecode(views[i]->meshopt_compression, static_cast<uint8_t *>(views[i]->data)))
+			valid = false;
+	});
+
+	return valid;
 }
 
-void GLTFLoader::loadFile(const char *path) {
-	cgltf_options options = {};
+void GLTFLoader::_texturesLoad(const cgltf_data &data, LoadJob &job, ThreadPool &pool) {
+	Scene &scene = job.scene;
+	LoadStats &_stats = job.stats;
+
+	scene.textureCount = data.images_count;
+	scene.textures = scene.arena->arrayAllocate<Texture>(scene.textureCount, true);
+
+	{
+		std::lock_guard<std::mutex> lock(job.mutex);
+		job.progress.textureCount = scene.textureCount;
+	}
+
+	std::vector<bool> srgb = _imagesSrgb(data);
+
+	typedef struct {
+		DecodeStats decodeStats[IMAGE_FORMAT_COUNT];
+		double mipTime;
+	} TextureStats;
+
+	std::vector<TextureStats> taskStats(scene.textureCount, TextureStats());
+	std::vector<Arena> taskArenas(scene.textureCount);
+
+	// one image per task, decode dominates and images are large enough to balance on their own
+	pool.parallelFor(scene.textureCount, [&](uint32_t imageIndex) {
+		if (job.cancelled) {
+			job.skipped = true;
+			return;
+		}
+
+		const cgltf_image &image = data.images[imageIndex];
+
+		MappedFile file = {};
+		void *owned = nullptr;
+		size_t size = 0;
+
+		const uint8_t *bytes = _imageBytes(image, job.path.c_str(), &file, &owned, &size);
+		if (bytes == nullptr) {
+			fprintf(stderr, "Image: %s, %u could not be read!\n", image.name, imageIndex);
+		} else {
+			ImageFormat format = TextureDecoder::formatDetect(bytes, size);
+			DecodeStats &decode = taskStats[imageIndex].decodeStats[format];
+			Texture &texture = scene.textures[imageIndex];
+
+			Timer timer;
+			uint32_t width = 0, height = 0;
+			uint8_t *pixels = nullptr;
+
+			// KTX2 chains are block compressed already and go to the GPU as they are
+			bool decoded;
+			if (format == IMAGE_FORMAT_KTX2) {
+				decoded = KTX2File::textureRead(bytes, size, taskArenas[imageIndex], &texture);
+				width = texture.width;
+				height = texture.height;
+			} else {
+				pixels = TextureDecoder::pixelsDecode(bytes, size, &width, &height);
+				decoded = pixels != nullptr;
+			}
+
+			decode.decodeTime = timer.elapsed();
+
+			if (!decoded) {
+				fprintf(stderr, "Image: %s, %u could not be decoded!\n", image.name, imageIndex);
+			} else {
+				decode.imageCount = 1;
+				decode.encodedBytes = size;
+				decode.pixelCount = (uint64_t)width * height;
+			}
+
+			if (pixels != nullptr) {
+				timer.reset();
+				texture = TextureDecoder::textureCreate(
+						pixels, width, height, srgb[imageIndex], job.options.mipFilter, taskArenas[imageIndex]);
+				taskStats[imageIndex].mipTime = timer.elapsed();
+
+				TextureDecoder::pixelsFree(pixels);
+			}
+		}
+
+		free(owned);
+		if (file.data != nullptr)
+			fileUnmap(file);
+
+		std::lock_guard<std::mutex> lock(job.mutex);
+		job.progress.texturesLoaded++;
+	});
+
+	for (Arena &taskArena : taskArenas)
+		scene.arena->splice(taskArena);
+
+	_stats.textureCount = scene.textureCount;
+	for (uint32_t i = 0; i < scene.textureCount; i++) {
+		_stats.textureBytes += scene.textures[i].size;
+		_stats.mipTime += taskStats[i].mipTime;
+
+		for (uint32_t j = 0; j < IMAGE_FORMAT_COUNT; j++) {
+			const DecodeStats &decode = taskStats[i].decodeStats[j];
+			_stats.decodeStats[j].imageCount += decode.imageCount;
+			_stats.decodeStats[j].encodedBytes += decode.encodedBytes;
+			_stats.decodeStats[j].pixelCount += decode.pixelCount;
+			_stats.decodeStats[j].decodeTime += decode.decodeTime;
+		}
+	}
+}
+
+void GLTFLoader::_loadRun(LoadJob &job) {
+	const char *path = job.path.c_str();
+	const LoadOptions &options = job.options;
+
+	Scene &scene = job.scene;
+	LoadStats &_stats = job.stats;
+
+	Timer totalTimer;
+	Timer timer;
+
+	const uint64_t rssStart = memoryRssAnonymous();
+	uint64_t rssMax = rssStart;
+
+	bool useCache = options.cacheDirectory != nullptr;
+	uint64_t cacheKey = 0;
+	char cachePath[4096];
+
+	if (useCache) {
+		cacheKey = _cacheKey(path, options, &useCache);
+		MeshCache::pathGet(options.cacheDirectory, cacheKey, cachePath, sizeof(cachePath));
+	}
+
+	if (useCache && !options.cacheRebuild && MeshCache::sceneRead(cachePath, cacheKey, &scene)) {
+		for (uint32_t i = 0; i < scene.meshCount; i++)
+			MeshBounds::meshBoundsCompute(scene.meshes[i]);
+
+		_worldBoundsCompute(scene, nullptr);
+
+		_stats.cacheHit = true;
+		_stats.cacheTime = timer.elapsed();
+		_stats.totalTime = totalTimer.elapsed();
+
+		_stats.meshCount = scene.meshCount;
+		_stats.nodeCount = scene.hierarchy.count;
+		_stats.levelCount = scene.hierarchy.levelCount;
+
+		for (uint32_t i = 0; i < scene.meshCount; i++) {
+			const Mesh &mesh = scene.meshes[i];
+			_stats.primitiveCount += mesh.primitiveCount;
+
+			for (uint32_t j = 0; j < mesh.primitiveCount; j++) {
+				_stats.vertexCount += mesh.primitives[j].vertices.count;
+				_stats.triangleCount += mesh.primitives[j].indices.count / 3;
+				_stats.meshletCount += mesh.primitives[j].meshlets.count;
+				_stats.lodCount += mesh.primitives[j].lods.count;
+
+				for (uint32_t k = 0; k < mesh.primitives[j].lods.count; k++)
+					_stats.lodTriangleCount += mesh.primitives[j].lods.data[k].indices.count / 3;
+			}
+		}
+
+		_stats.textureCount = scene.textureCount;
+		for (uint32_t i = 0; i < scene.textureCount; i++)
+			_stats.textureBytes += scene.textures[i].size;
+
+		_stats.rssGrowth = std::max(memoryRssAnonymous(), rssStart) - rssStart;
+		_stats.rssPeak = memoryRssPeak();
+		_arenaStats(*scene.arena, _stats);
+
+		// everything arrives at once
+		std::lock_guard<std::mutex> lock(job.mutex);
+		for (uint32_t i = 0; i < scene.meshCount; i++)
+			job.finishedMeshes.push_back(i);
+
+		job.progress.meshCount = job.progress.meshesLoaded = scene.meshCount;
+		job.progress.primitiveCount = job.progress.primitivesLoaded = _stats.primitiveCount;
+		job.progress.textureCount = job.progress.texturesLoaded = scene.textureCount;
+		job.progress.status = LOAD_STATUS_FINISHED;
+		return;
+	}
+
+	_stats.cacheTime = timer.elapsed();
+	timer.reset();
+
+	FileMappings mappings;
+	mappings.bytes = 0;
+
+	cgltf_options cgltfOptions = {};
+	if (options.mapFiles) {
+		cgltfOptions.file.read = _fileMapRead;
+		cgltfOptions.file.release = _fileMapRelease;
+		cgltfOptions.file.user_data = &mappings;
+	}
+
 	cgltf_data *data = NULL;
 
-	if (cgltf_parse_file(&options, path, &data) != cgltf_result_success)
+	if (cgltf_parse_file(&cgltfOptions, path, &data) != cgltf_result_success) {
+		_statusSet(job, LOAD_STATUS_FAILED);
+		return;
+	}
+
+	_stats.parseTime = timer.elapsed();
+	timer.reset();
+
+	if (cgltf_load_buffers(&cgltfOptions, data, path) != cgltf_result_success) {
+		cgltf_free(data);
+		_statusSet(job, LOAD_STATUS_FAILED);
 		return;
+	}
+
+	_stats.bufferTime = timer.elapsed();
+	timer.reset();
+
+	rssMax = std::max(rssMax, memoryRssAnonymous());
+
+	if (options.mapFiles) {
+		_stats.fileBytes = mappings.bytes;
+	} else {
+		_stats.fileBytes = data->json_size + data->bin_size;
+		for (uint64_t i = 0; i < data->buffers_count; i++) {
+			if (data->buffers[i].data_free_method == cgltf_data_free_method_file_release)
+				_stats.fileBytes += data->buffers[i].size;
+		}
+	}
+
+	ThreadPool pool(options.threadCount);
 
-	if (cgltf_load_buffers(&options, data, path) != cgltf_result_success)
+	if (!_bufferViewsDecode(*data, pool, &_stats.meshoptBytes)) {
+		fprintf(stderr, "%s: EXT_meshopt_compression data could not be decoded!\n", path);
+		cgltf_free(data);
+		_statusSet(job, LOAD_STATUS_FAILED);
 		return;
+	}
+
+	_stats.meshoptTime = timer.elapsed();
+	timer.reset();
+
+	scene.arena = new Arena();
+	scene.hierarchy = _hierarchyLoad(*data, *scene.arena);
+	TransformHierarchy::worldsUpdate(scene.hierarchy, &pool);
+
+	_stats.hierarchyTime = timer.elapsed();
+	timer.reset();
+
+	scene.meshCount = data->meshes_count;
+	scene.meshes = scene.arena->arrayAllocate<Mesh>(data->meshes_count, true);
+
+	// Every primitive of every mesh becomes one task, so a single huge mesh
+	// does not serialize the import. Results go to fixed slots, which keeps the
+	// output in file order regardless of scheduling.
+	typedef struct {
+		uint32_t meshIndex;
+		uint32_t primitiveIndex;
+	} PrimitiveTask;
+
+	std::vector<PrimitiveTask> tasks;
+	std::vector<uint32_t> primitivesLeft(data->meshes_count);
+
+	for (uint64_t i = 0; i < data->meshes_count; i++) {
+		const cgltf_mesh &mesh = data->meshes[i];
+
+		scene.meshes[i].primitiveCount = mesh.primitives_count;
+		scene.meshes[i].primitives = scene.arena->arrayAllocate<Primitive>(mesh.primitives_count, true);
+		primitivesLeft[i] = mesh.primitives_count;
+
+		for (uint64_t j = 0; j < mesh.primitives_count; j++)
+			tasks.push_back({ (uint32_t)i, (uint32_t)j });
+	}
+
+	// tasks are handed out in order, so sorting them is enough to load the closest meshes first
+	if (options.cameraPriority) {
+		std::vector<float> distances(data->meshes_count);
+		_meshDistances(*data, scene.hierarchy, options.cameraPosition, distances.data());
+
+		std::stable_sort(tasks.begin(), tasks.end(), [&](const PrimitiveTask &a, const PrimitiveTask &b) {
+			return distances[a.meshIndex] < distances[b.meshIndex];
+		});
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(job.mutex);
+		job.primitivesLeft = primitivesLeft;
+		job.progress.meshCount = scene.meshCount;
+		job.progress.primitiveCount = tasks.size();
+
+		// meshes without primitives have nothing to wait for
+		for (uint32_t i = 0; i < scene.meshCount; i++) {
+			if (primitivesLeft[i] != 0)
+				continue;
+
+			job.finishedMeshes.push_back(i);
+			job.progress.meshesLoaded++;
+		}
+	}
+
+	std::vector<LoadStats> taskStats(tasks.size(), LoadStats());
+
+	// one arena per task so workers never share an allocator, spliced into the scene afterwards
+	std::vector<Arena> taskArenas(tasks.size());
+
+	pool.parallelFor(tasks.size(), [&](uint32_t taskIndex) {
+		if (job.cancelled) {
+			job.skipped = true;
+			return;
+		}
+
+		const PrimitiveTask &task = tasks[taskIndex];
+		const cgltf_mesh &mesh = data->meshes[task.meshIndex];
+
+		Primitive &primitive = scene.meshes[task.meshIndex].primitives[task.primitiveIndex];
+		if (!_primitiveLoad(mesh.primitives[task.primitiveIndex], options, taskArenas[taskIndex], primitive,
+					taskStats[taskIndex]))
+			fprintf(stderr, "Mesh: %s, primitive: %u is invalid or missing required attributes!\n", mesh.name,
+					task.primitiveIndex);
+
+		std::lock_guard<std::mutex> lock(job.mutex);
+		job.progress.primitivesLoaded++;
+
+		// the other primitives of the mesh were written before their tasks took the lock
+		if (--job.primitivesLeft[task.meshIndex] == 0) {
+			MeshBounds::meshBoundsCompute(scene.meshes[task.meshIndex]);
+			job.finishedMeshes.push_back(task.meshIndex);
+			job.progress.meshesLoaded++;
+		}
+	});
+
+	for (Arena &taskArena : taskArenas)
+		scene.arena->splice(taskArena);
+
+	_stats.meshTime = timer.elapsed();
+	timer.reset();
+
+	// meshes left unfinished by a cancel were never handed out
+	{
+		std::lock_guard<std::mutex> lock(job.mutex);
+		for (uint32_t i = 0; i < scene.meshCount; i++) {
+			if (job.primitivesLeft[i] != 0)
+				MeshBounds::meshBoundsCompute(scene.meshes[i]);
+		}
+	}
+
+	_worldBoundsCompute(scene, &pool);
+
+	_stats.hierarchyTime += timer.elapsed();
+	timer.reset();
+
+	rssMax = std::max(rssMax, memoryRssAnonymous());
 
-	for (uint64_t i = 0; i < data->meshes_count; i++)
-		_meshLoad(data->meshes[i]);
+	if (options.loadTextures) {
+		_texturesLoad(*data, job, pool);
+
+		_stats.textureTime = timer.elapsed();
+		rssMax = std::max(rssMax, memoryRssAnonymous());
+	}
+
+	for (const LoadStats &taskStat : taskStats) {
+		_stats.indexTime += taskStat.indexTime;
+		_stats.attributeTime += taskStat.attributeTime;
+		_stats.weldTime += taskStat.weldTime;
+		_stats.normalTime += taskStat.normalTime;
+		_stats.weldedVertexCount += taskStat.weldedVertexCount;
+		_stats.tangentTime += taskStat.tangentTime;
+		_stats.boundsTime += taskStat.boundsTime;
+		_stats.boundsMismatchCount += taskStat.boundsMismatchCount;
+		_stats.optimizeTime += taskStat.optimizeTime;
+		_stats.transformsBefore += taskStat.transformsBefore;
+		_stats.transformsAfter += taskStat.transformsAfter;
+		_stats.meshletTime += taskStat.meshletTime;
+		_stats.meshletCount += taskStat.meshletCount;
+		_stats.lodTime += taskStat.lodTime;
+		_stats.lodCount += taskStat.lodCount;
+		_stats.lodTriangleCount += taskStat.lodTriangleCount;
+		_stats.vertexCount += taskStat.vertexCount;
+		_stats.triangleCount += taskStat.triangleCount;
+	}
+
+	_stats.threadCount = pool.threadCount();
+	_stats.meshCount = scene.meshCount;
+	_stats.primitiveCount = tasks.size();
+	_stats.nodeCount = scene.hierarchy.count;
+	_stats.levelCount = scene.hierarchy.levelCount;
 
 	cgltf_free(data);
+
+	// a partial scene must not end up in the cache, a cancel arriving after the last task changed nothing
+	bool cancelled = job.skipped;
+
+	if (useCache && !cancelled) {
+		timer.reset();
+
+		if (!MeshCache::sceneWrite(cachePath, cacheKey, scene))
+			fprintf(stderr, "Failed to write mesh cache: %s\n", cachePath);
+
+		_stats.cacheTime += timer.elapsed();
+	}
+
+	_stats.totalTime = totalTimer.elapsed();
+
+	_stats.mapped = options.mapFiles;
+	_stats.rssGrowth = rssMax - rssStart;
+	_stats.rssPeak = memoryRssPeak();
+	_arenaStats(*scene.arena, _stats);
+
+	_statusSet(job, cancelled ? LOAD_STATUS_CANCELLED : LOAD_STATUS_FINISHED);
+}
+
+Scene GLTFLoader::loadFile(const char *path, const LoadOptions &options, LoadStats *stats) {
+	LoadJob job(path, options);
+	_loadRun(job);
+
+	if (stats != nullptr)
+		*stats = job.stats;
+
+	return job.scene;
+}
+
+LoadJob *GLTFLoader::loadAsync(const char *path, const LoadOptions &options) {
+	LoadJob *job = new LoadJob(path, options);
+	job->thread = std::thread(_loadRun, std::ref(*job));
+	return job;
+}
+
+LoadProgress GLTFLoader::loadProgress(LoadJob *job) {
+	std::lock_guard<std::mutex> lock(job->mutex);
+	return job->progress;
+}
+
+uint32_t GLTFLoader::meshesPoll(LoadJob *job, StreamedMesh *meshes, uint32_t capacity) {
+	std::lock_guard<std::mutex> lock(job->mutex);
+
+	uint32_t count = std::min((uint32_t)job->finishedMeshes.size(), capacity);
+	for (uint32_t i = 0; i < count; i++) {
+		meshes[i].meshIndex = job->finishedMeshes[i];
+		meshes[i].mesh = &job->scene.meshes[job->finishedMeshes[i]];
+	}
+
+	job->finishedMeshes.erase(job->finishedMeshes.begin(), job->finishedMeshes.begin() + count);
+	return count;
+}
+
+void GLTFLoader::loadCancel(LoadJob *job) {
+	job->cancelled = true;
+}
+
+Scene GLTFLoader::loadFinish(LoadJob *job, LoadStats *stats) {
+	job->thread.join();
+
+	if (stats != nullptr)
+		*stats = job->stats;
+
+	Scene scene = job->scene;
+	delete job;
+
+	return scene;
+}
+
+void GLTFLoader::sceneFree(Scene &scene) {
+	delete scene.arena;
+	fileUnmap(scene.cacheFile);
+
+	scene = {};
 }
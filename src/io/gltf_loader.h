@@ -3,32 +3,221 @@
 
 #include <cstdint>
 
+#include <io/tangent_space.h>
+#include <io/texture_decoder.h>
+#include <io/types/hierarchy.h>
 #include <io/types/mesh.h>
+#include <io/types/scene.h>
+#include <io/types/texture.h>
 #include <io/types/vertex.h>
 
 #include <math/types/mat4.h>
 
+class Arena;
+class ThreadPool;
+
 struct cgltf_attribute;
+struct cgltf_data;
 struct cgltf_mesh;
 struct cgltf_node;
+struct cgltf_primitive;
+
+typedef struct {
+	// Threads decoding primitives, including the calling thread. 0 picks the hardware concurrency.
+	uint32_t threadCount = 1;
+
+	// mmap the .gltf/.glb and external .bin files instead of reading them into heap memory.
+	bool mapFiles = false;
+
+	// Directory holding baked scenes keyed by the source file hash, nullptr disables the cache.
+	// On a hit glTF parsing is skipped and the returned scene points into the mapped cache file.
+	const char *cacheDirectory = nullptr;
+
+	// Ignore any existing cache entry and bake a new one.
+	bool cacheRebuild = false;
+
+	// Reorder triangles and vertices for the post-transform cache, overdraw and vertex fetch.
+	bool optimizeMeshes = false;
+
+	// Merge bitwise identical vertices, see MeshWelder. Always done for primitives without indices.
+	bool weldVertices = false;
+
+	// Weighting of face normals for primitives without NORMAL, generated after welding.
+	NormalWeighting normalWeighting = NORMAL_WEIGHTING_ANGLE;
+
+	// Count primitives whose POSITION min/max disagree with the AABB computed from the positions
+	// in LoadStats::boundsMismatchCount. The computed AABB is used either way.
+	bool validateBounds = false;
+
+	// Fit each primitive's box along the principal axes of its positions instead of the world axes.
+	bool orientedBounds = false;
+
+	// Split primitives into meshlets with culling bounds, see MeshletBuilder.
+	bool buildMeshlets = false;
+
+	// Simplified levels per primitive, each with about lodReduction times the triangles of the one before.
+	uint32_t lodCount = 0;
+	float lodReduction = 0.5f;
+
+	// Load meshes whose node instances are closest to cameraPosition first, by bounding sphere distance.
+	// Meshes not placed by any node come last. Only the order changes, not the scene.
+	bool cameraPriority = false;
+	float cameraPosition[3] = {};
+
+	// Decode every image of the file on the worker pool and build its mip chain, see TextureDecoder.
+	// Images used as base color or emissive textures are treated as sRGB.
+	// KTX2 images keep their stored format and mip chain, see KTX2File.
+	bool loadTextures = false;
+	MipFilter mipFilter = MIP_FILTER_BOX;
+} LoadOptions;
+
+typedef enum {
+	LOAD_STATUS_LOADING,
+	LOAD_STATUS_FINISHED,
+	LOAD_STATUS_CANCELLED,
+	LOAD_STATUS_FAILED,
+} LoadStatus;
+
+// Counts are 0 until the file has been parsed.
+typedef struct {
+	LoadStatus status;
+	uint32_t meshCount;
+	uint32_t meshesLoaded;
+	uint32_t primitiveCount;
+	uint32_t primitivesLoaded;
+	uint32_t textureCount;
+	uint32_t texturesLoaded;
+} LoadProgress;
+
+// A mesh with all of its primitives decoded, valid until the scene is freed.
+typedef struct {
+	uint32_t meshIndex;
+	const Mesh *mesh;
+} StreamedMesh;
 
+// Handle of a load running in the background, see GLTFLoader::loadAsync.
+struct LoadJob;
+
+// Image decoding of one source format, without mip generation.
+typedef struct {
+	uint32_t imageCount;
+	uint64_t encodedBytes;
+	uint64_t pixelCount;
+	double decodeTime;
+} DecodeStats;
+
+// All times are in milliseconds. Stage times are summed over every worker,
+// so with more than one thread they can add up to more than meshTime.
 typedef struct {
-	char *name;
-	uint32_t *meshIndex;
-	math::mat4 transform;
-} Node;
+	double parseTime;
+	double bufferTime;
+	double meshoptTime;
+	double hierarchyTime;
+	double meshTime;
+	double cacheTime;
+	double totalTime;
+
+	double indexTime;
+	double attributeTime;
+	double weldTime;
+	double normalTime;
+	double tangentTime;
+	double boundsTime;
+	double optimizeTime;
+	double meshletTime;
+	double lodTime;
+	double textureTime;
+	double mipTime;
+
+	uint32_t threadCount;
+	uint32_t meshCount;
+	uint32_t primitiveCount;
+	uint32_t nodeCount;
+	uint32_t levelCount;
+	uint64_t vertexCount;
+	uint64_t triangleCount;
+	uint64_t weldedVertexCount;
+	uint32_t boundsMismatchCount;
+	uint64_t meshletCount;
+	uint64_t lodCount;
+	uint64_t lodTriangleCount;
+	uint32_t textureCount;
+	uint64_t textureBytes;
+
+	// Decode throughput per source format, decodeTime is summed over workers like the stage times.
+	DecodeStats decodeStats[IMAGE_FORMAT_COUNT];
+
+	// Simulated vertex shader invocations before and after optimizeMeshes, see MeshOptimizer.
+	// ACMR is transforms per triangle, ATVR transforms per vertex.
+	uint64_t transformsBefore;
+	uint64_t transformsAfter;
+
+	// Bytes of .gltf/.glb/.bin data, either mapped or copied to the heap.
+	uint64_t fileBytes;
+
+	// Bytes of EXT_meshopt_compression buffer views after decoding.
+	uint64_t meshoptBytes;
+	bool mapped;
+
+	// Largest anonymous resident set growth sampled between stages, and the process
+	// peak. Mapped file pages are not counted in rssGrowth since they are reclaimable.
+	uint64_t rssGrowth;
+	uint64_t rssPeak;
+
+	// Scene arena: requested bytes, malloc'd bytes, allocations and the mallocs backing them.
+	uint64_t arenaBytes;
+	uint64_t arenaReserved;
+	uint64_t arenaAllocations;
+	uint64_t arenaBlocks;
+
+	bool cacheHit;
+} LoadStats;
 
 class GLTFLoader {
 private:
 	static bool _checkAttributes(const cgltf_attribute *attributes, uint32_t attributeCount);
 	static math::mat4 _extractTransform(const cgltf_node &node);
-	static void _tangentsGenerate(const IndexArray &indices, VertexArray &vertices);
 
-	static Mesh _meshLoad(const cgltf_mesh &mesh);
-	static Node _nodeLoad(const cgltf_node &node);
+	static uint64_t _cacheKey(const char *path, const LoadOptions &options, bool *valid);
+
+	static bool _primitiveLoad(const cgltf_primitive &primitive, const LoadOptions &options, Arena &arena,
+			Primitive &out, LoadStats &stats);
+	static void _meshDistances(
+			const cgltf_data &data, const Hierarchy &hierarchy, const float *position, float *distances);
+
+	static bool _bufferViewsDecode(cgltf_data &data, ThreadPool &pool, uint64_t *bytes);
+	static void _texturesLoad(const cgltf_data &data, LoadJob &job, ThreadPool &pool);
+	static void _loadRun(LoadJob &job);
+	static Transform _nodeLoad(const cgltf_node &node);
+	static Hierarchy _hierarchyLoad(const cgltf_data &data, Arena &arena);
 
 public:
-	static void loadFile(const char *path);
+	static void statsPrint(const LoadStats &stats);
+
+	// Primitives and textures are decoded in parallel when options.threadCount != 1,
+	// the resulting scene is laid out in file order either way.
+	static Scene loadFile(const char *path, const LoadOptions &options = LoadOptions(), LoadStats *stats = nullptr);
+
+	// Starts loading on a background thread and returns right away. Meshes become
+	// available through meshesPoll as soon as all of their primitives are decoded,
+	// textures are decoded after the last mesh.
+	// path is copied, options.cacheDirectory must stay valid until loadFinish.
+	static LoadJob *loadAsync(const char *path, const LoadOptions &options = LoadOptions());
+	static LoadProgress loadProgress(LoadJob *job);
+
+	// Moves up to capacity meshes finished since the last call into meshes, returns how many.
+	static uint32_t meshesPoll(LoadJob *job, StreamedMesh *meshes, uint32_t capacity);
+
+	// Primitives already being decoded still finish, the rest are skipped and stay empty.
+	// A load that skipped anything ends as LOAD_STATUS_CANCELLED and is not written to the cache.
+	static void loadCancel(LoadJob *job);
+
+	// Waits for the load to end and frees the job. The scene is empty if loading
+	// failed, after a cancel the meshes that never finished have empty primitives.
+	static Scene loadFinish(LoadJob *job, LoadStats *stats = nullptr);
+
+	// Releases all memory of a scene returned by loadFile or loadFinish at once and unmaps its cache file.
+	static void sceneFree(Scene &scene);
 };
 
 #endif // !GLTF_LOADER_H
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <core/arena.h>
+
+#include <io/types/texture.h>
+
+#include "ktx2_file.h"
+#include "texture_encoder.h"
+
+const uint8_t IDENTIFIER[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+
+// VkFormat values, the loader builds without the Vulkan headers
+const uint32_t VK_FORMAT_R8G8B8A8_UNORM = 37;
+const uint32_t VK_FORMAT_R8G8B8A8_SRGB = 43;
+const uint32_t VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131;
+const uint32_t VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132;
+const uint32_t VK_FORMAT_BC4_UNORM_BLOCK = 139;
+const uint32_t VK_FORMAT_BC5_UNORM_BLOCK = 141;
+const uint32_t VK_FORMAT_BC7_UNORM_BLOCK = 145;
+const uint32_t VK_FORMAT_BC7_SRGB_BLOCK = 146;
+
+// Khronos data format descriptor values
+const uint32_t DF_MODEL_RGBSDA = 1;
+const uint32_t DF_MODEL_BC1A = 128;
+const uint32_t DF_MODEL_BC4 = 131;
+const uint32_t DF_MODEL_BC5 = 132;
+const uint32_t DF_MODEL_BC7 = 134;
+const uint32_t DF_PRIMARIES_BT709 = 1;
+const uint32_t DF_TRANSFER_LINEAR = 1;
+const uint32_t DF_TRANSFER_SRGB = 2;
+const uint32_t DF_SAMPLE_LINEAR = 0x10;
+
+typedef struct {
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+} Header;
+
+// Supercompression global data offset and length follow the header as two uint64_t, kept
+// apart so the struct has no padding. Neither is used without supercompression.
+const size_t LEVEL_INDEX_OFFSET = sizeof(IDENTIFIER) + sizeof(Header) + 2 * sizeof(uint64_t);
+
+typedef struct {
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+} LevelIndex;
+
+static uint32_t _vkFormat(TextureFormat format, bool srgb) {
+	switch (format) {
+		case TEXTURE_FORMAT_RGBA8:
+			return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		case TEXTURE_FORMAT_BC1:
+			return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC4:
+			return VK_FORMAT_BC4_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC5:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC7:
+			return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+		default:
+			return 0;
+	}
+}
+
+static bool _textureFormat(uint32_t vkFormat, TextureFormat *format, bool *srgb) {
+	for (uint32_t i = 0; i < TEXTURE_FORMAT_COUNT; i++) {
+		for (bool linear : { true, false }) {
+			if (_vkFormat((TextureFormat)i, !linear) != vkFormat)
+				continue;
+
+			*format = (TextureFormat)i;
+			*srgb = !linear;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Basic data format descriptor block, one sample per channel, or per 64 bit half of a block.
+static std::vector<uint32_t> _descriptorCreate(TextureFormat format, bool srgb) {
+	typedef struct {
+		uint32_t channel;
+		uint32_t bitOffset;
+		uint32_t bitLength;
+		uint32_t upper;
+	} Sample;
+
+	std::vector<Sample> samples;
+	uint32_t model;
+
+	switch (format) {
+		case TEXTURE_FORMAT_BC1:
+			model = DF_MODEL_BC1A;
+			samples.push_back({ 0, 0, 64, UINT32_MAX });
+			break;
+		case TEXTURE_FORMAT_BC4:
+			model = DF_MODEL_BC4;
+			samples.push_back({ 0, 0, 64, UINT32_MAX });
+			break;
+		case TEXTURE_FORMAT_BC5:
+			model = DF_MODEL_BC5;
+			samples.push_back({ 0, 0, 64, UINT32_MAX });
+			samples.push_back({ 1, 64, 64, UINT32_MAX });
+			break;
+		case TEXTURE_FORMAT_BC7:
+			model = DF_MODEL_BC7;
+			samples.push_back({ 0, 0, 128, UINT32_MAX });
+			break;
+		default:
+			// alpha is never sRGB encoded
+			model = DF_MODEL_RGBSDA;
+			samples.push_back({ 0, 0, 8, 255 });
+			samples.push_back({ 1, 8, 8, 255 });
+			samples.push_back({ 2, 16, 8, 255 });
+			samples.push_back({ 15 | (srgb ? DF_SAMPLE_LINEAR : 0), 24, 8, 255 });
+			break;
+	}
+
+	uint32_t blockDimension = format == TEXTURE_FORMAT_RGBA8 ? 0 : 3;
+	uint32_t blockSize = 24 + 16 * samples.size();
+
+	std::vector<uint32_t> words;
+	words.push_back(4 + blockSize);
+	words.push_back(0); // Khronos vendor, basic descriptor type
+	words.push_back(2 | (blockSize << 16));
+	words.push_back(model | (DF_PRIMARIES_BT709 << 8) | ((srgb ? DF_TRANSFER_SRGB : DF_TRANSFER_LINEAR) << 16));
+	words.push_back(blockDimension | (blockDimension << 8));
+	words.push_back(TextureEncoder::blockBytes(format));
+	words.push_back(0);
+
+	for (const Sample &sample : samples) {
+		words.push_back(sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24));
+		words.push_back(0);
+		words.push_back(0);
+		words.push_back(sample.upper);
+	}
+
+	return words;
+}
+
+// Levels are aligned to the least common multiple of the block size and 4.
+static uint64_t _levelAlign(uint64_t offset, TextureFormat format) {
+	uint64_t alignment = TextureEncoder::blockBytes(format);
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool KTX2File::formatDetect(const uint8_t *data, size_t size) {
+	return size >= sizeof(IDENTIFIER) && memcmp(data, IDENTIFIER, sizeof(IDENTIFIER)) == 0;
+}
+
+bool KTX2File::textureRead(const uint8_t *data, size_t size, Arena &arena, Texture *texture) {
+	if (!formatDetect(data, size) || size < LEVEL_INDEX_OFFSET)
+		return false;
+
+	Header header;
+	memcpy(&header, data + sizeof(IDENTIFIER), sizeof(Header));
+
+	Texture _texture = {};
+
+	// cube maps, arrays and volumes have no use in the renderer yet
+	bool valid = _textureFormat(header.vkFormat, &_texture.format, &_texture.srgb);
+	valid = valid && header.pixelWidth > 0 && header.pixelHeight > 0 && header.pixelDepth == 0;
+	valid = valid && header.layerCount <= 1 && header.faceCount == 1;
+	valid = valid && header.levelCount > 0 && header.levelCount <= TEXTURE_MAX_MIPS;
+	valid = valid && header.supercompressionScheme == 0;
+	valid = valid && LEVEL_INDEX_OFFSET + header.levelCount * sizeof(LevelIndex) <= size;
+
+	if (!valid)
+		return false;
+
+	std::vector<LevelIndex> levels(header.levelCount);
+	memcpy(levels.data(), data + LEVEL_INDEX_OFFSET, header.levelCount * sizeof(LevelIndex));
+
+	_texture.width = header.pixelWidth;
+	_texture.height = header.pixelHeight;
+	_texture.mipCount = header.levelCount;
+
+	for (uint32_t i = 0; i < header.levelCount; i++) {
+		MipLevel &level = _texture.mips[i];
+		level.width = std::max(header.pixelWidth >> i, 1u);
+		level.height = std::max(header.pixelHeight >> i, 1u);
+		level.offset = _texture.size;
+		level.size = TextureEncoder::levelSize(_texture.format, level.width, level.height);
+
+		valid = valid && levels[i].byteLength == level.size && levels[i].byteOffset <= size;
+		valid = valid && levels[i].byteLength <= size - levels[i].byteOffset;
+
+		_texture.size += level.size;
+	}
+
+	if (!valid)
+		return false;
+
+	_texture.data = arena.arrayAllocate<uint8_t>(_texture.size);
+	for (uint32_t i = 0; i < header.levelCount; i++)
+		memcpy(_texture.data + _texture.mips[i].offset, data + levels[i].byteOffset, levels[i].byteLength);
+
+	*texture = _texture;
+	return true;
+}
+
+bool KTX2File::textureWrite(const char *path, const Texture &texture) {
+	Header header = {};
+	header.vkFormat = _vkFormat(texture.format, texture.srgb);
+	header.typeSize = 1;
+	header.pixelWidth = texture.width;
+	header.pixelHeight = texture.height;
+	header.faceCount = 1;
+	header.levelCount = texture.mipCount;
+
+	std::vector<uint32_t> descriptor = _descriptorCreate(texture.format, texture.srgb);
+	header.dfdByteOffset = LEVEL_INDEX_OFFSET + texture.mipCount * sizeof(LevelIndex);
+	header.dfdByteLength = descriptor.size() * sizeof(uint32_t);
+
+	// smallest level first, so a streaming reader can show something early
+	std::vector<LevelIndex> levels(texture.mipCount);
+	uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+
+	for (uint32_t i = texture.mipCount; i-- > 0;) {
+		levels[i].byteOffset = _levelAlign(offset, texture.format);
+		levels[i].byteLength = texture.mips[i].size;
+		levels[i].uncompressedByteLength = texture.mips[i].size;
+
+		offset = levels[i].byteOffset + levels[i].byteLength;
+	}
+
+	char temporaryPath[4096];
+	snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+
+	FILE *file = fopen(temporaryPath, "wb");
+	if (file == nullptr)
+		return false;
+
+	bool success = fwrite(IDENTIFIER, sizeof(IDENTIFIER), 1, file) == 1;
+	success = success && fwrite(&header, sizeof(Header), 1, file) == 1;
+
+	const uint64_t supercompression[2] = {};
+	success = success && fwrite(supercompression, sizeof(supercompression), 1, file) == 1;
+	success = success && fwrite(levels.data(), sizeof(LevelIndex), levels.size(), file) == levels.size();
+	success = success && fwrite(descriptor.data(), sizeof(uint32_t), descriptor.size(), file) == descriptor.size();
+
+	offset = header.dfdByteOffset + header.dfdByteLength;
+
+	const uint8_t zeros[16] = {};
+	for (uint32_t i = texture.mipCount; i-- > 0 && success;) {
+		uint64_t padding = levels[i].byteOffset - offset;
+		success = fwrite(zeros, 1, padding, file) == padding;
+		success = success && fwrite(texture.data + texture.mips[i].offset, 1, texture.mips[i].size, file) ==
+						texture.mips[i].size;
+
+		offset = levels[i].byteOffset + levels[i].byteLength;
+	}
+
+	success = (fclose(file) == 0) && success;
+
+	if (!success || rename(temporaryPath, path) != 0) {
+		remove(temporaryPath);
+		return false;
+	}
+
+	return true;
+}
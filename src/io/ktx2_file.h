@@ -0,0 +1,25 @@
+#ifndef KTX2_FILE_H
+#define KTX2_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <io/types/texture.h>
+
+class Arena;
+
+// KTX2 containers holding one 2D image with its mip chain, in RGBA8 or one of
+// the block formats of TextureFormat. Supercompressed files are not supported.
+class KTX2File {
+public:
+	static bool formatDetect(const uint8_t *data, size_t size);
+
+	// Copies the levels into arena, largest first like every other Texture.
+	// Returns false on an unsupported or corrupt file, texture is left untouched then.
+	static bool textureRead(const uint8_t *data, size_t size, Arena &arena, Texture *texture);
+
+	// Writes to a temporary file first and renames it, like the mesh cache.
+	static bool textureWrite(const char *path, const Texture &texture);
+};
+
+#endif // !KTX2_FILE_H
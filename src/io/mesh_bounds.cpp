@@ -0,0 +1,635 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <core/thread_pool.h>
+
+#include <io/types/aabb.h>
+#include <io/types/bounds.h>
+#include <io/types/hierarchy.h>
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include <math/types/mat4.h>
+
+#include "mesh_bounds.h"
+
+using namespace math;
+
+// Nodes per task of worldBoundsUpdate.
+const uint32_t NODE_CHUNK = 4096;
+
+// Seed directions for the sphere: the axes and the four cube diagonals, unnormalized
+// since only the order of the projections matters.
+const float SEED_DIRECTIONS[7][3] = {
+	{ 1.0f, 0.0f, 0.0f },
+	{ 0.0f, 1.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f },
+	{ 1.0f, 1.0f, 1.0f },
+	{ 1.0f, 1.0f, -1.0f },
+	{ 1.0f, -1.0f, 1.0f },
+	{ 1.0f, -1.0f, -1.0f },
+};
+
+static inline float _dot(const float *a, const float *b) {
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline float _distanceSquared(const float *a, const float *b) {
+	float d[3] = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+	return _dot(d, d);
+}
+
+// Covers the float rounding of distances around center, so culling with the bounds stays conservative.
+static inline float _roundingSlack(const float *center, float extent) {
+	float magnitude = std::max(std::max(std::fabs(center[0]), std::fabs(center[1])), std::fabs(center[2]));
+	return (magnitude + extent) * FLT_EPSILON * 4.0f;
+}
+
+static inline void _aabbCenter(const AABB &aabb, float *center, float *halfExtents) {
+	halfExtents[0] = aabb.w * 0.5f;
+	halfExtents[1] = aabb.h * 0.5f;
+	halfExtents[2] = aabb.d * 0.5f;
+
+	center[0] = aabb.x + halfExtents[0];
+	center[1] = aabb.y + halfExtents[1];
+	center[2] = aabb.z + halfExtents[2];
+}
+
+AABB MeshBounds::aabbCompute(const VertexArray &vertices) {
+	AABB aabb = {};
+	if (vertices.count == 0)
+		return aabb;
+
+	float min[4], max[4];
+
+#ifdef __SSE2__
+	// the fourth lane reads normal[0] and is ignored
+	__m128 min0 = _mm_loadu_ps(vertices.data[0].position);
+	__m128 max0 = min0;
+	__m128 min1 = min0;
+	__m128 max1 = min0;
+
+	uint32_t i = 1;
+	for (; i + 2 <= vertices.count; i += 2) {
+		__m128 p0 = _mm_loadu_ps(vertices.data[i].position);
+		__m128 p1 = _mm_loadu_ps(vertices.data[i + 1].position);
+
+		min0 = _mm_min_ps(min0, p0);
+		max0 = _mm_max_ps(max0, p0);
+		min1 = _mm_min_ps(min1, p1);
+		max1 = _mm_max_ps(max1, p1);
+	}
+
+	if (i < vertices.count) {
+		__m128 p = _mm_loadu_ps(vertices.data[i].position);
+		min0 = _mm_min_ps(min0, p);
+		max0 = _mm_max_ps(max0, p);
+	}
+
+	_mm_storeu_ps(min, _mm_min_ps(min0, min1));
+	_mm_storeu_ps(max, _mm_max_ps(max0, max1));
+#else
+	memcpy(min, vertices.data[0].position, 3 * sizeof(float));
+	memcpy(max, vertices.data[0].position, 3 * sizeof(float));
+
+	for (uint32_t i = 1; i < vertices.count; i++) {
+		const float *p = vertices.data[i].position;
+		for (int k = 0; k < 3; k++) {
+			min[k] = std::min(min[k], p[k]);
+			max[k] = std::max(max[k], p[k]);
+		}
+	}
+#endif
+
+	aabb.x = min[0];
+	aabb.y = min[1];
+	aabb.z = min[2];
+
+	aabb.w = max[0] - min[0];
+	aabb.h = max[1] - min[1];
+	aabb.d = max[2] - min[2];
+	return aabb;
+}
+
+bool MeshBounds::aabbMatches(const AABB &stored, const AABB &computed, float tolerance) {
+	float slack = tolerance * std::max(std::max(computed.w, computed.h), std::max(computed.d, 1e-6f));
+
+	const float storedFaces[6] = { stored.x, stored.y, stored.z, stored.x + stored.w, stored.y + stored.h,
+		stored.z + stored.d };
+	const float computedFaces[6] = { computed.x, computed.y, computed.z, computed.x + computed.w,
+		computed.y + computed.h, computed.z + computed.d };
+
+	for (int i = 0; i < 6; i++) {
+		if (!(std::fabs(storedFaces[i] - computedFaces[i]) <= slack))
+			return false;
+	}
+
+	return true;
+}
+
+#ifdef __SSE2__
+
+typedef struct {
+	__m128 minimumDot, maximumDot;
+	__m128i minimum, maximum;
+} Extremes;
+
+static inline void _extremesUpdate(Extremes &extremes, __m128 d, __m128i index) {
+	__m128i less = _mm_castps_si128(_mm_cmplt_ps(d, extremes.minimumDot));
+	__m128i greater = _mm_castps_si128(_mm_cmpgt_ps(d, extremes.maximumDot));
+
+	extremes.minimumDot = _mm_min_ps(extremes.minimumDot, d);
+	extremes.maximumDot = _mm_max_ps(extremes.maximumDot, d);
+	extremes.minimum = _mm_or_si128(_mm_and_si128(less, index), _mm_andnot_si128(less, extremes.minimum));
+	extremes.maximum = _mm_or_si128(_mm_and_si128(greater, index), _mm_andnot_si128(greater, extremes.maximum));
+}
+
+#endif // __SSE2__
+
+// Vertices with the smallest and the largest projection onto each seed direction.
+static void _extremesFind(const VertexArray &vertices, uint32_t *minimum, uint32_t *maximum) {
+#ifdef __SSE2__
+	// the axes and the first diagonal in one register, the other diagonals and the x axis again in the second
+	const __m128 diagonalsX = _mm_set1_ps(1.0f);
+	const __m128 diagonalsY = _mm_setr_ps(1.0f, -1.0f, -1.0f, 0.0f);
+	const __m128 diagonalsZ = _mm_setr_ps(-1.0f, 1.0f, -1.0f, 0.0f);
+
+	const Extremes empty = { _mm_set1_ps(FLT_MAX), _mm_set1_ps(-FLT_MAX), _mm_setzero_si128(), _mm_setzero_si128() };
+	Extremes axes = empty;
+	Extremes diagonals = empty;
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		__m128 p = _mm_loadu_ps(vertices.data[i].position);
+		__m128 x = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+		__m128 y = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+		__m128 z = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+		__m128i index = _mm_set1_epi32(i);
+
+		// x, y, z and x + y + z
+		__m128 sum = _mm_add_ps(_mm_add_ps(x, y), z);
+		_extremesUpdate(axes, _mm_shuffle_ps(p, _mm_unpackhi_ps(p, sum), _MM_SHUFFLE(1, 0, 1, 0)), index);
+
+		__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, diagonalsX), _mm_mul_ps(y, diagonalsY)),
+				_mm_mul_ps(z, diagonalsZ));
+		_extremesUpdate(diagonals, d, index);
+	}
+
+	uint32_t minimums[8], maximums[8];
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(&minimums[0]), axes.minimum);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(&maximums[0]), axes.maximum);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(&minimums[4]), diagonals.minimum);
+	_mm_storeu_si128(reinterpret_cast<__m128i *>(&maximums[4]), diagonals.maximum);
+
+	memcpy(minimum, minimums, 7 * sizeof(uint32_t));
+	memcpy(maximum, maximums, 7 * sizeof(uint32_t));
+#else
+	float minimumDot[7], maximumDot[7];
+	for (int k = 0; k < 7; k++) {
+		minimum[k] = maximum[k] = 0;
+		minimumDot[k] = maximumDot[k] = _dot(vertices.data[0].position, SEED_DIRECTIONS[k]);
+	}
+
+	for (uint32_t i = 1; i < vertices.count; i++) {
+		const float *p = vertices.data[i].position;
+
+		for (int k = 0; k < 7; k++) {
+			float d = _dot(p, SEED_DIRECTIONS[k]);
+
+			if (d < minimumDot[k]) {
+				minimumDot[k] = d;
+				minimum[k] = i;
+			}
+
+			if (d > maximumDot[k]) {
+				maximumDot[k] = d;
+				maximum[k] = i;
+			}
+		}
+	}
+#endif
+}
+
+BoundingSphere MeshBounds::sphereCompute(const VertexArray &vertices, const AABB &aabb) {
+	BoundingSphere sphere = {};
+	if (vertices.count == 0)
+		return sphere;
+
+	uint32_t minimum[7], maximum[7];
+	_extremesFind(vertices, minimum, maximum);
+
+	int direction = 0;
+	float span = -1.0f;
+	for (int k = 0; k < 7; k++) {
+		float d = _distanceSquared(vertices.data[minimum[k]].position, vertices.data[maximum[k]].position);
+
+		if (d > span) {
+			span = d;
+			direction = k;
+		}
+	}
+
+	const float *p0 = vertices.data[minimum[direction]].position;
+	const float *p1 = vertices.data[maximum[direction]].position;
+
+	float center[3] = { (p0[0] + p1[0]) * 0.5f, (p0[1] + p1[1]) * 0.5f, (p0[2] + p1[2]) * 0.5f };
+	float radius = std::sqrt(span) * 0.5f;
+	float radiusSquared = radius * radius;
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		const float *p = vertices.data[i].position;
+
+		float d2 = _distanceSquared(p, center);
+		if (d2 <= radiusSquared)
+			continue;
+
+		// move the center towards the point so the old sphere and the point both fit
+		float d = std::sqrt(d2);
+		float grow = (d - radius) * 0.5f;
+		for (int k = 0; k < 3; k++)
+			center[k] += (p[k] - center[k]) * (grow / d);
+
+		radius += grow;
+		radiusSquared = radius * radius;
+	}
+
+	float aabbCenter[3], halfExtents[3];
+	_aabbCenter(aabb, aabbCenter, halfExtents);
+
+	float aabbRadius = std::sqrt(_dot(halfExtents, halfExtents));
+	if (aabbRadius < radius) {
+		memcpy(center, aabbCenter, sizeof(center));
+		radius = aabbRadius;
+	}
+
+	memcpy(sphere.center, center, sizeof(center));
+	sphere.radius = radius + _roundingSlack(center, radius);
+	return sphere;
+}
+
+// Jacobi rotations on a symmetric 3x3 matrix, the columns of vectors end up as its eigenvectors.
+static void _eigenvectorsCompute(double matrix[3][3], double vectors[3][3]) {
+	const int PAIRS[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++)
+			vectors[i][j] = i == j ? 1.0 : 0.0;
+	}
+
+	for (int sweep = 0; sweep < 16; sweep++) {
+		double off = matrix[0][1] * matrix[0][1] + matrix[0][2] * matrix[0][2] + matrix[1][2] * matrix[1][2];
+		double diagonal = matrix[0][0] * matrix[0][0] + matrix[1][1] * matrix[1][1] + matrix[2][2] * matrix[2][2];
+		if (off <= diagonal * 1e-24)
+			break;
+
+		for (const int *pair : PAIRS) {
+			const int p = pair[0], q = pair[1];
+			if (matrix[p][q] == 0.0)
+				continue;
+
+			double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+			double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0));
+			double c = 1.0 / std::sqrt(t * t + 1.0);
+			double s = t * c;
+
+			for (int k = 0; k < 3; k++) {
+				double kp = matrix[k][p], kq = matrix[k][q];
+				matrix[k][p] = c * kp - s * kq;
+				matrix[k][q] = s * kp + c * kq;
+			}
+
+			for (int k = 0; k < 3; k++) {
+				double pk = matrix[p][k], qk = matrix[q][k];
+				matrix[p][k] = c * pk - s * qk;
+				matrix[q][k] = s * pk + c * qk;
+			}
+
+			for (int k = 0; k < 3; k++) {
+				double kp = vectors[k][p], kq = vectors[k][q];
+				vectors[k][p] = c * kp - s * kq;
+				vectors[k][q] = s * kp + c * kq;
+			}
+		}
+	}
+}
+
+OrientedBox MeshBounds::aabbBox(const AABB &aabb) {
+	OrientedBox box = {};
+	_aabbCenter(aabb, box.center, box.halfExtents);
+
+	box.axes[0][0] = 1.0f;
+	box.axes[1][1] = 1.0f;
+	box.axes[2][2] = 1.0f;
+	return box;
+}
+
+// Covariance of the positions around their mean, summed relative to origin to keep the float sums small.
+static void _covarianceCompute(const VertexArray &vertices, const float *origin, double covariance[3][3]) {
+	double sum[3] = {}, squares[3] = {}, products[3] = {}; // products: xy, yz, zx
+
+#ifdef __SSE2__
+	// float sums over blocks short enough to stay exact enough, added up in double
+	const uint32_t BLOCK = 1024;
+	const __m128 center = _mm_setr_ps(origin[0], origin[1], origin[2], 0.0f);
+	const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+
+	for (uint32_t begin = 0; begin < vertices.count; begin += BLOCK) {
+		uint32_t end = std::min(begin + BLOCK, vertices.count);
+		__m128 blockSum = _mm_setzero_ps();
+		__m128 blockSquares = _mm_setzero_ps();
+		__m128 blockProducts = _mm_setzero_ps();
+
+		for (uint32_t i = begin; i < end; i++) {
+			__m128 d = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(vertices.data[i].position), center), mask);
+			__m128 rotated = _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 0, 2, 1));
+
+			blockSum = _mm_add_ps(blockSum, d);
+			blockSquares = _mm_add_ps(blockSquares, _mm_mul_ps(d, d));
+			blockProducts = _mm_add_ps(blockProducts, _mm_mul_ps(d, rotated));
+		}
+
+		float values[3][4];
+		_mm_storeu_ps(values[0], blockSum);
+		_mm_storeu_ps(values[1], blockSquares);
+		_mm_storeu_ps(values[2], blockProducts);
+
+		for (int k = 0; k < 3; k++) {
+			sum[k] += values[0][k];
+			squares[k] += values[1][k];
+			products[k] += values[2][k];
+		}
+	}
+#else
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		const float *p = vertices.data[i].position;
+		double d[3] = { p[0] - origin[0], p[1] - origin[1], p[2] - origin[2] };
+
+		for (int k = 0; k < 3; k++) {
+			sum[k] += d[k];
+			squares[k] += d[k] * d[k];
+			products[k] += d[k] * d[(k + 1) % 3];
+		}
+	}
+#endif
+
+	double mean[3];
+	for (int k = 0; k < 3; k++)
+		mean[k] = sum[k] / vertices.count;
+
+	for (int k = 0; k < 3; k++) {
+		int next = (k + 1) % 3;
+		covariance[k][k] = squares[k] / vertices.count - mean[k] * mean[k];
+		covariance[k][next] = covariance[next][k] = products[k] / vertices.count - mean[k] * mean[next];
+	}
+}
+
+// Smallest and largest projection of the positions relative to origin onto each axis.
+static void _axesProject(
+		const VertexArray &vertices, const float *origin, const float axes[3][3], float *minimum, float *maximum) {
+#ifdef __SSE2__
+	const __m128 center = _mm_setr_ps(origin[0], origin[1], origin[2], 0.0f);
+	const __m128 columnX = _mm_setr_ps(axes[0][0], axes[1][0], axes[2][0], 0.0f);
+	const __m128 columnY = _mm_setr_ps(axes[0][1], axes[1][1], axes[2][1], 0.0f);
+	const __m128 columnZ = _mm_setr_ps(axes[0][2], axes[1][2], axes[2][2], 0.0f);
+
+	__m128 low = _mm_set1_ps(FLT_MAX);
+	__m128 high = _mm_set1_ps(-FLT_MAX);
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		__m128 d = _mm_sub_ps(_mm_loadu_ps(vertices.data[i].position), center);
+		__m128 q = _mm_add_ps(_mm_add_ps(_mm_mul_ps(columnX, _mm_shuffle_ps(d, d, _MM_SHUFFLE(0, 0, 0, 0))),
+									  _mm_mul_ps(columnY, _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 1, 1, 1)))),
+				_mm_mul_ps(columnZ, _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 2, 2))));
+
+		low = _mm_min_ps(low, q);
+		high = _mm_max_ps(high, q);
+	}
+
+	float lows[4], highs[4];
+	_mm_storeu_ps(lows, low);
+	_mm_storeu_ps(highs, high);
+	memcpy(minimum, lows, 3 * sizeof(float));
+	memcpy(maximum, highs, 3 * sizeof(float));
+#else
+	for (int axis = 0; axis < 3; axis++) {
+		minimum[axis] = FLT_MAX;
+		maximum[axis] = -FLT_MAX;
+	}
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		const float *p = vertices.data[i].position;
+		float d[3] = { p[0] - origin[0], p[1] - origin[1], p[2] - origin[2] };
+
+		for (int axis = 0; axis < 3; axis++) {
+			float q = _dot(d, axes[axis]);
+			minimum[axis] = std::min(minimum[axis], q);
+			maximum[axis] = std::max(maximum[axis], q);
+		}
+	}
+#endif
+}
+
+OrientedBox MeshBounds::orientedBoxCompute(const VertexArray &vertices, const AABB &aabb) {
+	OrientedBox aligned = aabbBox(aabb);
+	if (vertices.count < 3)
+		return aligned;
+
+	double covariance[3][3];
+	_covarianceCompute(vertices, aligned.center, covariance);
+
+	double vectors[3][3];
+	_eigenvectorsCompute(covariance, vectors);
+
+	OrientedBox box = {};
+	for (int axis = 0; axis < 2; axis++) {
+		for (int k = 0; k < 3; k++)
+			box.axes[axis][k] = (float)vectors[k][axis];
+	}
+
+	// right handed, and exactly orthogonal after the rounding to float
+	const float *a = box.axes[0];
+	const float *b = box.axes[1];
+	float *c = box.axes[2];
+	c[0] = a[1] * b[2] - a[2] * b[1];
+	c[1] = a[2] * b[0] - a[0] * b[2];
+	c[2] = a[0] * b[1] - a[1] * b[0];
+
+	float scale = 1.0f / std::sqrt(_dot(c, c));
+	for (int k = 0; k < 3; k++)
+		c[k] *= scale;
+
+	float minimum[3], maximum[3];
+	_axesProject(vertices, aligned.center, box.axes, minimum, maximum);
+
+	memcpy(box.center, aligned.center, sizeof(box.center));
+	for (int axis = 0; axis < 3; axis++) {
+		float middle = (minimum[axis] + maximum[axis]) * 0.5f;
+		box.halfExtents[axis] = (maximum[axis] - minimum[axis]) * 0.5f;
+
+		for (int k = 0; k < 3; k++)
+			box.center[k] += box.axes[axis][k] * middle;
+	}
+
+	for (int axis = 0; axis < 3; axis++)
+		box.halfExtents[axis] += _roundingSlack(box.center, box.halfExtents[axis]);
+
+	// PCA is thrown off by uneven vertex density, it is not always the tighter box
+	float volume = box.halfExtents[0] * box.halfExtents[1] * box.halfExtents[2];
+	float alignedVolume = aligned.halfExtents[0] * aligned.halfExtents[1] * aligned.halfExtents[2];
+	return volume < alignedVolume ? box : aligned;
+}
+
+AABB MeshBounds::aabbMerge(const AABB &a, const AABB &b) {
+	float min[3] = { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) };
+	float max[3] = { std::max(a.x + a.w, b.x + b.w), std::max(a.y + a.h, b.y + b.h), std::max(a.z + a.d, b.z + b.d) };
+
+	AABB aabb;
+	aabb.x = min[0];
+	aabb.y = min[1];
+	aabb.z = min[2];
+
+	aabb.w = max[0] - min[0];
+	aabb.h = max[1] - min[1];
+	aabb.d = max[2] - min[2];
+	return aabb;
+}
+
+BoundingSphere MeshBounds::sphereMerge(const BoundingSphere &a, const BoundingSphere &b) {
+	float d = std::sqrt(_distanceSquared(a.center, b.center));
+
+	if (d + b.radius <= a.radius)
+		return a;
+
+	if (d + a.radius <= b.radius)
+		return b;
+
+	// spans both spheres along the line through their centers
+	BoundingSphere sphere;
+	sphere.radius = (d + a.radius + b.radius) * 0.5f;
+
+	float t = (sphere.radius - a.radius) / d;
+	for (int k = 0; k < 3; k++)
+		sphere.center[k] = a.center[k] + (b.center[k] - a.center[k]) * t;
+
+	return sphere;
+}
+
+void MeshBounds::meshBoundsCompute(Mesh &mesh) {
+	mesh.aabb = {};
+	mesh.sphere = {};
+
+	bool first = true;
+	for (uint32_t i = 0; i < mesh.primitiveCount; i++) {
+		const Primitive &primitive = mesh.primitives[i];
+		if (primitive.vertices.count == 0)
+			continue;
+
+		mesh.aabb = first ? primitive.aabb : aabbMerge(mesh.aabb, primitive.aabb);
+		mesh.sphere = first ? primitive.sphere : sphereMerge(mesh.sphere, primitive.sphere);
+		first = false;
+	}
+}
+
+AABB MeshBounds::aabbTransform(const AABB &aabb, const mat4 &matrix) {
+	float center[3], halfExtents[3];
+	_aabbCenter(aabb, center, halfExtents);
+
+	float worldCenter[4], worldExtents[4];
+
+#ifdef __SSE2__
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	__m128 x = _mm_loadu_ps(&matrix.x.x);
+	__m128 y = _mm_loadu_ps(&matrix.y.x);
+	__m128 z = _mm_loadu_ps(&matrix.z.x);
+	__m128 w = _mm_loadu_ps(&matrix.w.x);
+
+	__m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(center[0])), _mm_mul_ps(y, _mm_set1_ps(center[1]))),
+			_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(center[2])), w));
+
+	__m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, x), _mm_set1_ps(halfExtents[0])),
+								  _mm_mul_ps(_mm_andnot_ps(signMask, y), _mm_set1_ps(halfExtents[1]))),
+			_mm_mul_ps(_mm_andnot_ps(signMask, z), _mm_set1_ps(halfExtents[2])));
+
+	_mm_storeu_ps(worldCenter, c);
+	_mm_storeu_ps(worldExtents, e);
+#else
+	const vec4 *columns[3] = { &matrix.x, &matrix.y, &matrix.z };
+	const float *translation = &matrix.w.x;
+
+	for (int r = 0; r < 3; r++) {
+		worldCenter[r] = translation[r];
+		worldExtents[r] = 0.0f;
+
+		for (int c = 0; c < 3; c++) {
+			const float *column = &columns[c]->x;
+			worldCenter[r] += column[r] * center[c];
+			worldExtents[r] += std::fabs(column[r]) * halfExtents[c];
+		}
+	}
+#endif
+
+	AABB out;
+	out.x = worldCenter[0] - worldExtents[0];
+	out.y = worldCenter[1] - worldExtents[1];
+	out.z = worldCenter[2] - worldExtents[2];
+
+	out.w = worldExtents[0] * 2.0f;
+	out.h = worldExtents[1] * 2.0f;
+	out.d = worldExtents[2] * 2.0f;
+	return out;
+}
+
+BoundingSphere MeshBounds::sphereTransform(const BoundingSphere &sphere, const mat4 &matrix) {
+	const float *columns[3] = { &matrix.x.x, &matrix.y.x, &matrix.z.x };
+	const float *translation = &matrix.w.x;
+
+	BoundingSphere out;
+	float scale = 0.0f;
+
+	for (int r = 0; r < 3; r++) {
+		out.center[r] = translation[r] + columns[0][r] * sphere.center[0] + columns[1][r] * sphere.center[1] +
+				columns[2][r] * sphere.center[2];
+
+		scale = std::max(scale, _dot(columns[r], columns[r]));
+	}
+
+	out.radius = sphere.radius * std::sqrt(scale);
+	return out;
+}
+
+void MeshBounds::worldBoundsUpdate(
+		const Hierarchy &hierarchy, const Mesh *meshes, AABB *aabbs, BoundingSphere *spheres, ThreadPool *pool) {
+	auto nodesUpdate = [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			const mat4 &world = hierarchy.worlds[i];
+
+			if (hierarchy.meshIndices[i] == NO_MESH) {
+				aabbs[i] = { world.w.x, world.w.y, world.w.z, 0.0f, 0.0f, 0.0f };
+				spheres[i] = { { world.w.x, world.w.y, world.w.z }, 0.0f };
+				continue;
+			}
+
+			const Mesh &mesh = meshes[hierarchy.meshIndices[i]];
+			aabbs[i] = aabbTransform(mesh.aabb, world);
+			spheres[i] = sphereTransform(mesh.sphere, world);
+		}
+	};
+
+	const uint32_t chunks = (hierarchy.count + NODE_CHUNK - 1) / NODE_CHUNK;
+	if (pool == nullptr || chunks <= 1) {
+		nodesUpdate(0, hierarchy.count);
+		return;
+	}
+
+	pool->parallelFor(chunks, [&](uint32_t chunk) {
+		uint32_t begin = chunk * NODE_CHUNK;
+		nodesUpdate(begin, std::min(begin + NODE_CHUNK, hierarchy.count));
+	});
+}
@@ -0,0 +1,52 @@
+#ifndef MESH_BOUNDS_H
+#define MESH_BOUNDS_H
+
+#include <cstdint>
+
+#include <io/types/aabb.h>
+#include <io/types/bounds.h>
+#include <io/types/hierarchy.h>
+#include <io/types/mesh.h>
+
+#include <math/types/mat4.h>
+
+class ThreadPool;
+
+// Bounding volumes computed from the decoded positions rather than taken from
+// the exporter, and their transformation into world space. The AABB pass and
+// the world transforms use SSE2 where available.
+class MeshBounds {
+public:
+	// Exact AABB of the positions, zero for an empty array.
+	static AABB aabbCompute(const VertexArray &vertices);
+
+	// True when every face of stored lies within tolerance times the largest extent of computed.
+	static bool aabbMatches(const AABB &stored, const AABB &computed, float tolerance);
+
+	// Ritter's sphere seeded with the most distant pair of extremes along seven directions.
+	// Falls back to the sphere around aabb, the AABB of the same vertices, when that one is smaller.
+	static BoundingSphere sphereCompute(const VertexArray &vertices, const AABB &aabb);
+
+	// Box along the principal axes of the positions, or aabbBox(aabb) when that has the smaller volume.
+	static OrientedBox orientedBoxCompute(const VertexArray &vertices, const AABB &aabb);
+	static OrientedBox aabbBox(const AABB &aabb);
+
+	static AABB aabbMerge(const AABB &a, const AABB &b);
+	static BoundingSphere sphereMerge(const BoundingSphere &a, const BoundingSphere &b);
+
+	// Sets mesh.aabb and mesh.sphere from the primitives that have vertices.
+	static void meshBoundsCompute(Mesh &mesh);
+
+	// Arvo's method: the transformed center plus the extents summed over the absolute matrix columns.
+	static AABB aabbTransform(const AABB &aabb, const math::mat4 &matrix);
+
+	// The radius grows with the largest axis scale of matrix.
+	static BoundingSphere sphereTransform(const BoundingSphere &sphere, const math::mat4 &matrix);
+
+	// World bounds of every node's mesh from the current world transforms, aabbs and
+	// spheres hold hierarchy.count entries. Call again after TransformHierarchy::worldsUpdate.
+	static void worldBoundsUpdate(const Hierarchy &hierarchy, const Mesh *meshes, AABB *aabbs,
+			BoundingSphere *spheres, ThreadPool *pool = nullptr);
+};
+
+#endif // !MESH_BOUNDS_H
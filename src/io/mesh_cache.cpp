@@ -0,0 +1,456 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <core/arena.h>
+#include <core/mapped_file.h>
+
+#include <io/types/hierarchy.h>
+#include <io/types/mesh.h>
+#include <io/types/scene.h>
+#include <io/types/texture.h>
+#include <io/types/vertex.h>
+
+#include "mesh_cache.h"
+
+const char MAGIC[4] = { 'R', 'M', 'S', 'H' };
+const uint64_t DATA_ALIGNMENT = 16;
+
+static uint64_t _align(uint64_t offset) {
+	return (offset + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+static bool _padWrite(FILE *file, uint64_t offset) {
+	const uint8_t zeros[DATA_ALIGNMENT] = {};
+	uint64_t padding = _align(offset) - offset;
+	return fwrite(zeros, 1, padding, file) == padding;
+}
+
+// Places an array at the next aligned offset, returns where it starts.
+static uint64_t _arrayPlace(uint64_t &offset, uint64_t size) {
+	uint64_t start = _align(offset);
+	offset = start + size;
+	return start;
+}
+
+static bool _arrayWrite(FILE *file, uint64_t &offset, const void *data, uint64_t size) {
+	if (!_padWrite(file, offset))
+		return false;
+
+	offset = _align(offset) + size;
+	return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+typedef struct {
+	uint64_t levelOffsets;
+	uint64_t parents;
+	uint64_t meshIndices;
+	uint64_t locals;
+	uint64_t worlds;
+	uint64_t dirty;
+} HierarchyOffsets;
+
+// Same placement for reading and writing, offset ends up behind the last array.
+static HierarchyOffsets _hierarchyPlace(uint64_t &offset, uint32_t nodeCount, uint32_t levelCount) {
+	HierarchyOffsets offsets;
+	offsets.levelOffsets = _arrayPlace(offset, (levelCount + 1ull) * sizeof(uint32_t));
+	offsets.parents = _arrayPlace(offset, nodeCount * sizeof(uint32_t));
+	offsets.meshIndices = _arrayPlace(offset, nodeCount * sizeof(uint32_t));
+	offsets.locals = _arrayPlace(offset, nodeCount * sizeof(Transform));
+	offsets.worlds = _arrayPlace(offset, nodeCount * sizeof(math::mat4));
+	offsets.dirty = _arrayPlace(offset, nodeCount);
+	return offsets;
+}
+
+// offset + count * size <= end, without the sum wrapping around for offsets read from a corrupt file.
+static bool _rangeValid(uint64_t offset, uint64_t count, uint64_t size, uint64_t end) {
+	return offset <= end && count <= (end - offset) / size;
+}
+
+// Every index below vertexCount, consumers index the mapped vertices without checking.
+static bool _indicesValid(const uint32_t *indices, uint64_t count, uint32_t vertexCount) {
+	uint32_t largest = 0;
+	for (uint64_t i = 0; i < count; i++)
+		largest = std::max(largest, indices[i]);
+
+	return count == 0 || largest < vertexCount;
+}
+
+// Meshlet ranges inside the shared lists, their vertices inside the primitive and their triangles inside the
+// meshlet's own vertices.
+static bool _meshletsValid(const MeshletArray &meshlets, uint32_t vertexCount) {
+	for (uint32_t i = 0; i < meshlets.count; i++) {
+		const Meshlet &meshlet = meshlets.data[i];
+		if ((uint64_t)meshlet.vertexOffset + meshlet.vertexCount > meshlets.vertexCount)
+			return false;
+
+		if ((uint64_t)meshlet.triangleOffset + meshlet.triangleCount > meshlets.triangleCount)
+			return false;
+
+		if (!_indicesValid(meshlets.vertices + meshlet.vertexOffset, meshlet.vertexCount, vertexCount))
+			return false;
+
+		const uint8_t *triangles = meshlets.triangles + meshlet.triangleOffset * 3ull;
+		for (uint32_t j = 0; j < meshlet.triangleCount * 3; j++) {
+			if (triangles[j] >= meshlet.vertexCount)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void MeshCache::pathGet(const char *directory, uint64_t key, char *path, size_t size) {
+	snprintf(path, size, "%s/%016" PRIx64 ".mesh", directory, key);
+}
+
+bool MeshCache::sceneRead(const char *path, uint64_t key, Scene *scene) {
+	MappedFile file;
+	if (!fileMap(path, &file, true))
+		return false;
+
+	const uint8_t *base = reinterpret_cast<const uint8_t *>(file.data);
+	uint8_t *data = reinterpret_cast<uint8_t *>(file.data);
+
+	if (file.size < sizeof(Header)) {
+		fileUnmap(file);
+		return false;
+	}
+
+	const Header *header = reinterpret_cast<const Header *>(base);
+
+	bool valid = memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0;
+	valid = valid && header->version == MESH_CACHE_VERSION;
+	valid = valid && header->key == key;
+	valid = valid && header->vertexSize == sizeof(Vertex);
+	valid = valid && header->fileSize == file.size;
+
+	uint64_t recordsEnd = sizeof(Header) + header->meshCount * sizeof(MeshRecord) +
+			header->primitiveCount * sizeof(PrimitiveRecord);
+	valid = valid && recordsEnd <= file.size;
+
+	if (!valid) {
+		fileUnmap(file);
+		return false;
+	}
+
+	const MeshRecord *meshRecords = reinterpret_cast<const MeshRecord *>(base + sizeof(Header));
+	const PrimitiveRecord *primitiveRecords =
+			reinterpret_cast<const PrimitiveRecord *>(base + sizeof(Header) + header->meshCount * sizeof(MeshRecord));
+
+	for (uint32_t i = 0; i < header->primitiveCount; i++) {
+		const PrimitiveRecord &record = primitiveRecords[i];
+		valid = valid && _rangeValid(record.indexOffset, record.indexCount, sizeof(uint32_t), file.size);
+		valid = valid && _rangeValid(record.vertexOffset, record.vertexCount, sizeof(Vertex), file.size);
+		valid = valid && _rangeValid(record.meshletOffset, record.meshletCount, sizeof(Meshlet), file.size);
+		valid = valid &&
+				_rangeValid(record.meshletVertexOffset, record.meshletVertexCount, sizeof(uint32_t), file.size);
+		valid = valid && _rangeValid(record.meshletTriangleOffset, record.meshletTriangleCount, 3, file.size);
+		valid = valid && _rangeValid(record.lodOffset, record.lodCount, sizeof(LodRecord), file.size);
+
+		const LodRecord *lodRecords = reinterpret_cast<const LodRecord *>(base + record.lodOffset);
+		for (uint32_t j = 0; j < record.lodCount && valid; j++)
+			valid = _rangeValid(lodRecords[j].indexOffset, lodRecords[j].indexCount, sizeof(uint32_t), file.size);
+
+		// a corrupt entry with an intact header must not send consumers outside the vertices
+		const uint32_t *indices = reinterpret_cast<const uint32_t *>(base + record.indexOffset);
+		valid = valid && _indicesValid(indices, record.indexCount, record.vertexCount);
+
+		MeshletArray meshlets = {};
+		meshlets.data = reinterpret_cast<Meshlet *>(data + record.meshletOffset);
+		meshlets.count = record.meshletCount;
+		meshlets.vertices = reinterpret_cast<uint32_t *>(data + record.meshletVertexOffset);
+		meshlets.vertexCount = record.meshletVertexCount;
+		meshlets.triangles = data + record.meshletTriangleOffset;
+		meshlets.triangleCount = record.meshletTriangleCount;
+		valid = valid && _meshletsValid(meshlets, record.vertexCount);
+
+		for (uint32_t j = 0; j < record.lodCount && valid; j++) {
+			const uint32_t *lodIndices = reinterpret_cast<const uint32_t *>(base + lodRecords[j].indexOffset);
+			valid = _indicesValid(lodIndices, lodRecords[j].indexCount, record.vertexCount);
+		}
+	}
+
+	uint64_t hierarchyEnd = header->hierarchyOffset;
+	HierarchyOffsets hierarchyOffsets = _hierarchyPlace(hierarchyEnd, header->nodeCount, header->levelCount);
+	valid = valid && header->hierarchyOffset <= file.size && hierarchyEnd <= file.size;
+
+	// worldsUpdate relies on the level ranges and on parents coming first
+	if (valid) {
+		const uint32_t *levelOffsets = reinterpret_cast<const uint32_t *>(base + hierarchyOffsets.levelOffsets);
+		const uint32_t *parents = reinterpret_cast<const uint32_t *>(base + hierarchyOffsets.parents);
+
+		valid = levelOffsets[0] == 0 && levelOffsets[header->levelCount] == header->nodeCount;
+		for (uint32_t i = 0; i < header->levelCount && valid; i++)
+			valid = levelOffsets[i] <= levelOffsets[i + 1];
+
+		for (uint32_t i = 0; i < header->nodeCount && valid; i++)
+			valid = parents[i] == NO_PARENT || parents[i] < i;
+
+		const uint32_t *meshIndices = reinterpret_cast<const uint32_t *>(base + hierarchyOffsets.meshIndices);
+		for (uint32_t i = 0; i < header->nodeCount && valid; i++)
+			valid = meshIndices[i] == NO_MESH || meshIndices[i] < header->meshCount;
+	}
+
+	for (uint32_t i = 0; i < header->meshCount; i++) {
+		const MeshRecord &record = meshRecords[i];
+		valid = valid && (uint64_t)record.firstPrimitive + record.primitiveCount <= header->primitiveCount;
+	}
+
+	const TextureRecord *textureRecords = reinterpret_cast<const TextureRecord *>(base + header->textureOffset);
+	valid = valid && _rangeValid(header->textureOffset, header->textureCount, sizeof(TextureRecord), file.size);
+
+	for (uint32_t i = 0; i < header->textureCount && valid; i++) {
+		const TextureRecord &record = textureRecords[i];
+		valid = _rangeValid(record.dataOffset, record.size, 1, file.size) && record.mipCount <= TEXTURE_MAX_MIPS;
+		valid = valid && record.format < TEXTURE_FORMAT_COUNT;
+
+		for (uint32_t j = 0; j < record.mipCount && valid; j++)
+			valid = _rangeValid(record.mips[j].offset, record.mips[j].size, 1, record.size);
+	}
+
+	if (!valid) {
+		fileUnmap(file);
+		return false;
+	}
+
+	Scene _scene = {};
+	_scene.meshCount = header->meshCount;
+	_scene.arena = new Arena();
+	_scene.meshes = _scene.arena->arrayAllocate<Mesh>(header->meshCount, true);
+	_scene.cacheFile = file;
+
+	Hierarchy &hierarchy = _scene.hierarchy;
+	hierarchy.count = header->nodeCount;
+	hierarchy.levelCount = header->levelCount;
+	hierarchy.levelOffsets = reinterpret_cast<uint32_t *>(data + hierarchyOffsets.levelOffsets);
+	hierarchy.parents = reinterpret_cast<uint32_t *>(data + hierarchyOffsets.parents);
+	hierarchy.meshIndices = reinterpret_cast<uint32_t *>(data + hierarchyOffsets.meshIndices);
+	hierarchy.locals = reinterpret_cast<Transform *>(data + hierarchyOffsets.locals);
+	hierarchy.worlds = reinterpret_cast<math::mat4 *>(data + hierarchyOffsets.worlds);
+	hierarchy.dirty = data + hierarchyOffsets.dirty;
+	hierarchy.dirtyLevel = header->levelCount;
+
+	_scene.textureCount = header->textureCount;
+	_scene.textures = _scene.arena->arrayAllocate<Texture>(header->textureCount, true);
+
+	for (uint32_t i = 0; i < header->textureCount; i++) {
+		const TextureRecord &record = textureRecords[i];
+
+		Texture &texture = _scene.textures[i];
+		texture.data = data + record.dataOffset;
+		texture.size = record.size;
+		texture.width = record.width;
+		texture.height = record.height;
+		texture.mipCount = record.mipCount;
+		texture.format = (TextureFormat)record.format;
+		texture.srgb = record.srgb != 0;
+		memcpy(texture.mips, record.mips, sizeof(record.mips));
+	}
+
+	for (uint32_t i = 0; i < header->meshCount; i++) {
+		const MeshRecord &meshRecord = meshRecords[i];
+
+		Mesh &mesh = _scene.meshes[i];
+		mesh.primitiveCount = meshRecord.primitiveCount;
+		mesh.primitives = _scene.arena->arrayAllocate<Primitive>(meshRecord.primitiveCount, true);
+
+		for (uint32_t j = 0; j < meshRecord.primitiveCount; j++) {
+			const PrimitiveRecord &record = primitiveRecords[meshRecord.firstPrimitive + j];
+
+			Primitive &primitive = mesh.primitives[j];
+			primitive.aabb = record.aabb;
+			primitive.sphere = record.sphere;
+			primitive.box = record.box;
+			primitive.materialIndex = record.materialIndex;
+
+			primitive.indices.count = record.indexCount;
+			primitive.indices.data = reinterpret_cast<uint32_t *>(data + record.indexOffset);
+
+			primitive.vertices.count = record.vertexCount;
+			primitive.vertices.data = reinterpret_cast<Vertex *>(data + record.vertexOffset);
+
+			primitive.meshlets.count = record.meshletCount;
+			primitive.meshlets.data = reinterpret_cast<Meshlet *>(data + record.meshletOffset);
+			primitive.meshlets.vertexCount = record.meshletVertexCount;
+			primitive.meshlets.vertices = reinterpret_cast<uint32_t *>(data + record.meshletVertexOffset);
+			primitive.meshlets.triangleCount = record.meshletTriangleCount;
+			primitive.meshlets.triangles = data + record.meshletTriangleOffset;
+
+			const LodRecord *lodRecords = reinterpret_cast<const LodRecord *>(data + record.lodOffset);
+			primitive.lods.count = record.lodCount;
+			primitive.lods.data = _scene.arena->arrayAllocate<Lod>(record.lodCount);
+
+			for (uint32_t k = 0; k < record.lodCount; k++) {
+				Lod &lod = primitive.lods.data[k];
+				lod.error = lodRecords[k].error;
+				lod.indices.count = lodRecords[k].indexCount;
+				lod.indices.data = reinterpret_cast<uint32_t *>(data + lodRecords[k].indexOffset);
+			}
+		}
+	}
+
+	*scene = _scene;
+	return true;
+}
+
+bool MeshCache::sceneWrite(const char *path, uint64_t key, const Scene &scene) {
+	Header header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = MESH_CACHE_VERSION;
+	header.key = key;
+	header.vertexSize = sizeof(Vertex);
+	header.meshCount = scene.meshCount;
+	header.nodeCount = scene.hierarchy.count;
+	header.levelCount = scene.hierarchy.levelCount;
+	header.textureCount = scene.textureCount;
+
+	for (uint32_t i = 0; i < scene.meshCount; i++)
+		header.primitiveCount += scene.meshes[i].primitiveCount;
+
+	MeshRecord *meshRecords = (MeshRecord *)calloc(header.meshCount, sizeof(MeshRecord));
+	PrimitiveRecord *primitiveRecords = (PrimitiveRecord *)calloc(header.primitiveCount, sizeof(PrimitiveRecord));
+
+	uint64_t offset = sizeof(Header) + header.meshCount * sizeof(MeshRecord) +
+			header.primitiveCount * sizeof(PrimitiveRecord);
+
+	uint32_t primitiveIndex = 0;
+	for (uint32_t i = 0; i < scene.meshCount; i++) {
+		const Mesh &mesh = scene.meshes[i];
+
+		meshRecords[i].firstPrimitive = primitiveIndex;
+		meshRecords[i].primitiveCount = mesh.primitiveCount;
+
+		for (uint32_t j = 0; j < mesh.primitiveCount; j++) {
+			const Primitive &primitive = mesh.primitives[j];
+
+			PrimitiveRecord &record = primitiveRecords[primitiveIndex++];
+			record.aabb = primitive.aabb;
+			record.sphere = primitive.sphere;
+			record.box = primitive.box;
+			record.materialIndex = primitive.materialIndex;
+			record.indexCount = primitive.indices.count;
+			record.vertexCount = primitive.vertices.count;
+			record.meshletCount = primitive.meshlets.count;
+			record.meshletVertexCount = primitive.meshlets.vertexCount;
+			record.meshletTriangleCount = primitive.meshlets.triangleCount;
+			record.lodCount = primitive.lods.count;
+
+			record.indexOffset = _arrayPlace(offset, record.indexCount * sizeof(uint32_t));
+			record.vertexOffset = _arrayPlace(offset, record.vertexCount * sizeof(Vertex));
+			record.meshletOffset = _arrayPlace(offset, record.meshletCount * sizeof(Meshlet));
+			record.meshletVertexOffset = _arrayPlace(offset, record.meshletVertexCount * sizeof(uint32_t));
+			record.meshletTriangleOffset = _arrayPlace(offset, record.meshletTriangleCount * 3);
+			record.lodOffset = _arrayPlace(offset, record.lodCount * sizeof(LodRecord));
+
+			for (uint32_t k = 0; k < primitive.lods.count; k++)
+				_arrayPlace(offset, primitive.lods.data[k].indices.count * sizeof(uint32_t));
+		}
+	}
+
+	header.hierarchyOffset = offset;
+	_hierarchyPlace(offset, header.nodeCount, header.levelCount);
+
+	header.textureOffset = _arrayPlace(offset, header.textureCount * sizeof(TextureRecord));
+
+	std::vector<TextureRecord> textureRecords(header.textureCount);
+	for (uint32_t i = 0; i < header.textureCount; i++) {
+		const Texture &texture = scene.textures[i];
+
+		TextureRecord &record = textureRecords[i];
+		record.width = texture.width;
+		record.height = texture.height;
+		record.mipCount = texture.mipCount;
+		record.format = texture.format;
+		record.srgb = texture.srgb ? 1 : 0;
+		record.size = texture.size;
+		record.dataOffset = _arrayPlace(offset, texture.size);
+		memcpy(record.mips, texture.mips, sizeof(record.mips));
+	}
+
+	header.fileSize = offset;
+
+	char temporaryPath[4096];
+	snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path);
+
+	FILE *file = fopen(temporaryPath, "wb");
+	if (file == nullptr) {
+		free(meshRecords);
+		free(primitiveRecords);
+		return false;
+	}
+
+	bool success = fwrite(&header, sizeof(Header), 1, file) == 1;
+	success = success && fwrite(meshRecords, sizeof(MeshRecord), header.meshCount, file) == header.meshCount;
+	success = success &&
+			fwrite(primitiveRecords, sizeof(PrimitiveRecord), header.primitiveCount, file) == header.primitiveCount;
+
+	offset = sizeof(Header) + header.meshCount * sizeof(MeshRecord) + header.primitiveCount * sizeof(PrimitiveRecord);
+
+	for (uint32_t i = 0; i < scene.meshCount && success; i++) {
+		const Mesh &mesh = scene.meshes[i];
+
+		for (uint32_t j = 0; j < mesh.primitiveCount && success; j++) {
+			const Primitive &primitive = mesh.primitives[j];
+			const IndexArray &indices = primitive.indices;
+			const VertexArray &vertices = primitive.vertices;
+			const MeshletArray &meshlets = primitive.meshlets;
+
+			success = success && _arrayWrite(file, offset, indices.data, indices.count * sizeof(uint32_t));
+			success = success && _arrayWrite(file, offset, vertices.data, vertices.count * sizeof(Vertex));
+			success = success && _arrayWrite(file, offset, meshlets.data, meshlets.count * sizeof(Meshlet));
+			success = success && _arrayWrite(file, offset, meshlets.vertices, meshlets.vertexCount * sizeof(uint32_t));
+			success = success && _arrayWrite(file, offset, meshlets.triangles, meshlets.triangleCount * 3);
+
+			// level indices follow their records, placed the same way as above
+			const LodArray &lods = primitive.lods;
+			std::vector<LodRecord> lodRecords(lods.count);
+
+			uint64_t lodOffset = _align(offset) + lods.count * sizeof(LodRecord);
+			for (uint32_t k = 0; k < lods.count; k++) {
+				lodRecords[k].indexCount = lods.data[k].indices.count;
+				lodRecords[k].error = lods.data[k].error;
+				lodRecords[k].indexOffset = _arrayPlace(lodOffset, lods.data[k].indices.count * sizeof(uint32_t));
+			}
+
+			success = success && _arrayWrite(file, offset, lodRecords.data(), lods.count * sizeof(LodRecord));
+			for (uint32_t k = 0; k < lods.count; k++) {
+				const IndexArray &lodIndices = lods.data[k].indices;
+				success = success && _arrayWrite(file, offset, lodIndices.data, lodIndices.count * sizeof(uint32_t));
+			}
+		}
+	}
+
+	// written with its worlds current, so the dirty flags are all clear
+	const Hierarchy &hierarchy = scene.hierarchy;
+	const uint64_t nodeCount = hierarchy.count;
+	const uint64_t levelCount = hierarchy.levelCount;
+
+	success = success && _arrayWrite(file, offset, hierarchy.levelOffsets, (levelCount + 1) * sizeof(uint32_t));
+	success = success && _arrayWrite(file, offset, hierarchy.parents, nodeCount * sizeof(uint32_t));
+	success = success && _arrayWrite(file, offset, hierarchy.meshIndices, nodeCount * sizeof(uint32_t));
+	success = success && _arrayWrite(file, offset, hierarchy.locals, nodeCount * sizeof(Transform));
+	success = success && _arrayWrite(file, offset, hierarchy.worlds, nodeCount * sizeof(math::mat4));
+	success = success && _arrayWrite(file, offset, hierarchy.dirty, nodeCount);
+
+	success = success &&
+			_arrayWrite(file, offset, textureRecords.data(), header.textureCount * sizeof(TextureRecord));
+	for (uint32_t i = 0; i < header.textureCount && success; i++)
+		success = _arrayWrite(file, offset, scene.textures[i].data, scene.textures[i].size);
+
+	success = (fclose(file) == 0) && success;
+
+	free(meshRecords);
+	free(primitiveRecords);
+
+	if (!success || rename(temporaryPath, path) != 0) {
+		remove(temporaryPath);
+		return false;
+	}
+
+	return true;
+}
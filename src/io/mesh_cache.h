@@ -0,0 +1,100 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <io/types/scene.h>
+
+// Bump whenever the file layout, Vertex or the import pipeline output changes.
+const uint32_t MESH_CACHE_VERSION = 8;
+
+// Baked, upload-ready scene data keyed by a hash of the source file.
+//
+// File layout, all offsets relative to the start of the file:
+//   Header
+//   MeshRecord[meshCount]
+//   PrimitiveRecord[primitiveCount]
+//   per primitive, each array 16 byte aligned:
+//     uint32_t indices[], Vertex vertices[],
+//     Meshlet meshlets[], uint32_t meshletVertices[], uint8_t meshletTriangles[][3],
+//     LodRecord lods[], per level uint32_t indices[]
+//   hierarchy at hierarchyOffset, each array 16 byte aligned:
+//     uint32_t levelOffsets[levelCount + 1], uint32_t parents[], uint32_t meshIndices[],
+//     Transform locals[], mat4 worlds[], uint8_t dirty[]
+//   TextureRecord[textureCount] at textureOffset
+//   per texture, 16 byte aligned: uint8_t data[] holding the whole mip chain
+class MeshCache {
+private:
+	typedef struct {
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		uint32_t vertexSize;
+		uint32_t meshCount;
+		uint32_t primitiveCount;
+		uint32_t nodeCount;
+		uint64_t fileSize;
+		uint32_t levelCount;
+		uint32_t textureCount;
+		uint64_t hierarchyOffset;
+		uint64_t textureOffset;
+	} Header;
+
+	typedef struct {
+		uint32_t firstPrimitive;
+		uint32_t primitiveCount;
+	} MeshRecord;
+
+	typedef struct {
+		AABB aabb;
+		BoundingSphere sphere;
+		OrientedBox box;
+		uint32_t materialIndex;
+		uint32_t indexCount;
+		uint32_t vertexCount;
+		uint32_t meshletCount;
+		uint32_t meshletVertexCount;
+		uint32_t meshletTriangleCount;
+		uint32_t lodCount;
+		uint64_t indexOffset;
+		uint64_t vertexOffset;
+		uint64_t meshletOffset;
+		uint64_t meshletVertexOffset;
+		uint64_t meshletTriangleOffset;
+		uint64_t lodOffset;
+	} PrimitiveRecord;
+
+	typedef struct {
+		uint32_t indexCount;
+		float error;
+		uint64_t indexOffset;
+	} LodRecord;
+
+	typedef struct {
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+		uint32_t format;
+		uint32_t srgb;
+		uint32_t reserved;
+		uint64_t dataOffset;
+		uint64_t size;
+		MipLevel mips[TEXTURE_MAX_MIPS];
+	} TextureRecord;
+
+public:
+	// Writes "<directory>/<key as hex>.mesh" into path.
+	static void pathGet(const char *directory, uint64_t key, char *path, size_t size);
+
+	// Maps the cache file and builds a scene pointing into it, only the mesh,
+	// primitive, level and texture tables live in the scene arena. The mapping is copy on
+	// write, so the hierarchy can be edited in place. Returns false on a
+	// missing, stale or corrupt entry, scene is left untouched then.
+	static bool sceneRead(const char *path, uint64_t key, Scene *scene);
+
+	// Writes to a temporary file first and renames it, readers never see a partial entry.
+	static bool sceneWrite(const char *path, uint64_t key, const Scene &scene);
+};
+
+#endif // !MESH_CACHE_H
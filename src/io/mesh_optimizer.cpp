@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <io/types/aabb.h>
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include "mesh_optimizer.h"
+
+// Scoring from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation".
+const int32_t FORSYTH_CACHE_SIZE = 32;
+const uint32_t FORSYTH_MAX_VALENCE = 64;
+const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+typedef struct {
+	float cache[FORSYTH_CACHE_SIZE];
+	float valence[FORSYTH_MAX_VALENCE];
+} ScoreTable;
+
+static ScoreTable _scoreTableBuild() {
+	ScoreTable table;
+
+	for (int32_t i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+		if (i < 3) {
+			// the last triangle's vertices score the same regardless of order
+			table.cache[i] = FORSYTH_LAST_TRIANGLE_SCORE;
+		} else {
+			float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			table.cache[i] = std::pow(1.0f - (i - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+		}
+	}
+
+	table.valence[0] = 0.0f;
+	for (uint32_t i = 1; i < FORSYTH_MAX_VALENCE; i++)
+		table.valence[i] = FORSYTH_VALENCE_BOOST_SCALE * std::pow((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+
+	return table;
+}
+
+static inline float _vertexScore(const ScoreTable &table, int32_t cachePosition, uint32_t valence) {
+	// no triangles left, the vertex is of no use
+	if (valence == 0)
+		return -1.0f;
+
+	float score = cachePosition >= 0 ? table.cache[cachePosition] : 0.0f;
+	return score + table.valence[std::min(valence, FORSYTH_MAX_VALENCE - 1)];
+}
+
+VertexCacheStats MeshOptimizer::vertexCacheAnalyze(const IndexArray &indices, uint32_t vertexCount) {
+	VertexCacheStats stats = {};
+	if (indices.count == 0 || vertexCount == 0)
+		return stats;
+
+	// FIFO cache, timestamps tell whether a vertex is still inside
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t time = VERTEX_CACHE_SIZE + 1;
+	uint32_t misses = 0;
+
+	for (uint32_t i = 0; i < indices.count; i++) {
+		uint32_t index = indices.data[i];
+		if (time - timestamps[index] > VERTEX_CACHE_SIZE) {
+			timestamps[index] = time++;
+			misses++;
+		}
+	}
+
+	stats.transforms = misses;
+	stats.acmr = (float)misses / (indices.count / 3);
+	stats.atvr = (float)misses / vertexCount;
+	return stats;
+}
+
+void MeshOptimizer::vertexCacheOptimize(IndexArray &indices, uint32_t vertexCount) {
+	const uint32_t faceCount = indices.count / 3;
+	if (faceCount == 0)
+		return;
+
+	static const ScoreTable table = _scoreTableBuild();
+
+	// live triangles of each vertex, emitted ones are swapped past the valence
+	std::vector<uint32_t> valences(vertexCount, 0);
+	for (uint32_t i = 0; i < indices.count; i++)
+		valences[indices.data[i]]++;
+
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		offsets[i + 1] = offsets[i] + valences[i];
+
+	std::vector<uint32_t> adjacency(indices.count);
+	{
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < indices.count; i++)
+			adjacency[cursor[indices.data[i]]++] = i / 3;
+	}
+
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		vertexScores[i] = _vertexScore(table, -1, valences[i]);
+
+	std::vector<bool> emitted(faceCount, false);
+	std::vector<uint32_t> result(indices.count);
+
+	uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+	uint32_t cacheSize = 0;
+
+	uint32_t scanCursor = 0;
+	int64_t bestFace = -1;
+
+	for (uint32_t output = 0; output < faceCount; output++) {
+		if (bestFace < 0) {
+			// nothing in the cache has triangles left, take the next unused one
+			while (emitted[scanCursor])
+				scanCursor++;
+
+			bestFace = scanCursor;
+		}
+
+		const uint32_t *face = &indices.data[bestFace * 3];
+		memcpy(&result[output * 3], face, sizeof(uint32_t) * 3);
+		emitted[bestFace] = true;
+
+		// drop the face from its vertices' live lists
+		for (int k = 0; k < 3; k++) {
+			uint32_t vertex = face[k];
+			uint32_t *list = &adjacency[offsets[vertex]];
+
+			for (uint32_t j = 0; j < valences[vertex]; j++) {
+				if (list[j] != bestFace)
+					continue;
+
+				std::swap(list[j], list[valences[vertex] - 1]);
+				break;
+			}
+
+			valences[vertex]--;
+		}
+
+		// emitted vertices move to the front, the rest shifts back
+		uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+		uint32_t newCacheSize = 0;
+
+		for (int k = 0; k < 3; k++)
+			newCache[newCacheSize++] = face[k];
+
+		for (uint32_t j = 0; j < cacheSize; j++) {
+			uint32_t vertex = cache[j];
+			if (vertex != face[0] && vertex != face[1] && vertex != face[2])
+				newCache[newCacheSize++] = vertex;
+		}
+
+		// vertices pushed out of the cache lose their position score
+		for (uint32_t j = FORSYTH_CACHE_SIZE; j < newCacheSize; j++) {
+			uint32_t vertex = newCache[j];
+			vertexScores[vertex] = _vertexScore(table, -1, valences[vertex]);
+		}
+
+		cacheSize = std::min(newCacheSize, (uint32_t)FORSYTH_CACHE_SIZE);
+		memcpy(cache, newCache, cacheSize * sizeof(uint32_t));
+
+		for (uint32_t j = 0; j < cacheSize; j++)
+			vertexScores[cache[j]] = _vertexScore(table, j, valences[cache[j]]);
+
+		// only triangles touching the cache changed score, the best one is among them
+		bestFace = -1;
+		float bestScore = -1.0f;
+		for (uint32_t j = 0; j < cacheSize; j++) {
+			uint32_t vertex = cache[j];
+
+			for (uint32_t t = 0; t < valences[vertex]; t++) {
+				uint32_t f = adjacency[offsets[vertex] + t];
+				const uint32_t *fv = &indices.data[f * 3];
+
+				float score = vertexScores[fv[0]] + vertexScores[fv[1]] + vertexScores[fv[2]];
+
+				if (score > bestScore) {
+					bestScore = score;
+					bestFace = f;
+				}
+			}
+		}
+	}
+
+	memcpy(indices.data, result.data(), indices.count * sizeof(uint32_t));
+}
+
+void MeshOptimizer::overdrawOptimize(IndexArray &indices, const VertexArray &vertices, const AABB &aabb) {
+	const uint32_t faceCount = indices.count / 3;
+	if (faceCount == 0)
+		return;
+
+	// a cluster starts wherever a triangle misses the cache on all three vertices
+	std::vector<uint32_t> clusterStarts;
+	{
+		std::vector<uint32_t> timestamps(vertices.count, 0);
+		uint32_t time = VERTEX_CACHE_SIZE + 1;
+
+		for (uint32_t i = 0; i < faceCount; i++) {
+			uint32_t misses = 0;
+			for (int k = 0; k < 3; k++) {
+				uint32_t index = indices.data[i * 3 + k];
+				if (time - timestamps[index] > VERTEX_CACHE_SIZE) {
+					timestamps[index] = time++;
+					misses++;
+				}
+			}
+
+			if (i == 0 || misses == 3)
+				clusterStarts.push_back(i);
+		}
+	}
+
+	const uint32_t clusterCount = clusterStarts.size();
+	clusterStarts.push_back(faceCount);
+
+	const float center[3] = {
+		aabb.x + aabb.w * 0.5f,
+		aabb.y + aabb.h * 0.5f,
+		aabb.z + aabb.d * 0.5f,
+	};
+
+	// clusters facing away from the center sit on the outside and occlude the rest
+	std::vector<float> sortKeys(clusterCount);
+	for (uint32_t c = 0; c < clusterCount; c++) {
+		float centroid[3] = {};
+		float normal[3] = {};
+		float area = 0.0f;
+
+		for (uint32_t i = clusterStarts[c]; i < clusterStarts[c + 1]; i++) {
+			const float *p0 = vertices.data[indices.data[i * 3 + 0]].position;
+			const float *p1 = vertices.data[indices.data[i * 3 + 1]].position;
+			const float *p2 = vertices.data[indices.data[i * 3 + 2]].position;
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+			// area weighted, the cross product length is twice the area
+			float n[3] = {
+				e1[1] * e2[2] - e1[2] * e2[1],
+				e1[2] * e2[0] - e1[0] * e2[2],
+				e1[0] * e2[1] - e1[1] * e2[0],
+			};
+
+			float faceArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (int k = 0; k < 3; k++) {
+				centroid[k] += (p0[k] + p1[k] + p2[k]) * (faceArea / 3.0f);
+				normal[k] += n[k];
+			}
+
+			area += faceArea;
+		}
+
+		float normalLength = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (area <= 0.0f || normalLength <= 0.0f) {
+			sortKeys[c] = 0.0f;
+			continue;
+		}
+
+		float key = 0.0f;
+		for (int k = 0; k < 3; k++)
+			key += (centroid[k] / area - center[k]) * (normal[k] / normalLength);
+
+		sortKeys[c] = key;
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	for (uint32_t c = 0; c < clusterCount; c++)
+		order[c] = c;
+
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.count);
+
+	for (uint32_t c : order)
+		result.insert(result.end(), &indices.data[clusterStarts[c] * 3], &indices.data[clusterStarts[c + 1] * 3]);
+
+	memcpy(indices.data, result.data(), indices.count * sizeof(uint32_t));
+}
+
+void MeshOptimizer::vertexFetchOptimize(IndexArray &indices, VertexArray &vertices) {
+	const uint32_t UNUSED = ~0u;
+
+	std::vector<uint32_t> remap(vertices.count, UNUSED);
+	uint32_t next = 0;
+
+	for (uint32_t i = 0; i < indices.count; i++) {
+		uint32_t &target = remap[indices.data[i]];
+		if (target == UNUSED)
+			target = next++;
+
+		indices.data[i] = target;
+	}
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		if (remap[i] == UNUSED)
+			remap[i] = next++;
+	}
+
+	std::vector<Vertex> reordered(vertices.count);
+	for (uint32_t i = 0; i < vertices.count; i++)
+		reordered[remap[i]] = vertices.data[i];
+
+	memcpy(vertices.data, reordered.data(), vertices.count * sizeof(Vertex));
+}
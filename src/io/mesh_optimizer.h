@@ -0,0 +1,42 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstdint>
+
+#include <io/types/aabb.h>
+#include <io/types/mesh.h>
+
+// Post-transform cache efficiency of an index buffer, simulated with a FIFO
+// cache of VERTEX_CACHE_SIZE entries.
+//   transforms: vertex shader invocations, one per cache miss
+//   acmr: average cache miss ratio, vertex shader invocations per triangle, 0.5 at best
+//   atvr: average transformed vertex ratio, invocations per vertex, 1.0 at best
+typedef struct {
+	uint32_t transforms;
+	float acmr;
+	float atvr;
+} VertexCacheStats;
+
+const uint32_t VERTEX_CACHE_SIZE = 16;
+
+// Import-time passes reordering primitive data for the GPU, run in this order:
+//   vertexCacheOptimize   triangle order for post-transform cache hits (Forsyth)
+//   overdrawOptimize      cluster order so outward facing parts draw first
+//   vertexFetchOptimize   vertex order matching first use in the index buffer
+// None of them change the rendered result.
+class MeshOptimizer {
+public:
+	static VertexCacheStats vertexCacheAnalyze(const IndexArray &indices, uint32_t vertexCount);
+
+	static void vertexCacheOptimize(IndexArray &indices, uint32_t vertexCount);
+
+	// Splits the index buffer into clusters where the cache restarts and sorts
+	// them by how far they face away from the AABB center. Keeps the cache
+	// efficiency of the previous pass within each cluster.
+	static void overdrawOptimize(IndexArray &indices, const VertexArray &vertices, const AABB &aabb);
+
+	// Reorders vertices in place; unreferenced vertices move to the end.
+	static void vertexFetchOptimize(IndexArray &indices, VertexArray &vertices);
+};
+
+#endif // !MESH_OPTIMIZER_H
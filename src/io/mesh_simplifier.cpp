@@ -0,0 +1,591 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <core/arena.h>
+
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include "mesh_simplifier.h"
+
+// Planes through open border edges count this much more than surface planes.
+const double BORDER_WEIGHT = 10.0;
+
+// Collapses are ordered by the top SORT_BITS bits of their cost.
+const uint32_t SORT_BITS = 11;
+const uint32_t SORT_BUCKETS = 1 << SORT_BITS;
+
+// A level has to drop at least this share of the previous level's triangles.
+const float LOD_MIN_REDUCTION = 0.1f;
+
+typedef enum {
+	VERTEX_MANIFOLD,
+	VERTEX_BORDER,
+	VERTEX_LOCKED,
+} VertexKind;
+
+// Sum of squared distances to a set of planes, weighted: p'Ap + 2b'p + c.
+typedef struct {
+	double a00, a01, a02, a11, a12, a22;
+	double b0, b1, b2;
+	double c;
+	double weight;
+} Quadric;
+
+typedef struct {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+} Adjacency;
+
+typedef struct {
+	double cost;
+	uint32_t from;
+	uint32_t to;
+	uint32_t triangles; // removed by the collapse
+} Collapse;
+
+// Everything is indexed by vertex, per position data is only valid on the
+// representative, the first vertex with that position.
+typedef struct {
+	const VertexArray *vertices;
+
+	std::vector<double> positions; // normalized to the unit cube
+	double extent;                 // mesh units per normalized unit
+	std::vector<uint32_t> representatives;
+	std::vector<uint32_t> wedgeOffsets; // representative -> vertices sharing its position
+	std::vector<uint32_t> wedges;
+
+	std::vector<uint8_t> kinds;
+	std::vector<Quadric> quadrics;
+
+	std::vector<uint32_t> triangles; // current triangles, vertex indices
+	double error;                    // largest collapse cost so far
+} State;
+
+static void _quadricPlane(Quadric &q, const double *normal, double distance, double weight) {
+	q.a00 = normal[0] * normal[0] * weight;
+	q.a01 = normal[0] * normal[1] * weight;
+	q.a02 = normal[0] * normal[2] * weight;
+	q.a11 = normal[1] * normal[1] * weight;
+	q.a12 = normal[1] * normal[2] * weight;
+	q.a22 = normal[2] * normal[2] * weight;
+	q.b0 = normal[0] * distance * weight;
+	q.b1 = normal[1] * distance * weight;
+	q.b2 = normal[2] * distance * weight;
+	q.c = distance * distance * weight;
+	q.weight = weight;
+}
+
+static void _quadricAdd(Quadric &q, const Quadric &other) {
+	q.a00 += other.a00;
+	q.a01 += other.a01;
+	q.a02 += other.a02;
+	q.a11 += other.a11;
+	q.a12 += other.a12;
+	q.a22 += other.a22;
+	q.b0 += other.b0;
+	q.b1 += other.b1;
+	q.b2 += other.b2;
+	q.c += other.c;
+	q.weight += other.weight;
+}
+
+// Weighted mean squared distance of p to the planes.
+static double _quadricError(const Quadric &q, const double *p) {
+	double rx = q.a00 * p[0] + q.a01 * p[1] + q.a02 * p[2] + q.b0;
+	double ry = q.a01 * p[0] + q.a11 * p[1] + q.a12 * p[2] + q.b1;
+	double rz = q.a02 * p[0] + q.a12 * p[1] + q.a22 * p[2] + q.b2;
+
+	double error = p[0] * rx + p[1] * ry + p[2] * rz + q.b0 * p[0] + q.b1 * p[1] + q.b2 * p[2] + q.c;
+	return q.weight > 0.0 ? std::fabs(error) / q.weight : 0.0;
+}
+
+static inline void _cross(const double *a, const double *b, double *out) {
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline double _dot(const double *a, const double *b) {
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline uint64_t _edgeKey(uint32_t a, uint32_t b) {
+	return a < b ? (uint64_t)a << 32 | b : (uint64_t)b << 32 | a;
+}
+
+// Current triangles around each representative.
+static void _adjacencyBuild(const State &state, Adjacency &adjacency) {
+	const uint32_t vertexCount = state.vertices->count;
+
+	adjacency.offsets.assign(vertexCount + 1, 0);
+	for (uint32_t vertex : state.triangles)
+		adjacency.offsets[state.representatives[vertex] + 1]++;
+
+	for (uint32_t i = 0; i < vertexCount; i++)
+		adjacency.offsets[i + 1] += adjacency.offsets[i];
+
+	adjacency.triangles.resize(state.triangles.size());
+
+	std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	for (size_t i = 0; i < state.triangles.size(); i++)
+		adjacency.triangles[cursor[state.representatives[state.triangles[i]]]++] = i / 3;
+}
+
+// Unique representative edges, sorted, and how many triangles use each. Every
+// edge is found from its lower endpoint, which keeps the search local.
+static void _edgesCollect(const State &state, const Adjacency &adjacency, std::vector<uint64_t> &edges,
+		std::vector<uint32_t> &counts) {
+	const uint32_t vertexCount = state.vertices->count;
+
+	edges.clear();
+	counts.clear();
+
+	for (uint32_t a = 0; a < vertexCount; a++) {
+		size_t first = edges.size();
+
+		for (uint32_t i = adjacency.offsets[a]; i < adjacency.offsets[a + 1]; i++) {
+			const uint32_t *triangle = &state.triangles[adjacency.triangles[i] * 3];
+
+			for (int k = 0; k < 3; k++) {
+				uint32_t b = state.representatives[triangle[k]];
+				if (b <= a)
+					continue;
+
+				uint64_t key = _edgeKey(a, b);
+
+				size_t j = first;
+				while (j < edges.size() && edges[j] != key)
+					j++;
+
+				if (j == edges.size()) {
+					edges.push_back(key);
+					counts.push_back(0);
+				}
+
+				counts[j]++;
+			}
+		}
+
+		// few neighbours per vertex, insertion sort keeps the pairs together
+		for (size_t j = first + 1; j < edges.size(); j++) {
+			for (size_t m = j; m > first && edges[m - 1] > edges[m]; m--) {
+				std::swap(edges[m - 1], edges[m]);
+				std::swap(counts[m - 1], counts[m]);
+			}
+		}
+	}
+}
+
+static uint32_t _edgeCount(const std::vector<uint64_t> &edges, const std::vector<uint32_t> &counts, uint64_t key) {
+	auto it = std::lower_bound(edges.begin(), edges.end(), key);
+	return it != edges.end() && *it == key ? counts[it - edges.begin()] : 0;
+}
+
+static void _stateCreate(State &state, const IndexArray &indices, const VertexArray &vertices) {
+	const uint32_t vertexCount = vertices.count;
+	state.vertices = &vertices;
+	state.error = 0.0;
+
+	float minimum[3] = { INFINITY, INFINITY, INFINITY };
+	float maximum[3] = { -INFINITY, -INFINITY, -INFINITY };
+	for (uint32_t i = 0; i < vertexCount; i++) {
+		for (int k = 0; k < 3; k++) {
+			minimum[k] = std::min(minimum[k], vertices.data[i].position[k]);
+			maximum[k] = std::max(maximum[k], vertices.data[i].position[k]);
+		}
+	}
+
+	double extent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+	state.extent = extent > 0.0 ? extent : 1.0;
+
+	double scale = 1.0 / state.extent;
+
+	state.positions.resize(vertexCount * 3);
+	for (uint32_t i = 0; i < vertexCount; i++) {
+		for (int k = 0; k < 3; k++)
+			state.positions[i * 3 + k] = (vertices.data[i].position[k] - minimum[k]) * scale;
+	}
+
+	// vertices split for normals or UVs share a representative
+	std::vector<uint32_t> order(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		order[i] = i;
+
+	auto positionLess = [&](uint32_t a, uint32_t b) {
+		int compare = memcmp(vertices.data[a].position, vertices.data[b].position, sizeof(float) * 3);
+		return compare != 0 ? compare < 0 : a < b;
+	};
+	std::sort(order.begin(), order.end(), positionLess);
+
+	state.representatives.resize(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++) {
+		bool same = i > 0 &&
+				memcmp(vertices.data[order[i]].position, vertices.data[order[i - 1]].position, sizeof(float) * 3) == 0;
+		state.representatives[order[i]] = same ? state.representatives[order[i - 1]] : order[i];
+	}
+
+	state.wedgeOffsets.assign(vertexCount + 1, 0);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		state.wedgeOffsets[state.representatives[i] + 1]++;
+
+	for (uint32_t i = 0; i < vertexCount; i++)
+		state.wedgeOffsets[i + 1] += state.wedgeOffsets[i];
+
+	state.wedges.resize(vertexCount);
+	{
+		std::vector<uint32_t> cursor(state.wedgeOffsets.begin(), state.wedgeOffsets.end() - 1);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			state.wedges[cursor[state.representatives[i]]++] = i;
+	}
+
+	// triangles that are already degenerate on positions carry no surface
+	state.triangles.clear();
+	state.triangles.reserve(indices.count);
+	for (uint32_t i = 0; i + 2 < indices.count; i += 3) {
+		uint32_t a = state.representatives[indices.data[i + 0]];
+		uint32_t b = state.representatives[indices.data[i + 1]];
+		uint32_t c = state.representatives[indices.data[i + 2]];
+
+		if (a != b && b != c && c != a)
+			state.triangles.insert(state.triangles.end(), &indices.data[i], &indices.data[i + 3]);
+	}
+
+	Adjacency adjacency;
+	_adjacencyBuild(state, adjacency);
+
+	std::vector<uint64_t> edges;
+	std::vector<uint32_t> counts;
+	_edgesCollect(state, adjacency, edges, counts);
+
+	state.kinds.assign(vertexCount, VERTEX_MANIFOLD);
+	for (size_t i = 0; i < edges.size(); i++) {
+		if (counts[i] == 2)
+			continue;
+
+		uint8_t kind = counts[i] == 1 ? VERTEX_BORDER : VERTEX_LOCKED;
+		uint32_t a = edges[i] >> 32;
+		uint32_t b = edges[i] & 0xffffffff;
+
+		state.kinds[a] = std::max(state.kinds[a], kind);
+		state.kinds[b] = std::max(state.kinds[b], kind);
+	}
+
+	state.quadrics.assign(vertexCount, Quadric());
+	for (size_t i = 0; i < state.triangles.size(); i += 3) {
+		uint32_t corners[3];
+		for (int k = 0; k < 3; k++)
+			corners[k] = state.representatives[state.triangles[i + k]];
+
+		const double *p0 = &state.positions[corners[0] * 3];
+		const double *p1 = &state.positions[corners[1] * 3];
+		const double *p2 = &state.positions[corners[2] * 3];
+
+		double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+		double normal[3];
+		_cross(e1, e2, normal);
+
+		double length = std::sqrt(_dot(normal, normal));
+		if (length == 0.0)
+			continue;
+
+		for (int k = 0; k < 3; k++)
+			normal[k] /= length;
+
+		// area weighted so small slivers do not dominate
+		Quadric q;
+		_quadricPlane(q, normal, -_dot(normal, p0), length * 0.5);
+
+		for (int k = 0; k < 3; k++)
+			_quadricAdd(state.quadrics[corners[k]], q);
+
+		// a plane perpendicular to the surface keeps open borders in place
+		for (int k = 0; k < 3; k++) {
+			uint32_t a = corners[k];
+			uint32_t b = corners[(k + 1) % 3];
+			if (_edgeCount(edges, counts, _edgeKey(a, b)) != 1)
+				continue;
+
+			const double *pa = &state.positions[a * 3];
+			const double *pb = &state.positions[b * 3];
+			double edge[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+
+			double borderNormal[3];
+			_cross(edge, normal, borderNormal);
+
+			double borderLength = std::sqrt(_dot(borderNormal, borderNormal));
+			if (borderLength == 0.0)
+				continue;
+
+			for (int j = 0; j < 3; j++)
+				borderNormal[j] /= borderLength;
+
+			Quadric border;
+			_quadricPlane(border, borderNormal, -_dot(borderNormal, pa), _dot(edge, edge) * BORDER_WEIGHT);
+
+			_quadricAdd(state.quadrics[a], border);
+			_quadricAdd(state.quadrics[b], border);
+		}
+	}
+}
+
+static bool _collapseAllowed(const State &state, uint32_t from, uint32_t to, uint32_t edgeCount) {
+	switch (state.kinds[from]) {
+		case VERTEX_MANIFOLD:
+			return true;
+		case VERTEX_BORDER:
+			return edgeCount == 1 && state.kinds[to] != VERTEX_MANIFOLD;
+		default:
+			return false;
+	}
+}
+
+static double _collapseCost(const State &state, uint32_t from, uint32_t to) {
+	Quadric q = state.quadrics[from];
+	_quadricAdd(q, state.quadrics[to]);
+	return _quadricError(q, &state.positions[to * 3]);
+}
+
+// True when moving from onto to turns any remaining triangle around from upside down.
+static bool _collapseFlips(const State &state, const Adjacency &adjacency, uint32_t from, uint32_t to) {
+	for (uint32_t i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; i++) {
+		const uint32_t *triangle = &state.triangles[adjacency.triangles[i] * 3];
+
+		uint32_t corners[3];
+		for (int k = 0; k < 3; k++)
+			corners[k] = state.representatives[triangle[k]];
+
+		// the triangle along the collapsed edge disappears
+		if (corners[0] == to || corners[1] == to || corners[2] == to)
+			continue;
+
+		double before[3], after[3];
+		for (int pass = 0; pass < 2; pass++) {
+			const double *p[3];
+			for (int k = 0; k < 3; k++) {
+				uint32_t corner = pass == 1 && corners[k] == from ? to : corners[k];
+				p[k] = &state.positions[corner * 3];
+			}
+
+			double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+			double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+			_cross(e1, e2, pass == 0 ? before : after);
+		}
+
+		if (_dot(before, after) <= 0.0)
+			return true;
+	}
+
+	return false;
+}
+
+// Copy of the target position whose attributes match the corner's current vertex best.
+static uint32_t _wedgeSelect(const State &state, uint32_t vertex, uint32_t representative) {
+	const Vertex &current = state.vertices->data[vertex];
+
+	uint32_t best = representative;
+	float bestDistance = INFINITY;
+
+	for (uint32_t i = state.wedgeOffsets[representative]; i < state.wedgeOffsets[representative + 1]; i++) {
+		const Vertex &candidate = state.vertices->data[state.wedges[i]];
+
+		float distance = 0.0f;
+		for (int k = 0; k < 3; k++)
+			distance += (candidate.normal[k] - current.normal[k]) * (candidate.normal[k] - current.normal[k]);
+
+		for (int k = 0; k < 2; k++)
+			distance += (candidate.texCoord[k] - current.texCoord[k]) * (candidate.texCoord[k] - current.texCoord[k]);
+
+		if (distance < bestDistance) {
+			bestDistance = distance;
+			best = state.wedges[i];
+		}
+	}
+
+	return best;
+}
+
+// Approximate cheapest first order from the top bits of the cost as a float,
+// a single counting sort pass instead of a full comparison sort.
+static void _collapsesSort(const std::vector<Collapse> &collapses, std::vector<uint32_t> &order) {
+	std::vector<uint32_t> keys(collapses.size());
+	std::vector<uint32_t> offsets(SORT_BUCKETS + 1, 0);
+
+	for (size_t i = 0; i < collapses.size(); i++) {
+		float cost = (float)collapses[i].cost;
+
+		uint32_t bits;
+		memcpy(&bits, &cost, sizeof(bits));
+
+		// costs are never negative, the sign bit is always clear
+		keys[i] = (bits >> (31 - SORT_BITS)) & (SORT_BUCKETS - 1);
+		offsets[keys[i] + 1]++;
+	}
+
+	for (uint32_t i = 0; i < SORT_BUCKETS; i++)
+		offsets[i + 1] += offsets[i];
+
+	order.resize(collapses.size());
+	for (size_t i = 0; i < collapses.size(); i++)
+		order[offsets[keys[i]]++] = i;
+}
+
+// One round of independent collapses, cheapest first. Returns how many were made.
+static uint32_t _passRun(State &state, uint32_t targetTriangles) {
+	const uint32_t vertexCount = state.vertices->count;
+
+	uint32_t triangleCount = state.triangles.size() / 3;
+	if (triangleCount <= targetTriangles)
+		return 0;
+
+	Adjacency adjacency;
+	_adjacencyBuild(state, adjacency);
+
+	std::vector<uint64_t> edges;
+	std::vector<uint32_t> counts;
+	_edgesCollect(state, adjacency, edges, counts);
+
+	std::vector<Collapse> collapses;
+	collapses.reserve(edges.size());
+
+	for (size_t i = 0; i < edges.size(); i++) {
+		uint32_t a = edges[i] >> 32;
+		uint32_t b = edges[i] & 0xffffffff;
+
+		Collapse collapse = { INFINITY, 0, 0, counts[i] };
+		if (_collapseAllowed(state, a, b, counts[i]))
+			collapse = { _collapseCost(state, a, b), a, b, counts[i] };
+
+		if (_collapseAllowed(state, b, a, counts[i])) {
+			double cost = _collapseCost(state, b, a);
+			if (cost < collapse.cost)
+				collapse = { cost, b, a, counts[i] };
+		}
+
+		if (collapse.cost < INFINITY)
+			collapses.push_back(collapse);
+	}
+
+	std::vector<uint32_t> order;
+	_collapsesSort(collapses, order);
+
+	// collapses in one pass must not see each other's changes
+	std::vector<bool> touched(vertexCount, false);
+	std::vector<uint32_t> remap(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+		remap[i] = i;
+
+	uint32_t collapseCount = 0;
+	for (uint32_t index : order) {
+		const Collapse &collapse = collapses[index];
+		if (triangleCount <= targetTriangles)
+			break;
+
+		if (touched[collapse.from] || touched[collapse.to])
+			continue;
+
+		if (_collapseFlips(state, adjacency, collapse.from, collapse.to))
+			continue;
+
+		remap[collapse.from] = collapse.to;
+		_quadricAdd(state.quadrics[collapse.to], state.quadrics[collapse.from]);
+		state.error = std::max(state.error, collapse.cost);
+
+		for (uint32_t i = adjacency.offsets[collapse.from]; i < adjacency.offsets[collapse.from + 1]; i++) {
+			const uint32_t *triangle = &state.triangles[adjacency.triangles[i] * 3];
+			for (int k = 0; k < 3; k++)
+				touched[state.representatives[triangle[k]]] = true;
+		}
+
+		touched[collapse.to] = true;
+		triangleCount -= std::min(triangleCount, collapse.triangles);
+		collapseCount++;
+	}
+
+	if (collapseCount == 0)
+		return 0;
+
+	size_t write = 0;
+	for (size_t i = 0; i < state.triangles.size(); i += 3) {
+		uint32_t triangle[3];
+		uint32_t corners[3];
+
+		for (int k = 0; k < 3; k++) {
+			uint32_t vertex = state.triangles[i + k];
+			uint32_t representative = state.representatives[vertex];
+
+			corners[k] = remap[representative];
+			triangle[k] = corners[k] == representative ? vertex : _wedgeSelect(state, vertex, corners[k]);
+		}
+
+		if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0])
+			continue;
+
+		memcpy(&state.triangles[write], triangle, sizeof(triangle));
+		write += 3;
+	}
+
+	state.triangles.resize(write);
+	return collapseCount;
+}
+
+LodArray MeshSimplifier::lodsBuild(const IndexArray &indices, const VertexArray &vertices, Arena &arena,
+		uint32_t levelCount, float reduction) {
+	LodArray out = {};
+	if (levelCount == 0 || indices.count < 3 || vertices.count == 0)
+		return out;
+
+	State state;
+	_stateCreate(state, indices, vertices);
+
+	std::vector<Lod> lods;
+
+	uint32_t previousCount = indices.count / 3;
+	double target = previousCount;
+
+	for (uint32_t level = 0; level < levelCount; level++) {
+		target *= reduction;
+
+		while (_passRun(state, (uint32_t)target) > 0) {
+		}
+
+		uint32_t triangleCount = state.triangles.size() / 3;
+		if (triangleCount == 0 || triangleCount > previousCount * (1.0f - LOD_MIN_REDUCTION))
+			break;
+
+		Lod lod;
+		lod.indices.count = state.triangles.size();
+		lod.indices.data = arena.arrayAllocate<uint32_t>(lod.indices.count);
+		memcpy(lod.indices.data, state.triangles.data(), lod.indices.count * sizeof(uint32_t));
+		lod.error = std::sqrt(state.error) * state.extent;
+
+		lods.push_back(lod);
+		previousCount = triangleCount;
+	}
+
+	if (lods.empty())
+		return out;
+
+	out.count = lods.size();
+	out.data = arena.arrayAllocate<Lod>(out.count);
+	memcpy(out.data, lods.data(), out.count * sizeof(Lod));
+	return out;
+}
+
+uint32_t MeshSimplifier::lodSelect(const LodArray &lods, float distance, float pixelsPerUnit, float maxPixelError) {
+	// errors only grow with the level, take the last one still below the threshold
+	uint32_t level = 0;
+	for (uint32_t i = 0; i < lods.count; i++) {
+		if (lods.data[i].error * pixelsPerUnit > maxPixelError * distance)
+			break;
+
+		level = i + 1;
+	}
+
+	return level;
+}
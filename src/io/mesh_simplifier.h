@@ -0,0 +1,30 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <cstdint>
+
+#include <io/types/mesh.h>
+
+class Arena;
+
+// Quadric error edge collapse (Garland and Heckbert) that only changes the
+// index buffer: vertices collapse onto existing neighbours, so every level
+// shares the primitive's vertex array. Vertices with the same position are
+// simplified together and each corner keeps the copy with the closest normal
+// and texture coordinate, which keeps UV seams and hard edges intact. Open
+// borders only collapse along themselves, non-manifold vertices stay.
+class MeshSimplifier {
+public:
+	// Level i has about indices.count * reduction^i indices. Stops early when a
+	// level would not be at least 10% smaller than the one before. Arrays are
+	// allocated from arena.
+	static LodArray lodsBuild(const IndexArray &indices, const VertexArray &vertices, Arena &arena,
+			uint32_t levelCount, float reduction = 0.5f);
+
+	// Coarsest level whose error projects to at most maxPixelError pixels at the
+	// given distance, 0 meaning the full Primitive::indices and i lods.data[i - 1].
+	// pixelsPerUnit is viewport height / (2 * tan(fovY / 2)).
+	static uint32_t lodSelect(const LodArray &lods, float distance, float pixelsPerUnit, float maxPixelError = 1.0f);
+};
+
+#endif // !MESH_SIMPLIFIER_H
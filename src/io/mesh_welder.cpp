@@ -0,0 +1,136 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <core/arena.h>
+
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include "mesh_welder.h"
+
+const uint32_t EMPTY_SLOT = ~0u;
+
+static inline uint32_t _rotate(uint32_t value, uint32_t bits) {
+	return (value << bits) | (value >> (32 - bits));
+}
+
+// MurmurHash3 over whole words, the float bits are hashed as they are.
+static inline uint32_t _wordsHash(const uint32_t *words, uint32_t count) {
+	uint32_t hash = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		hash ^= _rotate(words[i] * 0xcc9e2d51u, 15) * 0x1b873593u;
+		hash = _rotate(hash, 13) * 5 + 0xe6546b64u;
+	}
+
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	return hash ^ (hash >> 16);
+}
+
+static inline uint32_t _vertexHash(const Vertex &vertex) {
+	uint32_t words[sizeof(Vertex) / 4];
+	memcpy(words, &vertex, sizeof(Vertex));
+	return _wordsHash(words, sizeof(Vertex) / 4);
+}
+
+static inline uint32_t _positionHash(const Vertex &vertex) {
+	uint32_t words[3];
+	memcpy(words, vertex.position, sizeof(words));
+	return _wordsHash(words, 3);
+}
+
+static inline bool _vertexEqual(const Vertex &a, const Vertex &b) {
+#ifdef __SSE2__
+	static_assert(sizeof(Vertex) == 48, "_vertexEqual assumes three 16 byte lanes");
+
+	const __m128i *pa = reinterpret_cast<const __m128i *>(&a);
+	const __m128i *pb = reinterpret_cast<const __m128i *>(&b);
+
+	__m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128(pa), _mm_loadu_si128(pb));
+	equal = _mm_and_si128(equal, _mm_cmpeq_epi32(_mm_loadu_si128(pa + 1), _mm_loadu_si128(pb + 1)));
+	equal = _mm_and_si128(equal, _mm_cmpeq_epi32(_mm_loadu_si128(pa + 2), _mm_loadu_si128(pb + 2)));
+	return _mm_movemask_epi8(equal) == 0xffff;
+#else
+	return memcmp(&a, &b, sizeof(Vertex)) == 0;
+#endif
+}
+
+static inline bool _positionEqual(const Vertex &a, const Vertex &b) {
+	return memcmp(a.position, b.position, sizeof(a.position)) == 0;
+}
+
+// Open addressing with linear probing, at most half full so probe chains stay short.
+static std::vector<uint32_t> _tableCreate(uint32_t count, uint32_t *mask) {
+	uint32_t capacity = 1;
+	while (capacity < count * 2)
+		capacity *= 2;
+
+	*mask = capacity - 1;
+	return std::vector<uint32_t>(capacity, EMPTY_SLOT);
+}
+
+IndexArray MeshWelder::indicesGenerate(uint32_t vertexCount, Arena &arena) {
+	IndexArray indices = {};
+	indices.data = arena.arrayAllocate<uint32_t>(vertexCount);
+	indices.count = vertexCount;
+
+	for (uint32_t i = 0; i < vertexCount; i++)
+		indices.data[i] = i;
+
+	return indices;
+}
+
+uint32_t MeshWelder::verticesWeld(IndexArray &indices, VertexArray &vertices) {
+	uint32_t mask;
+	std::vector<uint32_t> table = _tableCreate(vertices.count, &mask);
+	std::vector<uint32_t> remap(vertices.count);
+
+	// survivors move down to their final slot right away, so the table always points at compacted vertices
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		const Vertex &vertex = vertices.data[i];
+
+		uint32_t slot = _vertexHash(vertex) & mask;
+		while (table[slot] != EMPTY_SLOT && !_vertexEqual(vertices.data[table[slot]], vertex))
+			slot = (slot + 1) & mask;
+
+		if (table[slot] == EMPTY_SLOT) {
+			vertices.data[count] = vertex;
+			table[slot] = count++;
+		}
+
+		remap[i] = table[slot];
+	}
+
+	for (uint32_t i = 0; i < indices.count; i++)
+		indices.data[i] = remap[indices.data[i]];
+
+	uint32_t removed = vertices.count - count;
+	vertices.count = count;
+	return removed;
+}
+
+void MeshWelder::positionsRemap(const VertexArray &vertices, uint32_t *remap) {
+	uint32_t mask;
+	std::vector<uint32_t> table = _tableCreate(vertices.count, &mask);
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		const Vertex &vertex = vertices.data[i];
+
+		uint32_t slot = _positionHash(vertex) & mask;
+		while (table[slot] != EMPTY_SLOT && !_positionEqual(vertices.data[table[slot]], vertex))
+			slot = (slot + 1) & mask;
+
+		if (table[slot] == EMPTY_SLOT)
+			table[slot] = i;
+
+		remap[i] = table[slot];
+	}
+}
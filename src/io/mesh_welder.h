@@ -0,0 +1,26 @@
+#ifndef MESH_WELDER_H
+#define MESH_WELDER_H
+
+#include <cstdint>
+
+#include <io/types/mesh.h>
+
+class Arena;
+
+// Hash based vertex deduplication, linear in the vertex count. Vertices are
+// only merged when bitwise equal, compared 16 bytes at a time with SSE2 where
+// available, so welding never changes the rendered result.
+class MeshWelder {
+public:
+	// Identity index buffer for a non-indexed primitive, verticesWeld then removes the duplicates.
+	static IndexArray indicesGenerate(uint32_t vertexCount, Arena &arena);
+
+	// Merges identical vertices in place and rewrites indices to match. Survivors keep their
+	// first-use order, vertices.count shrinks. Returns the number of vertices removed.
+	static uint32_t verticesWeld(IndexArray &indices, VertexArray &vertices);
+
+	// remap[i] is the first vertex with the same position as vertex i.
+	static void positionsRemap(const VertexArray &vertices, uint32_t *remap);
+};
+
+#endif // !MESH_WELDER_H
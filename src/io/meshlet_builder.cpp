@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <core/arena.h>
+
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include "meshlet_builder.h"
+
+const uint8_t NOT_LOCAL = 0xff;
+
+// Below this the normals spread over more than about 84 degrees from the axis
+// and the cone would hardly ever cull.
+const float CONE_MIN_DOT = 0.1f;
+
+static inline float _dot(const float *a, const float *b) {
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline float _distanceSquared(const float *a, const float *b) {
+	float d[3] = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+	return _dot(d, d);
+}
+
+void MeshletBuilder::_boundsCompute(Meshlet &meshlet, const MeshletArray &meshlets, const VertexArray &vertices) {
+	const uint32_t *meshletVertices = &meshlets.vertices[meshlet.vertexOffset];
+	const uint8_t *triangles = &meshlets.triangles[meshlet.triangleOffset * 3];
+
+	// Ritter: start from the most distant pair of axis extremes, grow for each outlier
+	uint32_t minimum[3] = {}, maximum[3] = {};
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		const float *p = vertices.data[meshletVertices[i]].position;
+
+		for (int k = 0; k < 3; k++) {
+			if (p[k] < vertices.data[meshletVertices[minimum[k]]].position[k])
+				minimum[k] = i;
+
+			if (p[k] > vertices.data[meshletVertices[maximum[k]]].position[k])
+				maximum[k] = i;
+		}
+	}
+
+	int axis = 0;
+	float span = -1.0f;
+	for (int k = 0; k < 3; k++) {
+		float d = _distanceSquared(vertices.data[meshletVertices[minimum[k]]].position,
+				vertices.data[meshletVertices[maximum[k]]].position);
+
+		if (d > span) {
+			span = d;
+			axis = k;
+		}
+	}
+
+	const float *p0 = vertices.data[meshletVertices[minimum[axis]]].position;
+	const float *p1 = vertices.data[meshletVertices[maximum[axis]]].position;
+
+	float center[3] = { (p0[0] + p1[0]) * 0.5f, (p0[1] + p1[1]) * 0.5f, (p0[2] + p1[2]) * 0.5f };
+	float radius = std::sqrt(span) * 0.5f;
+
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		const float *p = vertices.data[meshletVertices[i]].position;
+
+		float d = std::sqrt(_distanceSquared(p, center));
+		if (d <= radius)
+			continue;
+
+		// move the center towards the point so the old sphere and the point both fit
+		float grow = (d - radius) * 0.5f;
+		for (int k = 0; k < 3; k++)
+			center[k] += (p[k] - center[k]) * (grow / d);
+
+		radius += grow;
+	}
+
+	memcpy(meshlet.center, center, sizeof(center));
+	meshlet.radius = radius;
+
+	// normal cone around the average of the unit face normals, see Meshlet for the test
+	float normals[MESHLET_MAX_TRIANGLES][3];
+	const float *corners[MESHLET_MAX_TRIANGLES];
+	float coneAxis[3] = {};
+	uint32_t normalCount = 0;
+
+	for (uint32_t i = 0; i < meshlet.triangleCount; i++) {
+		const float *a = vertices.data[meshletVertices[triangles[i * 3 + 0]]].position;
+		const float *b = vertices.data[meshletVertices[triangles[i * 3 + 1]]].position;
+		const float *c = vertices.data[meshletVertices[triangles[i * 3 + 2]]].position;
+
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float n[3] = {
+			e1[1] * e2[2] - e1[2] * e2[1],
+			e1[2] * e2[0] - e1[0] * e2[2],
+			e1[0] * e2[1] - e1[1] * e2[0],
+		};
+
+		float length = std::sqrt(_dot(n, n));
+		if (length == 0.0f)
+			continue;
+
+		for (int k = 0; k < 3; k++) {
+			normals[normalCount][k] = n[k] / length;
+			coneAxis[k] += normals[normalCount][k];
+		}
+
+		corners[normalCount++] = a;
+	}
+
+	memcpy(meshlet.coneApex, center, sizeof(center));
+	memset(meshlet.coneAxis, 0, sizeof(meshlet.coneAxis));
+	meshlet.coneCutoff = 1.0f;
+
+	float axisLength = std::sqrt(_dot(coneAxis, coneAxis));
+	if (normalCount == 0 || axisLength == 0.0f)
+		return;
+
+	for (int k = 0; k < 3; k++)
+		coneAxis[k] /= axisLength;
+
+	float minimumDot = 1.0f;
+	for (uint32_t i = 0; i < normalCount; i++)
+		minimumDot = std::min(minimumDot, _dot(normals[i], coneAxis));
+
+	memcpy(meshlet.coneAxis, coneAxis, sizeof(coneAxis));
+	if (minimumDot <= CONE_MIN_DOT)
+		return;
+
+	// move the apex back along the axis until it lies behind every triangle's plane
+	float apexDistance = 0.0f;
+	for (uint32_t i = 0; i < normalCount; i++) {
+		float toCenter[3] = { center[0] - corners[i][0], center[1] - corners[i][1], center[2] - corners[i][2] };
+		apexDistance = std::max(apexDistance, _dot(toCenter, normals[i]) / _dot(coneAxis, normals[i]));
+	}
+
+	for (int k = 0; k < 3; k++)
+		meshlet.coneApex[k] = center[k] - coneAxis[k] * apexDistance;
+
+	meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+}
+
+MeshletArray MeshletBuilder::meshletsBuild(const IndexArray &indices, const VertexArray &vertices, Arena &arena) {
+	MeshletArray out = {};
+
+	const uint32_t faceCount = indices.count / 3;
+	if (faceCount == 0)
+		return out;
+
+	// live triangles of each vertex, emitted ones are swapped past the valence
+	std::vector<uint32_t> valences(vertices.count, 0);
+	for (uint32_t i = 0; i < indices.count; i++)
+		valences[indices.data[i]]++;
+
+	std::vector<uint32_t> offsets(vertices.count + 1, 0);
+	for (uint32_t i = 0; i < vertices.count; i++)
+		offsets[i + 1] = offsets[i] + valences[i];
+
+	std::vector<uint32_t> adjacency(indices.count);
+	{
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < indices.count; i++)
+			adjacency[cursor[indices.data[i]]++] = i / 3;
+	}
+
+	std::vector<uint8_t> localIndices(vertices.count, NOT_LOCAL);
+	std::vector<bool> emitted(faceCount, false);
+
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint8_t> meshletTriangles;
+
+	Meshlet meshlet = {};
+	uint32_t scanCursor = 0;
+
+	for (uint32_t output = 0; output < faceCount; output++) {
+		int64_t bestFace = -1;
+		uint32_t bestExtra = 4;
+
+		// the neighbour adding the fewest vertices, a triangle closing a fan adds none
+		if (meshlet.triangleCount < MESHLET_MAX_TRIANGLES) {
+			for (uint32_t i = 0; i < meshlet.vertexCount && bestExtra > 0; i++) {
+				uint32_t vertex = meshletVertices[meshlet.vertexOffset + i];
+
+				for (uint32_t t = 0; t < valences[vertex]; t++) {
+					uint32_t face = adjacency[offsets[vertex] + t];
+					const uint32_t *fv = &indices.data[face * 3];
+
+					uint32_t extra = (localIndices[fv[0]] == NOT_LOCAL) + (localIndices[fv[1]] == NOT_LOCAL) +
+							(localIndices[fv[2]] == NOT_LOCAL);
+
+					if (extra < bestExtra && meshlet.vertexCount + extra <= MESHLET_MAX_VERTICES) {
+						bestExtra = extra;
+						bestFace = face;
+					}
+				}
+			}
+		}
+
+		if (bestFace < 0) {
+			if (meshlet.triangleCount > 0) {
+				for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+					localIndices[meshletVertices[meshlet.vertexOffset + i]] = NOT_LOCAL;
+
+				meshlets.push_back(meshlet);
+
+				meshlet = {};
+				meshlet.vertexOffset = meshletVertices.size();
+				meshlet.triangleOffset = meshletTriangles.size() / 3;
+			}
+
+			while (emitted[scanCursor])
+				scanCursor++;
+
+			bestFace = scanCursor;
+		}
+
+		const uint32_t *face = &indices.data[bestFace * 3];
+		emitted[bestFace] = true;
+
+		for (int k = 0; k < 3; k++) {
+			uint32_t vertex = face[k];
+
+			if (localIndices[vertex] == NOT_LOCAL) {
+				localIndices[vertex] = meshlet.vertexCount++;
+				meshletVertices.push_back(vertex);
+			}
+
+			meshletTriangles.push_back(localIndices[vertex]);
+
+			// a vertex can appear twice in a degenerate triangle, it is listed once per corner
+			uint32_t *list = &adjacency[offsets[vertex]];
+			for (uint32_t j = 0; j < valences[vertex]; j++) {
+				if (list[j] != bestFace)
+					continue;
+
+				std::swap(list[j], list[valences[vertex] - 1]);
+				break;
+			}
+
+			valences[vertex]--;
+		}
+
+		meshlet.triangleCount++;
+	}
+
+	meshlets.push_back(meshlet);
+
+	out.count = meshlets.size();
+	out.data = arena.arrayAllocate<Meshlet>(out.count);
+	memcpy(out.data, meshlets.data(), out.count * sizeof(Meshlet));
+
+	out.vertexCount = meshletVertices.size();
+	out.vertices = arena.arrayAllocate<uint32_t>(out.vertexCount);
+	memcpy(out.vertices, meshletVertices.data(), out.vertexCount * sizeof(uint32_t));
+
+	out.triangleCount = meshletTriangles.size() / 3;
+	out.triangles = arena.arrayAllocate<uint8_t>(meshletTriangles.size());
+	memcpy(out.triangles, meshletTriangles.data(), meshletTriangles.size());
+
+	for (uint32_t i = 0; i < out.count; i++)
+		_boundsCompute(out.data[i], out, vertices);
+
+	return out;
+}
+
+bool MeshletBuilder::meshletBackfacing(const Meshlet &meshlet, const float *cameraPosition) {
+	float direction[3] = {
+		meshlet.coneApex[0] - cameraPosition[0],
+		meshlet.coneApex[1] - cameraPosition[1],
+		meshlet.coneApex[2] - cameraPosition[2],
+	};
+
+	float length = std::sqrt(_dot(direction, direction));
+	return _dot(direction, meshlet.coneAxis) >= meshlet.coneCutoff * length;
+}
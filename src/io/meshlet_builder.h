@@ -0,0 +1,24 @@
+#ifndef MESHLET_BUILDER_H
+#define MESHLET_BUILDER_H
+
+#include <io/types/mesh.h>
+
+class Arena;
+
+// Splits primitives into meshlets for cluster culling. Triangles are added
+// greedily to the current meshlet, preferring neighbours that need the fewest
+// new vertices, so meshlets follow connectivity and stay compact. Run it after
+// MeshOptimizer, the seed of each meshlet is the next unused triangle in index order.
+class MeshletBuilder {
+private:
+	static void _boundsCompute(Meshlet &meshlet, const MeshletArray &meshlets, const VertexArray &vertices);
+
+public:
+	// Arrays are allocated from arena, an empty primitive gives an empty MeshletArray.
+	static MeshletArray meshletsBuild(const IndexArray &indices, const VertexArray &vertices, Arena &arena);
+
+	// True when every triangle of the meshlet faces away from the camera.
+	static bool meshletBackfacing(const Meshlet &meshlet, const float *cameraPosition);
+};
+
+#endif // !MESHLET_BUILDER_H
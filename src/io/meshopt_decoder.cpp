@@ -0,0 +1,682 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <cgltf/cgltf.h>
+
+#include "meshopt_decoder.h"
+
+const uint8_t VERTEX_HEADER = 0xa0;
+const uint8_t INDEX_HEADER = 0xe0;
+const uint8_t SEQUENCE_HEADER = 0xd0;
+
+// Vertex blocks hold at most 256 vertices and 8 KiB, each byte of the vertex is
+// stored as its own stream of zigzag deltas, in groups of 16 with 0, 2, 4 or 8 bits each.
+const size_t GROUP_SIZE = 16;
+const size_t BLOCK_MAX_VERTICES = 256;
+const size_t BLOCK_MAX_BYTES = 8192;
+
+// A group reads at most 8 packed bytes and 16 exceptions. The stream always ends in a
+// tail of at least 32 bytes, so checking for this much is enough for one group.
+const size_t GROUP_DECODE_LIMIT = 24;
+const size_t TAIL_MIN_SIZE = 32;
+
+// 2 and 4 bit values unpacked from one byte, highest bits first.
+typedef struct {
+	uint8_t twoBit[256][4];
+	uint8_t fourBit[256][2];
+} UnpackTables;
+
+static UnpackTables _unpackTablesCreate() {
+	UnpackTables tables;
+	for (uint32_t byte = 0; byte < 256; byte++) {
+		for (uint32_t i = 0; i < 4; i++)
+			tables.twoBit[byte][i] = (byte >> (6 - i * 2)) & 3;
+
+		tables.fourBit[byte][0] = byte >> 4;
+		tables.fourBit[byte][1] = byte & 15;
+	}
+
+	return tables;
+}
+
+static const UnpackTables &_unpackTables() {
+	static const UnpackTables tables = _unpackTablesCreate();
+	return tables;
+}
+
+static size_t _vertexBlockSize(size_t stride) {
+	size_t size = (BLOCK_MAX_BYTES / stride) & ~(GROUP_SIZE - 1);
+	return std::min(size, BLOCK_MAX_VERTICES);
+}
+
+// Values equal to the all ones sentinel did not fit and follow the packed bytes in full.
+static inline const uint8_t *_exceptionsFill(uint8_t *out, uint8_t sentinel, const uint8_t *exceptions) {
+#ifdef __SSE2__
+	__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out));
+	uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(values, _mm_set1_epi8((char)sentinel)));
+
+	while (mask != 0) {
+		out[__builtin_ctz(mask)] = *exceptions++;
+		mask &= mask - 1;
+	}
+#else
+	for (size_t i = 0; i < GROUP_SIZE; i++) {
+		if (out[i] == sentinel)
+			out[i] = *exceptions++;
+	}
+#endif
+
+	return exceptions;
+}
+
+static inline const uint8_t *_groupDecode(const uint8_t *data, uint8_t *out, uint32_t bits,
+		const UnpackTables &tables) {
+	switch (bits) {
+		case 0:
+			memset(out, 0, GROUP_SIZE);
+			return data;
+		case 1:
+			for (size_t i = 0; i < 4; i++)
+				memcpy(out + i * 4, tables.twoBit[data[i]], 4);
+
+			return _exceptionsFill(out, 3, data + 4);
+		case 2:
+			for (size_t i = 0; i < 8; i++)
+				memcpy(out + i * 2, tables.fourBit[data[i]], 2);
+
+			return _exceptionsFill(out, 15, data + 8);
+		default:
+			memcpy(out, data, GROUP_SIZE);
+			return data + GROUP_SIZE;
+	}
+}
+
+// Turns zigzag deltas into values in place and returns the value of vertex count - 1,
+// the base of the next block. lane holds count rounded up to GROUP_SIZE bytes.
+static uint8_t _deltasDecode(uint8_t *lane, size_t count, uint8_t previous) {
+#ifdef __SSE2__
+	const size_t aligned = (count + GROUP_SIZE - 1) & ~(GROUP_SIZE - 1);
+
+	const __m128i ones = _mm_set1_epi8(1);
+	const __m128i low = _mm_set1_epi8(0x7f);
+	__m128i carry = _mm_set1_epi8((char)previous);
+
+	for (size_t i = 0; i < aligned; i += GROUP_SIZE) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane + i));
+
+		__m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(v, ones));
+		v = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(v, 1), low), sign);
+
+		// inclusive prefix sum over the 16 bytes in four steps
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+		v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+		v = _mm_add_epi8(v, carry);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lane + i), v);
+
+		// broadcast the last byte
+		carry = _mm_shufflehi_epi16(_mm_unpackhi_epi8(v, v), 0xff);
+		carry = _mm_shuffle_epi32(carry, 0xff);
+	}
+#else
+	for (size_t i = 0; i < count; i++) {
+		uint8_t delta = (lane[i] >> 1) ^ -(lane[i] & 1);
+		lane[i] = previous = previous + delta;
+	}
+#endif
+
+	return lane[count - 1];
+}
+
+// Interleaves the per-byte lanes back into vertices, four lanes at a time.
+static void _lanesTranspose(const uint8_t *lanes, size_t aligned, size_t count, size_t stride, uint8_t *out) {
+#ifdef __SSE2__
+	for (size_t k = 0; k < stride; k += 4) {
+		const uint8_t *lane = lanes + k * aligned;
+
+		for (size_t i = 0; i < count; i += GROUP_SIZE) {
+			__m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane + i));
+			__m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane + aligned + i));
+			__m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane + aligned * 2 + i));
+			__m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lane + aligned * 3 + i));
+
+			__m128i a = _mm_unpacklo_epi8(r0, r1);
+			__m128i b = _mm_unpacklo_epi8(r2, r3);
+			__m128i c = _mm_unpackhi_epi8(r0, r1);
+			__m128i d = _mm_unpackhi_epi8(r2, r3);
+
+			__m128i words[4] = {
+				_mm_unpacklo_epi16(a, b),
+				_mm_unpackhi_epi16(a, b),
+				_mm_unpacklo_epi16(c, d),
+				_mm_unpackhi_epi16(c, d),
+			};
+
+			size_t end = std::min(count - i, GROUP_SIZE);
+			for (size_t j = 0; j < end; j++) {
+				int32_t word = _mm_cvtsi128_si32(words[j / 4]);
+				words[j / 4] = _mm_srli_si128(words[j / 4], 4);
+				memcpy(out + (i + j) * stride + k, &word, sizeof(word));
+			}
+		}
+	}
+#else
+	for (size_t k = 0; k < stride; k++) {
+		for (size_t i = 0; i < count; i++)
+			out[i * stride + k] = lanes[k * aligned + i];
+	}
+#endif
+}
+
+static const uint8_t *_vertexBlockDecode(const uint8_t *data, const uint8_t *dataEnd, uint8_t *out, size_t count,
+		size_t stride, uint8_t *last, const UnpackTables &tables) {
+	uint8_t lanes[BLOCK_MAX_BYTES];
+
+	const size_t aligned = (count + GROUP_SIZE - 1) & ~(GROUP_SIZE - 1);
+	const size_t groupCount = aligned / GROUP_SIZE;
+	const size_t headerSize = (groupCount + 3) / 4;
+
+	for (size_t k = 0; k < stride; k++) {
+		uint8_t *lane = lanes + k * aligned;
+
+		if ((size_t)(dataEnd - data) < headerSize)
+			return nullptr;
+
+		// 2 bits per group select its bit width
+		const uint8_t *header = data;
+		data += headerSize;
+
+		for (size_t group = 0; group < groupCount; group++) {
+			if ((size_t)(dataEnd - data) < GROUP_DECODE_LIMIT)
+				return nullptr;
+
+			uint32_t bits = (header[group / 4] >> ((group % 4) * 2)) & 3;
+			data = _groupDecode(data, lane + group * GROUP_SIZE, bits, tables);
+		}
+
+		last[k] = _deltasDecode(lane, count, last[k]);
+	}
+
+	_lanesTranspose(lanes, aligned, count, stride, out);
+	return data;
+}
+
+bool MeshoptDecoder::vertexBufferDecode(uint8_t *out, size_t count, size_t stride, const uint8_t *data, size_t size) {
+	if (stride == 0 || stride > 256 || stride % 4 != 0)
+		return false;
+
+	if (size < 1 + stride || (data[0] & 0xf0) != VERTEX_HEADER || (data[0] & 0x0f) != 0)
+		return false;
+
+	const UnpackTables &tables = _unpackTables();
+	const uint8_t *dataEnd = data + size;
+
+	// deltas of the first block start from the vertex stored at the very end
+	uint8_t last[256];
+	memcpy(last, dataEnd - stride, stride);
+
+	const size_t blockSize = _vertexBlockSize(stride);
+
+	data++;
+	for (size_t offset = 0; offset < count; offset += blockSize) {
+		size_t blockCount = std::min(blockSize, count - offset);
+
+		data = _vertexBlockDecode(data, dataEnd, out + offset * stride, blockCount, stride, last, tables);
+		if (data == nullptr)
+			return false;
+	}
+
+	return (size_t)(dataEnd - data) == std::max(stride, TAIL_MIN_SIZE);
+}
+
+// Variable length integer, 7 bits per byte, lowest first.
+static inline uint32_t _vbyteDecode(const uint8_t *&data) {
+	uint8_t lead = *data++;
+	if (lead < 128)
+		return lead;
+
+	uint32_t result = lead & 127;
+	uint32_t shift = 7;
+
+	for (int i = 0; i < 4; i++) {
+		uint8_t group = *data++;
+		result |= (uint32_t)(group & 127) << shift;
+		shift += 7;
+
+		if (group < 128)
+			break;
+	}
+
+	return result;
+}
+
+static inline uint32_t _indexDecode(const uint8_t *&data, uint32_t last) {
+	uint32_t v = _vbyteDecode(data);
+	return last + ((v >> 1) ^ -(v & 1));
+}
+
+static inline void _indexWrite(uint8_t *out, size_t i, size_t indexSize, uint32_t index) {
+	if (indexSize == 2) {
+		uint16_t narrow = (uint16_t)index;
+		memcpy(out + i * 2, &narrow, sizeof(narrow));
+	} else
+		memcpy(out + i * 4, &index, sizeof(index));
+}
+
+static inline void _triangleWrite(uint8_t *out, size_t i, size_t indexSize, uint32_t a, uint32_t b, uint32_t c) {
+	_indexWrite(out, i + 0, indexSize, a);
+	_indexWrite(out, i + 1, indexSize, b);
+	_indexWrite(out, i + 2, indexSize, c);
+}
+
+// Both fifos must be updated exactly like the encoder does, or the following triangles decode wrong.
+static inline void _vertexPush(uint32_t *fifo, uint32_t vertex, size_t &offset, bool push = true) {
+	fifo[offset] = vertex;
+	offset = (offset + push) & 15;
+}
+
+static inline void _edgePush(uint32_t (*fifo)[2], uint32_t a, uint32_t b, size_t &offset) {
+	fifo[offset][0] = a;
+	fifo[offset][1] = b;
+	offset = (offset + 1) & 15;
+}
+
+bool MeshoptDecoder::indexBufferDecode(uint8_t *out, size_t count, size_t indexSize, const uint8_t *data, size_t size) {
+	if (count % 3 != 0 || (indexSize != 2 && indexSize != 4))
+		return false;
+
+	// one code byte per triangle and a 16 byte table at the end
+	if (size < 1 + count / 3 + 16 || (data[0] & 0xf0) != INDEX_HEADER)
+		return false;
+
+	const uint32_t version = data[0] & 0x0f;
+	if (version > 1)
+		return false;
+
+	uint32_t edgeFifo[16][2];
+	uint32_t vertexFifo[16];
+	memset(edgeFifo, -1, sizeof(edgeFifo));
+	memset(vertexFifo, -1, sizeof(vertexFifo));
+
+	size_t edgeOffset = 0;
+	size_t vertexOffset = 0;
+
+	uint32_t next = 0;
+	uint32_t last = 0;
+
+	// version 1 spends 13 and 14 on free indices one below and above the last one
+	const uint32_t fecMax = version >= 1 ? 13 : 15;
+
+	const uint8_t *code = data + 1;
+	const uint8_t *payload = code + count / 3;
+	const uint8_t *payloadEnd = data + size - 16;
+	const uint8_t *codeauxTable = payloadEnd;
+
+	for (size_t i = 0; i < count; i += 3) {
+		// a triangle reads at most 16 payload bytes, the table behind payloadEnd keeps that in bounds
+		if (payload > payloadEnd)
+			return false;
+
+		uint8_t codetri = *code++;
+
+		if (codetri < 0xf0) {
+			// edge from the fifo plus a vertex from the fifo, the next new one or a free one
+			uint32_t fe = codetri >> 4;
+			uint32_t a = edgeFifo[(edgeOffset - 1 - fe) & 15][0];
+			uint32_t b = edgeFifo[(edgeOffset - 1 - fe) & 15][1];
+
+			uint32_t fec = codetri & 15;
+			uint32_t c;
+
+			if (fec < fecMax) {
+				c = fec == 0 ? next : vertexFifo[(vertexOffset - 1 - fec) & 15];
+				next += fec == 0;
+
+				_vertexPush(vertexFifo, c, vertexOffset, fec == 0);
+			} else {
+				// 13 and 14 map to -1 and +1
+				last = c = fec != 15 ? last + (fec - (fec ^ 3)) : _indexDecode(payload, last);
+
+				_vertexPush(vertexFifo, c, vertexOffset);
+			}
+
+			_triangleWrite(out, i, indexSize, a, b, c);
+			_edgePush(edgeFifo, c, b, edgeOffset);
+			_edgePush(edgeFifo, a, c, edgeOffset);
+		} else if (codetri < 0xfe) {
+			// no shared edge, first vertex is the next new one, the other two come from the table
+			uint8_t codeaux = codeauxTable[codetri & 15];
+			uint32_t feb = codeaux >> 4;
+			uint32_t fec = codeaux & 15;
+
+			uint32_t a = next++;
+
+			uint32_t b = feb == 0 ? next : vertexFifo[(vertexOffset - feb) & 15];
+			next += feb == 0;
+
+			uint32_t c = fec == 0 ? next : vertexFifo[(vertexOffset - fec) & 15];
+			next += fec == 0;
+
+			_triangleWrite(out, i, indexSize, a, b, c);
+
+			_vertexPush(vertexFifo, a, vertexOffset);
+			_vertexPush(vertexFifo, b, vertexOffset, feb == 0);
+			_vertexPush(vertexFifo, c, vertexOffset, fec == 0);
+
+			_edgePush(edgeFifo, b, a, edgeOffset);
+			_edgePush(edgeFifo, c, b, edgeOffset);
+			_edgePush(edgeFifo, a, c, edgeOffset);
+		} else {
+			// codeaux as a full byte, free indices allowed for all three vertices
+			uint8_t codeaux = *payload++;
+			uint32_t fea = codetri == 0xfe ? 0 : 15;
+			uint32_t feb = codeaux >> 4;
+			uint32_t fec = codeaux & 15;
+
+			// a zero byte restarts the new vertex counter
+			if (codeaux == 0)
+				next = 0;
+
+			uint32_t a = fea == 0 ? next++ : 0;
+			uint32_t b = feb == 0 ? next++ : vertexFifo[(vertexOffset - feb) & 15];
+			uint32_t c = fec == 0 ? next++ : vertexFifo[(vertexOffset - fec) & 15];
+
+			if (fea == 15)
+				last = a = _indexDecode(payload, last);
+
+			if (feb == 15)
+				last = b = _indexDecode(payload, last);
+
+			if (fec == 15)
+				last = c = _indexDecode(payload, last);
+
+			_triangleWrite(out, i, indexSize, a, b, c);
+
+			_vertexPush(vertexFifo, a, vertexOffset);
+			_vertexPush(vertexFifo, b, vertexOffset, feb == 0 || feb == 15);
+			_vertexPush(vertexFifo, c, vertexOffset, fec == 0 || fec == 15);
+
+			_edgePush(edgeFifo, b, a, edgeOffset);
+			_edgePush(edgeFifo, c, b, edgeOffset);
+			_edgePush(edgeFifo, a, c, edgeOffset);
+		}
+	}
+
+	// every payload byte is used, up to the table
+	return payload == payloadEnd;
+}
+
+bool MeshoptDecoder::indexSequenceDecode(
+		uint8_t *out, size_t count, size_t indexSize, const uint8_t *data, size_t size) {
+	if (indexSize != 2 && indexSize != 4)
+		return false;
+
+	// at least one byte per index and a 4 byte tail
+	if (size < 1 + count + 4 || (data[0] & 0xf0) != SEQUENCE_HEADER || (data[0] & 0x0f) > 1)
+		return false;
+
+	const uint8_t *payload = data + 1;
+	const uint8_t *payloadEnd = data + size - 4;
+
+	// deltas are relative to one of two baselines, picked by the lowest bit
+	uint32_t last[2] = {};
+
+	for (size_t i = 0; i < count; i++) {
+		if (payload >= payloadEnd)
+			return false;
+
+		uint32_t v = _vbyteDecode(payload);
+		uint32_t baseline = v & 1;
+		v >>= 1;
+
+		uint32_t index = last[baseline] + ((v >> 1) ^ -(v & 1));
+		last[baseline] = index;
+
+		_indexWrite(out, i, indexSize, index);
+	}
+
+	return payload == payloadEnd;
+}
+
+static inline int32_t _round(float value) {
+	return (int32_t)(value + (value >= 0.0f ? 0.5f : -0.5f));
+}
+
+template <typename T>
+static void _octahedralFilterScalar(T *data, size_t count) {
+	const float max = (float)((1 << (sizeof(T) * 8 - 1)) - 1);
+
+	for (size_t i = 0; i < count; i++) {
+		// z holds the value of 1.0, x and y the octahedral coordinates
+		float x = data[i * 4 + 0];
+		float y = data[i * 4 + 1];
+		float z = data[i * 4 + 2] - std::fabs(x) - std::fabs(y);
+
+		// unfold the lower hemisphere
+		float t = std::min(z, 0.0f);
+		x += x >= 0.0f ? t : -t;
+		y += y >= 0.0f ? t : -t;
+
+		float scale = max / std::sqrt(x * x + y * y + z * z);
+
+		data[i * 4 + 0] = (T)_round(x * scale);
+		data[i * 4 + 1] = (T)_round(y * scale);
+		data[i * 4 + 2] = (T)_round(z * scale);
+	}
+}
+
+#ifdef __SSE2__
+
+// Same as the scalar filter on four normals at once, components sign extended to 32 bits.
+static inline void _octahedralFilter4(__m128i &xi, __m128i &yi, __m128i &zi, float max) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	__m128 x = _mm_cvtepi32_ps(xi);
+	__m128 y = _mm_cvtepi32_ps(yi);
+	__m128 z = _mm_sub_ps(_mm_cvtepi32_ps(zi), _mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)));
+
+	__m128 t = _mm_min_ps(z, _mm_setzero_ps());
+	x = _mm_add_ps(x, _mm_xor_ps(t, _mm_and_ps(x, signMask)));
+	y = _mm_add_ps(y, _mm_xor_ps(t, _mm_and_ps(y, signMask)));
+
+	__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+	__m128 scale = _mm_div_ps(_mm_set1_ps(max), length);
+
+	x = _mm_mul_ps(x, scale);
+	y = _mm_mul_ps(y, scale);
+	z = _mm_mul_ps(z, scale);
+
+	xi = _mm_cvttps_epi32(_mm_add_ps(x, _mm_or_ps(half, _mm_and_ps(x, signMask))));
+	yi = _mm_cvttps_epi32(_mm_add_ps(y, _mm_or_ps(half, _mm_and_ps(y, signMask))));
+	zi = _mm_cvttps_epi32(_mm_add_ps(z, _mm_or_ps(half, _mm_and_ps(z, signMask))));
+}
+
+static size_t _octahedralFilter8(int8_t *data, size_t count) {
+	const __m128i byteMask = _mm_set1_epi32(0xff);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4));
+
+		__m128i x = _mm_srai_epi32(_mm_slli_epi32(n, 24), 24);
+		__m128i y = _mm_srai_epi32(_mm_slli_epi32(n, 16), 24);
+		__m128i z = _mm_srai_epi32(_mm_slli_epi32(n, 8), 24);
+
+		_octahedralFilter4(x, y, z, 127.0f);
+
+		__m128i result = _mm_and_si128(n, _mm_set1_epi32((int32_t)0xff000000));
+		result = _mm_or_si128(result, _mm_and_si128(x, byteMask));
+		result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(y, byteMask), 8));
+		result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(z, byteMask), 16));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * 4), result);
+	}
+
+	return i;
+}
+
+static size_t _octahedralFilter16(int16_t *data, size_t count) {
+	const __m128i wordMask = _mm_set1_epi32(0xffff);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		__m128i n0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4));
+		__m128i n1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 4 + 8));
+
+		// xy and zw halves of the four normals
+		n0 = _mm_shuffle_epi32(n0, _MM_SHUFFLE(3, 1, 2, 0));
+		n1 = _mm_shuffle_epi32(n1, _MM_SHUFFLE(3, 1, 2, 0));
+		__m128i xy = _mm_unpacklo_epi64(n0, n1);
+		__m128i zw = _mm_unpackhi_epi64(n0, n1);
+
+		__m128i x = _mm_srai_epi32(_mm_slli_epi32(xy, 16), 16);
+		__m128i y = _mm_srai_epi32(xy, 16);
+		__m128i z = _mm_srai_epi32(_mm_slli_epi32(zw, 16), 16);
+
+		_octahedralFilter4(x, y, z, 32767.0f);
+
+		xy = _mm_or_si128(_mm_and_si128(x, wordMask), _mm_slli_epi32(y, 16));
+		zw = _mm_or_si128(_mm_and_si128(z, wordMask), _mm_andnot_si128(wordMask, zw));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * 4), _mm_unpacklo_epi32(xy, zw));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * 4 + 8), _mm_unpackhi_epi32(xy, zw));
+	}
+
+	return i;
+}
+
+#endif
+
+void MeshoptDecoder::octahedralFilter(void *data, size_t count, size_t stride) {
+	size_t done = 0;
+
+	if (stride == 4) {
+		int8_t *values = static_cast<int8_t *>(data);
+#ifdef __SSE2__
+		done = _octahedralFilter8(values, count);
+#endif
+		_octahedralFilterScalar(values + done * 4, count - done);
+	} else {
+		int16_t *values = static_cast<int16_t *>(data);
+#ifdef __SSE2__
+		done = _octahedralFilter16(values, count);
+#endif
+		_octahedralFilterScalar(values + done * 4, count - done);
+	}
+}
+
+void MeshoptDecoder::quaternionFilter(int16_t *data, size_t count) {
+	const float scale = 1.0f / std::sqrt(2.0f);
+
+	for (size_t i = 0; i < count; i++) {
+		int16_t *q = data + i * 4;
+
+		// the last component holds the index of the dropped one in its low 2 bits and the scale above them
+		float s = scale / (float)(q[3] | 3);
+
+		float x = q[0] * s;
+		float y = q[1] * s;
+		float z = q[2] * s;
+		float w = std::sqrt(std::max(1.0f - x * x - y * y - z * z, 0.0f));
+
+		// w, x, y, z packed from the lowest bits, rotated so w lands at the dropped component
+		uint64_t packed = (uint64_t)(uint16_t)(int32_t)(w * 32767.0f + 0.5f);
+		packed |= (uint64_t)(uint16_t)_round(x * 32767.0f) << 16;
+		packed |= (uint64_t)(uint16_t)_round(y * 32767.0f) << 32;
+		packed |= (uint64_t)(uint16_t)_round(z * 32767.0f) << 48;
+
+		uint32_t rotation = (q[3] & 3) * 16;
+		packed = rotation == 0 ? packed : (packed << rotation) | (packed >> (64 - rotation));
+
+		memcpy(q, &packed, sizeof(packed));
+	}
+}
+
+void MeshoptDecoder::exponentialFilter(uint32_t *data, size_t count, size_t stride) {
+	const size_t words = count * (stride / 4);
+
+	size_t i = 0;
+
+#ifdef __SSE2__
+	for (; i + 4 <= words; i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+
+		__m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+		__m128i exponent = _mm_srai_epi32(v, 24);
+
+		// 2^exponent built directly in the float exponent bits
+		__m128 power = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+		__m128 result = _mm_mul_ps(power, _mm_cvtepi32_ps(mantissa));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data + i), _mm_castps_si128(result));
+	}
+#endif
+
+	for (; i < words; i++) {
+		int32_t mantissa = (int32_t)(data[i] << 8) >> 8;
+		int32_t exponent = (int32_t)data[i] >> 24;
+
+		uint32_t bits = (uint32_t)(exponent + 127) << 23;
+		float power;
+		memcpy(&power, &bits, sizeof(power));
+
+		float result = power * (float)mantissa;
+		memcpy(&data[i], &result, sizeof(result));
+	}
+}
+
+bool MeshoptDecoder::bufferViewDecode(const cgltf_meshopt_compression &compression, uint8_t *out) {
+	const cgltf_buffer *buffer = compression.buffer;
+	if (buffer == nullptr || buffer->data == nullptr || compression.offset > buffer->size ||
+			compression.size > buffer->size - compression.offset)
+		return false;
+
+	const uint8_t *data = static_cast<const uint8_t *>(buffer->data) + compression.offset;
+	const size_t count = compression.count;
+	const size_t stride = compression.stride;
+
+	switch (compression.mode) {
+		case cgltf_meshopt_compression_mode_attributes:
+			if (!vertexBufferDecode(out, count, stride, data, compression.size))
+				return false;
+			break;
+		case cgltf_meshopt_compression_mode_triangles:
+			return indexBufferDecode(out, count, stride, data, compression.size);
+		case cgltf_meshopt_compression_mode_indices:
+			return indexSequenceDecode(out, count, stride, data, compression.size);
+		default:
+			return false;
+	}
+
+	switch (compression.filter) {
+		case cgltf_meshopt_compression_filter_none:
+			return true;
+		case cgltf_meshopt_compression_filter_octahedral:
+			if (stride != 4 && stride != 8)
+				return false;
+
+			octahedralFilter(out, count, stride);
+			return true;
+		case cgltf_meshopt_compression_filter_quaternion:
+			if (stride != 8)
+				return false;
+
+			quaternionFilter(reinterpret_cast<int16_t *>(out), count);
+			return true;
+		case cgltf_meshopt_compression_filter_exponential:
+			exponentialFilter(reinterpret_cast<uint32_t *>(out), count, stride);
+			return true;
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef MESHOPT_DECODER_H
+#define MESHOPT_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+struct cgltf_meshopt_compression;
+
+// Decoders for the EXT_meshopt_compression bitstreams and filters, matching
+// meshoptimizer's meshopt_decode* functions. Vertex data is unpacked with
+// lookup tables, the byte deltas are summed and transposed back into vertices
+// with SSE2 where available, with a scalar fallback elsewhere.
+// Every decoder returns false on malformed input instead of reading past it.
+class MeshoptDecoder {
+public:
+	// Mode ATTRIBUTES, format version 0. out receives count * stride bytes, stride is a multiple of 4 up to 256.
+	static bool vertexBufferDecode(uint8_t *out, size_t count, size_t stride, const uint8_t *data, size_t size);
+
+	// Mode TRIANGLES, format versions 0 and 1. indexSize is 2 or 4, count a multiple of 3.
+	static bool indexBufferDecode(uint8_t *out, size_t count, size_t indexSize, const uint8_t *data, size_t size);
+
+	// Mode INDICES, format version 1. indexSize is 2 or 4.
+	static bool indexSequenceDecode(uint8_t *out, size_t count, size_t indexSize, const uint8_t *data, size_t size);
+
+	// Filters run in place on decoded attributes, count is the number of elements.
+	// OCTAHEDRAL: snorm8 or snorm16 normals, stride 4 or 8, the fourth component is kept.
+	static void octahedralFilter(void *data, size_t count, size_t stride);
+	// QUATERNION: snorm16 rotations with the largest component dropped, stride 8.
+	static void quaternionFilter(int16_t *data, size_t count);
+	// EXPONENTIAL: 24 bit mantissa and 8 bit exponent per 32 bit float, stride a multiple of 4.
+	static void exponentialFilter(uint32_t *data, size_t count, size_t stride);
+
+	// Decodes a compressed buffer view with its filter into out, which holds count * stride bytes.
+	static bool bufferViewDecode(const cgltf_meshopt_compression &compression, uint8_t *out);
+};
+
+#endif // !MESHOPT_DECODER_H
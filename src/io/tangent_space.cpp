@@ -0,0 +1,561 @@
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <core/thread_pool.h>
+
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include <math/types/precision.h>
+
+#include "mesh_welder.h"
+#include "tangent_space.h"
+
+// Faces per task, large enough to hide scheduling overhead.
+const uint32_t FACE_CHUNK = 16384;
+const uint32_t VERTEX_CHUNK = 16384;
+
+// Faces per stack block on the single threaded path.
+const uint32_t SERIAL_BLOCK = 256;
+
+// Per corner: angle weighted tangent in xyz, angle weighted handedness in w.
+typedef struct {
+	float tangent[3];
+	float handedness;
+} Corner;
+
+// acos on [-1, 1], Abramowitz and Stegun 4.4.45, absolute error below 7e-5.
+// Only used for corner weights, where that is plenty.
+static inline float _acos(float x) {
+	float a = std::fabs(x);
+	float r = std::sqrt(1.0f - a) * (1.5707288f + a * (-0.2121144f + a * (0.0742610f + a * -0.0187293f)));
+	return x < 0.0f ? 3.14159265f - r : r;
+}
+
+static void _cornersCompute(const uint32_t *indices, const Vertex *vertices, uint32_t faceBegin, uint32_t faceEnd,
+		Corner *corners) {
+	for (uint32_t face = faceBegin; face < faceEnd; face++) {
+		const Vertex *v[3] = {
+			&vertices[indices[face * 3 + 0]],
+			&vertices[indices[face * 3 + 1]],
+			&vertices[indices[face * 3 + 2]],
+		};
+
+		float e1[3], e2[3];
+		for (int k = 0; k < 3; k++) {
+			e1[k] = v[1]->position[k] - v[0]->position[k];
+			e2[k] = v[2]->position[k] - v[0]->position[k];
+		}
+
+		float du1 = v[1]->texCoord[0] - v[0]->texCoord[0];
+		float dv1 = v[1]->texCoord[1] - v[0]->texCoord[1];
+		float du2 = v[2]->texCoord[0] - v[0]->texCoord[0];
+		float dv2 = v[2]->texCoord[1] - v[0]->texCoord[1];
+
+		float det = du1 * dv2 - du2 * dv1;
+		float r = det != 0.0f ? 1.0f / det : 0.0f;
+
+		float t[3], b[3];
+		for (int k = 0; k < 3; k++) {
+			t[k] = (e1[k] * dv2 - e2[k] * dv1) * r;
+			b[k] = (e2[k] * du1 - e1[k] * du2) * r;
+		}
+
+		for (int c = 0; c < 3; c++) {
+			const float *p = v[c]->position;
+			const float *pa = v[(c + 1) % 3]->position;
+			const float *pb = v[(c + 2) % 3]->position;
+			const float *n = v[c]->normal;
+
+			float a[3] = { pa[0] - p[0], pa[1] - p[1], pa[2] - p[2] };
+			float d[3] = { pb[0] - p[0], pb[1] - p[1], pb[2] - p[2] };
+
+			float lengths = std::sqrt((a[0] * a[0] + a[1] * a[1] + a[2] * a[2]) * (d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+			float cosine = lengths > 0.0f ? (a[0] * d[0] + a[1] * d[1] + a[2] * d[2]) / lengths : 1.0f;
+			float angle = _acos(std::min(std::max(cosine, -1.0f), 1.0f));
+
+			// project the face tangent onto the plane of this corner's normal
+			float nt = n[0] * t[0] + n[1] * t[1] + n[2] * t[2];
+			float tp[3] = { t[0] - n[0] * nt, t[1] - n[1] * nt, t[2] - n[2] * nt };
+
+			float length = std::sqrt(tp[0] * tp[0] + tp[1] * tp[1] + tp[2] * tp[2]);
+			float weight = length > 0.0f ? angle / length : 0.0f;
+
+			// (n x tp) . b
+			float orientation = (n[1] * tp[2] - n[2] * tp[1]) * b[0] + (n[2] * tp[0] - n[0] * tp[2]) * b[1] +
+					(n[0] * tp[1] - n[1] * tp[0]) * b[2];
+
+			Corner &corner = corners[(face - faceBegin) * 3 + c];
+			corner.tangent[0] = tp[0] * weight;
+			corner.tangent[1] = tp[1] * weight;
+			corner.tangent[2] = tp[2] * weight;
+			corner.handedness = length > 0.0f ? (orientation < 0.0f ? -angle : angle) : 0.0f;
+		}
+	}
+}
+
+#ifdef __SSE2__
+
+typedef struct {
+	__m128 x, y, z;
+} Vec3x4;
+
+static inline Vec3x4 _sub(const Vec3x4 &a, const Vec3x4 &b) {
+	return { _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) };
+}
+
+static inline __m128 _dot(const Vec3x4 &a, const Vec3x4 &b) {
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+}
+
+// 1 / sqrt(x) refined with one Newton-Raphson step, about 22 bits of precision.
+static inline __m128 _rsqrt4(__m128 x) {
+	__m128 r = _mm_rsqrt_ps(x);
+	__m128 rr = _mm_mul_ps(_mm_mul_ps(x, r), r);
+	return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), _mm_sub_ps(_mm_set1_ps(3.0f), rr));
+}
+
+static inline __m128 _acos4(__m128 x) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	__m128 a = _mm_andnot_ps(signMask, x);
+
+	__m128 p = _mm_set1_ps(-0.0187293f);
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(0.0742610f));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.2121144f));
+	p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(1.5707288f));
+
+	__m128 r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a)), p);
+	__m128 negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+	__m128 mirrored = _mm_sub_ps(_mm_set1_ps(3.14159265f), r);
+	return _mm_or_ps(_mm_and_ps(negative, mirrored), _mm_andnot_ps(negative, r));
+}
+
+// Gathers position, normal and texture coordinates of corner c of four faces
+// into SoA lanes: three 16 byte loads per vertex and three 4x4 transposes.
+static inline void _gather(const Vertex *vertices, const uint32_t *indices, uint32_t face, int c, Vec3x4 &p, Vec3x4 &n,
+		__m128 &u, __m128 &v) {
+	static_assert(sizeof(Vertex) == 48 && offsetof(Vertex, normal) == 12 && offsetof(Vertex, texCoord) == 40,
+			"_gather assumes the Vertex layout");
+
+	const float *f[4];
+	for (int lane = 0; lane < 4; lane++)
+		f[lane] = vertices[indices[(face + lane) * 3 + c]].position;
+
+	// position.xyz, normal.x
+	__m128 a0 = _mm_loadu_ps(f[0]);
+	__m128 a1 = _mm_loadu_ps(f[1]);
+	__m128 a2 = _mm_loadu_ps(f[2]);
+	__m128 a3 = _mm_loadu_ps(f[3]);
+	_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+
+	// normal.yz, tangent.xy
+	__m128 b0 = _mm_loadu_ps(f[0] + 4);
+	__m128 b1 = _mm_loadu_ps(f[1] + 4);
+	__m128 b2 = _mm_loadu_ps(f[2] + 4);
+	__m128 b3 = _mm_loadu_ps(f[3] + 4);
+	_MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+
+	// tangent.zw, texCoord
+	__m128 c0 = _mm_loadu_ps(f[0] + 8);
+	__m128 c1 = _mm_loadu_ps(f[1] + 8);
+	__m128 c2 = _mm_loadu_ps(f[2] + 8);
+	__m128 c3 = _mm_loadu_ps(f[3] + 8);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+	p.x = a0;
+	p.y = a1;
+	p.z = a2;
+	n.x = a3;
+	n.y = b0;
+	n.z = b1;
+	u = c2;
+	v = c3;
+}
+
+static void _cornersComputeSSE(const uint32_t *indices, const Vertex *vertices, uint32_t faceBegin, uint32_t faceEnd,
+		Corner *corners) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	uint32_t face = faceBegin;
+	for (; face + 4 <= faceEnd; face += 4) {
+		Vec3x4 p[3], n[3];
+		__m128 u[3], v[3];
+
+		for (int c = 0; c < 3; c++)
+			_gather(vertices, indices, face, c, p[c], n[c], u[c], v[c]);
+
+		Vec3x4 e1 = _sub(p[1], p[0]);
+		Vec3x4 e2 = _sub(p[2], p[0]);
+
+		__m128 du1 = _mm_sub_ps(u[1], u[0]);
+		__m128 dv1 = _mm_sub_ps(v[1], v[0]);
+		__m128 du2 = _mm_sub_ps(u[2], u[0]);
+		__m128 dv2 = _mm_sub_ps(v[2], v[0]);
+
+		__m128 det = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+		__m128 r = _mm_and_ps(_mm_cmpneq_ps(det, zero), _mm_div_ps(one, det));
+
+		Vec3x4 t = {
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1.x, dv2), _mm_mul_ps(e2.x, dv1)), r),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1.y, dv2), _mm_mul_ps(e2.y, dv1)), r),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e1.z, dv2), _mm_mul_ps(e2.z, dv1)), r),
+		};
+
+		Vec3x4 b = {
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e2.x, du1), _mm_mul_ps(e1.x, du2)), r),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e2.y, du1), _mm_mul_ps(e1.y, du2)), r),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(e2.z, du1), _mm_mul_ps(e1.z, du2)), r),
+		};
+
+		for (int c = 0; c < 3; c++) {
+			Vec3x4 a = _sub(p[(c + 1) % 3], p[c]);
+			Vec3x4 d = _sub(p[(c + 2) % 3], p[c]);
+
+			__m128 lengths = _mm_mul_ps(_dot(a, a), _dot(d, d));
+			__m128 valid = _mm_cmpgt_ps(lengths, zero);
+			__m128 cosine = _mm_mul_ps(_dot(a, d), _rsqrt4(lengths));
+			cosine = _mm_or_ps(_mm_and_ps(valid, cosine), _mm_andnot_ps(valid, one));
+			cosine = _mm_min_ps(_mm_max_ps(cosine, minusOne), one);
+			__m128 angle = _acos4(cosine);
+
+			const Vec3x4 &nc = n[c];
+			__m128 nt = _dot(nc, t);
+			Vec3x4 tp = {
+				_mm_sub_ps(t.x, _mm_mul_ps(nc.x, nt)),
+				_mm_sub_ps(t.y, _mm_mul_ps(nc.y, nt)),
+				_mm_sub_ps(t.z, _mm_mul_ps(nc.z, nt)),
+			};
+
+			__m128 length = _dot(tp, tp);
+			__m128 hasLength = _mm_cmpgt_ps(length, zero);
+			__m128 weight = _mm_and_ps(hasLength, _mm_mul_ps(angle, _rsqrt4(length)));
+
+			Vec3x4 cross = {
+				_mm_sub_ps(_mm_mul_ps(nc.y, tp.z), _mm_mul_ps(nc.z, tp.y)),
+				_mm_sub_ps(_mm_mul_ps(nc.z, tp.x), _mm_mul_ps(nc.x, tp.z)),
+				_mm_sub_ps(_mm_mul_ps(nc.x, tp.y), _mm_mul_ps(nc.y, tp.x)),
+			};
+
+			__m128 flip = _mm_and_ps(_mm_cmplt_ps(_dot(cross, b), zero), signMask);
+			__m128 handedness = _mm_and_ps(hasLength, _mm_xor_ps(angle, flip));
+
+			__m128 x = _mm_mul_ps(tp.x, weight);
+			__m128 y = _mm_mul_ps(tp.y, weight);
+			__m128 z = _mm_mul_ps(tp.z, weight);
+			__m128 w = handedness;
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			Corner *out = &corners[(face - faceBegin) * 3 + c];
+			_mm_storeu_ps(out[0].tangent, x);
+			_mm_storeu_ps(out[3].tangent, y);
+			_mm_storeu_ps(out[6].tangent, z);
+			_mm_storeu_ps(out[9].tangent, w);
+		}
+	}
+
+	_cornersCompute(indices, vertices, face, faceEnd, corners + (face - faceBegin) * 3);
+}
+
+#endif // __SSE2__
+
+// Any unit vector perpendicular to n, for vertices no face gave a tangent to.
+static void _perpendicular(const float *n, float *out) {
+	float axis[3] = { 1.0f, 0.0f, 0.0f };
+	if (std::fabs(n[0]) > 0.9f) {
+		axis[0] = 0.0f;
+		axis[1] = 1.0f;
+	}
+
+	float d = n[0] * axis[0] + n[1] * axis[1] + n[2] * axis[2];
+	float t[3] = { axis[0] - n[0] * d, axis[1] - n[1] * d, axis[2] - n[2] * d };
+	float length = std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+
+	out[0] = t[0] / length;
+	out[1] = t[1] / length;
+	out[2] = t[2] / length;
+}
+
+static inline void _cornersComputeBest(
+		const uint32_t *indices, const Vertex *vertices, uint32_t faceBegin, uint32_t faceEnd, Corner *corners) {
+#ifdef __SSE2__
+	_cornersComputeSSE(indices, vertices, faceBegin, faceEnd, corners);
+#else
+	_cornersCompute(indices, vertices, faceBegin, faceEnd, corners);
+#endif
+}
+
+static void _tangentStore(const float *sum, Vertex &vertex) {
+	// FLT_MIN keeps the fast rsqrt tier away from denormals, a length of about 1e-19
+	float lengthSquared = sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2];
+	if (lengthSquared >= FLT_MIN) {
+		float scale = math::rsqrt(lengthSquared);
+		vertex.tangent[0] = sum[0] * scale;
+		vertex.tangent[1] = sum[1] * scale;
+		vertex.tangent[2] = sum[2] * scale;
+	} else {
+		_perpendicular(vertex.normal, vertex.tangent);
+	}
+
+	vertex.tangent[3] = sum[3] < 0.0f ? -1.0f : 1.0f;
+}
+
+// Single thread: corners are added to their vertex straight away, in index buffer order.
+static void _tangentsGenerateSerial(const IndexArray &indices, VertexArray &vertices) {
+	const uint32_t faceCount = indices.count / 3;
+
+	std::vector<float> sums(vertices.count * 4, 0.0f);
+
+	Corner block[SERIAL_BLOCK * 3];
+	for (uint32_t begin = 0; begin < faceCount; begin += SERIAL_BLOCK) {
+		uint32_t end = std::min(begin + SERIAL_BLOCK, faceCount);
+		_cornersComputeBest(indices.data, vertices.data, begin, end, block);
+
+		for (uint32_t i = 0; i < (end - begin) * 3; i++) {
+			float *sum = &sums[indices.data[begin * 3 + i] * 4];
+			sum[0] += block[i].tangent[0];
+			sum[1] += block[i].tangent[1];
+			sum[2] += block[i].tangent[2];
+			sum[3] += block[i].handedness;
+		}
+	}
+
+	for (uint32_t i = 0; i < vertices.count; i++)
+		_tangentStore(&sums[i * 4], vertices.data[i]);
+}
+
+// Multiple threads: corners go to a buffer, each vertex then sums its own corners
+// through a vertex to corner table. Summation order matches the serial path, so
+// both produce identical results.
+static void _tangentsGenerateParallel(const IndexArray &indices, VertexArray &vertices, ThreadPool &pool) {
+	const uint32_t faceCount = indices.count / 3;
+	const uint32_t vertexCount = vertices.count;
+
+	std::unique_ptr<Corner[]> corners(new Corner[indices.count]);
+
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	std::unique_ptr<uint32_t[]> vertexCorners(new uint32_t[indices.count]);
+
+	// the table only depends on indices, one task builds it while the others compute faces
+	const uint32_t faceChunks = (faceCount + FACE_CHUNK - 1) / FACE_CHUNK;
+	pool.parallelFor(faceChunks + 1, [&](uint32_t task) {
+		if (task < faceChunks) {
+			uint32_t begin = task * FACE_CHUNK;
+			uint32_t end = std::min(begin + FACE_CHUNK, faceCount);
+			_cornersComputeBest(indices.data, vertices.data, begin, end, &corners[begin * 3]);
+			return;
+		}
+
+		for (uint32_t i = 0; i < indices.count; i++)
+			offsets[indices.data[i] + 1]++;
+
+		for (uint32_t i = 0; i < vertexCount; i++)
+			offsets[i + 1] += offsets[i];
+
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < indices.count; i++)
+			vertexCorners[cursor[indices.data[i]]++] = i;
+	});
+
+	const uint32_t vertexChunks = (vertexCount + VERTEX_CHUNK - 1) / VERTEX_CHUNK;
+	pool.parallelFor(vertexChunks, [&](uint32_t chunk) {
+		uint32_t begin = chunk * VERTEX_CHUNK;
+		uint32_t end = std::min(begin + VERTEX_CHUNK, vertexCount);
+
+		for (uint32_t i = begin; i < end; i++) {
+			float sum[4] = {};
+			for (uint32_t j = offsets[i]; j < offsets[i + 1]; j++) {
+				const Corner &corner = corners[vertexCorners[j]];
+				sum[0] += corner.tangent[0];
+				sum[1] += corner.tangent[1];
+				sum[2] += corner.tangent[2];
+				sum[3] += corner.handedness;
+			}
+
+			_tangentStore(sum, vertices.data[i]);
+		}
+	});
+}
+
+// Face normal of every corner, scaled by twice the face area or by the corner angle.
+static void _cornerNormalsCompute(const uint32_t *indices, const Vertex *vertices, NormalWeighting weighting,
+		uint32_t faceBegin, uint32_t faceEnd, float *normals) {
+	for (uint32_t face = faceBegin; face < faceEnd; face++) {
+		const float *p[3] = {
+			vertices[indices[face * 3 + 0]].position,
+			vertices[indices[face * 3 + 1]].position,
+			vertices[indices[face * 3 + 2]].position,
+		};
+
+		float e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+		float e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+		float n[3] = {
+			e1[1] * e2[2] - e1[2] * e2[1],
+			e1[2] * e2[0] - e1[0] * e2[2],
+			e1[0] * e2[1] - e1[1] * e2[0],
+		};
+
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+		for (int c = 0; c < 3; c++) {
+			float weight = 1.0f;
+
+			if (weighting == NORMAL_WEIGHTING_ANGLE) {
+				const float *pa = p[(c + 1) % 3];
+				const float *pb = p[(c + 2) % 3];
+
+				float a[3] = { pa[0] - p[c][0], pa[1] - p[c][1], pa[2] - p[c][2] };
+				float d[3] = { pb[0] - p[c][0], pb[1] - p[c][1], pb[2] - p[c][2] };
+
+				float aa = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+				float dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+				float lengths = std::sqrt(aa * dd);
+				float cosine = lengths > 0.0f ? (a[0] * d[0] + a[1] * d[1] + a[2] * d[2]) / lengths : 1.0f;
+
+				weight = length > 0.0f ? _acos(std::min(std::max(cosine, -1.0f), 1.0f)) / length : 0.0f;
+			}
+
+			float *out = &normals[((face - faceBegin) * 3 + c) * 3];
+			out[0] = n[0] * weight;
+			out[1] = n[1] * weight;
+			out[2] = n[2] * weight;
+		}
+	}
+}
+
+static void _normalStore(const float *sum, Vertex &vertex) {
+	// FLT_MIN keeps the fast rsqrt tier away from denormals, a length of about 1e-19
+	float lengthSquared = sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2];
+	if (lengthSquared >= FLT_MIN) {
+		float scale = math::rsqrt(lengthSquared);
+		vertex.normal[0] = sum[0] * scale;
+		vertex.normal[1] = sum[1] * scale;
+		vertex.normal[2] = sum[2] * scale;
+	} else {
+		vertex.normal[0] = 0.0f;
+		vertex.normal[1] = 0.0f;
+		vertex.normal[2] = 1.0f;
+	}
+}
+
+// Single thread: corners are added to the first vertex at their position, in index buffer order.
+static void _normalsGenerateSerial(
+		const IndexArray &indices, VertexArray &vertices, NormalWeighting weighting, const uint32_t *remap) {
+	const uint32_t faceCount = indices.count / 3;
+
+	std::vector<float> sums(vertices.count * 3, 0.0f);
+
+	float block[SERIAL_BLOCK * 9];
+	for (uint32_t begin = 0; begin < faceCount; begin += SERIAL_BLOCK) {
+		uint32_t end = std::min(begin + SERIAL_BLOCK, faceCount);
+		_cornerNormalsCompute(indices.data, vertices.data, weighting, begin, end, block);
+
+		for (uint32_t i = 0; i < (end - begin) * 3; i++) {
+			float *sum = &sums[remap[indices.data[begin * 3 + i]] * 3];
+			sum[0] += block[i * 3 + 0];
+			sum[1] += block[i * 3 + 1];
+			sum[2] += block[i * 3 + 2];
+		}
+	}
+
+	for (uint32_t i = 0; i < vertices.count; i++)
+		_normalStore(&sums[remap[i] * 3], vertices.data[i]);
+}
+
+// Multiple threads: same scheme as the tangents, the table goes from each position
+// to the corners of every vertex there. Results match the serial path.
+static void _normalsGenerateParallel(const IndexArray &indices, VertexArray &vertices, NormalWeighting weighting,
+		const uint32_t *remap, ThreadPool &pool) {
+	const uint32_t faceCount = indices.count / 3;
+	const uint32_t vertexCount = vertices.count;
+
+	std::unique_ptr<float[]> normals(new float[indices.count * 3]);
+
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	std::unique_ptr<uint32_t[]> positionCorners(new uint32_t[indices.count]);
+
+	const uint32_t faceChunks = (faceCount + FACE_CHUNK - 1) / FACE_CHUNK;
+	pool.parallelFor(faceChunks + 1, [&](uint32_t task) {
+		if (task < faceChunks) {
+			uint32_t begin = task * FACE_CHUNK;
+			uint32_t end = std::min(begin + FACE_CHUNK, faceCount);
+			_cornerNormalsCompute(indices.data, vertices.data, weighting, begin, end, &normals[begin * 9]);
+			return;
+		}
+
+		for (uint32_t i = 0; i < indices.count; i++)
+			offsets[remap[indices.data[i]] + 1]++;
+
+		for (uint32_t i = 0; i < vertexCount; i++)
+			offsets[i + 1] += offsets[i];
+
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < indices.count; i++)
+			positionCorners[cursor[remap[indices.data[i]]]++] = i;
+	});
+
+	// first the vertices owning a position, then everyone else copies from them
+	const uint32_t vertexChunks = (vertexCount + VERTEX_CHUNK - 1) / VERTEX_CHUNK;
+	pool.parallelFor(vertexChunks, [&](uint32_t chunk) {
+		uint32_t begin = chunk * VERTEX_CHUNK;
+		uint32_t end = std::min(begin + VERTEX_CHUNK, vertexCount);
+
+		for (uint32_t i = begin; i < end; i++) {
+			if (remap[i] != i)
+				continue;
+
+			float sum[3] = {};
+			for (uint32_t j = offsets[i]; j < offsets[i + 1]; j++) {
+				const float *normal = &normals[positionCorners[j] * 3];
+				sum[0] += normal[0];
+				sum[1] += normal[1];
+				sum[2] += normal[2];
+			}
+
+			_normalStore(sum, vertices.data[i]);
+		}
+	});
+
+	pool.parallelFor(vertexChunks, [&](uint32_t chunk) {
+		uint32_t begin = chunk * VERTEX_CHUNK;
+		uint32_t end = std::min(begin + VERTEX_CHUNK, vertexCount);
+
+		for (uint32_t i = begin; i < end; i++)
+			memcpy(vertices.data[i].normal, vertices.data[remap[i]].normal, sizeof(vertices.data[i].normal));
+	});
+}
+
+void TangentSpace::normalsGenerate(
+		const IndexArray &indices, VertexArray &vertices, NormalWeighting weighting, ThreadPool *pool) {
+	assert(indices.count % 3 == 0);
+
+	std::unique_ptr<uint32_t[]> remap(new uint32_t[vertices.count]);
+	MeshWelder::positionsRemap(vertices, remap.get());
+
+	if (pool == nullptr || pool->threadCount() == 1 || indices.count / 3 <= FACE_CHUNK)
+		_normalsGenerateSerial(indices, vertices, weighting, remap.get());
+	else
+		_normalsGenerateParallel(indices, vertices, weighting, remap.get(), *pool);
+}
+
+void TangentSpace::tangentsGenerate(const IndexArray &indices, VertexArray &vertices, ThreadPool *pool) {
+	assert(indices.count % 3 == 0);
+
+	if (pool == nullptr || pool->threadCount() == 1 || indices.count / 3 <= FACE_CHUNK)
+		_tangentsGenerateSerial(indices, vertices);
+	else
+		_tangentsGenerateParallel(indices, vertices, *pool);
+}
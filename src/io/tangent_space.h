@@ -0,0 +1,31 @@
+#ifndef TANGENT_SPACE_H
+#define TANGENT_SPACE_H
+
+#include <io/types/mesh.h>
+
+class ThreadPool;
+
+typedef enum {
+	NORMAL_WEIGHTING_AREA,  // face normals weighted by triangle area, fine for even tessellation
+	NORMAL_WEIGHTING_ANGLE, // by corner angle, independent of how faces are split, better for CAD exports
+} NormalWeighting;
+
+// MikkTSpace-style tangent generation: per-face tangents are projected onto
+// the tangent plane of each corner's normal and accumulated weighted by the
+// corner angle, handedness goes to tangent[3] (+1 or -1). Unlike MikkTSpace,
+// vertices are never split, so vertices shared across a UV mirror seam get the
+// dominant handedness instead of being duplicated.
+class TangentSpace {
+public:
+	// Faces are processed four at a time with SSE where available. With a pool,
+	// the face and vertex passes are spread across it. Results do not depend on
+	// the number of threads.
+	static void tangentsGenerate(const IndexArray &indices, VertexArray &vertices, ThreadPool *pool = nullptr);
+
+	// Smooth normals for primitives without any. Vertices sharing a position get the same
+	// normal, so UV seams do not show. Threads are used the same way as for tangents.
+	static void normalsGenerate(
+			const IndexArray &indices, VertexArray &vertices, NormalWeighting weighting, ThreadPool *pool = nullptr);
+};
+
+#endif // !TANGENT_SPACE_H
@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <stb/stb_image.h>
+
+#include <core/arena.h>
+
+#include <io/types/texture.h>
+
+#include "ktx2_file.h"
+#include "texture_decoder.h"
+
+// Resolution of the linear to sRGB table, fine enough to keep the darkest sRGB codes apart.
+const uint32_t LINEAR_STEPS = 8192;
+
+// Kaiser window: radius in destination texels and shape.
+const float KAISER_RADIUS = 3.0f;
+const float KAISER_ALPHA = 4.0f;
+
+typedef struct {
+	float srgbToLinear[256];
+	float unormToFloat[256];
+	uint8_t linearToSrgb[LINEAR_STEPS];
+} ColorTables;
+
+static float _srgbDecode(float c) {
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static float _srgbEncode(float c) {
+	return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+static ColorTables _colorTablesBuild() {
+	ColorTables tables;
+
+	for (uint32_t i = 0; i < 256; i++) {
+		tables.srgbToLinear[i] = _srgbDecode(i / 255.0f);
+		tables.unormToFloat[i] = i / 255.0f;
+	}
+
+	for (uint32_t i = 0; i < LINEAR_STEPS; i++)
+		tables.linearToSrgb[i] = (uint8_t)(_srgbEncode(i / (float)(LINEAR_STEPS - 1)) * 255.0f + 0.5f);
+
+	return tables;
+}
+
+static const ColorTables &_colorTables() {
+	static const ColorTables tables = _colorTablesBuild();
+	return tables;
+}
+
+// One RGBA texel in float, the filters are written once against these helpers.
+#ifdef __SSE2__
+
+typedef __m128 Pixel;
+
+static inline Pixel _pixelZero() {
+	return _mm_setzero_ps();
+}
+
+static inline Pixel _pixelLoad(const float *p) {
+	return _mm_loadu_ps(p);
+}
+
+static inline void _pixelStore(float *p, Pixel v) {
+	_mm_storeu_ps(p, v);
+}
+
+static inline Pixel _pixelAdd(Pixel a, Pixel b) {
+	return _mm_add_ps(a, b);
+}
+
+static inline Pixel _pixelMulAdd(Pixel sum, Pixel v, float weight) {
+	return _mm_add_ps(sum, _mm_mul_ps(v, _mm_set1_ps(weight)));
+}
+
+#else
+
+typedef struct {
+	float v[4];
+} Pixel;
+
+static inline Pixel _pixelZero() {
+	Pixel p = {};
+	return p;
+}
+
+static inline Pixel _pixelLoad(const float *p) {
+	Pixel v;
+	memcpy(v.v, p, sizeof(v.v));
+	return v;
+}
+
+static inline void _pixelStore(float *p, Pixel v) {
+	memcpy(p, v.v, sizeof(v.v));
+}
+
+static inline Pixel _pixelAdd(Pixel a, Pixel b) {
+	for (int c = 0; c < 4; c++)
+		a.v[c] += b.v[c];
+
+	return a;
+}
+
+static inline Pixel _pixelMulAdd(Pixel sum, Pixel v, float weight) {
+	for (int c = 0; c < 4; c++)
+		sum.v[c] += v.v[c] * weight;
+
+	return sum;
+}
+
+#endif // __SSE2__
+
+static void _rowDecode(const uint8_t *row, uint32_t width, bool srgb, float *out) {
+	const ColorTables &tables = _colorTables();
+	const float *color = srgb ? tables.srgbToLinear : tables.unormToFloat;
+
+	for (uint32_t x = 0; x < width; x++) {
+		out[x * 4 + 0] = color[row[x * 4 + 0]];
+		out[x * 4 + 1] = color[row[x * 4 + 1]];
+		out[x * 4 + 2] = color[row[x * 4 + 2]];
+		out[x * 4 + 3] = tables.unormToFloat[row[x * 4 + 3]];
+	}
+}
+
+static void _rowEncode(const float *row, uint32_t width, bool srgb, uint8_t *out) {
+	const ColorTables &tables = _colorTables();
+
+	// color channels index the sRGB table when srgb is set, alpha always rounds to 8 bits
+	const float colorScale = srgb ? LINEAR_STEPS - 1 : 255.0f;
+
+#ifdef __SSE2__
+	const __m128 scale = _mm_setr_ps(colorScale, colorScale, colorScale, 255.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+
+	for (uint32_t x = 0; x < width; x++) {
+		__m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&row[x * 4]), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+		int32_t q[4];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(q), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), half)));
+
+		for (int c = 0; c < 3; c++)
+			out[x * 4 + c] = srgb ? tables.linearToSrgb[q[c]] : (uint8_t)q[c];
+
+		out[x * 4 + 3] = (uint8_t)q[3];
+	}
+#else
+	for (uint32_t x = 0; x < width; x++) {
+		for (int c = 0; c < 4; c++) {
+			float v = std::min(std::max(row[x * 4 + c], 0.0f), 1.0f);
+			int32_t q = (int32_t)(v * (c < 3 ? colorScale : 255.0f) + 0.5f);
+
+			out[x * 4 + c] = (c < 3 && srgb) ? tables.linearToSrgb[q] : (uint8_t)q;
+		}
+	}
+#endif
+}
+
+static void _levelBox(const MipLevel &source, const uint8_t *sourceData, const MipLevel &target, uint8_t *targetData,
+		bool srgb) {
+	std::vector<float> rows(source.width * 4 * 2);
+	std::vector<float> result(target.width * 4);
+
+	float *row0 = rows.data();
+	float *row1 = rows.data() + source.width * 4;
+
+	// odd sizes drop the last row and column, like a GPU generated chain
+	for (uint32_t y = 0; y < target.height; y++) {
+		uint32_t y0 = std::min(y * 2, source.height - 1);
+		uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+		_rowDecode(sourceData + (uint64_t)y0 * source.width * 4, source.width, srgb, row0);
+		_rowDecode(sourceData + (uint64_t)y1 * source.width * 4, source.width, srgb, row1);
+
+		for (uint32_t x = 0; x < target.width; x++) {
+			uint32_t x0 = std::min(x * 2, source.width - 1) * 4;
+			uint32_t x1 = std::min(x * 2 + 1, source.width - 1) * 4;
+
+			Pixel sum = _pixelAdd(_pixelAdd(_pixelLoad(&row0[x0]), _pixelLoad(&row0[x1])),
+					_pixelAdd(_pixelLoad(&row1[x0]), _pixelLoad(&row1[x1])));
+
+			_pixelStore(&result[x * 4], _pixelMulAdd(_pixelZero(), sum, 0.25f));
+		}
+
+		_rowEncode(result.data(), target.width, srgb, targetData + (uint64_t)y * target.width * 4);
+	}
+}
+
+static float _besselI0(float x) {
+	float sum = 1.0f, term = 1.0f;
+	for (int k = 1; k < 16; k++) {
+		term *= (x * 0.5f / k) * (x * 0.5f / k);
+		sum += term;
+	}
+
+	return sum;
+}
+
+// Tap indices, clamped to the edge, and normalized weights for every target texel along one axis.
+static uint32_t _kaiserTaps(
+		uint32_t sourceSize, uint32_t targetSize, std::vector<uint32_t> &indices, std::vector<float> &weights) {
+	const float scale = (float)sourceSize / targetSize;
+	const float support = KAISER_RADIUS * scale;
+	const uint32_t taps = 2 * (uint32_t)std::ceil(support);
+	const float normalization = _besselI0(KAISER_ALPHA);
+
+	indices.resize(targetSize * taps);
+	weights.resize(targetSize * taps);
+
+	for (uint32_t i = 0; i < targetSize; i++) {
+		float center = (i + 0.5f) * scale;
+		int32_t first = (int32_t)std::floor(center - support + 0.5f);
+
+		float total = 0.0f;
+		for (uint32_t t = 0; t < taps; t++) {
+			int32_t j = first + (int32_t)t;
+			float d = (j + 0.5f - center) / scale;
+
+			float sinc = d == 0.0f ? 1.0f : std::sin(float(M_PI) * d) / (float(M_PI) * d);
+			float window = d / KAISER_RADIUS;
+			window = std::fabs(window) < 1.0f ? _besselI0(KAISER_ALPHA * std::sqrt(1.0f - window * window)) : 0.0f;
+
+			indices[i * taps + t] = std::min(std::max(j, 0), (int32_t)sourceSize - 1);
+			weights[i * taps + t] = sinc * window / normalization;
+			total += weights[i * taps + t];
+		}
+
+		for (uint32_t t = 0; t < taps; t++)
+			weights[i * taps + t] /= total;
+	}
+
+	return taps;
+}
+
+static void _levelKaiser(const MipLevel &source, const uint8_t *sourceData, const MipLevel &target,
+		uint8_t *targetData, bool srgb) {
+	std::vector<uint32_t> columnIndices, rowIndices;
+	std::vector<float> columnWeights, rowWeights;
+
+	const uint32_t columnTaps = _kaiserTaps(source.width, target.width, columnIndices, columnWeights);
+	const uint32_t rowTaps = _kaiserTaps(source.height, target.height, rowIndices, rowWeights);
+
+	// horizontally filtered source rows, a target row reads rowTaps consecutive ones, so a ring that size holds them
+	std::vector<float> ring(rowTaps * target.width * 4);
+	std::vector<int64_t> ringRows(rowTaps, -1);
+
+	std::vector<float> decoded(source.width * 4);
+	std::vector<float> result(target.width * 4);
+
+	for (uint32_t y = 0; y < target.height; y++) {
+		for (uint32_t x = 0; x < target.width; x++)
+			_pixelStore(&result[x * 4], _pixelZero());
+
+		for (uint32_t t = 0; t < rowTaps; t++) {
+			uint32_t sourceRow = rowIndices[y * rowTaps + t];
+			float *filtered = &ring[(sourceRow % rowTaps) * target.width * 4];
+
+			if (ringRows[sourceRow % rowTaps] != sourceRow) {
+				_rowDecode(sourceData + (uint64_t)sourceRow * source.width * 4, source.width, srgb, decoded.data());
+
+				for (uint32_t x = 0; x < target.width; x++) {
+					Pixel sum = _pixelZero();
+					for (uint32_t k = 0; k < columnTaps; k++) {
+						const float *texel = &decoded[columnIndices[x * columnTaps + k] * 4];
+						sum = _pixelMulAdd(sum, _pixelLoad(texel), columnWeights[x * columnTaps + k]);
+					}
+
+					_pixelStore(&filtered[x * 4], sum);
+				}
+
+				ringRows[sourceRow % rowTaps] = sourceRow;
+			}
+
+			float weight = rowWeights[y * rowTaps + t];
+			for (uint32_t x = 0; x < target.width; x++) {
+				Pixel sum = _pixelMulAdd(_pixelLoad(&result[x * 4]), _pixelLoad(&filtered[x * 4]), weight);
+				_pixelStore(&result[x * 4], sum);
+			}
+		}
+
+		_rowEncode(result.data(), target.width, srgb, targetData + (uint64_t)y * target.width * 4);
+	}
+}
+
+ImageFormat TextureDecoder::formatDetect(const uint8_t *data, size_t size) {
+	const uint8_t PNG_MAGIC[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+	const uint8_t JPEG_MAGIC[3] = { 0xff, 0xd8, 0xff };
+
+	if (size >= sizeof(PNG_MAGIC) && memcmp(data, PNG_MAGIC, sizeof(PNG_MAGIC)) == 0)
+		return IMAGE_FORMAT_PNG;
+
+	if (size >= sizeof(JPEG_MAGIC) && memcmp(data, JPEG_MAGIC, sizeof(JPEG_MAGIC)) == 0)
+		return IMAGE_FORMAT_JPEG;
+
+	if (KTX2File::formatDetect(data, size))
+		return IMAGE_FORMAT_KTX2;
+
+	return IMAGE_FORMAT_OTHER;
+}
+
+const char *TextureDecoder::formatName(ImageFormat format) {
+	switch (format) {
+		case IMAGE_FORMAT_PNG:
+			return "png";
+		case IMAGE_FORMAT_JPEG:
+			return "jpeg";
+		case IMAGE_FORMAT_KTX2:
+			return "ktx2";
+		default:
+			return "other";
+	}
+}
+
+uint8_t *TextureDecoder::pixelsDecode(const uint8_t *data, size_t size, uint32_t *width, uint32_t *height) {
+	int x, y, channels;
+	uint8_t *pixels = stbi_load_from_memory(data, size, &x, &y, &channels, 4);
+	if (pixels == nullptr)
+		return nullptr;
+
+	*width = x;
+	*height = y;
+	return pixels;
+}
+
+void TextureDecoder::pixelsFree(uint8_t *pixels) {
+	stbi_image_free(pixels);
+}
+
+Texture TextureDecoder::textureCreate(
+		const uint8_t *pixels, uint32_t width, uint32_t height, bool srgb, MipFilter filter, Arena &arena) {
+	Texture texture = {};
+	texture.width = width;
+	texture.height = height;
+	texture.format = TEXTURE_FORMAT_RGBA8;
+	texture.srgb = srgb;
+
+	uint32_t levelWidth = width, levelHeight = height;
+	while (texture.mipCount < TEXTURE_MAX_MIPS) {
+		MipLevel &level = texture.mips[texture.mipCount++];
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.offset = texture.size;
+		level.size = (uint64_t)levelWidth * levelHeight * 4;
+
+		texture.size += level.size;
+
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+
+		levelWidth = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+	}
+
+	texture.data = arena.arrayAllocate<uint8_t>(texture.size);
+	memcpy(texture.data, pixels, texture.mips[0].size);
+
+	// every level is filtered from the one above it, reading 8 bit texels keeps the working set to a few rows
+	for (uint32_t i = 1; i < texture.mipCount; i++) {
+		const MipLevel &source = texture.mips[i - 1];
+		const MipLevel &target = texture.mips[i];
+
+		if (filter == MIP_FILTER_KAISER)
+			_levelKaiser(source, texture.data + source.offset, target, texture.data + target.offset, srgb);
+		else
+			_levelBox(source, texture.data + source.offset, target, texture.data + target.offset, srgb);
+	}
+
+	return texture;
+}
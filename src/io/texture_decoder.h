@@ -0,0 +1,42 @@
+#ifndef TEXTURE_DECODER_H
+#define TEXTURE_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <io/types/texture.h>
+
+class Arena;
+
+typedef enum {
+	MIP_FILTER_BOX,    // 2x2 average, cheap
+	MIP_FILTER_KAISER, // Kaiser windowed sinc, keeps detail in lower levels at about 6x the cost of box
+} MipFilter;
+
+typedef enum {
+	IMAGE_FORMAT_PNG,
+	IMAGE_FORMAT_JPEG,
+	IMAGE_FORMAT_KTX2, // read by KTX2File, already carries its mip chain
+	IMAGE_FORMAT_OTHER,
+	IMAGE_FORMAT_COUNT,
+} ImageFormat;
+
+// Image decoding through stb_image and CPU mip chain generation. Levels are
+// filtered in float, color textures in linear space with sRGB conversion on
+// both ends, four channels at a time with SSE where available. Every call is
+// independent, images can be decoded on any number of threads at once.
+class TextureDecoder {
+public:
+	static ImageFormat formatDetect(const uint8_t *data, size_t size);
+	static const char *formatName(ImageFormat format);
+
+	// Decodes to tightly packed RGBA8, release with pixelsFree. Returns nullptr if the image cannot be decoded.
+	static uint8_t *pixelsDecode(const uint8_t *data, size_t size, uint32_t *width, uint32_t *height);
+	static void pixelsFree(uint8_t *pixels);
+
+	// Copies pixels into level 0 and generates every level below it, the chain lives in arena.
+	static Texture textureCreate(
+			const uint8_t *pixels, uint32_t width, uint32_t height, bool srgb, MipFilter filter, Arena &arena);
+};
+
+#endif // !TEXTURE_DECODER_H
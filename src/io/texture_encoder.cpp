@@ -0,0 +1,818 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <core/arena.h>
+#include <core/thread_pool.h>
+#include <core/timer.h>
+
+#include <io/types/texture.h>
+
+#include "texture_encoder.h"
+
+const uint32_t BLOCK_SIZE = 4;
+const uint32_t BLOCK_TEXELS = BLOCK_SIZE * BLOCK_SIZE;
+
+// Rows of blocks per task, a 4K level splits into 64 tasks.
+const uint32_t BLOCK_ROWS_PER_TASK = 16;
+
+// Endpoint refinements after the principal axis fit, more rarely pay off.
+const uint32_t REFINE_ITERATIONS = 2;
+
+const uint8_t BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+typedef uint8_t Block[BLOCK_TEXELS][4];
+
+// Texels past the level edge repeat the last row and column, so they do not pull the endpoints.
+static void _blockLoad(const uint8_t *level, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY,
+		Block block) {
+	for (uint32_t y = 0; y < BLOCK_SIZE; y++) {
+		uint32_t sourceY = std::min(blockY * BLOCK_SIZE + y, height - 1);
+
+		for (uint32_t x = 0; x < BLOCK_SIZE; x++) {
+			uint32_t sourceX = std::min(blockX * BLOCK_SIZE + x, width - 1);
+			memcpy(block[y * BLOCK_SIZE + x], &level[((uint64_t)sourceY * width + sourceX) * 4], 4);
+		}
+	}
+}
+
+// Dominant direction of the texels in the first channelCount channels, by power iteration on the covariance.
+// Returns false for a block of a single color.
+static bool _principalAxis(const Block block, uint32_t channelCount, float *mean, float *axis) {
+	float covariance[4][4] = {};
+	float minimum[4], maximum[4];
+
+	for (uint32_t c = 0; c < channelCount; c++) {
+		mean[c] = 0.0f;
+		minimum[c] = 255.0f;
+		maximum[c] = 0.0f;
+
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+			mean[c] += block[i][c];
+			minimum[c] = std::min(minimum[c], (float)block[i][c]);
+			maximum[c] = std::max(maximum[c], (float)block[i][c]);
+		}
+
+		mean[c] /= BLOCK_TEXELS;
+	}
+
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		for (uint32_t a = 0; a < channelCount; a++) {
+			for (uint32_t b = a; b < channelCount; b++)
+				covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+		}
+	}
+
+	for (uint32_t a = 0; a < channelCount; a++) {
+		for (uint32_t b = 0; b < a; b++)
+			covariance[a][b] = covariance[b][a];
+	}
+
+	// the bounding box diagonal is a good start and already exact for gradients along one channel
+	float length = 0.0f;
+	for (uint32_t c = 0; c < channelCount; c++) {
+		axis[c] = maximum[c] - minimum[c];
+		length += axis[c] * axis[c];
+	}
+
+	if (length == 0.0f)
+		return false;
+
+	for (uint32_t iteration = 0; iteration < 8; iteration++) {
+		float next[4] = {};
+		float nextLength = 0.0f;
+
+		for (uint32_t a = 0; a < channelCount; a++) {
+			for (uint32_t b = 0; b < channelCount; b++)
+				next[a] += covariance[a][b] * axis[b];
+
+			nextLength += next[a] * next[a];
+		}
+
+		// the diagonal can be orthogonal to an anti-correlated axis, keep it then
+		if (nextLength < 1e-12f)
+			break;
+
+		for (uint32_t c = 0; c < channelCount; c++)
+			axis[c] = next[c] / std::sqrt(nextLength);
+	}
+
+	length = 0.0f;
+	for (uint32_t c = 0; c < channelCount; c++)
+		length += axis[c] * axis[c];
+
+	for (uint32_t c = 0; c < channelCount; c++)
+		axis[c] /= std::sqrt(length);
+
+	return true;
+}
+
+// Endpoints at the extreme projections of the texels onto the axis through mean.
+static void _axisEndpoints(const Block block, uint32_t channelCount, const float *mean, const float *axis,
+		float *endpoint0, float *endpoint1) {
+	float minimum = FLT_MAX, maximum = -FLT_MAX;
+
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		float t = 0.0f;
+		for (uint32_t c = 0; c < channelCount; c++)
+			t += (block[i][c] - mean[c]) * axis[c];
+
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+
+	for (uint32_t c = 0; c < channelCount; c++) {
+		endpoint0[c] = std::min(std::max(mean[c] + axis[c] * maximum, 0.0f), 255.0f);
+		endpoint1[c] = std::min(std::max(mean[c] + axis[c] * minimum, 0.0f), 255.0f);
+	}
+}
+
+// Least squares endpoints for fixed indices, weights[i] is the share of endpoint1 in texel i.
+// Returns false when all texels sit on one weight and the system is singular.
+static bool _endpointsFit(const Block block, uint32_t channelCount, const float *weights, float *endpoint0,
+		float *endpoint1) {
+	float a = 0.0f, b = 0.0f, c = 0.0f;
+	float x0[4] = {}, x1[4] = {};
+
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		float w1 = weights[i];
+		float w0 = 1.0f - w1;
+
+		a += w0 * w0;
+		b += w0 * w1;
+		c += w1 * w1;
+
+		for (uint32_t k = 0; k < channelCount; k++) {
+			x0[k] += w0 * block[i][k];
+			x1[k] += w1 * block[i][k];
+		}
+	}
+
+	float determinant = a * c - b * b;
+	if (std::fabs(determinant) < 1e-6f)
+		return false;
+
+	for (uint32_t k = 0; k < channelCount; k++) {
+		endpoint0[k] = std::min(std::max((c * x0[k] - b * x1[k]) / determinant, 0.0f), 255.0f);
+		endpoint1[k] = std::min(std::max((a * x1[k] - b * x0[k]) / determinant, 0.0f), 255.0f);
+	}
+
+	return true;
+}
+
+static uint32_t _texelDistance(const uint8_t *a, const uint8_t *b, uint32_t channelCount) {
+	uint32_t distance = 0;
+	for (uint32_t c = 0; c < channelCount; c++)
+		distance += (a[c] - b[c]) * (a[c] - b[c]);
+
+	return distance;
+}
+
+static void _bytesWrite(uint8_t *out, uint64_t value, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++)
+		out[i] = (uint8_t)(value >> (i * 8));
+}
+
+static uint64_t _bytesRead(const uint8_t *in, uint32_t count) {
+	uint64_t value = 0;
+	for (uint32_t i = 0; i < count; i++)
+		value |= (uint64_t)in[i] << (i * 8);
+
+	return value;
+}
+
+// BC1
+
+static uint16_t _color565(const float *color) {
+	uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+	uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+	uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void _bc1Palette(uint16_t color0, uint16_t color1, uint8_t palette[4][4]) {
+	const uint16_t colors[2] = { color0, color1 };
+
+	for (uint32_t i = 0; i < 2; i++) {
+		uint32_t r = colors[i] >> 11, g = (colors[i] >> 5) & 63, b = colors[i] & 31;
+		palette[i][0] = (uint8_t)((r << 3) | (r >> 2));
+		palette[i][1] = (uint8_t)((g << 2) | (g >> 4));
+		palette[i][2] = (uint8_t)((b << 3) | (b >> 2));
+		palette[i][3] = 255;
+	}
+
+	for (uint32_t c = 0; c < 3; c++) {
+		if (color0 > color1) {
+			palette[2][c] = (uint8_t)((2 * palette[0][c] + palette[1][c]) / 3);
+			palette[3][c] = (uint8_t)((palette[0][c] + 2 * palette[1][c]) / 3);
+		} else {
+			palette[2][c] = (uint8_t)((palette[0][c] + palette[1][c]) / 2);
+			palette[3][c] = 0;
+		}
+	}
+
+	palette[2][3] = 255;
+	palette[3][3] = 255;
+}
+
+// Picks the closest palette entry for every texel, returns the summed squared error.
+static uint32_t _bc1Indices(const Block block, uint16_t color0, uint16_t color1, uint32_t *indices) {
+	uint8_t palette[4][4];
+	_bc1Palette(color0, color1, palette);
+
+	uint32_t error = 0;
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		uint32_t best = UINT32_MAX;
+
+		for (uint32_t j = 0; j < 4; j++) {
+			uint32_t distance = _texelDistance(block[i], palette[j], 3);
+			if (distance < best) {
+				best = distance;
+				indices[i] = j;
+			}
+		}
+
+		error += best;
+	}
+
+	return error;
+}
+
+static void _bc1Encode(const Block block, uint8_t *out) {
+	float mean[4], axis[4];
+	float endpoint0[4], endpoint1[4];
+
+	uint16_t color0, color1;
+	uint32_t indices[BLOCK_TEXELS] = {};
+
+	if (!_principalAxis(block, 3, mean, axis)) {
+		color0 = color1 = _color565(mean);
+	} else {
+		_axisEndpoints(block, 3, mean, axis, endpoint0, endpoint1);
+		color0 = _color565(endpoint0);
+		color1 = _color565(endpoint1);
+
+		// the four color mode needs color0 > color1, equal endpoints fall back to three colors
+		if (color0 < color1)
+			std::swap(color0, color1);
+
+		uint32_t error = _bc1Indices(block, color0, color1, indices);
+
+		const float WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		for (uint32_t iteration = 0; iteration < REFINE_ITERATIONS && error > 0 && color0 != color1; iteration++) {
+			float weights[BLOCK_TEXELS];
+			for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+				weights[i] = WEIGHTS[indices[i]];
+
+			if (!_endpointsFit(block, 3, weights, endpoint0, endpoint1))
+				break;
+
+			uint16_t refined0 = _color565(endpoint0);
+			uint16_t refined1 = _color565(endpoint1);
+			if (refined0 < refined1)
+				std::swap(refined0, refined1);
+
+			if (refined0 == refined1)
+				break;
+
+			uint32_t refinedIndices[BLOCK_TEXELS];
+			uint32_t refinedError = _bc1Indices(block, refined0, refined1, refinedIndices);
+			if (refinedError >= error)
+				break;
+
+			error = refinedError;
+			color0 = refined0;
+			color1 = refined1;
+			memcpy(indices, refinedIndices, sizeof(indices));
+		}
+	}
+
+	// equal endpoints decode as three color mode, index 0 still yields color0 there
+	if (color0 == color1)
+		memset(indices, 0, sizeof(indices));
+
+	uint32_t bits = 0;
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+		bits |= indices[i] << (i * 2);
+
+	_bytesWrite(out, color0, 2);
+	_bytesWrite(out + 2, color1, 2);
+	_bytesWrite(out + 4, bits, 4);
+}
+
+static void _bc1Decode(const uint8_t *in, Block block) {
+	uint8_t palette[4][4];
+	_bc1Palette((uint16_t)_bytesRead(in, 2), (uint16_t)_bytesRead(in + 2, 2), palette);
+
+	uint32_t bits = (uint32_t)_bytesRead(in + 4, 4);
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+		memcpy(block[i], palette[(bits >> (i * 2)) & 3], 4);
+}
+
+// BC4, BC5 is two of these
+
+static void _bc4Palette(uint8_t value0, uint8_t value1, uint8_t palette[8]) {
+	palette[0] = value0;
+	palette[1] = value1;
+
+	if (value0 > value1) {
+		for (uint32_t i = 2; i < 8; i++)
+			palette[i] = (uint8_t)(((8 - i) * value0 + (i - 1) * value1 + 3) / 7);
+	} else {
+		for (uint32_t i = 2; i < 6; i++)
+			palette[i] = (uint8_t)(((6 - i) * value0 + (i - 1) * value1 + 2) / 5);
+
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+static void _bc4Encode(const Block block, uint32_t channel, uint8_t *out) {
+	uint8_t minimum = 255, maximum = 0;
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		minimum = std::min(minimum, block[i][channel]);
+		maximum = std::max(maximum, block[i][channel]);
+	}
+
+	uint8_t palette[8];
+	_bc4Palette(maximum, minimum, palette);
+
+	uint64_t bits = 0;
+	for (uint32_t i = 0; i < BLOCK_TEXELS && maximum > minimum; i++) {
+		uint32_t best = UINT32_MAX, index = 0;
+
+		for (uint32_t j = 0; j < 8; j++) {
+			uint32_t distance = std::abs(block[i][channel] - palette[j]);
+			if (distance < best) {
+				best = distance;
+				index = j;
+			}
+		}
+
+		bits |= (uint64_t)index << (i * 3);
+	}
+
+	out[0] = maximum;
+	out[1] = minimum;
+	_bytesWrite(out + 2, bits, 6);
+}
+
+static void _bc4Decode(const uint8_t *in, uint32_t channel, Block block) {
+	uint8_t palette[8];
+	_bc4Palette(in[0], in[1], palette);
+
+	uint64_t bits = _bytesRead(in + 2, 6);
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+		block[i][channel] = palette[(bits >> (i * 3)) & 7];
+}
+
+// BC7 mode 6: 7 bit RGBA endpoints with one shared low bit each, 4 bit indices
+
+static uint8_t _bc7Interpolate(uint8_t value0, uint8_t value1, uint32_t index) {
+	return (uint8_t)(((64 - BC7_WEIGHTS[index]) * value0 + BC7_WEIGHTS[index] * value1 + 32) >> 6);
+}
+
+// Endpoints already carry their p-bit in the low bit. Indices come from projecting onto the
+// endpoint segment, the weights are close to uniform so the neighbours are compared exactly.
+static uint32_t _bc7Indices(const Block block, const uint8_t *endpoint0, const uint8_t *endpoint1,
+		uint32_t *indices) {
+	uint8_t palette[16][4];
+	for (uint32_t i = 0; i < 16; i++) {
+		for (uint32_t c = 0; c < 4; c++)
+			palette[i][c] = _bc7Interpolate(endpoint0[c], endpoint1[c], i);
+	}
+
+	float direction[4];
+	float length = 0.0f;
+	for (uint32_t c = 0; c < 4; c++) {
+		direction[c] = (float)endpoint1[c] - endpoint0[c];
+		length += direction[c] * direction[c];
+	}
+
+	float scale = length > 0.0f ? 15.0f / length : 0.0f;
+
+	uint32_t error = 0;
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		float t = 0.0f;
+		for (uint32_t c = 0; c < 4; c++)
+			t += (block[i][c] - endpoint0[c]) * direction[c];
+
+		int32_t nearest = std::min(std::max((int32_t)(t * scale + 0.5f), 0), 15);
+
+		uint32_t best = UINT32_MAX;
+		for (int32_t index = std::max(nearest - 1, 0); index <= std::min(nearest + 1, 15); index++) {
+			uint32_t distance = _texelDistance(block[i], palette[index], 4);
+			if (distance < best) {
+				best = distance;
+				indices[i] = index;
+			}
+		}
+
+		error += best;
+	}
+
+	return error;
+}
+
+// Tries the four p-bit combinations for float endpoints, keeps the best in quantized.
+static uint32_t _bc7Quantize(const Block block, const float *endpoint0, const float *endpoint1,
+		uint8_t quantized[2][4], uint32_t *indices) {
+	uint32_t bestError = UINT32_MAX;
+
+	for (uint32_t pbits = 0; pbits < 4; pbits++) {
+		uint8_t candidate[2][4];
+		const float *endpoints[2] = { endpoint0, endpoint1 };
+
+		for (uint32_t e = 0; e < 2; e++) {
+			uint32_t pbit = (pbits >> e) & 1;
+
+			for (uint32_t c = 0; c < 4; c++) {
+				int32_t value = (int32_t)((endpoints[e][c] - pbit) * 0.5f + 0.5f);
+				candidate[e][c] = (uint8_t)((std::min(std::max(value, 0), 127) << 1) | pbit);
+			}
+		}
+
+		uint32_t candidateIndices[BLOCK_TEXELS];
+		uint32_t error = _bc7Indices(block, candidate[0], candidate[1], candidateIndices);
+		if (error < bestError) {
+			bestError = error;
+			memcpy(quantized, candidate, sizeof(candidate));
+			memcpy(indices, candidateIndices, sizeof(candidateIndices));
+		}
+	}
+
+	return bestError;
+}
+
+static void _bc7Encode(const Block block, uint8_t *out) {
+	float mean[4], axis[4];
+	float endpoint0[4], endpoint1[4];
+
+	if (!_principalAxis(block, 4, mean, axis)) {
+		memcpy(endpoint0, mean, sizeof(mean));
+		memcpy(endpoint1, mean, sizeof(mean));
+	} else {
+		_axisEndpoints(block, 4, mean, axis, endpoint0, endpoint1);
+	}
+
+	uint8_t quantized[2][4];
+	uint32_t indices[BLOCK_TEXELS];
+	uint32_t error = _bc7Quantize(block, endpoint0, endpoint1, quantized, indices);
+
+	for (uint32_t iteration = 0; iteration < REFINE_ITERATIONS && error > 0; iteration++) {
+		float weights[BLOCK_TEXELS];
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+			weights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+
+		if (!_endpointsFit(block, 4, weights, endpoint0, endpoint1))
+			break;
+
+		uint8_t refined[2][4];
+		uint32_t refinedIndices[BLOCK_TEXELS];
+		uint32_t refinedError = _bc7Quantize(block, endpoint0, endpoint1, refined, refinedIndices);
+		if (refinedError >= error)
+			break;
+
+		error = refinedError;
+		memcpy(quantized, refined, sizeof(refined));
+		memcpy(indices, refinedIndices, sizeof(refinedIndices));
+	}
+
+	// the first index drops its top bit, swapping the endpoints mirrors the indices
+	if (indices[0] >= 8) {
+		std::swap(quantized[0], quantized[1]);
+		for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+			indices[i] = 15 - indices[i];
+	}
+
+	// mode bit 6, then r0 r1 g0 g1 b0 b1 a0 a1 at 7 bits, p0 p1, 63 index bits
+	uint64_t low = 1 << 6;
+	uint64_t high = 0;
+	uint32_t position = 7;
+
+	auto bitsWrite = [&](uint64_t value, uint32_t count) {
+		if (position < 64) {
+			low |= value << position;
+			if (position + count > 64)
+				high |= value >> (64 - position);
+		} else {
+			high |= value << (position - 64);
+		}
+
+		position += count;
+	};
+
+	for (uint32_t c = 0; c < 4; c++) {
+		bitsWrite(quantized[0][c] >> 1, 7);
+		bitsWrite(quantized[1][c] >> 1, 7);
+	}
+
+	bitsWrite(quantized[0][0] & 1, 1);
+	bitsWrite(quantized[1][0] & 1, 1);
+
+	bitsWrite(indices[0], 3);
+	for (uint32_t i = 1; i < BLOCK_TEXELS; i++)
+		bitsWrite(indices[i], 4);
+
+	_bytesWrite(out, low, 8);
+	_bytesWrite(out + 8, high, 8);
+}
+
+// Only mode 6 blocks decode, every other mode reads as transparent black.
+static void _bc7Decode(const uint8_t *in, Block block) {
+	uint64_t low = _bytesRead(in, 8);
+	uint64_t high = _bytesRead(in + 8, 8);
+
+	if ((low & 0x7f) != (1 << 6)) {
+		memset(block, 0, sizeof(Block));
+		return;
+	}
+
+	uint32_t position = 7;
+	auto bitsRead = [&](uint32_t count) {
+		uint64_t value;
+		if (position >= 64)
+			value = high >> (position - 64);
+		else if (position + count > 64)
+			value = (low >> position) | (high << (64 - position));
+		else
+			value = low >> position;
+
+		position += count;
+		return (uint32_t)(value & ((1ull << count) - 1));
+	};
+
+	uint8_t endpoints[2][4];
+	for (uint32_t c = 0; c < 4; c++) {
+		endpoints[0][c] = (uint8_t)(bitsRead(7) << 1);
+		endpoints[1][c] = (uint8_t)(bitsRead(7) << 1);
+	}
+
+	for (uint32_t e = 0; e < 2; e++) {
+		uint32_t pbit = bitsRead(1);
+		for (uint32_t c = 0; c < 4; c++)
+			endpoints[e][c] |= pbit;
+	}
+
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+		uint32_t index = bitsRead(i == 0 ? 3 : 4);
+		for (uint32_t c = 0; c < 4; c++)
+			block[i][c] = _bc7Interpolate(endpoints[0][c], endpoints[1][c], index);
+	}
+}
+
+static void _blockEncode(TextureFormat format, const Block block, uint8_t *out) {
+	switch (format) {
+		case TEXTURE_FORMAT_BC1:
+			_bc1Encode(block, out);
+			break;
+		case TEXTURE_FORMAT_BC4:
+			_bc4Encode(block, 0, out);
+			break;
+		case TEXTURE_FORMAT_BC5:
+			_bc4Encode(block, 0, out);
+			_bc4Encode(block, 1, out + 8);
+			break;
+		case TEXTURE_FORMAT_BC7:
+			_bc7Encode(block, out);
+			break;
+		default:
+			break;
+	}
+}
+
+static void _blockDecode(TextureFormat format, const uint8_t *in, Block block) {
+	switch (format) {
+		case TEXTURE_FORMAT_BC1:
+			_bc1Decode(in, block);
+			break;
+		case TEXTURE_FORMAT_BC4:
+			memset(block, 0, sizeof(Block));
+			_bc4Decode(in, 0, block);
+			break;
+		case TEXTURE_FORMAT_BC5:
+			memset(block, 0, sizeof(Block));
+			_bc4Decode(in, 0, block);
+			_bc4Decode(in + 8, 1, block);
+			break;
+		case TEXTURE_FORMAT_BC7:
+			_bc7Decode(in, block);
+			return;
+		default:
+			return;
+	}
+
+	for (uint32_t i = 0; i < BLOCK_TEXELS; i++)
+		block[i][3] = 255;
+}
+
+static uint32_t _channelCount(TextureFormat format) {
+	switch (format) {
+		case TEXTURE_FORMAT_BC4:
+			return 1;
+		case TEXTURE_FORMAT_BC5:
+			return 2;
+		case TEXTURE_FORMAT_BC1:
+			return 3;
+		default:
+			return 4;
+	}
+}
+
+// Chain layout of source in format, levels back to back from the largest.
+static Texture _textureLayout(const Texture &source, TextureFormat format) {
+	Texture texture = {};
+	texture.width = source.width;
+	texture.height = source.height;
+	texture.mipCount = source.mipCount;
+	texture.format = format;
+	texture.srgb = source.srgb;
+
+	for (uint32_t i = 0; i < source.mipCount; i++) {
+		MipLevel &level = texture.mips[i];
+		level.width = source.mips[i].width;
+		level.height = source.mips[i].height;
+		level.offset = texture.size;
+		level.size = TextureEncoder::levelSize(format, level.width, level.height);
+
+		texture.size += level.size;
+	}
+
+	return texture;
+}
+
+typedef struct {
+	uint32_t level;
+	uint32_t blockRowBegin;
+	uint32_t blockRowEnd;
+} EncodeTask;
+
+static std::vector<EncodeTask> _tasksCreate(const Texture &texture) {
+	std::vector<EncodeTask> tasks;
+
+	for (uint32_t i = 0; i < texture.mipCount; i++) {
+		uint32_t blockRows = (texture.mips[i].height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+		for (uint32_t row = 0; row < blockRows; row += BLOCK_ROWS_PER_TASK)
+			tasks.push_back({ i, row, std::min(row + BLOCK_ROWS_PER_TASK, blockRows) });
+	}
+
+	return tasks;
+}
+
+static void _tasksRun(uint32_t count, ThreadPool *pool, const std::function<void(uint32_t)> &function) {
+	if (pool != nullptr) {
+		pool->parallelFor(count, function);
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+		function(i);
+}
+
+const char *TextureEncoder::formatName(TextureFormat format) {
+	switch (format) {
+		case TEXTURE_FORMAT_RGBA8:
+			return "rgba8";
+		case TEXTURE_FORMAT_BC1:
+			return "bc1";
+		case TEXTURE_FORMAT_BC4:
+			return "bc4";
+		case TEXTURE_FORMAT_BC5:
+			return "bc5";
+		case TEXTURE_FORMAT_BC7:
+			return "bc7";
+		default:
+			return "unknown";
+	}
+}
+
+uint32_t TextureEncoder::blockBytes(TextureFormat format) {
+	switch (format) {
+		case TEXTURE_FORMAT_BC1:
+		case TEXTURE_FORMAT_BC4:
+			return 8;
+		case TEXTURE_FORMAT_BC5:
+		case TEXTURE_FORMAT_BC7:
+			return 16;
+		default:
+			return 4;
+	}
+}
+
+uint64_t TextureEncoder::levelSize(TextureFormat format, uint32_t width, uint32_t height) {
+	if (format == TEXTURE_FORMAT_RGBA8)
+		return (uint64_t)width * height * 4;
+
+	uint64_t blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	uint64_t blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	return blocksX * blocksY * blockBytes(format);
+}
+
+Texture TextureEncoder::textureEncode(
+		const Texture &source, TextureFormat format, Arena &arena, ThreadPool *pool, EncodeStats *stats) {
+	Timer timer;
+
+	Texture texture = _textureLayout(source, format);
+	texture.data = arena.arrayAllocate<uint8_t>(texture.size);
+
+	const uint32_t channelCount = _channelCount(format);
+	const uint32_t bytesPerBlock = blockBytes(format);
+
+	std::vector<EncodeTask> tasks = _tasksCreate(texture);
+	std::vector<double> taskErrors(tasks.size(), 0.0);
+
+	_tasksRun(tasks.size(), pool, [&](uint32_t taskIndex) {
+		const EncodeTask &task = tasks[taskIndex];
+		const MipLevel &sourceLevel = source.mips[task.level];
+		const MipLevel &level = texture.mips[task.level];
+
+		const uint8_t *sourceData = source.data + sourceLevel.offset;
+		uint32_t blocksX = (level.width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+		// squared error of the stored channels, texels past the level edge do not count
+		uint64_t error = 0;
+
+		for (uint32_t blockY = task.blockRowBegin; blockY < task.blockRowEnd; blockY++) {
+			for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+				uint8_t *out = texture.data + level.offset + ((uint64_t)blockY * blocksX + blockX) * bytesPerBlock;
+
+				Block block, decoded;
+				_blockLoad(sourceData, level.width, level.height, blockX, blockY, block);
+				_blockEncode(format, block, out);
+				_blockDecode(format, out, decoded);
+
+				for (uint32_t y = 0; y < BLOCK_SIZE && blockY * BLOCK_SIZE + y < level.height; y++) {
+					for (uint32_t x = 0; x < BLOCK_SIZE && blockX * BLOCK_SIZE + x < level.width; x++)
+						error += _texelDistance(block[y * BLOCK_SIZE + x], decoded[y * BLOCK_SIZE + x], channelCount);
+				}
+			}
+		}
+
+		taskErrors[taskIndex] = (double)error;
+	});
+
+	if (stats != nullptr) {
+		*stats = {};
+		stats->encodeTime = timer.elapsed();
+		stats->sourceBytes = source.size;
+		stats->encodedBytes = texture.size;
+
+		for (uint32_t i = 0; i < texture.mipCount; i++)
+			stats->pixelCount += (uint64_t)texture.mips[i].width * texture.mips[i].height;
+
+		for (double error : taskErrors)
+			stats->squaredError += error;
+
+		stats->channelSamples = stats->pixelCount * channelCount;
+
+		double meanError = stats->squaredError / stats->channelSamples;
+		stats->psnr = meanError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanError)
+									  : std::numeric_limits<double>::infinity();
+	}
+
+	return texture;
+}
+
+Texture TextureEncoder::textureDecode(const Texture &source, Arena &arena) {
+	Texture texture = _textureLayout(source, TEXTURE_FORMAT_RGBA8);
+	texture.data = arena.arrayAllocate<uint8_t>(texture.size);
+
+	if (source.format == TEXTURE_FORMAT_RGBA8) {
+		memcpy(texture.data, source.data, texture.size);
+		return texture;
+	}
+
+	const uint32_t bytesPerBlock = blockBytes(source.format);
+
+	for (uint32_t i = 0; i < texture.mipCount; i++) {
+		const MipLevel &level = texture.mips[i];
+		uint32_t blocksX = (level.width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		uint32_t blocksY = (level.height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+		for (uint32_t blockY = 0; blockY < blocksY; blockY++) {
+			for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+				const uint8_t *in =
+						source.data + source.mips[i].offset + ((uint64_t)blockY * blocksX + blockX) * bytesPerBlock;
+
+				Block block;
+				_blockDecode(source.format, in, block);
+
+				for (uint32_t y = 0; y < BLOCK_SIZE && blockY * BLOCK_SIZE + y < level.height; y++) {
+					for (uint32_t x = 0; x < BLOCK_SIZE && blockX * BLOCK_SIZE + x < level.width; x++) {
+						uint64_t texel = (uint64_t)(blockY * BLOCK_SIZE + y) * level.width + blockX * BLOCK_SIZE + x;
+						memcpy(&texture.data[level.offset + texel * 4], block[y * BLOCK_SIZE + x], 4);
+					}
+				}
+			}
+		}
+	}
+
+	return texture;
+}
@@ -0,0 +1,43 @@
+#ifndef TEXTURE_ENCODER_H
+#define TEXTURE_ENCODER_H
+
+#include <cstdint>
+
+#include <io/types/texture.h>
+
+class Arena;
+class ThreadPool;
+
+// Error over every channel the format stores, all levels included. Times are in milliseconds.
+typedef struct {
+	double encodeTime;
+	uint64_t pixelCount;
+	uint64_t sourceBytes;
+	uint64_t encodedBytes;
+	double squaredError;
+	uint64_t channelSamples;
+	double psnr;
+} EncodeStats;
+
+// CPU block compression of RGBA8 mip chains. BC1 and BC7 fit endpoints along
+// the principal axis and refine them by least squares, BC4 and BC5 span the
+// channel range. BC7 only emits mode 6, one subset with 4 bit indices, which
+// is a good fit for smooth color and alpha but weaker on sharp two color edges.
+class TextureEncoder {
+public:
+	static const char *formatName(TextureFormat format);
+	static uint32_t blockBytes(TextureFormat format);
+
+	// Size of a level in format, whole 4x4 blocks for the block formats.
+	static uint64_t levelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+	// Encodes every level of an RGBA8 texture, rows of blocks are spread over pool when given.
+	// The result lives in arena and keeps the sRGB flag of source.
+	static Texture textureEncode(const Texture &source, TextureFormat format, Arena &arena,
+			ThreadPool *pool = nullptr, EncodeStats *stats = nullptr);
+
+	// Decodes a block compressed texture back to RGBA8, missing channels read as 0 and alpha as 255.
+	static Texture textureDecode(const Texture &source, Arena &arena);
+};
+
+#endif // !TEXTURE_ENCODER_H
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include <core/arena.h>
+#include <core/thread_pool.h>
+
+#include <io/types/hierarchy.h>
+
+#include <math/types/mat4.h>
+#include <math/types/trs.h>
+
+#include "transform_hierarchy.h"
+
+using namespace math;
+
+// Nodes per task, small levels near the roots run on the calling thread.
+const uint32_t NODE_CHUNK = 2048;
+
+uint32_t TransformHierarchy::_levelFind(const Hierarchy &hierarchy, uint32_t node) {
+	const uint32_t *levelEnds = hierarchy.levelOffsets + 1;
+	return std::upper_bound(levelEnds, levelEnds + hierarchy.levelCount, node) - levelEnds;
+}
+
+mat4 TransformHierarchy::transformMatrix(const Transform &transform) {
+	const float *t = transform.translation;
+	const float *q = transform.rotation;
+	const float *s = transform.scale;
+	return trsMatrix(trs(vec3(t[0], t[1], t[2]), quat(q[0], q[1], q[2], q[3]), vec3(s[0], s[1], s[2])));
+}
+
+Transform TransformHierarchy::transformDecompose(const mat4 &matrix) {
+	trs local = trsDecompose(matrix);
+
+	Transform transform = {
+		{ local.translation.x, local.translation.y, local.translation.z },
+		{ local.rotation.x, local.rotation.y, local.rotation.z, local.rotation.w },
+		{ local.scale.x, local.scale.y, local.scale.z },
+	};
+	return transform;
+}
+
+Hierarchy TransformHierarchy::hierarchyAllocate(uint32_t count, uint32_t levelCount, Arena &arena) {
+	Hierarchy hierarchy = {};
+	hierarchy.count = count;
+	hierarchy.levelCount = levelCount;
+	hierarchy.levelOffsets = arena.arrayAllocate<uint32_t>(levelCount + 1);
+	hierarchy.parents = arena.arrayAllocate<uint32_t>(count);
+	hierarchy.meshIndices = arena.arrayAllocate<uint32_t>(count);
+	hierarchy.locals = arena.arrayAllocate<Transform>(count);
+	hierarchy.worlds = arena.arrayAllocate<mat4>(count);
+	hierarchy.dirty = arena.arrayAllocate<uint8_t>(count, true);
+	hierarchy.dirtyLevel = levelCount;
+	return hierarchy;
+}
+
+void TransformHierarchy::localSet(Hierarchy &hierarchy, uint32_t node, const Transform &local) {
+	hierarchy.locals[node] = local;
+
+	if (hierarchy.dirty[node])
+		return;
+
+	hierarchy.dirty[node] = 1;
+	hierarchy.dirtyLevel = std::min(hierarchy.dirtyLevel, _levelFind(hierarchy, node));
+}
+
+void TransformHierarchy::dirtyAll(Hierarchy &hierarchy) {
+	memset(hierarchy.dirty, 1, hierarchy.count);
+	hierarchy.dirtyLevel = 0;
+}
+
+void TransformHierarchy::worldsUpdate(Hierarchy &hierarchy, ThreadPool *pool) {
+	if (hierarchy.dirtyLevel >= hierarchy.levelCount)
+		return;
+
+	const uint32_t *parents = hierarchy.parents;
+	const Transform *locals = hierarchy.locals;
+	mat4 *worlds = hierarchy.worlds;
+	uint8_t *dirty = hierarchy.dirty;
+
+	// a node is recomputed when it or its parent changed, the flag then passes on to its children
+	auto nodesUpdate = [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			uint32_t parent = parents[i];
+
+			if (parent == NO_PARENT) {
+				if (dirty[i])
+					worlds[i] = transformMatrix(locals[i]);
+
+				continue;
+			}
+
+			if (!dirty[i] && !dirty[parent])
+				continue;
+
+			dirty[i] = 1;
+			worlds[i] = worlds[parent] * transformMatrix(locals[i]);
+		}
+	};
+
+	for (uint32_t level = hierarchy.dirtyLevel; level < hierarchy.levelCount; level++) {
+		const uint32_t begin = hierarchy.levelOffsets[level];
+		const uint32_t end = hierarchy.levelOffsets[level + 1];
+		const uint32_t chunks = (end - begin + NODE_CHUNK - 1) / NODE_CHUNK;
+
+		if (pool == nullptr || chunks <= 1) {
+			nodesUpdate(begin, end);
+			continue;
+		}
+
+		pool->parallelFor(chunks, [&](uint32_t chunk) {
+			uint32_t chunkBegin = begin + chunk * NODE_CHUNK;
+			nodesUpdate(chunkBegin, std::min(chunkBegin + NODE_CHUNK, end));
+		});
+	}
+
+	const uint32_t first = hierarchy.levelOffsets[hierarchy.dirtyLevel];
+	memset(dirty + first, 0, hierarchy.count - first);
+	hierarchy.dirtyLevel = hierarchy.levelCount;
+}
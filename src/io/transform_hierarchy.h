@@ -0,0 +1,37 @@
+#ifndef TRANSFORM_HIERARCHY_H
+#define TRANSFORM_HIERARCHY_H
+
+#include <cstdint>
+
+#include <io/types/hierarchy.h>
+
+#include <math/types/mat4.h>
+
+class Arena;
+class ThreadPool;
+
+// World transform propagation over a flattened Hierarchy. Edits only mark
+// nodes dirty, worldsUpdate then recomputes the dirty nodes and everything
+// below them, skipping the levels above the first edit entirely.
+class TransformHierarchy {
+private:
+	static uint32_t _levelFind(const Hierarchy &hierarchy, uint32_t node);
+
+public:
+	static math::mat4 transformMatrix(const Transform &transform);
+
+	// Shear is dropped, a negative determinant ends up as a negative x scale.
+	static Transform transformDecompose(const math::mat4 &matrix);
+
+	// Allocates every array for count nodes from arena, levelOffsets for levelCount levels.
+	// Fill levelOffsets, parents, meshIndices and locals, then call dirtyAll and worldsUpdate.
+	static Hierarchy hierarchyAllocate(uint32_t count, uint32_t levelCount, Arena &arena);
+
+	static void localSet(Hierarchy &hierarchy, uint32_t node, const Transform &local);
+	static void dirtyAll(Hierarchy &hierarchy);
+
+	// Levels with enough nodes are split across the pool. Results do not depend on the number of threads.
+	static void worldsUpdate(Hierarchy &hierarchy, ThreadPool *pool = nullptr);
+};
+
+#endif // !TRANSFORM_HIERARCHY_H
@@ -0,0 +1,16 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+typedef struct {
+	float center[3];
+	float radius;
+} BoundingSphere;
+
+// Box around center spanning halfExtents[i] along each of the orthonormal axes[i].
+typedef struct {
+	float center[3];
+	float axes[3][3];
+	float halfExtents[3];
+} OrientedBox;
+
+#endif // !BOUNDS_H
@@ -0,0 +1,36 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <cstdint>
+
+#include <math/types/mat4.h>
+
+const uint32_t NO_PARENT = ~0u;
+const uint32_t NO_MESH = ~0u;
+
+// Local transform of a node, applied as translation * rotation * scale.
+typedef struct {
+	float translation[3];
+	float rotation[4]; // unit quaternion x, y, z, w
+	float scale[3];
+} Transform;
+
+// Scene nodes flattened breadth first into arrays indexed by node. Every level
+// of the tree is one contiguous range and parents always come before their
+// children, so world transforms can be computed a level at a time.
+typedef struct {
+	uint32_t count;
+	uint32_t levelCount;
+	uint32_t *levelOffsets; // levelCount + 1 entries, level l holds nodes [levelOffsets[l], levelOffsets[l + 1])
+
+	uint32_t *parents;     // NO_PARENT for roots
+	uint32_t *meshIndices; // NO_MESH for nodes without a mesh
+	Transform *locals;
+	math::mat4 *worlds;
+
+	// Set by TransformHierarchy::localSet, cleared by worldsUpdate.
+	uint8_t *dirty;
+	uint32_t dirtyLevel; // first level holding a dirty node, levelCount when all worlds are current
+} Hierarchy;
+
+#endif // !HIERARCHY_H
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include "aabb.h"
+#include "bounds.h"
 #include "vertex.h"
 
 typedef struct {
@@ -16,17 +17,74 @@ typedef struct {
 	uint32_t count;
 } VertexArray;
 
+typedef struct {
+	CompactVertex *data;
+	uint32_t count;
+} CompactVertexArray;
+
+const uint32_t MESHLET_MAX_VERTICES = 64;
+const uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// Cluster of up to MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles.
+// Triangles index the meshlet's own vertex list, which in turn indexes the primitive vertices.
+typedef struct {
+	uint32_t vertexOffset;   // into MeshletArray::vertices
+	uint32_t triangleOffset; // into MeshletArray::triangles, in triangles
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+
+	float center[3];
+	float radius;
+
+	// Backfacing when dot(normalize(coneApex - camera), coneAxis) >= coneCutoff,
+	// a cutoff of 1 disables the test.
+	float coneApex[3];
+	float coneAxis[3];
+	float coneCutoff;
+} Meshlet;
+
+typedef struct {
+	Meshlet *data;
+	uint32_t count;
+
+	uint32_t *vertices;
+	uint32_t vertexCount;
+
+	uint8_t *triangles; // three local vertex indices per triangle
+	uint32_t triangleCount;
+} MeshletArray;
+
+// Simplified index list over the full primitive's vertices.
+typedef struct {
+	IndexArray indices;
+	float error; // estimated largest deviation from the full primitive, in mesh units
+} Lod;
+
+typedef struct {
+	Lod *data;
+	uint32_t count;
+} LodArray;
+
+// Bounds are computed from the decoded positions, see MeshBounds.
 typedef struct {
 	AABB aabb;
+	BoundingSphere sphere;
+	OrientedBox box; // the AABB as a box unless LoadOptions::orientedBounds is set
 	uint32_t materialIndex;
 
 	IndexArray indices;
 	VertexArray vertices;
+	MeshletArray meshlets; // empty unless LoadOptions::buildMeshlets is set
+	LodArray lods;         // coarser levels after indices, empty unless LoadOptions::lodCount > 0
 } Primitive;
 
 typedef struct {
 	Primitive *primitives;
 	uint32_t primitiveCount;
+
+	// Enclose every primitive with vertices, zero for a mesh without any.
+	AABB aabb;
+	BoundingSphere sphere;
 } Mesh;
 
 #endif // !MESH_H
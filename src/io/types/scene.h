@@ -0,0 +1,39 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <cstdint>
+
+#include <core/mapped_file.h>
+
+#include "hierarchy.h"
+#include "mesh.h"
+#include "texture.h"
+
+class Arena;
+
+// Release with GLTFLoader::sceneFree.
+typedef struct {
+	Mesh *meshes;
+	uint32_t meshCount;
+
+	// Indexed like the glTF images, undecodable ones are left empty.
+	// Empty unless LoadOptions::loadTextures is set.
+	Texture *textures;
+	uint32_t textureCount;
+
+	// Every node of the file, world transforms are current when the scene is returned.
+	Hierarchy hierarchy;
+
+	// World space bounds of each node's mesh, see MeshBounds::worldBoundsUpdate.
+	// Nodes without a mesh get a zero sized box and sphere at their origin.
+	AABB *worldAABBs;
+	BoundingSphere *worldSpheres;
+
+	// Owns meshes, primitives and their arrays, except data living in cacheFile.
+	Arena *arena;
+
+	// Set when the scene came from the mesh cache, primitive data points into it.
+	MappedFile cacheFile;
+} Scene;
+
+#endif // !SCENE_H
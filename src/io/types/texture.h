@@ -0,0 +1,40 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <cstdint>
+
+// Enough levels for a 32768 texel wide image.
+const uint32_t TEXTURE_MAX_MIPS = 16;
+
+// Block formats store 4x4 texel blocks, levels smaller than a block still take a whole one.
+typedef enum {
+	TEXTURE_FORMAT_RGBA8,
+	TEXTURE_FORMAT_BC1, // RGB, 8 bytes per block
+	TEXTURE_FORMAT_BC4, // R, 8 bytes per block
+	TEXTURE_FORMAT_BC5, // RG, 16 bytes per block, normal maps
+	TEXTURE_FORMAT_BC7, // RGBA, 16 bytes per block
+	TEXTURE_FORMAT_COUNT,
+} TextureFormat;
+
+typedef struct {
+	uint32_t width;
+	uint32_t height;
+	uint64_t offset; // into Texture::data
+	uint64_t size;
+} MipLevel;
+
+// Image with its mip chain down to 1x1, levels stored back to back from the
+// largest, so the whole chain goes to the GPU in one staging copy.
+typedef struct {
+	uint8_t *data;
+	uint64_t size;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	TextureFormat format;
+	bool srgb; // color data, mips are filtered in linear space
+
+	MipLevel mips[TEXTURE_MAX_MIPS];
+} Texture;
+
+#endif // !TEXTURE_H
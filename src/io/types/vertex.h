@@ -1,11 +1,21 @@
 #ifndef VERTEX_H
 #define VERTEX_H
 
+#include <cstdint>
+
 typedef struct {
 	float position[3];
 	float normal[3];
-	float tangent[3];
+	float tangent[4]; // xyz, handedness in w
 	float texCoord[2];
 } Vertex;
 
+// Quantized Vertex, 20 instead of 48 bytes. See VertexQuantizer for the encoding.
+typedef struct {
+	uint16_t position[4]; // unorm16 inside the primitive AABB, tangent handedness in w (0 or 1)
+	int16_t normal[2];    // octahedral, snorm16
+	int16_t tangent[2];   // octahedral, snorm16
+	uint16_t texCoord[2]; // half float
+} CompactVertex;
+
 #endif // !VERTEX_H
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <io/types/aabb.h>
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include <math/types/mat4.h>
+#include <math/types/vec4.h>
+
+#include "vertex_quantizer.h"
+
+static inline uint16_t _unorm16(float value) {
+	return (uint16_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+}
+
+static inline int16_t _snorm16(float value) {
+	return (int16_t)std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+}
+
+static inline float _snorm16Float(int16_t value) {
+	return std::max(value / 32767.0f, -1.0f);
+}
+
+// Projects the unit vector onto the octahedron |x| + |y| + |z| = 1 and folds
+// the lower half over the diagonals.
+static void _octEncode(const float *vector, int16_t *out) {
+	float length = std::fabs(vector[0]) + std::fabs(vector[1]) + std::fabs(vector[2]);
+	if (length == 0.0f) {
+		out[0] = 0;
+		out[1] = 0;
+		return;
+	}
+
+	float x = vector[0] / length;
+	float y = vector[1] / length;
+
+	if (vector[2] < 0.0f) {
+		float foldedX = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	out[0] = _snorm16(x);
+	out[1] = _snorm16(y);
+}
+
+// Same as octDecode in material.vert.
+static void _octDecode(const int16_t *encoded, float *out) {
+	float x = _snorm16Float(encoded[0]);
+	float y = _snorm16Float(encoded[1]);
+	float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+	float t = std::max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+
+	float length = std::sqrt(x * x + y * y + z * z);
+	out[0] = x / length;
+	out[1] = y / length;
+	out[2] = z / length;
+}
+
+float VertexQuantizer::positionScale(const AABB &aabb) {
+	float extent = std::max(aabb.w, std::max(aabb.h, aabb.d));
+	return extent > 0.0f ? extent : 1.0f;
+}
+
+math::mat4 VertexQuantizer::positionMatrix(const AABB &aabb) {
+	float scale = positionScale(aabb);
+
+	return math::mat4(math::vec4(scale, 0.0f, 0.0f, 0.0f), math::vec4(0.0f, scale, 0.0f, 0.0f),
+			math::vec4(0.0f, 0.0f, scale, 0.0f), math::vec4(aabb.x, aabb.y, aabb.z, 1.0f));
+}
+
+void VertexQuantizer::verticesQuantize(const VertexArray &vertices, const AABB &aabb, CompactVertexArray &out) {
+	const float min[3] = { aabb.x, aabb.y, aabb.z };
+	const float inverseScale = 1.0f / positionScale(aabb);
+
+	for (uint32_t i = 0; i < vertices.count; i++) {
+		const Vertex &vertex = vertices.data[i];
+		CompactVertex &compact = out.data[i];
+
+		for (int k = 0; k < 3; k++)
+			compact.position[k] = _unorm16((vertex.position[k] - min[k]) * inverseScale);
+
+		compact.position[3] = vertex.tangent[3] < 0.0f ? 0 : 65535;
+
+		_octEncode(vertex.normal, compact.normal);
+		_octEncode(vertex.tangent, compact.tangent);
+
+		compact.texCoord[0] = halfFromFloat(vertex.texCoord[0]);
+		compact.texCoord[1] = halfFromFloat(vertex.texCoord[1]);
+	}
+
+	out.count = vertices.count;
+}
+
+Vertex VertexQuantizer::vertexDequantize(const CompactVertex &vertex, const AABB &aabb) {
+	const float min[3] = { aabb.x, aabb.y, aabb.z };
+	const float scale = positionScale(aabb);
+
+	Vertex out;
+	for (int k = 0; k < 3; k++)
+		out.position[k] = min[k] + vertex.position[k] / 65535.0f * scale;
+
+	_octDecode(vertex.normal, out.normal);
+	_octDecode(vertex.tangent, out.tangent);
+	out.tangent[3] = vertex.position[3] != 0 ? 1.0f : -1.0f;
+
+	out.texCoord[0] = floatFromHalf(vertex.texCoord[0]);
+	out.texCoord[1] = floatFromHalf(vertex.texCoord[1]);
+	return out;
+}
+
+// Round to nearest even, overflow goes to infinity and NaN stays NaN.
+uint16_t VertexQuantizer::halfFromFloat(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = (bits >> 16) & 0x8000;
+	uint32_t magnitude = bits & 0x7fffffff;
+
+	if (magnitude >= 0x7f800000)
+		return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+
+	// 65520.0f and above round past the largest half
+	if (magnitude >= 0x477ff000)
+		return sign | 0x7c00;
+
+	// below 2^-14 the result is subnormal, scaling by 2^24 is exact
+	if (magnitude < 0x38800000) {
+		float absolute;
+		memcpy(&absolute, &magnitude, sizeof(absolute));
+		return sign | (uint16_t)std::nearbyint(absolute * 16777216.0f);
+	}
+
+	uint32_t half = (magnitude - 0x38000000) >> 13;
+	uint32_t remainder = magnitude & 0x1fff;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+		half++;
+
+	return sign | half;
+}
+
+float VertexQuantizer::floatFromHalf(uint16_t value) {
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1f;
+	uint32_t mantissa = value & 0x3ff;
+
+	if (exponent == 0) {
+		float result = mantissa / 16777216.0f;
+		return sign ? -result : result;
+	}
+
+	uint32_t bits = exponent == 31 ? sign | 0x7f800000 | (mantissa << 13)
+								   : sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
@@ -0,0 +1,34 @@
+#ifndef VERTEX_QUANTIZER_H
+#define VERTEX_QUANTIZER_H
+
+#include <cstdint>
+
+#include <io/types/aabb.h>
+#include <io/types/mesh.h>
+#include <io/types/vertex.h>
+
+#include <math/types/mat4.h>
+
+// Converts Vertex to CompactVertex and back.
+//
+// Positions are stored relative to the AABB minimum with one scale for all
+// three axes, so the dequantization is a uniform scale and translation that
+// folds into the model matrix without skewing normals. Normals and tangents
+// use the octahedral mapping, texture coordinates IEEE half floats.
+class VertexQuantizer {
+public:
+	// Quantized to world units is aabb.min + position * scale.
+	static float positionScale(const AABB &aabb);
+
+	// Maps unorm positions back into the mesh space, multiply the model matrix by it.
+	static math::mat4 positionMatrix(const AABB &aabb);
+
+	// out.data must hold vertices.count entries.
+	static void verticesQuantize(const VertexArray &vertices, const AABB &aabb, CompactVertexArray &out);
+	static Vertex vertexDequantize(const CompactVertex &vertex, const AABB &aabb);
+
+	static uint16_t halfFromFloat(float value);
+	static float floatFromHalf(uint16_t value);
+};
+
+#endif // !VERTEX_QUANTIZER_H
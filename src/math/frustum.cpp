@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <core/thread_pool.h>
+
+#include "frustum.h"
+#include "transform_batch.h"
+#include "types/lanes.h"
+#include "types/simd.h"
+#include "types/vec3.h"
+
+using namespace math;
+
+// Elements per test, one bit each in the visibility mask.
+const uint32_t CULL_BATCH = 8;
+
+// Elements per task, a multiple of CULL_BATCH.
+const uint32_t CULL_CHUNK = 16384;
+
+static inline bool _sphereTest(const Frustum &frustum, const SphereStream &spheres, uint32_t i) {
+	return frustumSphereTest(frustum, vec3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]);
+}
+
+static inline bool _aabbTest(const Frustum &frustum, const AABBStream &aabbs, uint32_t i) {
+	vec3 halfExtents = vec3(aabbs.w[i], aabbs.h[i], aabbs.d[i]) * 0.5f;
+	return frustumBoxTest(frustum, vec3(aabbs.x[i], aabbs.y[i], aabbs.z[i]) + halfExtents, halfExtents);
+}
+
+#ifdef MATH_SSE
+
+// A plane splatted over the lanes, with the absolute normal for the boxes.
+typedef struct {
+	lanes x, y, z, w;
+	lanes absX, absY, absZ;
+} PlaneLanes;
+
+typedef struct {
+	PlaneLanes planes[FRUSTUM_PLANE_COUNT];
+} FrustumLanes;
+
+static FrustumLanes _frustumSplat(const Frustum &frustum) {
+	FrustumLanes out;
+	for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+		const vec4 &plane = frustum.planes[p];
+		PlaneLanes &lanesPlane = out.planes[p];
+
+		lanesPlane.x = lanesSplat(plane.x);
+		lanesPlane.y = lanesSplat(plane.y);
+		lanesPlane.z = lanesSplat(plane.z);
+		lanesPlane.w = lanesSplat(plane.w);
+		lanesPlane.absX = lanesAbs(lanesPlane.x);
+		lanesPlane.absY = lanesAbs(lanesPlane.y);
+		lanesPlane.absZ = lanesAbs(lanesPlane.z);
+	}
+
+	return out;
+}
+
+static inline lanes _planeDistance(const PlaneLanes &plane, lanes x, lanes y, lanes z) {
+	return lanesMadd(plane.x, x, lanesMadd(plane.y, y, lanesMadd(plane.z, z, plane.w)));
+}
+
+// Bit k set when sphere i + k is not outside any plane.
+static inline uint32_t _spheresMask(const FrustumLanes &frustum, const SphereStream &spheres, uint32_t i) {
+	lanes x = lanesLoad(spheres.x + i), y = lanesLoad(spheres.y + i), z = lanesLoad(spheres.z + i);
+	lanes negativeRadius = lanesSub(lanesSplat(0.0f), lanesLoad(spheres.radius + i));
+
+	uint32_t mask = (1u << LANE_COUNT) - 1;
+	for (const PlaneLanes &plane : frustum.planes)
+		mask &= lanesGreaterEqual(_planeDistance(plane, x, y, z), negativeRadius);
+
+	return mask;
+}
+
+static inline uint32_t _aabbsMask(const FrustumLanes &frustum, const AABBStream &aabbs, uint32_t i) {
+	const lanes half = lanesSplat(0.5f);
+
+	lanes hx = lanesMul(lanesLoad(aabbs.w + i), half);
+	lanes hy = lanesMul(lanesLoad(aabbs.h + i), half);
+	lanes hz = lanesMul(lanesLoad(aabbs.d + i), half);
+
+	lanes cx = lanesAdd(lanesLoad(aabbs.x + i), hx);
+	lanes cy = lanesAdd(lanesLoad(aabbs.y + i), hy);
+	lanes cz = lanesAdd(lanesLoad(aabbs.z + i), hz);
+
+	const lanes zero = lanesSplat(0.0f);
+	uint32_t mask = (1u << LANE_COUNT) - 1;
+	for (const PlaneLanes &plane : frustum.planes) {
+		lanes reach = lanesMadd(plane.absX, hx, lanesMadd(plane.absY, hy, lanesMul(plane.absZ, hz)));
+		mask &= lanesGreaterEqual(lanesAdd(_planeDistance(plane, cx, cy, cz), reach), zero);
+	}
+
+	return mask;
+}
+
+#endif // MATH_SSE
+
+// Expands the mask of the batch at first into indices, without branches: every index is written and the
+// count only advances past the visible ones. n <= first, so the writes stay within the batch's chunk.
+static inline uint32_t _indicesWrite(uint32_t mask, uint32_t first, uint32_t *visible, uint32_t n) {
+	for (uint32_t k = 0; k < CULL_BATCH; k++) {
+		visible[n] = first + k;
+		n += (mask >> k) & 1;
+	}
+
+	return n;
+}
+
+// batchMask(i) tests elements [i, i + CULL_BATCH), test(i) a single one for the tail. Batches that are culled
+// entirely, most of them for large scenes, write nothing. Every chunk compacts into its own range of visible
+// first, the ranges are then moved together in order.
+template <typename BatchMask, typename Test>
+static uint32_t _cull(uint32_t count, uint32_t *visible, ThreadPool *pool, BatchMask batchMask, Test test) {
+	auto chunkCull = [&](uint32_t begin, uint32_t end) {
+		uint32_t n = begin;
+		uint32_t i = begin;
+
+		for (; i + CULL_BATCH <= end; i += CULL_BATCH) {
+			uint32_t mask = batchMask(i);
+			if (mask != 0)
+				n = _indicesWrite(mask, i, visible, n);
+		}
+
+		for (; i < end; i++) {
+			visible[n] = i;
+			n += test(i) ? 1 : 0;
+		}
+
+		return n - begin;
+	};
+
+	const uint32_t chunks = (count + CULL_CHUNK - 1) / CULL_CHUNK;
+	if (pool == nullptr || chunks <= 1)
+		return chunkCull(0, count);
+
+	std::vector<uint32_t> counts(chunks);
+	pool->parallelFor(chunks, [&](uint32_t chunk) {
+		uint32_t begin = chunk * CULL_CHUNK;
+		counts[chunk] = chunkCull(begin, std::min(begin + CULL_CHUNK, count));
+	});
+
+	uint32_t n = counts[0];
+	for (uint32_t chunk = 1; chunk < chunks; chunk++) {
+		memmove(visible + n, visible + chunk * CULL_CHUNK, counts[chunk] * sizeof(uint32_t));
+		n += counts[chunk];
+	}
+
+	return n;
+}
+
+uint32_t math::spheresCull(
+		const Frustum &frustum, const SphereStream &spheres, uint32_t count, uint32_t *visible, ThreadPool *pool) {
+	auto test = [&](uint32_t i) { return _sphereTest(frustum, spheres, i); };
+
+#ifdef MATH_SSE
+	const FrustumLanes frustumLanes = _frustumSplat(frustum);
+	auto batchMask = [&](uint32_t i) {
+		uint32_t mask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k += LANE_COUNT)
+			mask |= _spheresMask(frustumLanes, spheres, i + k) << k;
+
+		return mask;
+	};
+#else
+	auto batchMask = [&](uint32_t i) {
+		uint32_t mask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k++)
+			mask |= (uint32_t)test(i + k) << k;
+
+		return mask;
+	};
+#endif
+
+	return _cull(count, visible, pool, batchMask, test);
+}
+
+uint32_t math::aabbsCull(
+		const Frustum &frustum, const AABBStream &aabbs, uint32_t count, uint32_t *visible, ThreadPool *pool) {
+	auto test = [&](uint32_t i) { return _aabbTest(frustum, aabbs, i); };
+
+#ifdef MATH_SSE
+	const FrustumLanes frustumLanes = _frustumSplat(frustum);
+	auto batchMask = [&](uint32_t i) {
+		uint32_t mask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k += LANE_COUNT)
+			mask |= _aabbsMask(frustumLanes, aabbs, i + k) << k;
+
+		return mask;
+	};
+#else
+	auto batchMask = [&](uint32_t i) {
+		uint32_t mask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k++)
+			mask |= (uint32_t)test(i + k) << k;
+
+		return mask;
+	};
+#endif
+
+	return _cull(count, visible, pool, batchMask, test);
+}
+
+uint32_t math::boundsCull(const Frustum &frustum, const SphereStream &spheres, const AABBStream &aabbs,
+		uint32_t count, uint32_t *visible, ThreadPool *pool) {
+	auto test = [&](uint32_t i) { return _sphereTest(frustum, spheres, i) && _aabbTest(frustum, aabbs, i); };
+
+#ifdef MATH_SSE
+	const FrustumLanes frustumLanes = _frustumSplat(frustum);
+	auto batchMask = [&](uint32_t i) {
+		uint32_t mask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k += LANE_COUNT)
+			mask |= _spheresMask(frustumLanes, spheres, i + k) << k;
+
+		if (mask == 0)
+			return mask;
+
+		uint32_t boxMask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k += LANE_COUNT)
+			boxMask |= _aabbsMask(frustumLanes, aabbs, i + k) << k;
+
+		return mask & boxMask;
+	};
+#else
+	auto batchMask = [&](uint32_t i) {
+		uint32_t mask = 0;
+		for (uint32_t k = 0; k < CULL_BATCH; k++)
+			mask |= (uint32_t)test(i + k) << k;
+
+		return mask;
+	};
+#endif
+
+	return _cull(count, visible, pool, batchMask, test);
+}
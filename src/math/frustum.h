@@ -0,0 +1,105 @@
+#ifndef MATH_FRUSTUM_H
+#define MATH_FRUSTUM_H
+
+#include <cmath>
+#include <cstdint>
+
+#include "transform_batch.h"
+#include "types/mat4.h"
+#include "types/vec3.h"
+#include "types/vec4.h"
+
+class ThreadPool;
+
+namespace math {
+
+// Structure of arrays view of spheres, element i is centered at (x[i], y[i], z[i]).
+typedef struct {
+	float *x, *y, *z;
+	float *radius;
+} SphereStream;
+
+// Named after the clip space bound, with the Vulkan y flip FRUSTUM_BOTTOM (y >= -w) is the top of the image.
+typedef enum {
+	FRUSTUM_LEFT,
+	FRUSTUM_RIGHT,
+	FRUSTUM_BOTTOM,
+	FRUSTUM_TOP,
+	FRUSTUM_NEAR,
+	FRUSTUM_FAR,
+	FRUSTUM_PLANE_COUNT,
+} FrustumPlane;
+
+// Planes as (normal, distance) with unit normals pointing inwards, p is inside when dot(normal, p) + distance >= 0.
+typedef struct {
+	vec4 planes[FRUSTUM_PLANE_COUNT];
+} Frustum;
+
+inline vec4 _planeNormalize(const vec4 &plane) {
+	float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+
+	// the far plane of perspectiveInfinite has no normal, nothing lies beyond it
+	if (length == 0.0f)
+		return vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	return plane / length;
+}
+
+// Planes of a projection * view matrix from perspective or perspectiveFocal, in the space the view matrix
+// maps from: Vulkan clip space, -w <= x, y <= w and reverse z, w >= z >= 0 from the near to the far plane.
+inline Frustum frustumExtract(const mat4 &viewProjection) {
+	const mat4 rows = transpose(viewProjection);
+
+	Frustum frustum;
+	frustum.planes[FRUSTUM_LEFT] = rows.w + rows.x;
+	frustum.planes[FRUSTUM_RIGHT] = rows.w - rows.x;
+	frustum.planes[FRUSTUM_BOTTOM] = rows.w + rows.y;
+	frustum.planes[FRUSTUM_TOP] = rows.w - rows.y;
+	frustum.planes[FRUSTUM_NEAR] = rows.w - rows.z;
+	frustum.planes[FRUSTUM_FAR] = rows.z;
+
+	for (vec4 &plane : frustum.planes)
+		plane = _planeNormalize(plane);
+
+	return frustum;
+}
+
+// Conservative: true unless the sphere lies entirely outside one plane.
+inline bool frustumSphereTest(const Frustum &frustum, const vec3 &center, float radius) {
+	for (const vec4 &plane : frustum.planes) {
+		if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+// Conservative: true unless the box lies entirely outside one plane.
+inline bool frustumBoxTest(const Frustum &frustum, const vec3 &center, const vec3 &halfExtents) {
+	for (const vec4 &plane : frustum.planes) {
+		float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		float reach = std::fabs(plane.x) * halfExtents.x + std::fabs(plane.y) * halfExtents.y +
+				std::fabs(plane.z) * halfExtents.z;
+
+		if (distance + reach < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+// Batch culling: writes the indices of the elements that pass the test to visible in ascending order and
+// returns how many. visible holds count entries, past the returned count it is left undefined. Tests run
+// in batches of 8, on 8 (AVX2) or 2x4 (SSE) lanes, and the pool splits the elements into chunks.
+uint32_t spheresCull(const Frustum &frustum, const SphereStream &spheres, uint32_t count, uint32_t *visible,
+		ThreadPool *pool = nullptr);
+uint32_t aabbsCull(const Frustum &frustum, const AABBStream &aabbs, uint32_t count, uint32_t *visible,
+		ThreadPool *pool = nullptr);
+
+// Visible when both the sphere and the box pass, the box is only tested for batches with a visible sphere.
+uint32_t boundsCull(const Frustum &frustum, const SphereStream &spheres, const AABBStream &aabbs, uint32_t count,
+		uint32_t *visible, ThreadPool *pool = nullptr);
+
+} // namespace math
+
+#endif // !MATH_FRUSTUM_H
@@ -1,13 +1,63 @@
 #ifndef MATH_PROJECTION_H
 #define MATH_PROJECTION_H
 
+#include <cmath>
+
 #include "types/mat4.h"
+#include "types/precision.h"
 #include "types/vec3.h"
 
 namespace math {
 
-mat4 perspective(float aspect, float fovY, float zNear, float zFar);
-mat4 lookAt(const vec3 &eye, const vec3 &target, const vec3 &up);
+// Flips y and maps OpenGL's [-1, 1] clip depth to Vulkan's [0, 1].
+constexpr mat4 OPENGL_TO_VULKAN_MATRIX = {
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, -1.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, 0.5f, 0.0f },
+	{ 0.0f, 0.0f, 0.5f, 1.0f },
+};
+
+// Maps [0, 1] depth to [1, 0], the near plane ends up at 1 where floats are the least precise.
+constexpr mat4 REVERSE_Z_MATRIX = {
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, 1.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, -1.0f, 0.0f },
+	{ 0.0f, 0.0f, 1.0f, 1.0f },
+};
+
+// REVERSE_Z_MATRIX * OPENGL_TO_VULKAN_MATRIX, folded by hand since the product is not constexpr.
+constexpr mat4 VULKAN_REVERSE_Z_MATRIX = {
+	{ 1.0f, 0.0f, 0.0f, 0.0f },
+	{ 0.0f, -1.0f, 0.0f, 0.0f },
+	{ 0.0f, 0.0f, -0.5f, 0.0f },
+	{ 0.0f, 0.0f, 0.5f, 1.0f },
+};
+
+// Right handed view space looking down -z to Vulkan clip space with reverse z: depth 1 at zNear, 0 at zFar.
+// focal is 1 / tan(fovY / 2). The same as VULKAN_REVERSE_Z_MATRIX times the OpenGL projection, in closed form.
+constexpr mat4 perspectiveFocal(float aspect, float focal, float zNear, float zFar) {
+	return mat4(vec4(focal / aspect, 0.0f, 0.0f, 0.0f), vec4(0.0f, -focal, 0.0f, 0.0f),
+			vec4(0.0f, 0.0f, zNear / (zFar - zNear), -1.0f), vec4(0.0f, 0.0f, (zFar * zNear) / (zFar - zNear), 0.0f));
+}
+
+// perspectiveFocal with zFar at infinity, depth falls off as zNear / distance.
+constexpr mat4 perspectiveInfinite(float aspect, float focal, float zNear) {
+	return mat4(vec4(focal / aspect, 0.0f, 0.0f, 0.0f), vec4(0.0f, -focal, 0.0f, 0.0f), vec4(0.0f, 0.0f, 0.0f, -1.0f),
+			vec4(0.0f, 0.0f, zNear, 0.0f));
+}
+
+inline mat4 perspective(float aspect, float fovY, float zNear, float zFar) {
+	return perspectiveFocal(aspect, 1.0f / std::tan(fovY / 2.0f), zNear, zFar);
+}
+
+// Right handed view matrix: the inverse of the camera's world matrix, which looks down -z with y up.
+inline mat4 lookAt(const vec3 &eye, const vec3 &target, const vec3 &up, Precision precision = PRECISION_DEFAULT) {
+	vec3 back = normalize(eye - target, precision);
+	vec3 right = normalize(cross(up, back), precision);
+	vec3 cameraUp = cross(back, right);
+
+	return affineInverse(mat4(vec4(right, 0.0f), vec4(cameraUp, 0.0f), vec4(back, 0.0f), vec4(eye, 1.0f)));
+}
 
 }; // namespace math
 
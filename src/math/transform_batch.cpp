@@ -0,0 +1,358 @@
+#include <cmath>
+#include <cstdint>
+
+#include "transform_batch.h"
+#include "types/lanes.h"
+#include "types/mat4.h"
+#include "types/quat.h"
+#include "types/simd.h"
+#include "types/trs.h"
+
+using namespace math;
+
+static inline const mat4 &_matrixAt(const mat4 *matrices, const uint32_t *matrixIndices, uint32_t i) {
+	return matrices[matrixIndices != nullptr ? matrixIndices[i] : i];
+}
+
+#ifdef MATH_SSE
+
+// The affine part of a matrix per lane, columns[c][r] is row r of column c.
+typedef struct {
+	lanes columns[4][3];
+} MatrixLanes;
+
+static inline MatrixLanes _matrixSplat(const mat4 &matrix) {
+	const float *elements = &matrix.x.x;
+
+	MatrixLanes out;
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 3; r++)
+			out.columns[c][r] = lanesSplat(elements[c * 4 + r]);
+	}
+
+	return out;
+}
+
+// Four matrices transposed so that lane k holds the elements of matrices[k].
+static inline void _matrixGather4(const mat4 *const *matrices, __m128 out[4][3]) {
+	for (int c = 0; c < 4; c++) {
+		__m128 r0 = _mm_load_ps(&(&matrices[0]->x)[c].x);
+		__m128 r1 = _mm_load_ps(&(&matrices[1]->x)[c].x);
+		__m128 r2 = _mm_load_ps(&(&matrices[2]->x)[c].x);
+		__m128 r3 = _mm_load_ps(&(&matrices[3]->x)[c].x);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+		out[c][0] = r0;
+		out[c][1] = r1;
+		out[c][2] = r2;
+	}
+}
+
+static inline MatrixLanes _matrixGather(const mat4 *matrices, const uint32_t *matrixIndices, uint32_t begin) {
+	const mat4 *gathered[LANE_COUNT];
+	for (uint32_t k = 0; k < LANE_COUNT; k++)
+		gathered[k] = &_matrixAt(matrices, matrixIndices, begin + k);
+
+	MatrixLanes out;
+#ifdef MATH_AVX2
+	__m128 low[4][3], high[4][3];
+	_matrixGather4(gathered, low);
+	_matrixGather4(gathered + 4, high);
+
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 3; r++)
+			out.columns[c][r] = _mm256_insertf128_ps(_mm256_castps128_ps256(low[c][r]), high[c][r], 1);
+	}
+#else
+	_matrixGather4(gathered, out.columns);
+#endif
+
+	return out;
+}
+
+// Four elements by their own matrices: the columns of each matrix weighted by its element, transposed back
+// into streams. Cheaper than transposing the matrices into lanes, which takes four transposes instead of one.
+static inline void _matricesBlock(const mat4 *matrices, const uint32_t *matrixIndices, bool translate,
+		const Vec3Stream &in, const Vec3Stream &out, uint32_t i) {
+	__m128 results[4];
+	for (uint32_t k = 0; k < 4; k++) {
+		const mat4 &m = _matrixAt(matrices, matrixIndices, i + k);
+
+		__m128 sum = _mm_mul_ps(_mm_load_ps(&m.z.x), _mm_set1_ps(in.z[i + k]));
+		if (translate)
+			sum = _mm_add_ps(sum, _mm_load_ps(&m.w.x));
+
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(&m.y.x), _mm_set1_ps(in.y[i + k])));
+		results[k] = _mm_add_ps(sum, _mm_mul_ps(_mm_load_ps(&m.x.x), _mm_set1_ps(in.x[i + k])));
+	}
+
+	_MM_TRANSPOSE4_PS(results[0], results[1], results[2], results[3]);
+	_mm_storeu_ps(out.x + i, results[0]);
+	_mm_storeu_ps(out.y + i, results[1]);
+	_mm_storeu_ps(out.z + i, results[2]);
+}
+
+// Row r of the matrix times (x, y, z, w), translation is null for w = 0.
+static inline lanes _row(const MatrixLanes &m, int r, lanes x, lanes y, lanes z, const lanes *translation) {
+	lanes sum = lanesMul(m.columns[2][r], z);
+	if (translation != nullptr)
+		sum = lanesAdd(sum, translation[r]);
+
+	return lanesMadd(m.columns[0][r], x, lanesMadd(m.columns[1][r], y, sum));
+}
+
+static inline void _pointsBlock(const MatrixLanes &m, const Vec3Stream &in, const Vec3Stream &out, uint32_t i) {
+	lanes x = lanesLoad(in.x + i), y = lanesLoad(in.y + i), z = lanesLoad(in.z + i);
+
+	lanesStore(out.x + i, _row(m, 0, x, y, z, m.columns[3]));
+	lanesStore(out.y + i, _row(m, 1, x, y, z, m.columns[3]));
+	lanesStore(out.z + i, _row(m, 2, x, y, z, m.columns[3]));
+}
+
+static inline void _directionsBlock(const MatrixLanes &m, const Vec3Stream &in, const Vec3Stream &out, uint32_t i) {
+	lanes x = lanesLoad(in.x + i), y = lanesLoad(in.y + i), z = lanesLoad(in.z + i);
+
+	lanesStore(out.x + i, _row(m, 0, x, y, z, nullptr));
+	lanesStore(out.y + i, _row(m, 1, x, y, z, nullptr));
+	lanesStore(out.z + i, _row(m, 2, x, y, z, nullptr));
+}
+
+static inline void _aabbsBlock(const MatrixLanes &m, const AABBStream &in, const AABBStream &out, uint32_t i) {
+	const lanes half = lanesSplat(0.5f);
+
+	lanes hx = lanesMul(lanesLoad(in.w + i), half);
+	lanes hy = lanesMul(lanesLoad(in.h + i), half);
+	lanes hz = lanesMul(lanesLoad(in.d + i), half);
+
+	lanes cx = lanesAdd(lanesLoad(in.x + i), hx);
+	lanes cy = lanesAdd(lanesLoad(in.y + i), hy);
+	lanes cz = lanesAdd(lanesLoad(in.z + i), hz);
+
+	float *mins[3] = { out.x + i, out.y + i, out.z + i };
+	float *sizes[3] = { out.w + i, out.h + i, out.d + i };
+
+	for (int r = 0; r < 3; r++) {
+		lanes center = _row(m, r, cx, cy, cz, m.columns[3]);
+		lanes extent = lanesMadd(lanesAbs(m.columns[0][r]), hx,
+				lanesMadd(lanesAbs(m.columns[1][r]), hy, lanesMul(lanesAbs(m.columns[2][r]), hz)));
+
+		lanesStore(mins[r], lanesSub(center, extent));
+		lanesStore(sizes[r], lanesAdd(extent, extent));
+	}
+}
+
+// The upper 3x3 of quatMatrix for four rotations in lanes, scaled per column like trsMatrix when scales is not
+// null. columns[c][r] like MatrixLanes.
+static inline void _rotationsCompute(
+		__m128 x, __m128 y, __m128 z, __m128 w, const __m128 *scales, __m128 columns[3][3]) {
+	const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f);
+
+	__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+	__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+	__m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+	columns[0][0] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)));
+	columns[0][1] = _mm_mul_ps(two, _mm_add_ps(xy, wz));
+	columns[0][2] = _mm_mul_ps(two, _mm_sub_ps(xz, wy));
+
+	columns[1][0] = _mm_mul_ps(two, _mm_sub_ps(xy, wz));
+	columns[1][1] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)));
+	columns[1][2] = _mm_mul_ps(two, _mm_add_ps(yz, wx));
+
+	columns[2][0] = _mm_mul_ps(two, _mm_add_ps(xz, wy));
+	columns[2][1] = _mm_mul_ps(two, _mm_sub_ps(yz, wx));
+	columns[2][2] = _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)));
+
+	if (scales == nullptr)
+		return;
+
+	for (int c = 0; c < 3; c++) {
+		for (int r = 0; r < 3; r++)
+			columns[c][r] = _mm_mul_ps(columns[c][r], scales[c]);
+	}
+}
+
+// Column c of four matrices from its rows in lanes.
+static inline void _columnStore(__m128 x, __m128 y, __m128 z, __m128 w, int c, mat4 *matrices) {
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+	_mm_store_ps(&(&matrices[0].x)[c].x, x);
+	_mm_store_ps(&(&matrices[1].x)[c].x, y);
+	_mm_store_ps(&(&matrices[2].x)[c].x, z);
+	_mm_store_ps(&(&matrices[3].x)[c].x, w);
+}
+
+static inline void _rotationsStore(const __m128 columns[3][3], mat4 *matrices) {
+	for (int c = 0; c < 3; c++)
+		_columnStore(columns[c][0], columns[c][1], columns[c][2], _mm_setzero_ps(), c, matrices);
+}
+
+static inline void _trsBlock(const trs *transforms, mat4 *matrices) {
+	// three overlapping loads per transform, (tx, ty, tz, qx), (qy, qz, qw, sx) and (qw, sx, sy, sz), the last
+	// one ends with the transform
+	__m128 a[4], b[4], c[4];
+	for (int k = 0; k < 4; k++) {
+		const float *elements = &transforms[k].translation.x;
+		a[k] = _mm_loadu_ps(elements);
+		b[k] = _mm_loadu_ps(elements + 4);
+		c[k] = _mm_loadu_ps(elements + 6);
+	}
+
+	_MM_TRANSPOSE4_PS(a[0], a[1], a[2], a[3]);
+	_MM_TRANSPOSE4_PS(b[0], b[1], b[2], b[3]);
+	_MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+
+	const __m128 scales[3] = { b[3], c[2], c[3] };
+	__m128 columns[3][3];
+	_rotationsCompute(a[3], b[0], b[1], b[2], scales, columns);
+	_rotationsStore(columns, matrices);
+	_columnStore(a[0], a[1], a[2], _mm_set1_ps(1.0f), 3, matrices);
+}
+
+static inline void _quatsBlock(const quat *rotations, mat4 *matrices) {
+	__m128 x = _mm_loadu_ps(&rotations[0].x);
+	__m128 y = _mm_loadu_ps(&rotations[1].x);
+	__m128 z = _mm_loadu_ps(&rotations[2].x);
+	__m128 w = _mm_loadu_ps(&rotations[3].x);
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+
+	__m128 columns[3][3];
+	_rotationsCompute(x, y, z, w, nullptr, columns);
+	_rotationsStore(columns, matrices);
+
+	for (int k = 0; k < 4; k++)
+		matrices[k].w = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+#endif // MATH_SSE
+
+static inline void _point(const mat4 &matrix, const Vec3Stream &in, const Vec3Stream &out, uint32_t i) {
+	const float *m = &matrix.x.x;
+	float x = in.x[i], y = in.y[i], z = in.z[i];
+
+	out.x[i] = m[0] * x + m[4] * y + m[8] * z + m[12];
+	out.y[i] = m[1] * x + m[5] * y + m[9] * z + m[13];
+	out.z[i] = m[2] * x + m[6] * y + m[10] * z + m[14];
+}
+
+static inline void _direction(const mat4 &matrix, const Vec3Stream &in, const Vec3Stream &out, uint32_t i) {
+	const float *m = &matrix.x.x;
+	float x = in.x[i], y = in.y[i], z = in.z[i];
+
+	out.x[i] = m[0] * x + m[4] * y + m[8] * z;
+	out.y[i] = m[1] * x + m[5] * y + m[9] * z;
+	out.z[i] = m[2] * x + m[6] * y + m[10] * z;
+}
+
+static inline void _aabb(const mat4 &matrix, const AABBStream &in, const AABBStream &out, uint32_t i) {
+	const float *m = &matrix.x.x;
+	float half[3] = { in.w[i] * 0.5f, in.h[i] * 0.5f, in.d[i] * 0.5f };
+	float center[3] = { in.x[i] + half[0], in.y[i] + half[1], in.z[i] + half[2] };
+
+	float *mins[3] = { out.x, out.y, out.z };
+	float *sizes[3] = { out.w, out.h, out.d };
+
+	for (int r = 0; r < 3; r++) {
+		float worldCenter = m[r] * center[0] + m[4 + r] * center[1] + m[8 + r] * center[2] + m[12 + r];
+		float extent = std::fabs(m[r]) * half[0] + std::fabs(m[4 + r]) * half[1] + std::fabs(m[8 + r]) * half[2];
+
+		mins[r][i] = worldCenter - extent;
+		sizes[r][i] = extent + extent;
+	}
+}
+
+void math::pointsTransform(const mat4 &matrix, const Vec3Stream &in, const Vec3Stream &out, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	const MatrixLanes m = _matrixSplat(matrix);
+	for (; i + LANE_COUNT <= count; i += LANE_COUNT)
+		_pointsBlock(m, in, out, i);
+#endif
+
+	for (; i < count; i++)
+		_point(matrix, in, out, i);
+}
+
+void math::pointsTransform(const mat4 *matrices, const uint32_t *matrixIndices, const Vec3Stream &in,
+		const Vec3Stream &out, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	for (; i + 4 <= count; i += 4)
+		_matricesBlock(matrices, matrixIndices, true, in, out, i);
+#endif
+
+	for (; i < count; i++)
+		_point(_matrixAt(matrices, matrixIndices, i), in, out, i);
+}
+
+void math::directionsTransform(const mat4 &matrix, const Vec3Stream &in, const Vec3Stream &out, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	const MatrixLanes m = _matrixSplat(matrix);
+	for (; i + LANE_COUNT <= count; i += LANE_COUNT)
+		_directionsBlock(m, in, out, i);
+#endif
+
+	for (; i < count; i++)
+		_direction(matrix, in, out, i);
+}
+
+void math::directionsTransform(const mat4 *matrices, const uint32_t *matrixIndices, const Vec3Stream &in,
+		const Vec3Stream &out, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	for (; i + 4 <= count; i += 4)
+		_matricesBlock(matrices, matrixIndices, false, in, out, i);
+#endif
+
+	for (; i < count; i++)
+		_direction(_matrixAt(matrices, matrixIndices, i), in, out, i);
+}
+
+void math::aabbsTransform(const mat4 &matrix, const AABBStream &in, const AABBStream &out, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	const MatrixLanes m = _matrixSplat(matrix);
+	for (; i + LANE_COUNT <= count; i += LANE_COUNT)
+		_aabbsBlock(m, in, out, i);
+#endif
+
+	for (; i < count; i++)
+		_aabb(matrix, in, out, i);
+}
+
+void math::aabbsTransform(const mat4 *matrices, const uint32_t *matrixIndices, const AABBStream &in,
+		const AABBStream &out, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	for (; i + LANE_COUNT <= count; i += LANE_COUNT)
+		_aabbsBlock(_matrixGather(matrices, matrixIndices, i), in, out, i);
+#endif
+
+	for (; i < count; i++)
+		_aabb(_matrixAt(matrices, matrixIndices, i), in, out, i);
+}
+
+// _trsBlock reads the ten floats of a transform as one array.
+static_assert(sizeof(trs) == 10 * sizeof(float), "trs must be packed");
+
+void math::trsMatrices(const trs *transforms, mat4 *matrices, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	for (; i + 4 <= count; i += 4)
+		_trsBlock(transforms + i, matrices + i);
+#endif
+
+	for (; i < count; i++)
+		matrices[i] = trsMatrix(transforms[i]);
+}
+
+void math::quatMatrices(const quat *rotations, mat4 *matrices, uint32_t count) {
+	uint32_t i = 0;
+#ifdef MATH_SSE
+	for (; i + 4 <= count; i += 4)
+		_quatsBlock(rotations + i, matrices + i);
+#endif
+
+	for (; i < count; i++)
+		matrices[i] = quatMatrix(rotations[i]);
+}
@@ -0,0 +1,51 @@
+#ifndef MATH_TRANSFORM_BATCH_H
+#define MATH_TRANSFORM_BATCH_H
+
+#include <cstdint>
+
+#include "types/mat4.h"
+#include "types/quat.h"
+#include "types/trs.h"
+
+namespace math {
+
+// Structure of arrays view, element i is (x[i], y[i], z[i]).
+typedef struct {
+	float *x, *y, *z;
+} Vec3Stream;
+
+// Boxes as min corner and size like AABB in io/types/aabb.h, element i is (x[i], y[i], z[i], w[i], h[i], d[i]).
+typedef struct {
+	float *x, *y, *z;
+	float *w, *h, *d;
+} AABBStream;
+
+// Batch transforms of count elements from in to out, 8 (AVX2) or 4 (SSE) elements per step and the rest one by
+// one, see simd.h. The matrices are affine, their bottom row is ignored. out may be in itself.
+//
+// The overloads taking matrices transform element i by matrices[matrixIndices[i]], e.g. a joint per vertex,
+// or by matrices[i] when matrixIndices is null, e.g. a world matrix per instance.
+
+// Positions: w = 1.
+void pointsTransform(const mat4 &matrix, const Vec3Stream &in, const Vec3Stream &out, uint32_t count);
+void pointsTransform(const mat4 *matrices, const uint32_t *matrixIndices, const Vec3Stream &in,
+		const Vec3Stream &out, uint32_t count);
+
+// Directions: w = 0, not renormalized. Transform normals by the inverse transpose.
+void directionsTransform(const mat4 &matrix, const Vec3Stream &in, const Vec3Stream &out, uint32_t count);
+void directionsTransform(const mat4 *matrices, const uint32_t *matrixIndices, const Vec3Stream &in,
+		const Vec3Stream &out, uint32_t count);
+
+// The AABB around each transformed box, with Arvo's method like MeshBounds::aabbTransform.
+void aabbsTransform(const mat4 &matrix, const AABBStream &in, const AABBStream &out, uint32_t count);
+void aabbsTransform(const mat4 *matrices, const uint32_t *matrixIndices, const AABBStream &in,
+		const AABBStream &out, uint32_t count);
+
+// trsMatrix and quatMatrix of count elements, 4 per step (SSE) and the rest one by one. The same arithmetic as
+// the single element functions, equal up to FMA contraction.
+void trsMatrices(const trs *transforms, mat4 *matrices, uint32_t count);
+void quatMatrices(const quat *rotations, mat4 *matrices, uint32_t count);
+
+} // namespace math
+
+#endif // !MATH_TRANSFORM_BATCH_H
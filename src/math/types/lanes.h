@@ -0,0 +1,102 @@
+#ifndef MATH_LANES_H
+#define MATH_LANES_H
+
+#include <cstdint>
+
+#include "simd.h"
+
+#ifdef MATH_SSE
+
+namespace math {
+
+// A register of the widest backend for the batch kernels: the same component of LANE_COUNT consecutive
+// elements of a structure of arrays. Loads and stores are unaligned.
+#ifdef MATH_AVX2
+typedef __m256 lanes;
+const uint32_t LANE_COUNT = 8;
+
+inline lanes lanesSplat(float v) {
+	return _mm256_set1_ps(v);
+}
+
+inline lanes lanesLoad(const float *p) {
+	return _mm256_loadu_ps(p);
+}
+
+inline void lanesStore(float *p, lanes v) {
+	_mm256_storeu_ps(p, v);
+}
+
+inline lanes lanesAdd(lanes a, lanes b) {
+	return _mm256_add_ps(a, b);
+}
+
+inline lanes lanesSub(lanes a, lanes b) {
+	return _mm256_sub_ps(a, b);
+}
+
+inline lanes lanesMul(lanes a, lanes b) {
+	return _mm256_mul_ps(a, b);
+}
+
+// a * b + c
+inline lanes lanesMadd(lanes a, lanes b, lanes c) {
+	return _mm256_fmadd_ps(a, b, c);
+}
+
+inline lanes lanesAbs(lanes v) {
+	return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+// Bit k set when lane k of a is at least b.
+inline uint32_t lanesGreaterEqual(lanes a, lanes b) {
+	return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GE_OQ));
+}
+#else
+typedef __m128 lanes;
+const uint32_t LANE_COUNT = 4;
+
+inline lanes lanesSplat(float v) {
+	return _mm_set1_ps(v);
+}
+
+inline lanes lanesLoad(const float *p) {
+	return _mm_loadu_ps(p);
+}
+
+inline void lanesStore(float *p, lanes v) {
+	_mm_storeu_ps(p, v);
+}
+
+inline lanes lanesAdd(lanes a, lanes b) {
+	return _mm_add_ps(a, b);
+}
+
+inline lanes lanesSub(lanes a, lanes b) {
+	return _mm_sub_ps(a, b);
+}
+
+inline lanes lanesMul(lanes a, lanes b) {
+	return _mm_mul_ps(a, b);
+}
+
+// a * b + c
+inline lanes lanesMadd(lanes a, lanes b, lanes c) {
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+inline lanes lanesAbs(lanes v) {
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// Bit k set when lane k of a is at least b.
+inline uint32_t lanesGreaterEqual(lanes a, lanes b) {
+	return _mm_movemask_ps(_mm_cmpge_ps(a, b));
+}
+#endif
+
+} // namespace math
+
+#endif // MATH_SSE
+
+#endif // !MATH_LANES_H
@@ -13,10 +13,31 @@ public:
 	void operator*=(const mat3 &m);
 
 	mat3() {}
-	mat3(float _v);
-	mat3(const vec3 &_x, const vec3 &_y, const vec3 &_z);
+	constexpr mat3(float _v) : x(_v, 0.0f, 0.0f), y(0.0f, _v, 0.0f), z(0.0f, 0.0f, _v) {} // _v on the diagonal
+	constexpr mat3(const vec3 &_x, const vec3 &_y, const vec3 &_z) : x(_x), y(_y), z(_z) {}
 };
 
+// a * b
+inline mat3 _mat3Mul(const mat3 &a, const mat3 &b) {
+	const vec3 rows[3] = {
+		vec3(a.x.x, a.y.x, a.z.x),
+		vec3(a.x.y, a.y.y, a.z.y),
+		vec3(a.x.z, a.y.z, a.z.z),
+	};
+
+	return mat3(vec3(dot(rows[0], b.x), dot(rows[1], b.x), dot(rows[2], b.x)),
+			vec3(dot(rows[0], b.y), dot(rows[1], b.y), dot(rows[2], b.y)),
+			vec3(dot(rows[0], b.z), dot(rows[1], b.z), dot(rows[2], b.z)));
+}
+
+inline mat3 mat3::operator*(const mat3 &m) const {
+	return _mat3Mul(*this, m);
+}
+
+inline void mat3::operator*=(const mat3 &m) {
+	*this = _mat3Mul(*this, m);
+}
+
 } // namespace math
 
 #endif // !MATH_MAT3_H
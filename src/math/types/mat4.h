@@ -1,10 +1,26 @@
 #ifndef MATH_MAT4_H
 #define MATH_MAT4_H
 
+#include "simd.h"
 #include "vec4.h"
 
 namespace math {
 
+class mat4;
+
+mat4 transpose(const mat4 &m);
+
+// General inverse by 2x2 blocks, undefined for singular matrices.
+mat4 inverse(const mat4 &m);
+
+// Inverse of an affine matrix, its bottom row is taken as (0, 0, 0, 1). Cheaper than inverse.
+mat4 affineInverse(const mat4 &m);
+
+// The inverse transpose of the upper 3x3 with no translation, transforms normals so that they stay
+// perpendicular to the transformed surface under non-uniform scale. Not normalized.
+mat4 normalMatrix(const mat4 &m);
+
+// Column major: x, y and z are the basis vectors, w the translation. a * b applies b first.
 class mat4 {
 public:
 	vec4 x, y, z, w;
@@ -12,11 +28,295 @@ public:
 	mat4 operator*(const mat4 &m) const;
 	void operator*=(const mat4 &m);
 
+	vec4 operator*(const vec4 &v) const;
+
 	mat4() {}
-	mat4(float _v);
-	mat4(const vec4 &_x, const vec4 &_y, const vec4 &_z, const vec4 &_w);
+	constexpr mat4(float _v) // _v on the diagonal, zero elsewhere
+		: x(_v, 0.0f, 0.0f, 0.0f), y(0.0f, _v, 0.0f, 0.0f), z(0.0f, 0.0f, _v, 0.0f), w(0.0f, 0.0f, 0.0f, _v) {}
+	constexpr mat4(const vec4 &_x, const vec4 &_y, const vec4 &_z, const vec4 &_w) : x(_x), y(_y), z(_z), w(_w) {}
 };
 
+#ifdef MATH_SSE
+
+// Column major product: every column of the result is a weighted sum of the columns of a.
+inline __m128 _mat4Column(const mat4 &a, __m128 weights) {
+	__m128 x = _mm_mul_ps(_mm_load_ps(&a.x.x), _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(0, 0, 0, 0)));
+	__m128 y = _mm_mul_ps(_mm_load_ps(&a.y.x), _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(1, 1, 1, 1)));
+	__m128 z = _mm_mul_ps(_mm_load_ps(&a.z.x), _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(2, 2, 2, 2)));
+	__m128 w = _mm_mul_ps(_mm_load_ps(&a.w.x), _mm_shuffle_ps(weights, weights, _MM_SHUFFLE(3, 3, 3, 3)));
+	return _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w));
+}
+
+#endif // MATH_SSE
+
+// a * b
+inline mat4 _mat4Mul(const mat4 &a, const mat4 &b) {
+	mat4 out;
+
+#if defined(MATH_AVX2)
+	// two result columns per register, the in-lane permutes broadcast each column's weights.
+	// mat4 is only 16 byte aligned, hence the unaligned 256 bit loads.
+	__m256 x = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(&a.x));
+	__m256 y = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(&a.y));
+	__m256 z = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(&a.z));
+	__m256 w = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(&a.w));
+
+	for (int i = 0; i < 2; i++) {
+		__m256 weights = _mm256_loadu_ps(&(&b.x)[i * 2].x);
+
+		__m256 column = _mm256_mul_ps(x, _mm256_permute_ps(weights, _MM_SHUFFLE(0, 0, 0, 0)));
+		column = _mm256_fmadd_ps(y, _mm256_permute_ps(weights, _MM_SHUFFLE(1, 1, 1, 1)), column);
+		column = _mm256_fmadd_ps(z, _mm256_permute_ps(weights, _MM_SHUFFLE(2, 2, 2, 2)), column);
+		column = _mm256_fmadd_ps(w, _mm256_permute_ps(weights, _MM_SHUFFLE(3, 3, 3, 3)), column);
+
+		_mm256_storeu_ps(&(&out.x)[i * 2].x, column);
+	}
+#elif defined(MATH_SSE)
+	_mm_store_ps(&out.x.x, _mat4Column(a, _mm_load_ps(&b.x.x)));
+	_mm_store_ps(&out.y.x, _mat4Column(a, _mm_load_ps(&b.y.x)));
+	_mm_store_ps(&out.z.x, _mat4Column(a, _mm_load_ps(&b.z.x)));
+	_mm_store_ps(&out.w.x, _mat4Column(a, _mm_load_ps(&b.w.x)));
+#else
+	const float *columns = &a.x.x;
+	const float *weights = &b.x.x;
+	float *outColumns = &out.x.x;
+
+	for (int i = 0; i < 4; i++) {
+		for (int r = 0; r < 4; r++) {
+			outColumns[i * 4 + r] = columns[r] * weights[i * 4] + columns[4 + r] * weights[i * 4 + 1] +
+					columns[8 + r] * weights[i * 4 + 2] + columns[12 + r] * weights[i * 4 + 3];
+		}
+	}
+#endif
+
+	return out;
+}
+
+inline mat4 transpose(const mat4 &m) {
+#ifdef MATH_SSE
+	__m128 x = _mm_load_ps(&m.x.x);
+	__m128 y = _mm_load_ps(&m.y.x);
+	__m128 z = _mm_load_ps(&m.z.x);
+	__m128 w = _mm_load_ps(&m.w.x);
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+
+	mat4 out;
+	_mm_store_ps(&out.x.x, x);
+	_mm_store_ps(&out.y.x, y);
+	_mm_store_ps(&out.z.x, z);
+	_mm_store_ps(&out.w.x, w);
+	return out;
+#else
+	return mat4(vec4(m.x.x, m.y.x, m.z.x, m.w.x), vec4(m.x.y, m.y.y, m.z.y, m.w.y), vec4(m.x.z, m.y.z, m.z.z, m.w.z),
+			vec4(m.x.w, m.y.w, m.z.w, m.w.w));
+#endif
+}
+
+inline mat4 mat4::operator*(const mat4 &m) const {
+	return _mat4Mul(*this, m);
+}
+
+inline void mat4::operator*=(const mat4 &m) {
+	*this = _mat4Mul(*this, m);
+}
+
+inline vec4 mat4::operator*(const vec4 &v) const {
+#ifdef MATH_SSE
+	vec4 out;
+	_mm_store_ps(&out.x, _mat4Column(*this, _mm_load_ps(&v.x)));
+	return out;
+#else
+	return vec4(x.x * v.x + y.x * v.y + z.x * v.z + w.x * v.w, x.y * v.x + y.y * v.y + z.y * v.z + w.y * v.w,
+			x.z * v.x + y.z * v.y + z.z * v.z + w.z * v.w, x.w * v.x + y.w * v.y + z.w * v.z + w.w * v.w);
+#endif
+}
+
+#ifdef MATH_SSE
+
+// 2x2 matrices as (m00, m01, m10, m11): a * b, adjugate(a) * b and a * adjugate(b).
+inline __m128 _mat2Mul(__m128 a, __m128 b) {
+	return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+inline __m128 _mat2AdjugateMul(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+inline __m128 _mat2MulAdjugate(__m128 a, __m128 b) {
+	return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+}
+
+// cross(a, b) with w = 0 for finite input.
+inline __m128 _vec4Cross(__m128 a, __m128 b) {
+	__m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+	__m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+	return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// The rows of the inverse of the upper 3x3, cross products of its columns over the determinant.
+inline void _mat3InverseRows(const mat4 &m, __m128 rows[3]) {
+	__m128 x = _mm_load_ps(&m.x.x), y = _mm_load_ps(&m.y.x), z = _mm_load_ps(&m.z.x);
+
+	__m128 yz = _vec4Cross(y, z);
+	__m128 determinant = _vec4HorizontalAdd(_mm_mul_ps(x, yz));
+	__m128 denom = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+	rows[0] = _mm_mul_ps(yz, denom);
+	rows[1] = _mm_mul_ps(_vec4Cross(z, x), denom);
+	rows[2] = _mm_mul_ps(_vec4Cross(x, y), denom);
+}
+
+#else
+
+// The rows of the inverse of the upper 3x3, cross products of its columns over the determinant.
+inline void _mat3InverseRows(const mat4 &m, vec3 rows[3]) {
+	vec3 x = vec3(m.x.x, m.x.y, m.x.z), y = vec3(m.y.x, m.y.y, m.y.z), z = vec3(m.z.x, m.z.y, m.z.z);
+
+	vec3 yz = cross(y, z);
+	float denom = 1.0f / dot(x, yz);
+
+	rows[0] = yz * denom;
+	rows[1] = cross(z, x) * denom;
+	rows[2] = cross(x, y) * denom;
+}
+
+#endif // MATH_SSE
+
+// The inverse of the transpose is the transpose of the inverse, so both backends treat the columns as the rows
+// of a row major matrix and still produce the column major inverse.
+inline mat4 inverse(const mat4 &m) {
+#ifdef MATH_SSE
+	__m128 c0 = _mm_load_ps(&m.x.x), c1 = _mm_load_ps(&m.y.x), c2 = _mm_load_ps(&m.z.x), c3 = _mm_load_ps(&m.w.x);
+
+	// the four 2x2 blocks | A B |
+	//                     | C D |
+	__m128 a = _mm_movelh_ps(c0, c1), b = _mm_movehl_ps(c1, c0);
+	__m128 c = _mm_movelh_ps(c2, c3), d = _mm_movehl_ps(c3, c2);
+
+	// (|A|, |B|, |C|, |D|)
+	__m128 even = _mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 odd = _mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1));
+	__m128 determinants = _mm_sub_ps(_mm_mul_ps(even, _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(odd, _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+	__m128 detA = _mm_shuffle_ps(determinants, determinants, _MM_SHUFFLE(0, 0, 0, 0));
+	__m128 detB = _mm_shuffle_ps(determinants, determinants, _MM_SHUFFLE(1, 1, 1, 1));
+	__m128 detC = _mm_shuffle_ps(determinants, determinants, _MM_SHUFFLE(2, 2, 2, 2));
+	__m128 detD = _mm_shuffle_ps(determinants, determinants, _MM_SHUFFLE(3, 3, 3, 3));
+
+	__m128 dc = _mat2AdjugateMul(d, c);
+	__m128 ab = _mat2AdjugateMul(a, b);
+
+	// the adjugates of the blocks of the inverse, before the division by |M|
+	__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), _mat2Mul(b, dc));
+	__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), _mat2Mul(c, ab));
+	__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), _mat2MulAdjugate(d, ab));
+	__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), _mat2MulAdjugate(a, dc));
+
+	// |M| = |A| |D| + |B| |C| - tr(adjugate(A) B adjugate(D) C)
+	__m128 trace = _vec4HorizontalAdd(_mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0))));
+	__m128 determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+	__m128 denom = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), determinant);
+
+	x = _mm_mul_ps(x, denom);
+	y = _mm_mul_ps(y, denom);
+	z = _mm_mul_ps(z, denom);
+	w = _mm_mul_ps(w, denom);
+
+	// the adjugate shuffles folded into putting the blocks back together
+	mat4 out;
+	_mm_store_ps(&out.x.x, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_store_ps(&out.y.x, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+	_mm_store_ps(&out.z.x, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_store_ps(&out.w.x, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+	return out;
+#else
+	const float(*a)[4] = reinterpret_cast<const float(*)[4]>(&m.x.x);
+
+	// 2x2 determinants of the top two and the bottom two rows
+	float s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1], s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+	float s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3], s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+	float s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3], s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+
+	float c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3], c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+	float c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2], c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+	float c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2], c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+
+	float denom = 1.0f / (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+
+	return mat4(vec4((a[1][1] * c5 - a[1][2] * c4 + a[1][3] * c3) * denom,
+						(-a[0][1] * c5 + a[0][2] * c4 - a[0][3] * c3) * denom,
+						(a[3][1] * s5 - a[3][2] * s4 + a[3][3] * s3) * denom,
+						(-a[2][1] * s5 + a[2][2] * s4 - a[2][3] * s3) * denom),
+			vec4((-a[1][0] * c5 + a[1][2] * c2 - a[1][3] * c1) * denom,
+					(a[0][0] * c5 - a[0][2] * c2 + a[0][3] * c1) * denom,
+					(-a[3][0] * s5 + a[3][2] * s2 - a[3][3] * s1) * denom,
+					(a[2][0] * s5 - a[2][2] * s2 + a[2][3] * s1) * denom),
+			vec4((a[1][0] * c4 - a[1][1] * c2 + a[1][3] * c0) * denom,
+					(-a[0][0] * c4 + a[0][1] * c2 - a[0][3] * c0) * denom,
+					(a[3][0] * s4 - a[3][1] * s2 + a[3][3] * s0) * denom,
+					(-a[2][0] * s4 + a[2][1] * s2 - a[2][3] * s0) * denom),
+			vec4((-a[1][0] * c3 + a[1][1] * c1 - a[1][2] * c0) * denom,
+					(a[0][0] * c3 - a[0][1] * c1 + a[0][2] * c0) * denom,
+					(-a[3][0] * s3 + a[3][1] * s1 - a[3][2] * s0) * denom,
+					(a[2][0] * s3 - a[2][1] * s1 + a[2][2] * s0) * denom));
+#endif
+}
+
+// The inverse of the upper 3x3 is transposed into columns, the translation is -inverse * translation.
+inline mat4 affineInverse(const mat4 &m) {
+#ifdef MATH_SSE
+	__m128 rows[3];
+	_mat3InverseRows(m, rows);
+
+	__m128 x = rows[0], y = rows[1], z = rows[2], w = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(x, y, z, w);
+
+	__m128 translation = _mm_load_ps(&m.w.x);
+	__m128 sum = _mm_mul_ps(x, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(0, 0, 0, 0)));
+	sum = _mm_add_ps(sum, _mm_mul_ps(y, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(1, 1, 1, 1))));
+	sum = _mm_add_ps(sum, _mm_mul_ps(z, _mm_shuffle_ps(translation, translation, _MM_SHUFFLE(2, 2, 2, 2))));
+
+	mat4 out;
+	_mm_store_ps(&out.x.x, x);
+	_mm_store_ps(&out.y.x, y);
+	_mm_store_ps(&out.z.x, z);
+	_mm_store_ps(&out.w.x, _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), sum));
+	return out;
+#else
+	vec3 rows[3];
+	_mat3InverseRows(m, rows);
+
+	vec3 t = vec3(m.w.x, m.w.y, m.w.z);
+	return mat4(vec4(rows[0].x, rows[1].x, rows[2].x, 0.0f), vec4(rows[0].y, rows[1].y, rows[2].y, 0.0f),
+			vec4(rows[0].z, rows[1].z, rows[2].z, 0.0f),
+			vec4(-dot(rows[0], t), -dot(rows[1], t), -dot(rows[2], t), 1.0f));
+#endif
+}
+
+// The rows of the inverse are the columns of the inverse transpose.
+inline mat4 normalMatrix(const mat4 &m) {
+#ifdef MATH_SSE
+	__m128 rows[3];
+	_mat3InverseRows(m, rows);
+
+	mat4 out;
+	_mm_store_ps(&out.x.x, rows[0]);
+	_mm_store_ps(&out.y.x, rows[1]);
+	_mm_store_ps(&out.z.x, rows[2]);
+	out.w = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	return out;
+#else
+	vec3 rows[3];
+	_mat3InverseRows(m, rows);
+
+	return mat4(vec4(rows[0], 0.0f), vec4(rows[1], 0.0f), vec4(rows[2], 0.0f), vec4(0.0f, 0.0f, 0.0f, 1.0f));
+#endif
+}
+
 } // namespace math
 
 #endif // !MATH_MAT4_H
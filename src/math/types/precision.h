@@ -0,0 +1,53 @@
+#ifndef MATH_PRECISION_H
+#define MATH_PRECISION_H
+
+#include <cmath>
+
+#include "simd.h"
+
+namespace math {
+
+// Precision of rsqrt and of the length and normalize functions built on it, passed per call site or left to
+// PRECISION_DEFAULT: exact, or fast when built with MATH_FAST_RSQRT (RENDERER_MATH_FAST_RSQRT). The argument is
+// a constant at every call site, the branch on it inlines away.
+typedef enum {
+	PRECISION_EXACT, // sqrt then a division, within 1.5 ulp of 1 / sqrt(x)
+	PRECISION_FAST,  // the SSE estimate refined with one Newton step, within RSQRT_FAST_ULP. Exact without SSE.
+} Precision;
+
+#ifdef MATH_FAST_RSQRT
+const Precision PRECISION_DEFAULT = PRECISION_FAST;
+#else
+const Precision PRECISION_DEFAULT = PRECISION_EXACT;
+#endif
+
+// Largest error of the fast tier in units in the last place, what the estimate's specified relative error of
+// 1.5 * 2^-12 allows after one step. bench/precision_report checks it for every float in [1, 4), the error
+// repeats every two binades.
+const float RSQRT_FAST_ULP = 4.0f;
+
+#ifdef MATH_SSE
+
+// r + 0.5 * r * (1 - x * r * r) for the estimate r, adding the small correction last rounds better than the
+// usual 0.5 * r * (3 - x * r * r). Zero and denormals give infinity or NaN.
+inline __m128 _rsqrtFast4(__m128 x) {
+	__m128 r = _mm_rsqrt_ps(x);
+	__m128 residual = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_mul_ps(x, r), r));
+	return _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), r), residual));
+}
+
+#endif // MATH_SSE
+
+// 1 / sqrt(x) for x > 0, the fast tier needs x to be a normal float.
+inline float rsqrt(float x, Precision precision = PRECISION_DEFAULT) {
+#ifdef MATH_SSE
+	if (precision == PRECISION_FAST)
+		return _mm_cvtss_f32(_rsqrtFast4(_mm_set_ss(x)));
+#endif
+
+	return 1.0f / std::sqrt(x);
+}
+
+} // namespace math
+
+#endif // !MATH_PRECISION_H
@@ -0,0 +1,147 @@
+#ifndef MATH_QUAT_H
+#define MATH_QUAT_H
+
+#include <cmath>
+
+#include "mat4.h"
+#include "precision.h"
+#include "simd.h"
+#include "vec3.h"
+#include "vec4.h"
+
+namespace math {
+
+class quat;
+
+constexpr quat conjugate(const quat &q);
+constexpr float dot(const quat &a, const quat &b);
+quat normalize(const quat &q, Precision precision = PRECISION_DEFAULT);
+
+// Rotation by angle radians around the unit vector axis.
+quat angleAxis(float angle, const vec3 &axis);
+vec3 rotate(const quat &q, const vec3 &v);
+
+// Shortest path interpolation of unit quaternions, nlerp normalizes the linear blend, slerp keeps a constant speed.
+quat nlerp(const quat &a, const quat &b, float t);
+quat slerp(const quat &a, const quat &b, float t);
+
+mat4 quatMatrix(const quat &q);
+
+// Rotation as (axis * sin(angle / 2), cos(angle / 2)), x, y, z, w like glTF. Not aligned so that trs packs
+// into 40 bytes, the SSE product loads it unaligned.
+class quat {
+public:
+	float x, y, z, w;
+
+	quat operator*(const quat &q) const; // applies q first
+	void operator*=(const quat &q);
+
+	quat() {}
+	constexpr quat(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+	constexpr quat(const vec3 &_xyz, float _w) : x(_xyz.x), y(_xyz.y), z(_xyz.z), w(_w) {}
+};
+
+constexpr quat QUAT_IDENTITY = quat(0.0f, 0.0f, 0.0f, 1.0f);
+
+// The inverse of a unit quaternion.
+constexpr quat conjugate(const quat &q) {
+	return quat(-q.x, -q.y, -q.z, q.w);
+}
+
+constexpr float dot(const quat &a, const quat &b) {
+	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+}
+
+inline quat normalize(const quat &q, Precision precision) {
+	float denom = rsqrt(dot(q, q), precision);
+	return quat(q.x * denom, q.y * denom, q.z * denom, q.w * denom);
+}
+
+inline quat angleAxis(float angle, const vec3 &axis) {
+	return quat(axis * std::sin(angle * 0.5f), std::cos(angle * 0.5f));
+}
+
+// v + 2 * cross(u, cross(u, v) + w * v) with u the vector part, cheaper than going through a matrix.
+inline vec3 rotate(const quat &q, const vec3 &v) {
+	vec3 u = vec3(q.x, q.y, q.z);
+	vec3 t = cross(u, v) * 2.0f;
+	return v + t * q.w + cross(u, t);
+}
+
+inline quat nlerp(const quat &a, const quat &b, float t) {
+	// q and -q are the same rotation, blend towards the one on a's side
+	float weight = dot(a, b) < 0.0f ? -t : t;
+	float remainder = 1.0f - t;
+	return normalize(quat(a.x * remainder + b.x * weight, a.y * remainder + b.y * weight,
+			a.z * remainder + b.z * weight, a.w * remainder + b.w * weight));
+}
+
+inline quat slerp(const quat &a, const quat &b, float t) {
+	float cosAngle = dot(a, b);
+	float sign = cosAngle < 0.0f ? -1.0f : 1.0f;
+	cosAngle *= sign;
+
+	// sin(angle) vanishes for nearly equal rotations, where the linear blend is just as good
+	if (cosAngle > 0.9995f)
+		return nlerp(a, b, t);
+
+	float angle = std::acos(cosAngle);
+	float denom = 1.0f / std::sin(angle);
+	float remainder = std::sin((1.0f - t) * angle) * denom;
+	float weight = std::sin(t * angle) * denom * sign;
+
+	return quat(a.x * remainder + b.x * weight, a.y * remainder + b.y * weight, a.z * remainder + b.z * weight,
+			a.w * remainder + b.w * weight);
+}
+
+inline mat4 quatMatrix(const quat &q) {
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	return mat4(vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f),
+			vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f),
+			vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f), vec4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+// Hamilton product a * b.
+inline quat _quatMul(const quat &a, const quat &b) {
+#ifdef MATH_SSE
+	// a.w * b plus a.x, a.y and a.z times b permuted and with the signs of the product flipped in
+	__m128 left = _mm_loadu_ps(&a.x);
+	__m128 right = _mm_loadu_ps(&b.x);
+
+	__m128 sum = _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(3, 3, 3, 3)), right);
+
+	__m128 term = _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(0, 0, 0, 0)),
+			_mm_shuffle_ps(right, right, _MM_SHUFFLE(0, 1, 2, 3)));
+	sum = _mm_add_ps(sum, _mm_xor_ps(term, _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)));
+
+	term = _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(1, 1, 1, 1)),
+			_mm_shuffle_ps(right, right, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_ps(sum, _mm_xor_ps(term, _mm_setr_ps(0.0f, 0.0f, -0.0f, -0.0f)));
+
+	term = _mm_mul_ps(_mm_shuffle_ps(left, left, _MM_SHUFFLE(2, 2, 2, 2)),
+			_mm_shuffle_ps(right, right, _MM_SHUFFLE(2, 3, 0, 1)));
+	sum = _mm_add_ps(sum, _mm_xor_ps(term, _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f)));
+
+	quat out;
+	_mm_storeu_ps(&out.x, sum);
+	return out;
+#else
+	return quat(a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+			a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+#endif
+}
+
+inline quat quat::operator*(const quat &q) const {
+	return _quatMul(*this, q);
+}
+
+inline void quat::operator*=(const quat &q) {
+	*this = _quatMul(*this, q);
+}
+
+} // namespace math
+
+#endif // !MATH_QUAT_H
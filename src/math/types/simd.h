@@ -0,0 +1,19 @@
+#ifndef MATH_SIMD_H
+#define MATH_SIMD_H
+
+// Backend of vec4 and mat4, picked at compile time from the target:
+//   MATH_AVX2  256 bit mat4 products with FMA, build with RENDERER_AVX2 (-mavx2 -mfma)
+//   MATH_SSE   128 bit vec4 and mat4, any x86-64 target
+//   neither    scalar, also forced with MATH_SCALAR (RENDERER_MATH_SCALAR) to compare against
+// MATH_AVX2 implies MATH_SSE, the vec4 operations stay 128 bit.
+#if !defined(MATH_SCALAR) && defined(__SSE2__)
+#define MATH_SSE
+#include <emmintrin.h>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define MATH_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#endif // !MATH_SIMD_H
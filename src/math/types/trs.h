@@ -0,0 +1,100 @@
+#ifndef MATH_TRS_H
+#define MATH_TRS_H
+
+#include <cmath>
+
+#include "mat4.h"
+#include "quat.h"
+#include "vec3.h"
+#include "vec4.h"
+
+namespace math {
+
+class trs;
+
+mat4 trsMatrix(const trs &transform);
+
+// Shear is dropped, a negative determinant ends up as a negative x scale.
+trs trsDecompose(const mat4 &matrix);
+
+// Translation * rotation * scale, the layout of Transform in io/types/hierarchy.h: 40 bytes, no padding.
+class trs {
+public:
+	vec3 translation;
+	quat rotation; // unit
+	vec3 scale;
+
+	trs() {}
+	constexpr trs(const vec3 &_translation, const quat &_rotation, const vec3 &_scale)
+		: translation(_translation), rotation(_rotation), scale(_scale) {}
+};
+
+constexpr trs TRS_IDENTITY = trs(vec3(0.0f), QUAT_IDENTITY, vec3(1.0f));
+
+inline mat4 trsMatrix(const trs &transform) {
+	const quat &q = transform.rotation;
+	const vec3 &s = transform.scale;
+	const vec3 &t = transform.translation;
+
+	float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+	float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+	float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+	return mat4(vec4((1.0f - 2.0f * (yy + zz)) * s.x, 2.0f * (xy + wz) * s.x, 2.0f * (xz - wy) * s.x, 0.0f),
+			vec4(2.0f * (xy - wz) * s.y, (1.0f - 2.0f * (xx + zz)) * s.y, 2.0f * (yz + wx) * s.y, 0.0f),
+			vec4(2.0f * (xz + wy) * s.z, 2.0f * (yz - wx) * s.z, (1.0f - 2.0f * (xx + yy)) * s.z, 0.0f),
+			vec4(t, 1.0f));
+}
+
+inline trs trsDecompose(const mat4 &matrix) {
+	trs transform;
+	transform.translation = vec3(matrix.w.x, matrix.w.y, matrix.w.z);
+
+	const vec4 *columns[3] = { &matrix.x, &matrix.y, &matrix.z };
+	float *scale = &transform.scale.x;
+
+	float r[3][3];
+	for (int c = 0; c < 3; c++) {
+		const vec4 &column = *columns[c];
+		float s = std::sqrt(column.x * column.x + column.y * column.y + column.z * column.z);
+
+		scale[c] = s;
+		r[c][0] = s != 0.0f ? column.x / s : 0.0f;
+		r[c][1] = s != 0.0f ? column.y / s : 0.0f;
+		r[c][2] = s != 0.0f ? column.z / s : 0.0f;
+	}
+
+	// a mirrored basis is not a rotation, fold the reflection into the x scale
+	float determinant = r[0][0] * (r[1][1] * r[2][2] - r[2][1] * r[1][2]) -
+			r[1][0] * (r[0][1] * r[2][2] - r[2][1] * r[0][2]) + r[2][0] * (r[0][1] * r[1][2] - r[1][1] * r[0][2]);
+
+	if (determinant < 0.0f) {
+		scale[0] = -scale[0];
+		for (int k = 0; k < 3; k++)
+			r[0][k] = -r[0][k];
+	}
+
+	// Shepperd: divide by the largest of the four quaternion components
+	quat &q = transform.rotation;
+	float trace = r[0][0] + r[1][1] + r[2][2];
+
+	if (trace > 0.0f) {
+		float s = std::sqrt(trace + 1.0f) * 2.0f;
+		q = quat((r[1][2] - r[2][1]) / s, (r[2][0] - r[0][2]) / s, (r[0][1] - r[1][0]) / s, 0.25f * s);
+	} else if (r[0][0] > r[1][1] && r[0][0] > r[2][2]) {
+		float s = std::sqrt(1.0f + r[0][0] - r[1][1] - r[2][2]) * 2.0f;
+		q = quat(0.25f * s, (r[1][0] + r[0][1]) / s, (r[2][0] + r[0][2]) / s, (r[1][2] - r[2][1]) / s);
+	} else if (r[1][1] > r[2][2]) {
+		float s = std::sqrt(1.0f + r[1][1] - r[0][0] - r[2][2]) * 2.0f;
+		q = quat((r[1][0] + r[0][1]) / s, 0.25f * s, (r[2][1] + r[1][2]) / s, (r[2][0] - r[0][2]) / s);
+	} else {
+		float s = std::sqrt(1.0f + r[2][2] - r[0][0] - r[1][1]) * 2.0f;
+		q = quat((r[2][0] + r[0][2]) / s, (r[2][1] + r[1][2]) / s, 0.25f * s, (r[0][1] - r[1][0]) / s);
+	}
+
+	return transform;
+}
+
+} // namespace math
+
+#endif // !MATH_TRS_H
@@ -1,29 +1,35 @@
 #ifndef MATH_VEC3_H
 #define MATH_VEC3_H
 
+#include <cfloat>
+#include <cmath>
+
+#include "precision.h"
+
 namespace math {
 
 class vec3;
 
-vec3 cross(const vec3 &a, const vec3 &b);
+constexpr vec3 cross(const vec3 &a, const vec3 &b);
 float distance(const vec3 &a, const vec3 &b);
-float dot(const vec3 &a, const vec3 &b);
-float length(const vec3 &v);
-vec3 normalize(const vec3 &v);
+constexpr float dot(const vec3 &a, const vec3 &b);
+float length(const vec3 &v, Precision precision = PRECISION_DEFAULT);
+vec3 normalize(const vec3 &v, Precision precision = PRECISION_DEFAULT);
 
+// Header only so every operation inlines into the loops using it, the constexpr ones also work in constants.
 class vec3 {
 public:
 	float x, y, z;
 
-	vec3 operator-() const;
+	constexpr vec3 operator-() const;
 
-	vec3 operator*(float v) const;
-	vec3 operator/(float v) const;
+	constexpr vec3 operator*(float v) const;
+	constexpr vec3 operator/(float v) const;
 
-	vec3 operator+(const vec3 &v) const;
-	vec3 operator-(const vec3 &v) const;
-	vec3 operator*(const vec3 &v) const;
-	vec3 operator/(const vec3 &v) const;
+	constexpr vec3 operator+(const vec3 &v) const;
+	constexpr vec3 operator-(const vec3 &v) const;
+	constexpr vec3 operator*(const vec3 &v) const;
+	constexpr vec3 operator/(const vec3 &v) const;
 
 	void operator*=(float v);
 	void operator/=(float v);
@@ -34,10 +40,100 @@ public:
 	void operator/=(const vec3 &v);
 
 	vec3() {}
-	vec3(float _v);
-	vec3(float _x, float _y, float _z);
+	constexpr vec3(float _v) : x(_v), y(_v), z(_v) {}
+	constexpr vec3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
 };
 
+constexpr vec3 cross(const vec3 &a, const vec3 &b) {
+	return vec3((a.y * b.z) - (a.z * b.y), (a.z * b.x) - (a.x * b.z), (a.x * b.y) - (a.y * b.x));
+}
+
+inline float distance(const vec3 &a, const vec3 &b) {
+	vec3 v = a - b;
+	return std::sqrt((v.x * v.x) + (v.y * v.y) + (v.z * v.z));
+}
+
+constexpr float dot(const vec3 &a, const vec3 &b) {
+	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z);
+}
+
+// The fast tier only pays off when the length divides something, sqrt alone is about as cheap.
+inline float length(const vec3 &v, Precision precision) {
+	float squared = dot(v, v);
+	if (precision == PRECISION_FAST && squared >= FLT_MIN)
+		return squared * rsqrt(squared, PRECISION_FAST);
+
+	return std::sqrt(squared);
+}
+
+inline vec3 normalize(const vec3 &v, Precision precision) {
+	return v * rsqrt(dot(v, v), precision);
+}
+
+constexpr vec3 vec3::operator-() const {
+	return vec3(-x, -y, -z);
+}
+
+constexpr vec3 vec3::operator*(float v) const {
+	return vec3(x * v, y * v, z * v);
+}
+
+constexpr vec3 vec3::operator/(float v) const {
+	return vec3(x / v, y / v, z / v);
+}
+
+constexpr vec3 vec3::operator+(const vec3 &v) const {
+	return vec3(x + v.x, y + v.y, z + v.z);
+}
+
+constexpr vec3 vec3::operator-(const vec3 &v) const {
+	return vec3(x - v.x, y - v.y, z - v.z);
+}
+
+constexpr vec3 vec3::operator*(const vec3 &v) const {
+	return vec3(x * v.x, y * v.y, z * v.z);
+}
+
+constexpr vec3 vec3::operator/(const vec3 &v) const {
+	return vec3(x / v.x, y / v.y, z / v.z);
+}
+
+inline void vec3::operator*=(float v) {
+	x *= v;
+	y *= v;
+	z *= v;
+}
+
+inline void vec3::operator/=(float v) {
+	x /= v;
+	y /= v;
+	z /= v;
+}
+
+inline void vec3::operator+=(const vec3 &v) {
+	x += v.x;
+	y += v.y;
+	z += v.z;
+}
+
+inline void vec3::operator-=(const vec3 &v) {
+	x -= v.x;
+	y -= v.y;
+	z -= v.z;
+}
+
+inline void vec3::operator*=(const vec3 &v) {
+	x *= v.x;
+	y *= v.y;
+	z *= v.z;
+}
+
+inline void vec3::operator/=(const vec3 &v) {
+	x /= v.x;
+	y /= v.y;
+	z /= v.z;
+}
+
 } // namespace math
 
 #endif // !MATH_VEC3_H
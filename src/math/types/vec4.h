@@ -1,16 +1,24 @@
 #ifndef MATH_VEC4_H
 #define MATH_VEC4_H
 
+#include <cfloat>
+#include <cmath>
+
+#include "precision.h"
+#include "simd.h"
+#include "vec3.h"
+
 namespace math {
 
-class vec3;
 class vec4;
 
-float dot(const vec4 &a, const vec4 &b);
-float length(const vec4 &v);
-vec4 normalize(const vec4 &v);
+constexpr float dot(const vec4 &a, const vec4 &b);
+float length(const vec4 &v, Precision precision = PRECISION_DEFAULT);
+vec4 normalize(const vec4 &v, Precision precision = PRECISION_DEFAULT);
 
-class vec4 {
+// 16 byte aligned so the SIMD backends load and store it whole, see simd.h.
+// The constructors are constexpr, the arithmetic is inline but not constexpr since it uses intrinsics.
+class alignas(16) vec4 {
 public:
 	float x, y, z, w;
 
@@ -33,11 +41,182 @@ public:
 	void operator/=(const vec4 &v);
 
 	vec4() {}
-	vec4(float _v);
-	vec4(const vec3 &_xyz, float _w);
-	vec4(float _x, float _y, float _z, float _w);
+	constexpr vec4(float _v) : x(_v), y(_v), z(_v), w(_v) {}
+	constexpr vec4(const vec3 &_xyz, float _w) : x(_xyz.x), y(_xyz.y), z(_xyz.z), w(_w) {}
+	constexpr vec4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
 };
 
-}; // namespace math
+// A single dot product gains nothing from a horizontal add, both backends share the scalar one.
+constexpr float dot(const vec4 &a, const vec4 &b) {
+	return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+}
+
+inline float length(const vec4 &v, Precision precision) {
+	float squared = dot(v, v);
+	if (precision == PRECISION_FAST && squared >= FLT_MIN)
+		return squared * rsqrt(squared, PRECISION_FAST);
+
+	return std::sqrt(squared);
+}
+
+#ifdef MATH_SSE
+
+inline __m128 _vec4Load(const vec4 &v) {
+	return _mm_load_ps(&v.x);
+}
+
+inline vec4 _vec4Store(__m128 v) {
+	vec4 out;
+	_mm_store_ps(&out.x, v);
+	return out;
+}
+
+// The sum of all four lanes in every lane.
+inline __m128 _vec4HorizontalAdd(__m128 v) {
+	__m128 pairs = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+inline vec4 normalize(const vec4 &v, Precision precision) {
+	__m128 value = _vec4Load(v);
+	__m128 squared = _vec4HorizontalAdd(_mm_mul_ps(value, value));
+
+	if (precision == PRECISION_FAST)
+		return _vec4Store(_mm_mul_ps(value, _rsqrtFast4(squared)));
+
+	return _vec4Store(_mm_div_ps(value, _mm_sqrt_ps(squared)));
+}
+
+inline vec4 vec4::operator-() const {
+	return _vec4Store(_mm_xor_ps(_vec4Load(*this), _mm_set1_ps(-0.0f)));
+}
+
+inline vec4 vec4::operator*(float v) const {
+	return _vec4Store(_mm_mul_ps(_vec4Load(*this), _mm_set1_ps(v)));
+}
+
+inline vec4 vec4::operator/(float v) const {
+	return _vec4Store(_mm_div_ps(_vec4Load(*this), _mm_set1_ps(v)));
+}
+
+inline vec4 vec4::operator+(const vec4 &v) const {
+	return _vec4Store(_mm_add_ps(_vec4Load(*this), _vec4Load(v)));
+}
+
+inline vec4 vec4::operator-(const vec4 &v) const {
+	return _vec4Store(_mm_sub_ps(_vec4Load(*this), _vec4Load(v)));
+}
+
+inline vec4 vec4::operator*(const vec4 &v) const {
+	return _vec4Store(_mm_mul_ps(_vec4Load(*this), _vec4Load(v)));
+}
+
+inline vec4 vec4::operator/(const vec4 &v) const {
+	return _vec4Store(_mm_div_ps(_vec4Load(*this), _vec4Load(v)));
+}
+
+inline void vec4::operator*=(float v) {
+	*this = *this * v;
+}
+
+inline void vec4::operator/=(float v) {
+	*this = *this / v;
+}
+
+inline void vec4::operator+=(const vec4 &v) {
+	*this = *this + v;
+}
+
+inline void vec4::operator-=(const vec4 &v) {
+	*this = *this - v;
+}
+
+inline void vec4::operator*=(const vec4 &v) {
+	*this = *this * v;
+}
+
+inline void vec4::operator/=(const vec4 &v) {
+	*this = *this / v;
+}
+
+#else
+
+inline vec4 normalize(const vec4 &v, Precision precision) {
+	return v * rsqrt(dot(v, v), precision);
+}
+
+inline vec4 vec4::operator-() const {
+	return vec4(-x, -y, -z, -w);
+}
+
+inline vec4 vec4::operator*(float v) const {
+	return vec4(x * v, y * v, z * v, w * v);
+}
+
+inline vec4 vec4::operator/(float v) const {
+	return vec4(x / v, y / v, z / v, w / v);
+}
+
+inline vec4 vec4::operator+(const vec4 &v) const {
+	return vec4(x + v.x, y + v.y, z + v.z, w + v.w);
+}
+
+inline vec4 vec4::operator-(const vec4 &v) const {
+	return vec4(x - v.x, y - v.y, z - v.z, w - v.w);
+}
+
+inline vec4 vec4::operator*(const vec4 &v) const {
+	return vec4(x * v.x, y * v.y, z * v.z, w * v.w);
+}
+
+inline vec4 vec4::operator/(const vec4 &v) const {
+	return vec4(x / v.x, y / v.y, z / v.z, w / v.w);
+}
+
+inline void vec4::operator*=(float v) {
+	x *= v;
+	y *= v;
+	z *= v;
+	w *= v;
+}
+
+inline void vec4::operator/=(float v) {
+	x /= v;
+	y /= v;
+	z /= v;
+	w /= v;
+}
+
+inline void vec4::operator+=(const vec4 &v) {
+	x += v.x;
+	y += v.y;
+	z += v.z;
+	w += v.w;
+}
+
+inline void vec4::operator-=(const vec4 &v) {
+	x -= v.x;
+	y -= v.y;
+	z -= v.z;
+	w -= v.w;
+}
+
+inline void vec4::operator*=(const vec4 &v) {
+	x *= v.x;
+	y *= v.y;
+	z *= v.z;
+	w *= v.w;
+}
+
+inline void vec4::operator/=(const vec4 &v) {
+	x /= v.x;
+	y /= v.y;
+	z /= v.z;
+	w /= v.w;
+}
+
+#endif // MATH_SSE
+
+} // namespace math
 
 #endif // !MATH_VEC4_H
@@ -1,7 +1,7 @@
 #ifndef VK_ATTRIBUTES_H
 #define VK_ATTRIBUTES_H
 
-#include <io/vertex.h>
+#include <io/types/vertex.h>
 #include <vulkan/vulkan_core.h>
 
 const VkVertexInputBindingDescription VERTEX_BINDING = { 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX };
@@ -9,8 +9,22 @@ const VkVertexInputBindingDescription VERTEX_BINDING = { 0, sizeof(Vertex), VK_V
 const VkVertexInputAttributeDescription VERTEX_ATTRIBUTES[] = {
 	{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position) },
 	{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal) },
-	{ 2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, tangent) },
+	{ 2, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(Vertex, tangent) },
 	{ 3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, texCoord) },
 };
 
+// For material_compact.vert, the model matrix must include VertexQuantizer::positionMatrix.
+const VkVertexInputBindingDescription COMPACT_VERTEX_BINDING = {
+	0,
+	sizeof(CompactVertex),
+	VK_VERTEX_INPUT_RATE_VERTEX,
+};
+
+const VkVertexInputAttributeDescription COMPACT_VERTEX_ATTRIBUTES[] = {
+	{ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(CompactVertex, position) },
+	{ 1, 0, VK_FORMAT_R16G16_SNORM, offsetof(CompactVertex, normal) },
+	{ 2, 0, VK_FORMAT_R16G16_SNORM, offsetof(CompactVertex, tangent) },
+	{ 3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(CompactVertex, texCoord) },
+};
+
 #endif // !VK_ATTRIBUTES_H
@@ -85,13 +85,14 @@ void RD::bufferDestroy(AllocatedBuffer buffer) {
 	vmaDestroyBuffer(m_allocator, buffer.handle, buffer.allocation);
 }
 
-AllocatedImage RD::imageCreate(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage) {
+AllocatedImage RD::imageCreate(
+		uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, uint32_t mipCount) {
 	VkImageCreateInfo imageInfo = {};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
 	imageInfo.imageType = VK_IMAGE_TYPE_2D;
 	imageInfo.format = format;
 	imageInfo.extent = { width, height, 1 };
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipCount;
 	imageInfo.arrayLayers = 1;
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
@@ -110,7 +111,10 @@ AllocatedImage RD::imageCreate(uint32_t width, uint32_t height, VkFormat format,
 	return image;
 }
 
-void RD::imageUpdate(VkImage image, uint32_t width, uint32_t height, VkFormat format, void *data, size_t size) {
+// Copies data into a staging buffer and from there into the regions, every level a region
+// touches ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+void RD::_imageUpload(
+		VkImage image, const void *data, size_t size, const VkBufferImageCopy *regions, uint32_t regionCount) {
 	VmaAllocationInfo stagingAllocInfo;
 	VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
 
@@ -120,14 +124,14 @@ void RD::imageUpdate(VkImage image, uint32_t width, uint32_t height, VkFormat fo
 
 	VkCommandBuffer commandBuffer = _beginSingleTimeCommands();
 
-	{
-		VkImageSubresourceRange subresourceRange = {};
-		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		subresourceRange.baseMipLevel = 0;
-		subresourceRange.levelCount = 1;
-		subresourceRange.baseArrayLayer = 0;
-		subresourceRange.layerCount = 1;
+	VkImageSubresourceRange subresourceRange = {};
+	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	subresourceRange.baseMipLevel = 0;
+	subresourceRange.levelCount = regionCount;
+	subresourceRange.baseArrayLayer = 0;
+	subresourceRange.layerCount = 1;
 
+	{
 		VkImageMemoryBarrier imageBarrier = {};
 		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 		imageBarrier.srcAccessMask = VK_ACCESS_NONE;
@@ -143,34 +147,10 @@ void RD::imageUpdate(VkImage image, uint32_t width, uint32_t height, VkFormat fo
 				nullptr, 0, nullptr, 1, &imageBarrier);
 	}
 
-	{
-		VkImageSubresourceLayers imageSubresource = {};
-		imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		imageSubresource.mipLevel = 0;
-		imageSubresource.baseArrayLayer = 0;
-		imageSubresource.layerCount = 1;
-
-		VkExtent3D imageExtent = {};
-		imageExtent.width = width;
-		imageExtent.height = height;
-		imageExtent.depth = 1;
-
-		VkBufferImageCopy region = {};
-		region.imageSubresource = imageSubresource;
-		region.imageExtent = imageExtent;
-
-		vkCmdCopyBufferToImage(
-				commandBuffer, stagingBuffer.handle, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-	}
+	vkCmdCopyBufferToImage(
+			commandBuffer, stagingBuffer.handle, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, regions);
 
 	{
-		VkImageSubresourceRange subresourceRange = {};
-		subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		subresourceRange.baseMipLevel = 0;
-		subresourceRange.levelCount = 1;
-		subresourceRange.baseArrayLayer = 0;
-		subresourceRange.layerCount = 1;
-
 		VkImageMemoryBarrier imageBarrier = {};
 		imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 		imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -190,15 +170,58 @@ void RD::imageUpdate(VkImage image, uint32_t width, uint32_t height, VkFormat fo
 	bufferDestroy(stagingBuffer);
 }
 
+void RD::imageUpdate(VkImage image, uint32_t width, uint32_t height, VkFormat format, void *data, size_t size) {
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { width, height, 1 };
+
+	_imageUpload(image, data, size, &region, 1);
+}
+
+VkFormat RD::textureFormat(const Texture &texture) {
+	switch (texture.format) {
+		case TEXTURE_FORMAT_BC1:
+			return texture.srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC4:
+			return VK_FORMAT_BC4_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC5:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+		case TEXTURE_FORMAT_BC7:
+			return texture.srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+		default:
+			return texture.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+void RD::textureUpdate(VkImage image, const Texture &texture) {
+	// levels are tightly packed, for block formats a zero row length already means whole blocks
+	VkBufferImageCopy regions[TEXTURE_MAX_MIPS] = {};
+
+	for (uint32_t i = 0; i < texture.mipCount; i++) {
+		VkBufferImageCopy &region = regions[i];
+		region.bufferOffset = texture.mips[i].offset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = { texture.mips[i].width, texture.mips[i].height, 1 };
+	}
+
+	_imageUpload(image, texture.data, texture.size, regions, texture.mipCount);
+}
+
 void RD::imageDestroy(AllocatedImage image) {
 	vmaDestroyImage(m_allocator, image.handle, image.allocation);
 }
 
-VkImageView RD::imageViewCreate(VkImage image, VkFormat format) {
+VkImageView RD::imageViewCreate(VkImage image, VkFormat format, uint32_t mipCount) {
 	VkImageSubresourceRange subresourceRange = {};
 	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = 1;
+	subresourceRange.levelCount = mipCount;
 	subresourceRange.baseArrayLayer = 0;
 	subresourceRange.layerCount = 1;
 
@@ -4,6 +4,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <io/types/texture.h>
+
 #include "common/vk_allocated.h"
 #include "vulkan_context.h"
 
@@ -45,17 +47,27 @@ private:
 	VkCommandBuffer _beginSingleTimeCommands();
 	void _endSingleTimeCommands(VkCommandBuffer commandBuffer);
 
+	void _imageUpload(VkImage image, const void *data, size_t size, const VkBufferImageCopy *regions,
+			uint32_t regionCount);
+
 public:
 	AllocatedBuffer bufferCreate(size_t size, VkBufferUsageFlags usage, VmaAllocationInfo *allocInfo);
 	void bufferCopy(VkBuffer srcBuffer, VkBuffer dstBuffer, size_t size);
 	void bufferUpdate(VkBuffer buffer, void *data, size_t size);
 	void bufferDestroy(AllocatedBuffer buffer);
 
-	AllocatedImage imageCreate(uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage);
+	AllocatedImage imageCreate(
+			uint32_t width, uint32_t height, VkFormat format, VkImageUsageFlags usage, uint32_t mipCount = 1);
 	void imageUpdate(VkImage image, uint32_t width, uint32_t height, VkFormat format, void *data, size_t size);
 	void imageDestroy(AllocatedImage image);
 
-	VkImageView imageViewCreate(VkImage image, VkFormat format);
+	// Format of a loaded texture, block compressed chains are sampled as they are.
+	static VkFormat textureFormat(const Texture &texture);
+
+	// Uploads every level of texture in one staging copy, image needs texture.mipCount levels.
+	void textureUpdate(VkImage image, const Texture &texture);
+
+	VkImageView imageViewCreate(VkImage image, VkFormat format, uint32_t mipCount = 1);
 	void imageViewDestroy(VkImageView imageView);
 
 	VkInstance vulkanInstance();